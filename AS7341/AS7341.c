@@ -13,19 +13,88 @@
 
 
 // 静态函数声明
-static bool AS7341_WriteRegister(as7341_handle_t *handle, uint8_t mem_addr, uint8_t *val, uint16_t size);
+static bool AS7341_WriteRegister(as7341_handle_t *handle, uint8_t mem_addr, const uint8_t *val, uint16_t size);
 static bool AS7341_WriteRegisterByte(as7341_handle_t *handle, uint8_t mem_addr, uint8_t val);
 static bool AS7341_ReadRegister(as7341_handle_t *handle, uint16_t mem_addr, uint8_t *dest, uint16_t size);
 static uint8_t AS7341_ReadRegisterByte(as7341_handle_t *handle, uint16_t mem_addr);
+static uint8_t AS7341_FetchRegisterByte(as7341_handle_t *handle, uint16_t mem_addr);
+static int8_t AS7341_ShadowIndex(uint16_t mem_addr);
+static void AS7341_UpdateCountsScale(as7341_handle_t *handle);
+static void AS7341_ShadowStore(as7341_handle_t *handle, uint16_t mem_addr, const uint8_t *val, uint16_t size);
 static bool AS7341_ModifyRegisterBit(as7341_handle_t *handle, uint16_t reg, bool value, uint8_t pos);
 static uint8_t AS7341_CheckRegisterBit(as7341_handle_t *handle, uint16_t reg, uint8_t pos);
 static uint8_t AS7341_ModifyBitInByte(uint8_t var, uint8_t value, uint8_t pos);
 static bool AS7341_ModifyRegisterMultipleBit(as7341_handle_t *handle, uint16_t reg, uint8_t value, uint8_t pos, uint8_t bits);
 static bool AS7341_EnableSMUX(as7341_handle_t *handle);
 static bool AS7341_SetSMUXCommand(as7341_handle_t *handle, as7341_smux_cmd_t command);
+static bool AS7341_LoadSMUX(as7341_handle_t *handle, const uint8_t *smux_map);
 static void AS7341_SetSMUXLowChannels(as7341_handle_t *handle, bool f1_f4);
+static void AS7341_ArmInterrupt(as7341_handle_t *handle);
+static void AS7341_WaitForInterrupt(as7341_handle_t *handle, uint32_t timeout_ms);
 static bool AS7341_InitDevice(as7341_handle_t *handle, int32_t sensor_id);
 
+// 影子寄存器表，顺序对应handle->shadow[]
+// 只缓存由本驱动写入、器件不会自行改变的寄存器；ENABLE的SMUXEN位会自动清零，
+// 轮询时用AS7341_FetchRegisterByte()直接读取并刷新影子
+const uint8_t AS7341_SHADOW_REGS[AS7341_SHADOW_COUNT] = {
+    AS7341_ENABLE, AS7341_ATIME, AS7341_CONFIG, AS7341_LED, AS7341_CFG0,
+    AS7341_CFG1, AS7341_CFG6, AS7341_ASTEP_L, AS7341_ASTEP_H,
+};
+
+// SMUX映射表（对应SMUX RAM 0x00-0x13，每字节高低半字节各控制一个像素连接的ADC）
+
+/**
+ * @brief F1,F2,F3,F4,NIR,Clear的SMUX配置
+ */
+const uint8_t AS7341_SMUX_F1F4_CLEAR_NIR[AS7341_SMUX_SIZE] = {
+    0x30, // 0x00 F3左连接到ADC2
+    0x01, // 0x01 F1左连接到ADC0
+    0x00, // 0x02 保留或禁用
+    0x00, // 0x03 F8左禁用
+    0x00, // 0x04 F6左禁用
+    0x42, // 0x05 F4左连接到ADC3/F2左连接到ADC1
+    0x00, // 0x06 F5左禁用
+    0x00, // 0x07 F7左禁用
+    0x50, // 0x08 CLEAR连接到ADC4
+    0x00, // 0x09 F5右禁用
+    0x00, // 0x0A F7右禁用
+    0x00, // 0x0B 保留或禁用
+    0x20, // 0x0C F2右连接到ADC1
+    0x04, // 0x0D F4右连接到ADC3
+    0x00, // 0x0E F6/F8右禁用
+    0x30, // 0x0F F3右连接到ADC2
+    0x01, // 0x10 F1右连接到ADC0
+    0x50, // 0x11 CLEAR右连接到ADC4
+    0x00, // 0x12 保留或禁用
+    0x06, // 0x13 NIR连接到ADC5
+};
+
+/**
+ * @brief F5,F6,F7,F8,NIR,Clear的SMUX配置
+ */
+const uint8_t AS7341_SMUX_F5F8_CLEAR_NIR[AS7341_SMUX_SIZE] = {
+    0x00, // 0x00 F3左禁用
+    0x00, // 0x01 F1左禁用
+    0x00, // 0x02 保留/禁用
+    0x40, // 0x03 F8左连接到ADC3
+    0x02, // 0x04 F6左连接到ADC1
+    0x00, // 0x05 F4/F2禁用
+    0x10, // 0x06 F5左连接到ADC0
+    0x03, // 0x07 F7左连接到ADC2
+    0x50, // 0x08 CLEAR连接到ADC4
+    0x10, // 0x09 F5右连接到ADC0
+    0x03, // 0x0A F7右连接到ADC2
+    0x00, // 0x0B 保留或禁用
+    0x00, // 0x0C F2右禁用
+    0x00, // 0x0D F4右禁用
+    0x24, // 0x0E F8右连接到ADC2/F6右连接到ADC1
+    0x00, // 0x0F F3右禁用
+    0x00, // 0x10 F1右禁用
+    0x50, // 0x11 CLEAR右连接到ADC4
+    0x00, // 0x12 保留或禁用
+    0x06, // 0x13 NIR连接到ADC5
+};
+
 // 核心函数实现
 
 /**
@@ -44,6 +113,8 @@ bool AS7341_Init(as7341_handle_t *handle, I2C_HandleTypeDef *i2c_handle,
     handle->i2c_handle = i2c_handle;
     handle->i2c_address = i2c_address << 1; 
     handle->reading_state = AS7341_WAITING_START;
+    handle->smux_low = AS7341_SMUX_F1F4_CLEAR_NIR;
+    handle->smux_high = AS7341_SMUX_F5F8_CLEAR_NIR;
     
     // 初始化设备
     bool init_result = AS7341_InitDevice(handle, sensor_id);
@@ -90,6 +161,41 @@ bool AS7341_SetGain(as7341_handle_t *handle, as7341_gain_t gain_value)
     return AS7341_WriteRegisterByte(handle, AS7341_CFG1, gain_value);
 }
 
+/**
+ * @brief 设置两组测量使用的SMUX映射
+ * @note  映射为SMUX RAM 0x00-0x13的20字节内容，NULL恢复默认映射；
+ *        表只保存指针，需在使用期间保持有效（通常定义为const全局数组）
+ */
+bool AS7341_SetSMUXMaps(as7341_handle_t *handle, const uint8_t *low_map, const uint8_t *high_map)
+{
+    if (handle == NULL || !handle->initialized) {
+        return false;
+    }
+    
+    handle->smux_low = (low_map != NULL) ? low_map : AS7341_SMUX_F1F4_CLEAR_NIR;
+    handle->smux_high = (high_map != NULL) ? high_map : AS7341_SMUX_F5F8_CLEAR_NIR;
+    return true;
+}
+
+/**
+ * @brief 写入一组SMUX映射并启用
+ * @note  停止光谱测量后用一次I2C突发写入全部20字节，用于自定义的单次测量
+ */
+bool AS7341_WriteSMUX(as7341_handle_t *handle, const uint8_t *smux_map)
+{
+    if (handle == NULL || !handle->initialized || smux_map == NULL) {
+        return false;
+    }
+    
+    AS7341_EnableSpectralMeasurement(handle, false);
+    if (!AS7341_SetSMUXCommand(handle, AS7341_SMUX_CMD_WRITE) || !AS7341_LoadSMUX(handle, smux_map)) {
+        return false;
+    }
+    bool result = AS7341_EnableSMUX(handle);
+    AS7341_ArmInterrupt(handle);
+    return result;
+}
+
 /**
  * @brief 获取积分步长值
  */
@@ -131,6 +237,8 @@ as7341_gain_t AS7341_GetGain(as7341_handle_t *handle)
 
 /**
  * @brief 获取总积分时间
+ * @note  (ATIME + 1) * (ASTEP + 1) * 2.78us，按毫秒截断；2.78/1000 = 139/50000，
+ *        步数最大2^24，乘139不超过32位
  */
 uint32_t AS7341_GetTINT(as7341_handle_t *handle)
 {
@@ -138,14 +246,14 @@ uint32_t AS7341_GetTINT(as7341_handle_t *handle)
         return 0;
     }
     
-    uint16_t astep = AS7341_GetASTEP(handle);
-    uint8_t atime = AS7341_GetATIME(handle);
+    uint32_t steps = ((uint32_t)AS7341_GetATIME(handle) + 1) * ((uint32_t)AS7341_GetASTEP(handle) + 1);
     
-    return (uint32_t)((atime + 1) * (astep + 1) * 2.78f / 1000.0f);
+    return steps * 139U / 50000U;
 }
 
 /**
  * @brief 将原始ADC值转换为基本计数值
+ * @note  使用缓存的换算系数，参数未改变时不访问总线
  */
 float AS7341_ToBasicCounts(as7341_handle_t *handle, uint16_t raw)
 {
@@ -153,25 +261,54 @@ float AS7341_ToBasicCounts(as7341_handle_t *handle, uint16_t raw)
         return 0.0f;
     }
     
-    float gain_val = 0.0f;
-    as7341_gain_t gain = AS7341_GetGain(handle);
+    if (!handle->counts_scale_valid) {
+        AS7341_UpdateCountsScale(handle);
+    }
+    
+    return raw * handle->counts_scale;
+}
+
+/**
+ * @brief 将channel_readings中的12个通道全部转换为基本计数值
+ * @param basic_counts 输出缓冲区，至少12个元素，顺序同as7341_color_channel_t
+ */
+bool AS7341_ToBasicCountsAll(as7341_handle_t *handle, float *basic_counts)
+{
+    if (handle == NULL || !handle->initialized || basic_counts == NULL) {
+        return false;
+    }
+    
+    if (!handle->counts_scale_valid) {
+        AS7341_UpdateCountsScale(handle);
+    }
+    
+    float scale = handle->counts_scale;
+    for (int i = 0; i < 12; i++) {
+        basic_counts[i] = handle->channel_readings[i] * scale;
+    }
+    return true;
+}
+
+/**
+ * @brief 将12个通道转换为定点基本计数值（Q16.16，无浮点运算）
+ * @param basic_counts 输出缓冲区，至少12个元素
+ * @note  超过65535基本计数（积分时间很短时）饱和为0xFFFFFFFF
+ */
+bool AS7341_ToBasicCountsAll_Fixed(as7341_handle_t *handle, uint32_t *basic_counts)
+{
+    if (handle == NULL || !handle->initialized || basic_counts == NULL) {
+        return false;
+    }
     
-    switch (gain) {
-        case AS7341_GAIN_0_5X:  gain_val = 0.5f; break;
-        case AS7341_GAIN_1X:    gain_val = 1.0f; break;
-        case AS7341_GAIN_2X:    gain_val = 2.0f; break;
-        case AS7341_GAIN_4X:    gain_val = 4.0f; break;
-        case AS7341_GAIN_8X:    gain_val = 8.0f; break;
-        case AS7341_GAIN_16X:   gain_val = 16.0f; break;
-        case AS7341_GAIN_32X:   gain_val = 32.0f; break;
-        case AS7341_GAIN_64X:   gain_val = 64.0f; break;
-        case AS7341_GAIN_128X:  gain_val = 128.0f; break;
-        case AS7341_GAIN_256X:  gain_val = 256.0f; break;
-        case AS7341_GAIN_512X:  gain_val = 512.0f; break;
-        default: gain_val = 1.0f; break;
+    if (!handle->counts_scale_valid) {
+        AS7341_UpdateCountsScale(handle);
     }
     
-    return raw / (gain_val * (AS7341_GetATIME(handle) + 1) * (AS7341_GetASTEP(handle) + 1) * 2.78f / 1000.0f);
+    for (int i = 0; i < 12; i++) {
+        uint64_t value = ((uint64_t)handle->channel_readings[i] * handle->counts_scale_mul) >> handle->counts_scale_shift;
+        basic_counts[i] = (value > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)value;
+    }
+    return true;
 }
 
 /**
@@ -217,6 +354,12 @@ void AS7341_DelayForData(as7341_handle_t *handle, uint32_t wait_time)
         return;
     }
     
+    // 中断模式：休眠等待INT，不轮询STATUS2也不空转
+    if (handle->int_enabled) {
+        AS7341_WaitForInterrupt(handle, (wait_time == 0) ? 200 : wait_time);
+        return;
+    }
+    
     if (wait_time == 0) {
         uint32_t timeout_ms = 200;
         uint32_t elapsed_ms = 0;
@@ -402,27 +545,7 @@ void AS7341_Setup_F1F4_Clear_NIR(as7341_handle_t *handle)
         return;
     }
     
-    // F1,F2,F3,F4,NIR,Clear的SMUX配置
-    AS7341_WriteRegisterByte(handle, 0x00, 0x30); // F3左连接到ADC2
-    AS7341_WriteRegisterByte(handle, 0x01, 0x01); // F1左连接到ADC0
-    AS7341_WriteRegisterByte(handle, 0x02, 0x00); // 保留或禁用
-    AS7341_WriteRegisterByte(handle, 0x03, 0x00); // F8左禁用
-    AS7341_WriteRegisterByte(handle, 0x04, 0x00); // F6左禁用
-    AS7341_WriteRegisterByte(handle, 0x05, 0x42); // F4左连接到ADC3/F2左连接到ADC1
-    AS7341_WriteRegisterByte(handle, 0x06, 0x00); // F5左禁用
-    AS7341_WriteRegisterByte(handle, 0x07, 0x00); // F7左禁用
-    AS7341_WriteRegisterByte(handle, 0x08, 0x50); // CLEAR连接到ADC4
-    AS7341_WriteRegisterByte(handle, 0x09, 0x00); // F5右禁用
-    AS7341_WriteRegisterByte(handle, 0x0A, 0x00); // F7右禁用
-    AS7341_WriteRegisterByte(handle, 0x0B, 0x00); // 保留或禁用
-    AS7341_WriteRegisterByte(handle, 0x0C, 0x20); // F2右连接到ADC1
-    AS7341_WriteRegisterByte(handle, 0x0D, 0x04); // F4右连接到ADC3
-    AS7341_WriteRegisterByte(handle, 0x0E, 0x00); // F6/F8右禁用
-    AS7341_WriteRegisterByte(handle, 0x0F, 0x30); // F3右连接到ADC2
-    AS7341_WriteRegisterByte(handle, 0x10, 0x01); // F1右连接到ADC0
-    AS7341_WriteRegisterByte(handle, 0x11, 0x50); // CLEAR右连接到ADC4
-    AS7341_WriteRegisterByte(handle, 0x12, 0x00); // 保留或禁用
-    AS7341_WriteRegisterByte(handle, 0x13, 0x06); // NIR连接到ADC5
+    AS7341_LoadSMUX(handle, AS7341_SMUX_F1F4_CLEAR_NIR);
 }
 
 /**
@@ -434,27 +557,7 @@ void AS7341_Setup_F5F8_Clear_NIR(as7341_handle_t *handle)
         return;
     }
     
-    // F5,F6,F7,F8,NIR,Clear的SMUX配置
-    AS7341_WriteRegisterByte(handle, 0x00, 0x00); // F3左禁用
-    AS7341_WriteRegisterByte(handle, 0x01, 0x00); // F1左禁用
-    AS7341_WriteRegisterByte(handle, 0x02, 0x00); // 保留/禁用
-    AS7341_WriteRegisterByte(handle, 0x03, 0x40); // F8左连接到ADC3
-    AS7341_WriteRegisterByte(handle, 0x04, 0x02); // F6左连接到ADC1
-    AS7341_WriteRegisterByte(handle, 0x05, 0x00); // F4/F2禁用
-    AS7341_WriteRegisterByte(handle, 0x06, 0x10); // F5左连接到ADC0
-    AS7341_WriteRegisterByte(handle, 0x07, 0x03); // F7左连接到ADC2
-    AS7341_WriteRegisterByte(handle, 0x08, 0x50); // CLEAR连接到ADC4
-    AS7341_WriteRegisterByte(handle, 0x09, 0x10); // F5右连接到ADC0
-    AS7341_WriteRegisterByte(handle, 0x0A, 0x03); // F7右连接到ADC2
-    AS7341_WriteRegisterByte(handle, 0x0B, 0x00); // 保留或禁用
-    AS7341_WriteRegisterByte(handle, 0x0C, 0x00); // F2右禁用
-    AS7341_WriteRegisterByte(handle, 0x0D, 0x00); // F4右禁用
-    AS7341_WriteRegisterByte(handle, 0x0E, 0x24); // F8右连接到ADC2/F6右连接到ADC1
-    AS7341_WriteRegisterByte(handle, 0x0F, 0x00); // F3右禁用
-    AS7341_WriteRegisterByte(handle, 0x10, 0x00); // F1右禁用
-    AS7341_WriteRegisterByte(handle, 0x11, 0x50); // CLEAR右连接到ADC4
-    AS7341_WriteRegisterByte(handle, 0x12, 0x00); // 保留或禁用
-    AS7341_WriteRegisterByte(handle, 0x13, 0x06); // NIR连接到ADC5
+    AS7341_LoadSMUX(handle, AS7341_SMUX_F5F8_CLEAR_NIR);
 }
 
 /**
@@ -548,6 +651,7 @@ void AS7341_DisableAll(as7341_handle_t *handle)
 
 /**
  * @brief 检查数据是否就绪
+ * @note  中断模式下只检查EXTI回调设置的标志，不访问总线
  */
 bool AS7341_GetIsDataReady(as7341_handle_t *handle)
 {
@@ -555,9 +659,94 @@ bool AS7341_GetIsDataReady(as7341_handle_t *handle)
         return false;
     }
     
+    if (handle->int_enabled) {
+        return handle->int_pending;
+    }
+    
     return AS7341_CheckRegisterBit(handle, AS7341_STATUS2, 6);
 }
 
+/**
+ * @brief 启用中断模式
+ * @param int_pin INT引脚连接的EXTI引脚（GPIO_PIN_x），需在CubeMX中配置为下降沿中断并上拉
+ * @note  每个光谱测量周期结束时INT拉低（APERS = 0，不比较阈值），
+ *        AS7341_GetIsDataReady()改为检查EXTI回调设置的标志
+ */
+bool AS7341_EnableInterrupt(as7341_handle_t *handle, uint16_t int_pin)
+{
+    if (handle == NULL || !handle->initialized) {
+        return false;
+    }
+    
+    bool result = AS7341_WriteRegisterByte(handle, AS7341_PERS, 0x00) &&
+                  AS7341_ModifyRegisterBit(handle, AS7341_INTENAB, true, 3);    // SP_IEN
+    if (!result) {
+        return false;
+    }
+    
+    handle->int_pin = int_pin;
+    handle->int_pending = false;
+    handle->int_enabled = true;
+    AS7341_WriteRegisterByte(handle, AS7341_STATUS, 0xFF);    // 清除已有的中断，释放INT引脚
+    return true;
+}
+
+/**
+ * @brief 关闭中断模式，恢复轮询STATUS2
+ */
+bool AS7341_DisableInterrupt(as7341_handle_t *handle)
+{
+    if (handle == NULL || !handle->initialized) {
+        return false;
+    }
+    
+    handle->int_enabled = false;
+    handle->int_pending = false;
+    
+    bool result = AS7341_ModifyRegisterBit(handle, AS7341_INTENAB, false, 3);
+    AS7341_WriteRegisterByte(handle, AS7341_STATUS, 0xFF);
+    return result;
+}
+
+/**
+ * @brief INT引脚的EXTI回调
+ * @note  在HAL_GPIO_EXTI_Callback()中调用，记录数据就绪，不访问I2C；
+ *        非阻塞读取正在等待低/高通道组时调用INT通知，由任务调用AS7341_CheckReadingProgress()
+ *        读取数据并进入下一步（读取和重新配置SMUX需要I2C，不能在中断中进行）
+ */
+void AS7341_EXTI_Callback(as7341_handle_t *handle, uint16_t gpio_pin)
+{
+    if (handle == NULL || !handle->int_enabled || gpio_pin != handle->int_pin) {
+        return;
+    }
+    
+    handle->int_pending = true;
+    
+    if (handle->int_notify != NULL &&
+        (handle->reading_state == AS7341_WAITING_LOW || handle->reading_state == AS7341_WAITING_HIGH)) {
+        handle->int_notify(handle->int_notify_ctx);
+    }
+}
+
+/**
+ * @brief 设置INT通知
+ * @param notify 非阻塞读取的一个测量周期结束时调用（中断上下文），NULL取消通知
+ * @param user_ctx 传给notify的参数
+ * @note  一次非阻塞读取通知两次（低、高通道组各一次），每次通知后调用一次
+ *        AS7341_CheckReadingProgress()，第二次返回true
+ */
+void AS7341_SetInterruptNotify(as7341_handle_t *handle, as7341_int_notify_t notify, void *user_ctx)
+{
+    if (handle == NULL) {
+        return;
+    }
+    
+    // 先取消旧的通知，EXTI回调不会拿新参数调用旧函数
+    handle->int_notify = NULL;
+    handle->int_notify_ctx = user_ctx;
+    handle->int_notify = notify;
+}
+
 /**
  * @brief 设置寄存器组
  */
@@ -570,6 +759,56 @@ bool AS7341_SetBank(as7341_handle_t *handle, bool low)
     return AS7341_ModifyRegisterBit(handle, AS7341_CFG0, low, 4);
 }
 
+/**
+ * @brief 使所有影子寄存器失效
+ * @note  之后每个寄存器第一次读取时从器件重新读入
+ */
+void AS7341_InvalidateShadow(as7341_handle_t *handle)
+{
+    if (handle == NULL) {
+        return;
+    }
+    
+    handle->shadow_valid = 0;
+    handle->counts_scale_valid = false;
+}
+
+/**
+ * @brief 从器件重新读入所有影子寄存器
+ */
+bool AS7341_SyncShadow(as7341_handle_t *handle)
+{
+    if (handle == NULL || !handle->initialized) {
+        return false;
+    }
+    
+    handle->shadow_valid = 0;
+    
+    // CFG0决定寄存器组，先读入；CONFIG和LED在0x60-0x74组中
+    AS7341_FetchRegisterByte(handle, AS7341_CFG0);
+    handle->counts_scale_valid = false;
+    bool low_bank = (handle->shadow[AS7341_ShadowIndex(AS7341_CFG0)] >> 4) & 0x01;
+    
+    if (!low_bank) {
+        AS7341_SetBank(handle, true);
+    }
+    AS7341_FetchRegisterByte(handle, AS7341_CONFIG);
+    AS7341_FetchRegisterByte(handle, AS7341_LED);
+    AS7341_SetBank(handle, false);
+    
+    for (int i = 0; i < AS7341_SHADOW_COUNT; i++) {
+        if (!(handle->shadow_valid & (1U << i))) {
+            AS7341_FetchRegisterByte(handle, AS7341_SHADOW_REGS[i]);
+        }
+    }
+    
+    if (low_bank) {
+        AS7341_SetBank(handle, true);
+    }
+    
+    return handle->shadow_valid == (1U << AS7341_SHADOW_COUNT) - 1;
+}
+
 
 // 静态函数实现
 
@@ -647,6 +886,55 @@ static bool AS7341_SetSMUXCommand(as7341_handle_t *handle, as7341_smux_cmd_t com
     return AS7341_ModifyRegisterMultipleBit(handle, AS7341_CFG6, command, 3, 2);
 }
 
+/**
+ * @brief 为下一次测量清除中断
+ * @note  在开始测量前调用（光谱测量已停止），清除STATUS释放INT引脚，
+ *        下一个测量周期结束时再次触发
+ */
+static void AS7341_ArmInterrupt(as7341_handle_t *handle)
+{
+    if (handle == NULL || !handle->int_enabled) {
+        return;
+    }
+    
+    AS7341_WriteRegisterByte(handle, AS7341_STATUS, 0xFF);
+    handle->int_pending = false;
+}
+
+/**
+ * @brief 中断模式下等待数据就绪
+ * @note  用__WFI()休眠到下一个中断（INT的EXTI或SysTick）再检查标志，不访问总线；
+ *        检查与休眠之间到来的INT最多晚一个SysTick被发现。每50ms刷新一次看门狗
+ */
+static void AS7341_WaitForInterrupt(as7341_handle_t *handle, uint32_t timeout_ms)
+{
+    uint32_t start = HAL_GetTick();
+    uint32_t refreshed = start;
+    
+    while (!handle->int_pending && (HAL_GetTick() - start) < timeout_ms) {
+        __WFI();
+        if (HAL_GetTick() - refreshed >= 50) {
+            extern void System_WatchdogRefresh(void);
+            System_WatchdogRefresh();
+            refreshed = HAL_GetTick();
+        }
+    }
+}
+
+/**
+ * @brief 突发写入SMUX映射
+ * @note  需先发出SMUX写命令；SMUX RAM地址连续，一次I2C事务写完20字节，
+ *        代替逐字节写入的20次寻址
+ */
+static bool AS7341_LoadSMUX(as7341_handle_t *handle, const uint8_t *smux_map)
+{
+    if (handle == NULL || smux_map == NULL) {
+        return false;
+    }
+    
+    return AS7341_WriteRegister(handle, AS7341_SMUX_RAM, smux_map, AS7341_SMUX_SIZE);
+}
+
 /**
  * @brief 设置SMUX低通道
  */
@@ -657,13 +945,13 @@ static void AS7341_SetSMUXLowChannels(as7341_handle_t *handle, bool f1_f4)
     }
     
     AS7341_EnableSpectralMeasurement(handle, false);
-    AS7341_SetSMUXCommand(handle, AS7341_SMUX_CMD_WRITE);
-    if (f1_f4) {
-        AS7341_Setup_F1F4_Clear_NIR(handle);
-    } else {
-        AS7341_Setup_F5F8_Clear_NIR(handle);
+    // 没有发出写命令时不写SMUX RAM，避免把映射当作普通寄存器写入
+    if (!AS7341_SetSMUXCommand(handle, AS7341_SMUX_CMD_WRITE)) {
+        return;
     }
+    AS7341_LoadSMUX(handle, f1_f4 ? handle->smux_low : handle->smux_high);
     AS7341_EnableSMUX(handle);
+    AS7341_ArmInterrupt(handle);
 
     HAL_Delay(10);
 }
@@ -671,14 +959,15 @@ static void AS7341_SetSMUXLowChannels(as7341_handle_t *handle, bool f1_f4)
 /**
  * @brief 写入寄存器
  */
-static bool AS7341_WriteRegister(as7341_handle_t *handle, uint8_t mem_addr, uint8_t *val, uint16_t size)
+static bool AS7341_WriteRegister(as7341_handle_t *handle, uint8_t mem_addr, const uint8_t *val, uint16_t size)
 {
     if (handle == NULL || val == NULL) {
         return false;
     }
     
     HAL_StatusTypeDef status = HAL_I2C_Mem_Write(handle->i2c_handle, handle->i2c_address, 
-                                                 mem_addr, 1, val, size, AS7341_TIMEOUT_MS);
+                                                 mem_addr, 1, (uint8_t*)val, size, AS7341_TIMEOUT_MS);
+    AS7341_ShadowStore(handle, mem_addr, (status == HAL_OK) ? val : NULL, size);
     return (status == HAL_OK);
 }
 
@@ -693,6 +982,7 @@ static bool AS7341_WriteRegisterByte(as7341_handle_t *handle, uint8_t mem_addr,
     
     HAL_StatusTypeDef status = HAL_I2C_Mem_Write(handle->i2c_handle, handle->i2c_address, 
                                                  mem_addr, 1, &val, 1, AS7341_TIMEOUT_MS);
+    AS7341_ShadowStore(handle, mem_addr, (status == HAL_OK) ? &val : NULL, 1);
     return (status == HAL_OK);
 }
 
@@ -705,13 +995,30 @@ static bool AS7341_ReadRegister(as7341_handle_t *handle, uint16_t mem_addr, uint
         return false;
     }
     
+    // 整段都有有效影子时不访问总线（如ASTEP）
+    uint16_t i;
+    for (i = 0; i < size; i++) {
+        int8_t index = AS7341_ShadowIndex(mem_addr + i);
+        if (index < 0 || !(handle->shadow_valid & (1U << index))) {
+            break;
+        }
+        dest[i] = handle->shadow[index];
+    }
+    if (i == size) {
+        return true;
+    }
+    
     HAL_StatusTypeDef status = HAL_I2C_Mem_Read(handle->i2c_handle, handle->i2c_address, 
                                                 mem_addr, 1, dest, size, AS7341_TIMEOUT_MS);
+    if (status == HAL_OK) {
+        AS7341_ShadowStore(handle, mem_addr, dest, size);
+    }
     return (status == HAL_OK);
 }
 
 /**
  * @brief 读取单个寄存器字节
+ * @note  有效的影子寄存器直接返回缓存值
  */
 static uint8_t AS7341_ReadRegisterByte(as7341_handle_t *handle, uint16_t mem_addr)
 {
@@ -719,11 +1026,96 @@ static uint8_t AS7341_ReadRegisterByte(as7341_handle_t *handle, uint16_t mem_add
         return 0;
     }
     
+    int8_t index = AS7341_ShadowIndex(mem_addr);
+    if (index >= 0 && (handle->shadow_valid & (1U << index))) {
+        return handle->shadow[index];
+    }
+    
+    return AS7341_FetchRegisterByte(handle, mem_addr);
+}
+
+/**
+ * @brief 从器件读取单个寄存器字节
+ * @note  总是访问总线，读取成功时刷新影子；用于会被器件改变的位
+ */
+static uint8_t AS7341_FetchRegisterByte(as7341_handle_t *handle, uint16_t mem_addr)
+{
+    if (handle == NULL) {
+        return 0;
+    }
+    
     uint8_t data = 0;
-    HAL_I2C_Mem_Read(handle->i2c_handle, handle->i2c_address, mem_addr, 1, &data, 1, AS7341_TIMEOUT_MS);
+    if (HAL_I2C_Mem_Read(handle->i2c_handle, handle->i2c_address, mem_addr, 1, &data, 1, AS7341_TIMEOUT_MS) == HAL_OK) {
+        AS7341_ShadowStore(handle, mem_addr, &data, 1);
+    }
     return data;
 }
 
+/**
+ * @brief 查找寄存器在影子表中的位置
+ * @retval 影子索引，不缓存的寄存器返回-1
+ */
+static int8_t AS7341_ShadowIndex(uint16_t mem_addr)
+{
+    for (int8_t i = 0; i < AS7341_SHADOW_COUNT; i++) {
+        if (AS7341_SHADOW_REGS[i] == mem_addr) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 更新一段寄存器对应的影子
+ * @note  val为NULL表示写入失败，器件中的值未知，使对应影子失效
+ */
+static void AS7341_ShadowStore(as7341_handle_t *handle, uint16_t mem_addr, const uint8_t *val, uint16_t size)
+{
+    for (uint16_t i = 0; i < size; i++) {
+        int8_t index = AS7341_ShadowIndex(mem_addr + i);
+        if (index < 0) {
+            continue;
+        }
+        uint16_t reg = mem_addr + i;
+        if (reg == AS7341_CFG1 || reg == AS7341_ATIME || reg == AS7341_ASTEP_L || reg == AS7341_ASTEP_H) {
+            handle->counts_scale_valid = false;
+        }
+        if (val != NULL) {
+            handle->shadow[index] = val[i];
+            handle->shadow_valid |= (1U << index);
+        } else {
+            handle->shadow_valid &= ~(1U << index);
+        }
+    }
+}
+
+/**
+ * @brief 根据增益、ATIME、ASTEP重新计算基本计数换算系数
+ * @note  基本计数 = raw / (增益 * 积分时间ms)，积分时间ms = 步数 * 2.78 / 1000；
+ *        定点系数按mul / 2^shift = 2^16 * 100000 / (增益 * 步数 * 278)计算，mul保持32位精度
+ */
+static void AS7341_UpdateCountsScale(as7341_handle_t *handle)
+{
+    uint8_t gain = (uint8_t)AS7341_GetGain(handle);
+    uint32_t gain_x2 = (gain <= AS7341_GAIN_512X) ? (1UL << gain) : 2;    // 0.5x对应1
+    uint64_t steps = ((uint64_t)AS7341_GetATIME(handle) + 1) * ((uint64_t)AS7341_GetASTEP(handle) + 1);
+    
+    handle->counts_scale = 2000.0f / (gain_x2 * (float)steps * 2.78f);
+    
+    // 分子2^16 * 200000（增益按2倍计）约2^34，左移最多29位不溢出
+    uint64_t numerator = (uint64_t)200000 << AS7341_BASIC_COUNTS_FRAC_BITS;
+    uint64_t denominator = gain_x2 * steps * 278;
+    uint8_t shift = 0;
+    while (shift < 29 && ((numerator << (shift + 1)) / denominator) <= 0xFFFFFFFFULL) {
+        shift++;
+    }
+    uint64_t mul = (numerator << shift) / denominator;
+    handle->counts_scale_mul = (mul > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)mul;
+    handle->counts_scale_shift = shift;
+    
+    handle->counts_scale_valid = true;
+}
+
 /**
  * @brief 修改寄存器中的单个位
  */
@@ -741,6 +1133,7 @@ static bool AS7341_ModifyRegisterBit(as7341_handle_t *handle, uint16_t reg, bool
 
 /**
  * @brief 检查寄存器中的单个位
+ * @note  用于轮询状态位，总是从器件读取
  */
 static uint8_t AS7341_CheckRegisterBit(as7341_handle_t *handle, uint16_t reg, uint8_t pos)
 {
@@ -748,7 +1141,7 @@ static uint8_t AS7341_CheckRegisterBit(as7341_handle_t *handle, uint16_t reg, ui
         return 0;
     }
     
-    return (uint8_t)((AS7341_ReadRegisterByte(handle, reg) >> pos) & 0x01);
+    return (uint8_t)((AS7341_FetchRegisterByte(handle, reg) >> pos) & 0x01);
 }
 
 /**
@@ -28,6 +28,7 @@
 #define AS7341_CONFIG 0x70
 #define AS7341_LED 0x74
 #define AS7341_STATUS 0x93
+#define AS7341_STATUS2 0xA3
 #define AS7341_CFG0 0xA9
 #define AS7341_CFG1 0xAA
 #define AS7341_CFG6 0xAF
@@ -35,6 +36,8 @@
 #define AS7341_CFG12 0xB5
 #define AS7341_ASTEP_L 0xCA
 #define AS7341_ASTEP_H 0xCB
+#define AS7341_PERS 0xBD
+#define AS7341_INTENAB 0xF9
 
 // ADC通道数据寄存器
 #define AS7341_CH0_DATA_L 0x95
@@ -52,6 +55,16 @@
 
 #define AS7341_TIMEOUT_MS 100
 
+// 影子寄存器（配置寄存器的写直通缓存）
+#define AS7341_SHADOW_COUNT 9
+
+// 定点基本计数的小数位数（AS7341_ToBasicCountsAll_Fixed输出Q16.16）
+#define AS7341_BASIC_COUNTS_FRAC_BITS 16
+
+// SMUX配置RAM（SMUX写命令下0x00-0x13映射为SMUX配置，地址自动递增）
+#define AS7341_SMUX_RAM 0x00
+#define AS7341_SMUX_SIZE 20
+
 /* 枚举类型定义 */
 
 typedef enum {
@@ -107,14 +120,40 @@ typedef enum {
 
 /* 结构体定义 */
 
+// INT通知：非阻塞读取的一个测量周期结束时在EXTI回调（中断上下文）中调用，
+// 应只唤醒任务或置标志，由任务调用AS7341_CheckReadingProgress()读取数据
+typedef void (*as7341_int_notify_t)(void *user_ctx);
+
 typedef struct {
     I2C_HandleTypeDef *i2c_handle;
     uint8_t i2c_address;
     uint16_t channel_readings[12];
     as7341_waiting_t reading_state;
+    const uint8_t *smux_low;    // 低通道组SMUX映射（默认F1-F4、Clear、NIR）
+    const uint8_t *smux_high;   // 高通道组SMUX映射（默认F5-F8、Clear、NIR）
+    uint8_t shadow[AS7341_SHADOW_COUNT]; // 配置寄存器影子（ENABLE、ATIME、CONFIG、LED、CFG0、CFG1、CFG6、ASTEP）
+    uint16_t shadow_valid;      // 影子有效位，每位对应shadow[]中的一个寄存器
+    float counts_scale;         // 基本计数换算系数 1/(增益*积分时间ms)
+    uint32_t counts_scale_mul;  // 定点换算系数，基本计数(Q16.16) = (raw * mul) >> shift
+    uint8_t counts_scale_shift;
+    bool counts_scale_valid;    // 增益、ATIME、ASTEP改变后清除，下次换算时重新计算
+    uint16_t int_pin;           // INT引脚对应的EXTI引脚（GPIO_PIN_x）
+    bool int_enabled;           // 中断模式：数据就绪由INT引脚通知，不再轮询STATUS2
+    volatile bool int_pending;  // EXTI回调置位，开始下一次测量时清除
+    as7341_int_notify_t int_notify; // 非阻塞读取等待的测量完成时调用，NULL不通知
+    void *int_notify_ctx;
     bool initialized;
 } as7341_handle_t;
 
+/* 常量声明 */
+
+// 默认SMUX映射，可复制后修改作为自定义映射
+extern const uint8_t AS7341_SMUX_F1F4_CLEAR_NIR[AS7341_SMUX_SIZE];
+extern const uint8_t AS7341_SMUX_F5F8_CLEAR_NIR[AS7341_SMUX_SIZE];
+
+// 影子寄存器表，顺序对应as7341_handle_t的shadow[]
+extern const uint8_t AS7341_SHADOW_REGS[AS7341_SHADOW_COUNT];
+
 /* 函数声明 */
 
 // 初始化和配置
@@ -122,18 +161,30 @@ bool AS7341_Init(as7341_handle_t *handle, I2C_HandleTypeDef *i2c_handle, uint8_t
 bool AS7341_SetASTEP(as7341_handle_t *handle, uint16_t astep_value);
 bool AS7341_SetATIME(as7341_handle_t *handle, uint8_t atime_value);
 bool AS7341_SetGain(as7341_handle_t *handle, as7341_gain_t gain_value);
+bool AS7341_SetSMUXMaps(as7341_handle_t *handle, const uint8_t *low_map, const uint8_t *high_map);
+bool AS7341_WriteSMUX(as7341_handle_t *handle, const uint8_t *smux_map);
 
 // 数据获取
 uint16_t AS7341_GetASTEP(as7341_handle_t *handle);
 uint8_t AS7341_GetATIME(as7341_handle_t *handle);
 as7341_gain_t AS7341_GetGain(as7341_handle_t *handle);
 uint32_t AS7341_GetTINT(as7341_handle_t *handle);
+float AS7341_ToBasicCounts(as7341_handle_t *handle, uint16_t raw);
+bool AS7341_ToBasicCountsAll(as7341_handle_t *handle, float *basic_counts);
+bool AS7341_ToBasicCountsAll_Fixed(as7341_handle_t *handle, uint32_t *basic_counts);
 
 // 数据读取
 bool AS7341_ReadAllChannels(as7341_handle_t *handle);
 bool AS7341_ReadAllChannels_Blocking(as7341_handle_t *handle);
+bool AS7341_ReadAllChannelsToBuffer(as7341_handle_t *handle, uint16_t *readings_buffer);
+void AS7341_DelayForData(as7341_handle_t *handle, uint32_t wait_time);
 uint16_t AS7341_ReadChannel(as7341_handle_t *handle, as7341_adc_channel_t channel);
 uint16_t AS7341_GetChannel(as7341_handle_t *handle, as7341_color_channel_t channel);
+bool AS7341_GetAllChannels(as7341_handle_t *handle, uint32_t *readings_buffer);
+bool AS7341_StartReading(as7341_handle_t *handle);
+bool AS7341_CheckReadingProgress(as7341_handle_t *handle);
+void AS7341_Setup_F1F4_Clear_NIR(as7341_handle_t *handle);
+void AS7341_Setup_F5F8_Clear_NIR(as7341_handle_t *handle);
 
 // 控制功能
 bool AS7341_PowerEnable(as7341_handle_t *handle, bool enable_power);
@@ -141,6 +192,18 @@ bool AS7341_EnableSpectralMeasurement(as7341_handle_t *handle, bool enable_measu
 bool AS7341_EnableLED(as7341_handle_t *handle, bool enable_led);
 bool AS7341_SetLEDCurrent(as7341_handle_t *handle, uint16_t led_current_ma);
 bool AS7341_GetIsDataReady(as7341_handle_t *handle);
+bool AS7341_SetBank(as7341_handle_t *handle, bool low);
+void AS7341_DisableAll(as7341_handle_t *handle);
+
+// 中断模式
+bool AS7341_EnableInterrupt(as7341_handle_t *handle, uint16_t int_pin);
+bool AS7341_DisableInterrupt(as7341_handle_t *handle);
+void AS7341_EXTI_Callback(as7341_handle_t *handle, uint16_t gpio_pin);
+void AS7341_SetInterruptNotify(as7341_handle_t *handle, as7341_int_notify_t notify, void *user_ctx);
+
+// 影子寄存器
+void AS7341_InvalidateShadow(as7341_handle_t *handle);
+bool AS7341_SyncShadow(as7341_handle_t *handle);
 
 /**
  * 使用说明：
@@ -148,6 +211,12 @@ bool AS7341_GetIsDataReady(as7341_handle_t *handle);
  * 2. 使用AS7341_SetGain()和AS7341_SetATIME()配置参数
  * 3. 使用AS7341_ReadAllChannels_Blocking()读取所有通道数据
  * 4. 使用AS7341_GetChannel()获取特定波长通道数据
+ * 5. 配置寄存器有写直通影子，读-改-写只需一次写入；传感器掉电复位或被其它主机改写后，
+ *    调用AS7341_InvalidateShadow()或AS7341_SyncShadow()
+ * 6. INT引脚接到EXTI时，用AS7341_EnableInterrupt()切换到中断模式，并在HAL_GPIO_EXTI_Callback()
+ *    中调用AS7341_EXTI_Callback()；等待测量完成时不再占用I2C总线，阻塞读取在等待时休眠（__WFI），
+ *    非阻塞读取用AS7341_SetInterruptNotify()在INT到来时唤醒任务，每次通知调用一次AS7341_CheckReadingProgress()
+ * 7. 需要其它通道组合时，用AS7341_SetSMUXMaps()替换两组SMUX映射（20字节，NULL恢复默认）
  */
 
 #endif /* _AS7341_H */
\ No newline at end of file
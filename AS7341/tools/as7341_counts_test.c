@@ -0,0 +1,179 @@
+/**
+ * @file    as7341_counts_test.c
+ * @brief   基本计数换算测试（主机程序） - 检查定点换算与浮点换算一致、参数改变后换算系数失效
+ * @author  ShanQue
+ * @date    2026/10/16
+ *
+ * 编译（在AS7341目录下）:
+ *   gcc -std=gnu11 -O2 -I tools/host -I . -o as7341_counts_test tools/as7341_counts_test.c tools/host/hal_host.c AS7341.c -lm
+ *
+ * 用法:
+ *   as7341_counts_test
+ *
+ * 在tools/host/hal_host.c的寄存器模型上依次检查:
+ *   - 全部增益、一组ATIME/ASTEP（含最短和最长积分时间）和原始值下，AS7341_ToBasicCountsAll_Fixed()
+ *     与AS7341_ToBasicCountsAll()的结果一致（相对误差1e-5或2个Q16.16最低位之内），两者都与
+ *     按双精度计算的基本计数一致；超过65535基本计数时定点结果饱和
+ *   - 换算系数缓存后再次换算不访问总线
+ *   - 设置增益、ATIME、ASTEP，写入失败，AS7341_InvalidateShadow()和AS7341_SyncShadow()之后
+ *     counts_scale_valid被清除，下一次换算使用新参数
+ * 全部通过时打印"OK"并返回0，失败时打印出错的一步并返回1。
+ */
+
+#include "AS7341.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_CHECK(cond, step)  do { if (!(cond)) { printf("失败: %s\n", step); return 1; } } while (0)
+
+#define TEST_FIXED_ONE      (1UL << AS7341_BASIC_COUNTS_FRAC_BITS)
+#define TEST_REL_LIMIT      1e-5
+#define TEST_ABS_LIMIT      (2.0 / TEST_FIXED_ONE)
+
+static const uint8_t g_atimes[] = { 0, 1, 29, 100, 255 };
+static const uint16_t g_asteps[] = { 0, 1, 599, 999, 65534 };
+static const uint16_t g_raws[] = { 0, 1, 7, 1234, 40000, 65535 };
+
+static I2C_HandleTypeDef g_i2c;
+
+static void test_model_reset(void)
+{
+    memset(hal_host_regs, 0, sizeof(hal_host_regs));
+    memset(hal_host_low_regs, 0, sizeof(hal_host_low_regs));
+    hal_host_regs[AS7341_WHOAMI] = AS7341_CHIP_ID << 2;
+    hal_host_regs[AS7341_CFG1] = 0x09;
+    hal_host_regs[AS7341_ATIME] = 0x00;
+    hal_host_regs[AS7341_ASTEP_L] = 0xE7;
+    hal_host_regs[AS7341_ASTEP_H] = 0x03;
+    hal_host_i2c_write_fail = 0;
+}
+
+/**
+ * @brief  按数据手册计算基本计数：raw / (增益 * 积分时间ms)，积分时间ms = (ATIME+1)(ASTEP+1) * 2.78 / 1000
+ */
+static double test_expected(uint8_t gain, uint8_t atime, uint16_t astep, uint16_t raw)
+{
+    double gain_x = (gain == AS7341_GAIN_0_5X) ? 0.5 : (double)(1UL << (gain - 1));
+    double time_ms = ((double)atime + 1) * ((double)astep + 1) * 2.78 / 1000.0;
+    return raw / (gain_x * time_ms);
+}
+
+static bool test_close(double value, double reference)
+{
+    double diff = fabs(value - reference);
+    return diff <= TEST_ABS_LIMIT || diff <= fabs(reference) * TEST_REL_LIMIT;
+}
+
+/**
+ * @brief  当前参数下把channel_readings填成raw并比较两种换算
+ * @param  saturated: 定点结果饱和时加1
+ * @param  worst: 定点与浮点的最大相对误差（不小于1个基本计数的值）
+ */
+static bool test_compare(as7341_handle_t *h, uint8_t gain, uint8_t atime, uint16_t astep, uint16_t raw,
+                         uint32_t *saturated, double *worst)
+{
+    float values[12];
+    uint32_t fixed[12];
+
+    for (int i = 0; i < 12; i++) {
+        h->channel_readings[i] = raw;
+    }
+    if (!AS7341_ToBasicCountsAll(h, values) || !AS7341_ToBasicCountsAll_Fixed(h, fixed)) {
+        return false;
+    }
+
+    double expected = test_expected(gain, atime, astep, raw);
+    if (!test_close(values[0], expected)) {
+        printf("增益%u ATIME%u ASTEP%u 原始值%u: 浮点%.6f 应为%.6f\n", gain, atime, astep, raw, values[0], expected);
+        return false;
+    }
+
+    if (expected * TEST_FIXED_ONE >= 4294967295.0) {
+        (*saturated)++;
+        return fixed[0] == 0xFFFFFFFFUL;
+    }
+
+    double fixed_value = (double)fixed[0] / TEST_FIXED_ONE;
+    if (!test_close(fixed_value, values[0]) || !test_close(fixed_value, expected)) {
+        printf("增益%u ATIME%u ASTEP%u 原始值%u: 定点%.6f 浮点%.6f 应为%.6f\n",
+               gain, atime, astep, raw, fixed_value, values[0], expected);
+        return false;
+    }
+    if (values[0] >= 1.0f && fabs(fixed_value - values[0]) / values[0] > *worst) {
+        *worst = fabs(fixed_value - values[0]) / values[0];
+    }
+    return true;
+}
+
+/**
+ * @brief  换算后counts_scale_valid为真，系数对应增益gain
+ */
+static bool test_scale_follows(as7341_handle_t *h, uint8_t gain, uint8_t atime, uint16_t astep)
+{
+    uint32_t saturated = 0;
+    double worst = 0;
+    return test_compare(h, gain, atime, astep, 1234, &saturated, &worst) && h->counts_scale_valid;
+}
+
+int main(void)
+{
+    as7341_handle_t handle;
+    uint32_t cases = 0;
+    uint32_t saturated = 0;
+    double worst = 0;
+
+    test_model_reset();
+    TEST_CHECK(AS7341_Init(&handle, &g_i2c, AS7341_I2CADDR_DEFAULT, 0), "AS7341_Init");
+
+    // 定点与浮点一致
+    for (uint8_t gain = AS7341_GAIN_0_5X; gain <= AS7341_GAIN_512X; gain++) {
+        TEST_CHECK(AS7341_SetGain(&handle, (as7341_gain_t)gain), "设置增益");
+        for (size_t a = 0; a < sizeof(g_atimes); a++) {
+            TEST_CHECK(AS7341_SetATIME(&handle, g_atimes[a]), "设置ATIME");
+            for (size_t s = 0; s < sizeof(g_asteps) / sizeof(g_asteps[0]); s++) {
+                TEST_CHECK(AS7341_SetASTEP(&handle, g_asteps[s]), "设置ASTEP");
+                for (size_t r = 0; r < sizeof(g_raws) / sizeof(g_raws[0]); r++) {
+                    TEST_CHECK(test_compare(&handle, gain, g_atimes[a], g_asteps[s], g_raws[r], &saturated, &worst),
+                               "定点与浮点一致");
+                    cases++;
+                }
+            }
+        }
+    }
+    printf("%lu组: 饱和%lu组, 定点与浮点最大相对误差%.2e\n", (unsigned long)cases, (unsigned long)saturated, worst);
+    TEST_CHECK(saturated > 0 && saturated < cases, "覆盖饱和与未饱和");
+
+    // 换算系数缓存后不访问总线
+    TEST_CHECK(AS7341_SetGain(&handle, AS7341_GAIN_64X) && AS7341_SetATIME(&handle, 100) &&
+               AS7341_SetASTEP(&handle, 999), "设置参数");
+    TEST_CHECK(test_scale_follows(&handle, AS7341_GAIN_64X, 100, 999), "计算换算系数");
+    uint32_t reads = hal_host_i2c_reads;
+    uint32_t fixed[12];
+    TEST_CHECK(AS7341_ToBasicCountsAll_Fixed(&handle, fixed) && hal_host_i2c_reads == reads, "缓存的系数不访问总线");
+
+    // 参数改变后失效
+    TEST_CHECK(AS7341_SetGain(&handle, AS7341_GAIN_4X) && !handle.counts_scale_valid, "设置增益后失效");
+    TEST_CHECK(test_scale_follows(&handle, AS7341_GAIN_4X, 100, 999), "新增益的系数");
+    TEST_CHECK(AS7341_SetATIME(&handle, 29) && !handle.counts_scale_valid, "设置ATIME后失效");
+    TEST_CHECK(test_scale_follows(&handle, AS7341_GAIN_4X, 29, 999), "新ATIME的系数");
+    TEST_CHECK(AS7341_SetASTEP(&handle, 599) && !handle.counts_scale_valid, "设置ASTEP后失效");
+    TEST_CHECK(test_scale_follows(&handle, AS7341_GAIN_4X, 29, 599), "新ASTEP的系数");
+
+    // 写入失败：器件中的值未知，系数失效，下一次从器件读入原值
+    hal_host_i2c_write_fail = 1;
+    TEST_CHECK(!AS7341_SetATIME(&handle, 50) && !handle.counts_scale_valid, "写入失败后失效");
+    TEST_CHECK(test_scale_follows(&handle, AS7341_GAIN_4X, 29, 599), "写入失败后的系数");
+
+    AS7341_InvalidateShadow(&handle);
+    TEST_CHECK(!handle.counts_scale_valid, "AS7341_InvalidateShadow后失效");
+    TEST_CHECK(test_scale_follows(&handle, AS7341_GAIN_4X, 29, 599), "影子失效后的系数");
+
+    // 其它主机改写增益：同步后使用新增益
+    hal_host_regs[AS7341_CFG1] = AS7341_GAIN_256X;
+    TEST_CHECK(AS7341_SyncShadow(&handle) && !handle.counts_scale_valid, "AS7341_SyncShadow后失效");
+    TEST_CHECK(test_scale_follows(&handle, AS7341_GAIN_256X, 29, 599), "同步后的系数");
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file    as7341_int_test.c
+ * @brief   中断模式测试（主机程序） - 在寄存器模型上检查INT通知推进非阻塞读取、阻塞读取休眠等待
+ * @author  ShanQue
+ * @date    2026/10/16
+ *
+ * 编译（在AS7341目录下）:
+ *   gcc -std=gnu11 -O2 -I tools/host -I . -o as7341_int_test tools/as7341_int_test.c tools/host/hal_host.c AS7341.c
+ *
+ * 用法:
+ *   as7341_int_test
+ *
+ * tools/host/hal_host.c的寄存器模型在启用SP_IEN时，写入SP_EN后TEST_INT_DELAY_MS毫秒拉低INT，
+ * 调用测试的EXTI处理函数；__WFI()相当于休眠到下一个SysTick。依次检查:
+ *   - 非阻塞读取：EXTI回调在低、高通道组完成时各通知一次，每次通知后调用一次
+ *     AS7341_CheckReadingProgress()，第二次完成读取；通知之间不访问总线
+ *   - 阻塞读取：等待时休眠而不是HAL_Delay()空转，从不读取STATUS2，用时接近两个测量周期
+ *   - INT没有到来时阻塞读取按200ms超时返回
+ *   - 关闭中断模式后恢复轮询STATUS2
+ * 全部通过时打印"OK"并返回0，失败时打印出错的一步并返回1。
+ */
+
+#include "AS7341.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_CHECK(cond, step)  do { if (!(cond)) { printf("失败: %s\n", step); return 1; } } while (0)
+
+#define TEST_INT_PIN        0x0020      // GPIO_PIN_5
+#define TEST_INT_DELAY_MS   30
+
+static I2C_HandleTypeDef g_i2c;
+static as7341_handle_t g_handle;
+static uint32_t g_notifies;
+static volatile bool g_wakeup;
+
+static void test_model_reset(void)
+{
+    memset(hal_host_regs, 0, sizeof(hal_host_regs));
+    memset(hal_host_low_regs, 0, sizeof(hal_host_low_regs));
+    memset(hal_host_reg_reads, 0, sizeof(hal_host_reg_reads));
+    hal_host_regs[AS7341_WHOAMI] = AS7341_CHIP_ID << 2;
+    hal_host_regs[AS7341_CFG1] = 0x09;
+    hal_host_regs[AS7341_ASTEP_L] = 0xE7;
+    hal_host_regs[AS7341_ASTEP_H] = 0x03;
+    hal_host_tick = 0;
+    hal_host_int_delay_ms = TEST_INT_DELAY_MS;
+}
+
+// 相当于HAL_GPIO_EXTI_Callback()
+static void test_on_int(void)
+{
+    AS7341_EXTI_Callback(&g_handle, TEST_INT_PIN);
+}
+
+// INT通知：只唤醒"任务"
+static void test_notify(void *user_ctx)
+{
+    (void)user_ctx;
+    g_notifies++;
+    g_wakeup = true;
+}
+
+/**
+ * @brief  任务等待一次通知，超时返回false
+ */
+static bool test_wait_notify(uint32_t timeout_ms)
+{
+    uint32_t start = HAL_GetTick();
+    while (!g_wakeup) {
+        if (HAL_GetTick() - start >= timeout_ms) {
+            return false;
+        }
+        __WFI();
+    }
+    g_wakeup = false;
+    return true;
+}
+
+int main(void)
+{
+    test_model_reset();
+    hal_host_int_hook = test_on_int;
+    TEST_CHECK(AS7341_Init(&g_handle, &g_i2c, AS7341_I2CADDR_DEFAULT, 0), "AS7341_Init");
+    TEST_CHECK(AS7341_EnableInterrupt(&g_handle, TEST_INT_PIN), "启用中断模式");
+    AS7341_SetInterruptNotify(&g_handle, test_notify, NULL);
+
+    // 非阻塞读取：两次通知，每次通知后推进一步
+    for (int i = 0; i < 12; i++) {
+        hal_host_regs[AS7341_CH0_DATA_L + i] = (uint8_t)(i + 1);
+    }
+    TEST_CHECK(AS7341_StartReading(&g_handle), "开始非阻塞读取");
+    TEST_CHECK(test_wait_notify(200), "低通道组通知");
+    uint32_t reads = hal_host_i2c_reads;
+    TEST_CHECK(!AS7341_CheckReadingProgress(&g_handle), "低通道组后未完成");
+    TEST_CHECK(hal_host_i2c_reads > reads, "低通道组读取数据");
+    uint32_t idle_reads = hal_host_i2c_reads;
+    TEST_CHECK(test_wait_notify(200), "高通道组通知");
+    TEST_CHECK(hal_host_i2c_reads == idle_reads, "等待INT时不访问总线");
+    TEST_CHECK(AS7341_CheckReadingProgress(&g_handle), "高通道组后完成");
+    TEST_CHECK(g_notifies == 2 && g_handle.channel_readings[0] == 0x0201 &&
+               g_handle.channel_readings[11] == 0x0C0B, "读取结果");
+    TEST_CHECK(!test_wait_notify(100) && g_notifies == 2, "完成后不再通知");
+    printf("非阻塞读取: 通知%lu次 STATUS2读取%lu次\n",
+           (unsigned long)g_notifies, (unsigned long)hal_host_reg_reads[AS7341_STATUS2]);
+    TEST_CHECK(hal_host_reg_reads[AS7341_STATUS2] == 0, "非阻塞读取不读STATUS2");
+
+    // 阻塞读取：休眠等待INT，不轮询STATUS2
+    uint32_t start = HAL_GetTick();
+    TEST_CHECK(AS7341_ReadAllChannels(&g_handle), "阻塞读取");
+    uint32_t elapsed = HAL_GetTick() - start;
+    printf("阻塞读取: 用时%lums STATUS2读取%lu次\n",
+           (unsigned long)elapsed, (unsigned long)hal_host_reg_reads[AS7341_STATUS2]);
+    TEST_CHECK(hal_host_reg_reads[AS7341_STATUS2] == 0, "阻塞读取不读STATUS2");
+    TEST_CHECK(elapsed >= 2 * TEST_INT_DELAY_MS && elapsed < 2 * TEST_INT_DELAY_MS + 40, "阻塞读取用时");
+    TEST_CHECK(g_notifies == 2, "阻塞读取不通知");
+
+    // INT没有到来：按200ms超时
+    hal_host_int_delay_ms = 0;
+    TEST_CHECK(AS7341_WriteSMUX(&g_handle, AS7341_SMUX_F1F4_CLEAR_NIR) &&
+               AS7341_EnableSpectralMeasurement(&g_handle, true), "开始测量");
+    start = HAL_GetTick();
+    AS7341_DelayForData(&g_handle, 0);
+    elapsed = HAL_GetTick() - start;
+    TEST_CHECK(elapsed >= 200 && elapsed <= 201 && hal_host_reg_reads[AS7341_STATUS2] == 0, "INT超时");
+
+    // 关闭中断模式：恢复轮询STATUS2
+    TEST_CHECK(AS7341_DisableInterrupt(&g_handle), "关闭中断模式");
+    TEST_CHECK(AS7341_ReadAllChannels(&g_handle), "轮询读取");
+    TEST_CHECK(hal_host_reg_reads[AS7341_STATUS2] > 0, "轮询模式读取STATUS2");
+
+    printf("OK\n");
+    return 0;
+}
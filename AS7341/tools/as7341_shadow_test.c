@@ -0,0 +1,272 @@
+/**
+ * @file    as7341_shadow_test.c
+ * @brief   影子寄存器测试（主机程序） - 在寄存器模型上检查影子缓存与逐次读-改-写等价
+ * @author  ShanQue
+ * @date    2026/10/16
+ *
+ * 编译（在AS7341目录下）:
+ *   gcc -std=gnu11 -O2 -I tools/host -I . -o as7341_shadow_test tools/as7341_shadow_test.c tools/host/hal_host.c AS7341.c
+ *
+ * 用法:
+ *   as7341_shadow_test
+ *
+ * 同一组API调用在tools/host/hal_host.c的寄存器模型上执行两遍:
+ *   - 参考：每次I2C事务之后使全部影子失效，驱动只能用到刚刚读写的那个值，读-改-写都从器件读取，
+ *     相当于没有影子的驱动
+ *   - 缓存：正常使用影子
+ * 检查两遍的I2C写入序列和最终寄存器状态完全一致、缓存时读取更少，且每一步之后有效的影子都等于器件中的值。
+ * 另外检查写入失败后影子失效、其它主机改写后AS7341_SyncShadow()读入新值。
+ * 全部通过时打印"OK"并返回0，失败时打印出错的一步并返回1。
+ */
+
+#include "AS7341.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_MAX_WRITES     1024
+
+#define TEST_CHECK(cond, step)  do { if (!(cond)) { printf("失败: %s\n", step); return 1; } } while (0)
+
+typedef struct {
+    const char *name;
+    bool (*run)(as7341_handle_t *handle);
+} test_step_t;
+
+typedef struct {
+    uint16_t writes[TEST_MAX_WRITES];   // 写入的寄存器，bit8为1表示0x60-0x7F的另一组
+    uint8_t values[TEST_MAX_WRITES];
+    uint32_t write_count;
+    uint32_t reads;
+    uint8_t regs[256];
+    uint8_t low_regs[256];
+} test_trace_t;
+
+static I2C_HandleTypeDef g_i2c;
+static test_trace_t *g_trace;
+static as7341_handle_t *g_reference_handle;
+
+/* =============================================================================
+ * 寄存器模型
+ * =============================================================================
+ */
+
+static void test_on_write(uint16_t reg, uint8_t value)
+{
+    if (g_trace->write_count < TEST_MAX_WRITES) {
+        bool low_bank = reg >= 0x60 && reg < 0x80 && (hal_host_regs[AS7341_CFG0] & 0x10);
+        g_trace->writes[g_trace->write_count] = (uint16_t)((low_bank ? 0x100 : 0) | reg);
+        g_trace->values[g_trace->write_count] = value;
+    }
+    g_trace->write_count++;
+}
+
+static void test_on_i2c(void)
+{
+    // 在驱动用本次事务的结果更新影子之前清空
+    if (g_reference_handle != NULL) {
+        AS7341_InvalidateShadow(g_reference_handle);
+    }
+}
+
+static void test_model_reset(test_trace_t *trace)
+{
+    memset(hal_host_regs, 0, sizeof(hal_host_regs));
+    memset(hal_host_low_regs, 0, sizeof(hal_host_low_regs));
+    hal_host_regs[AS7341_WHOAMI] = AS7341_CHIP_ID << 2;
+    hal_host_regs[AS7341_CFG1] = 0x09;
+    hal_host_regs[AS7341_ATIME] = 0x00;
+    hal_host_regs[AS7341_ASTEP_L] = 0xE7;
+    hal_host_regs[AS7341_ASTEP_H] = 0x03;
+    hal_host_i2c_reads = 0;
+    hal_host_i2c_writes = 0;
+    hal_host_i2c_write_fail = 0;
+
+    memset(trace, 0, sizeof(test_trace_t));
+    g_trace = trace;
+    hal_host_write_hook = test_on_write;
+    hal_host_i2c_hook = test_on_i2c;
+}
+
+/**
+ * @brief  有效的影子是否都等于器件中的值（CONFIG、LED在0x60-0x74组中）
+ */
+static bool test_shadow_matches(const as7341_handle_t *handle)
+{
+    for (int i = 0; i < AS7341_SHADOW_COUNT; i++) {
+        if (!(handle->shadow_valid & (1U << i))) {
+            continue;
+        }
+        uint8_t reg = AS7341_SHADOW_REGS[i];
+        uint8_t device = (reg == AS7341_CONFIG || reg == AS7341_LED) ? hal_host_low_regs[reg] : hal_host_regs[reg];
+        if (handle->shadow[i] != device) {
+            printf("影子0x%02X = 0x%02X，器件中为0x%02X\n", reg, handle->shadow[i], device);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* =============================================================================
+ * API调用序列
+ * =============================================================================
+ */
+
+static bool step_init(as7341_handle_t *h)
+{
+    return AS7341_Init(h, &g_i2c, AS7341_I2CADDR_DEFAULT, 0);
+}
+
+static bool step_configure(as7341_handle_t *h)
+{
+    return AS7341_SetGain(h, AS7341_GAIN_64X) && AS7341_SetATIME(h, 100) && AS7341_SetASTEP(h, 999);
+}
+
+static bool step_led_on(as7341_handle_t *h)
+{
+    return AS7341_EnableLED(h, true) && AS7341_SetLEDCurrent(h, 20);
+}
+
+static bool step_read_blocking(as7341_handle_t *h)
+{
+    return AS7341_ReadAllChannels_Blocking(h);
+}
+
+static bool step_read(as7341_handle_t *h)
+{
+    return AS7341_ReadAllChannels(h);
+}
+
+static bool step_read_async(as7341_handle_t *h)
+{
+    if (!AS7341_StartReading(h)) {
+        return false;
+    }
+    for (int i = 0; i < 100; i++) {
+        if (AS7341_CheckReadingProgress(h)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool step_custom_smux(as7341_handle_t *h)
+{
+    return AS7341_SetSMUXMaps(h, AS7341_SMUX_F5F8_CLEAR_NIR, AS7341_SMUX_F1F4_CLEAR_NIR) &&
+           AS7341_WriteSMUX(h, AS7341_SMUX_F1F4_CLEAR_NIR) &&
+           AS7341_EnableSpectralMeasurement(h, true);
+}
+
+static bool step_read_getters(as7341_handle_t *h)
+{
+    return AS7341_GetASTEP(h) == 999 && AS7341_GetATIME(h) == 100 && AS7341_GetGain(h) == AS7341_GAIN_64X;
+}
+
+static bool step_led_off(as7341_handle_t *h)
+{
+    return AS7341_EnableLED(h, false);
+}
+
+static bool step_bank(as7341_handle_t *h)
+{
+    return AS7341_SetBank(h, true) && AS7341_SetBank(h, false);
+}
+
+static bool step_power_cycle(as7341_handle_t *h)
+{
+    AS7341_DisableAll(h);
+    return AS7341_PowerEnable(h, false) && AS7341_PowerEnable(h, true);
+}
+
+static const test_step_t g_steps[] = {
+    { "AS7341_Init",                    step_init },
+    { "设置增益/ATIME/ASTEP",           step_configure },
+    { "打开LED",                        step_led_on },
+    { "阻塞读取",                       step_read_blocking },
+    { "读取",                           step_read },
+    { "非阻塞读取",                     step_read_async },
+    { "自定义SMUX",                     step_custom_smux },
+    { "读回配置",                       step_read_getters },
+    { "关闭LED",                        step_led_off },
+    { "切换寄存器组",                   step_bank },
+    { "关闭再上电",                     step_power_cycle },
+};
+
+#define TEST_STEP_COUNT (sizeof(g_steps) / sizeof(g_steps[0]))
+
+/**
+ * @brief  执行整个序列
+ * @param  reference: true时每一步之前和每次I2C事务之后使影子失效
+ */
+static bool test_run(as7341_handle_t *handle, test_trace_t *trace, bool reference)
+{
+    test_model_reset(trace);
+    g_reference_handle = reference ? handle : NULL;
+
+    for (size_t i = 0; i < TEST_STEP_COUNT; i++) {
+        if (reference) {
+            AS7341_InvalidateShadow(handle);
+        }
+        if (!g_steps[i].run(handle)) {
+            printf("%s: %s返回失败\n", reference ? "参考" : "缓存", g_steps[i].name);
+            return false;
+        }
+        if (!test_shadow_matches(handle)) {
+            printf("%s: %s之后影子与器件不一致\n", reference ? "参考" : "缓存", g_steps[i].name);
+            return false;
+        }
+    }
+
+    g_reference_handle = NULL;
+    trace->reads = hal_host_i2c_reads;
+    memcpy(trace->regs, hal_host_regs, sizeof(trace->regs));
+    memcpy(trace->low_regs, hal_host_low_regs, sizeof(trace->low_regs));
+    return true;
+}
+
+int main(void)
+{
+    static test_trace_t reference;
+    static test_trace_t cached;
+    as7341_handle_t handle;
+
+    // 等价性：写入序列和最终状态一致，读取更少
+    TEST_CHECK(test_run(&handle, &reference, true), "参考序列");
+    TEST_CHECK(test_run(&handle, &cached, false), "缓存序列");
+    printf("参考: 读%lu次 写%lu字节\n", (unsigned long)reference.reads, (unsigned long)reference.write_count);
+    printf("缓存: 读%lu次 写%lu字节\n", (unsigned long)cached.reads, (unsigned long)cached.write_count);
+    TEST_CHECK(reference.write_count <= TEST_MAX_WRITES, "写入记录溢出");
+    TEST_CHECK(cached.write_count == reference.write_count &&
+               memcmp(cached.writes, reference.writes, reference.write_count * sizeof(uint16_t)) == 0 &&
+               memcmp(cached.values, reference.values, reference.write_count) == 0, "写入序列一致");
+    TEST_CHECK(memcmp(cached.regs, reference.regs, sizeof(cached.regs)) == 0 &&
+               memcmp(cached.low_regs, reference.low_regs, sizeof(cached.low_regs)) == 0, "最终寄存器状态一致");
+    TEST_CHECK(cached.reads < reference.reads, "缓存减少读取");
+
+    // 读取步骤单独计数：配置已缓存时只剩状态轮询和通道数据
+    uint32_t reads = hal_host_i2c_reads;
+    TEST_CHECK(AS7341_ReadAllChannels_Blocking(&handle), "单独阻塞读取");
+    printf("AS7341_ReadAllChannels_Blocking: 读%lu次\n", (unsigned long)(hal_host_i2c_reads - reads));
+
+    // 读取缓存的寄存器不访问总线
+    reads = hal_host_i2c_reads;
+    TEST_CHECK(AS7341_GetATIME(&handle) == 100 && AS7341_GetASTEP(&handle) == 999, "读回缓存值");
+    TEST_CHECK(hal_host_i2c_reads == reads, "缓存的寄存器不访问总线");
+
+    // 写入失败：影子失效，下一次读取从器件读入原值
+    hal_host_i2c_write_fail = 1;
+    TEST_CHECK(!AS7341_SetATIME(&handle, 50), "写入失败应返回false");
+    TEST_CHECK(AS7341_GetATIME(&handle) == 100 && hal_host_i2c_reads == reads + 1, "写入失败后从器件读入");
+    TEST_CHECK(test_shadow_matches(&handle), "写入失败后影子一致");
+
+    // 其它主机改写：缓存值不变，同步后读入新值
+    hal_host_regs[AS7341_CFG1] = AS7341_GAIN_4X;
+    hal_host_low_regs[AS7341_LED] = 0x85;
+    TEST_CHECK(AS7341_GetGain(&handle) == AS7341_GAIN_64X, "同步前返回缓存值");
+    TEST_CHECK(AS7341_SyncShadow(&handle), "同步影子");
+    TEST_CHECK(AS7341_GetGain(&handle) == AS7341_GAIN_4X, "同步后读入新增益");
+    TEST_CHECK(test_shadow_matches(&handle), "同步后影子一致");
+    TEST_CHECK(!(hal_host_regs[AS7341_CFG0] & 0x10), "同步后恢复寄存器组");
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,7 @@
+/* 主机工具用替身，app_printf()由hal_host.c实现（丢弃输出） */
+#ifndef AS7341_HOST_APP_H
+#define AS7341_HOST_APP_H
+
+void app_printf(const char *format, ...);
+
+#endif /* AS7341_HOST_APP_H */
@@ -0,0 +1,133 @@
+/**
+ * @file    hal_host.c
+ * @brief   主机工具用的HAL替身实现 - AS7341寄存器模型
+ * @note    仅用于tools目录下的主机程序。模型只包含驱动依赖的器件行为:
+ *          - CFG0(0xA9)的REG_BANK位(bit4)为1时0x60-0x7F访问另一组寄存器，CFG0本身不分组
+ *          - ENABLE(0x80)的SMUXEN位(bit4)在SMUX配置完成后自动清零（模型中读到一次后清零）
+ *          - 写入ENABLE时SP_EN位(bit1)为1则STATUS2(0xA3)的AVALID位(bit6)置位；
+ *            INTENAB(0xF9)的SP_IEN位(bit3)为1时，hal_host_int_delay_ms毫秒后INT拉低
+ *          时间只在HAL_Delay()和__WFI()中推进
+ */
+
+#include "stm32f4xx_hal.h"
+#include "app.h"
+#include <stdbool.h>
+
+#define HOST_CFG0       0xA9
+#define HOST_ENABLE     0x80
+#define HOST_STATUS2    0xA3
+#define HOST_INTENAB    0xF9
+
+uint8_t hal_host_regs[256];
+uint8_t hal_host_low_regs[256];
+uint32_t hal_host_i2c_reads;
+uint32_t hal_host_i2c_writes;
+uint32_t hal_host_i2c_write_fail;
+void (*hal_host_write_hook)(uint16_t reg, uint8_t value);
+void (*hal_host_i2c_hook)(void);
+uint32_t hal_host_reg_reads[256];
+uint32_t hal_host_tick;
+uint32_t hal_host_int_delay_ms;
+void (*hal_host_int_hook)(void);
+
+static bool host_int_scheduled;
+static uint32_t host_int_due;
+
+static uint8_t *host_reg(uint16_t reg)
+{
+    reg &= 0xFF;
+    if (reg >= 0x60 && reg < 0x80 && (hal_host_regs[HOST_CFG0] & 0x10)) {
+        return &hal_host_low_regs[reg];
+    }
+    return &hal_host_regs[reg];
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t dev_address, uint16_t mem_address,
+                                    uint16_t mem_add_size, uint8_t *data, uint16_t size, uint32_t timeout)
+{
+    (void)hi2c; (void)dev_address; (void)mem_add_size; (void)timeout;
+    hal_host_i2c_writes++;
+    if (hal_host_i2c_write_fail > 0) {
+        hal_host_i2c_write_fail--;
+        return HAL_ERROR;
+    }
+
+    for (uint16_t i = 0; i < size; i++) {
+        uint16_t reg = mem_address + i;
+        *host_reg(reg) = data[i];
+        if (reg == HOST_ENABLE && (data[i] & 0x02)) {
+            hal_host_regs[HOST_STATUS2] |= 0x40;
+            if ((hal_host_regs[HOST_INTENAB] & 0x08) && hal_host_int_delay_ms > 0) {
+                host_int_scheduled = true;
+                host_int_due = hal_host_tick + hal_host_int_delay_ms;
+            }
+        }
+        if (hal_host_write_hook != NULL) {
+            hal_host_write_hook(reg, data[i]);
+        }
+    }
+    if (hal_host_i2c_hook != NULL) {
+        hal_host_i2c_hook();
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t dev_address, uint16_t mem_address,
+                                   uint16_t mem_add_size, uint8_t *data, uint16_t size, uint32_t timeout)
+{
+    (void)hi2c; (void)dev_address; (void)mem_add_size; (void)timeout;
+    hal_host_i2c_reads++;
+
+    for (uint16_t i = 0; i < size; i++) {
+        uint16_t reg = mem_address + i;
+        data[i] = *host_reg(reg);
+        hal_host_reg_reads[reg & 0xFF]++;
+        if (reg == HOST_ENABLE) {
+            hal_host_regs[HOST_ENABLE] &= (uint8_t)~0x10;
+        }
+    }
+    if (hal_host_i2c_hook != NULL) {
+        hal_host_i2c_hook();
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief  推进1ms，到期的INT先触发
+ */
+static void host_advance(void)
+{
+    hal_host_tick++;
+    if (host_int_scheduled && (int32_t)(hal_host_tick - host_int_due) >= 0) {
+        host_int_scheduled = false;
+        if (hal_host_int_hook != NULL) {
+            hal_host_int_hook();
+        }
+    }
+}
+
+void HAL_Delay(uint32_t delay)
+{
+    for (uint32_t i = 0; i < delay; i++) {
+        host_advance();
+    }
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return hal_host_tick;
+}
+
+void __WFI(void)
+{
+    host_advance();
+}
+
+void app_printf(const char *format, ...)
+{
+    (void)format;
+}
+
+void System_WatchdogRefresh(void)
+{
+}
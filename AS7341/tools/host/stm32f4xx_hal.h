@@ -0,0 +1,57 @@
+/**
+ * @file    stm32f4xx_hal.h
+ * @brief   主机工具用的最小HAL替身 - 只提供AS7341驱动用到的类型和函数声明
+ * @note    仅用于tools目录下主机程序的编译，函数由hal_host.c实现；
+ *          I2C读写作用在一个AS7341寄存器模型上
+ */
+
+#ifndef AS7341_HOST_HAL_H
+#define AS7341_HOST_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+
+typedef struct { uint32_t Instance; } I2C_HandleTypeDef;
+
+/* 主机专用：寄存器模型。CFG0的REG_BANK位为1时0x60-0x7F访问hal_host_low_regs，其余访问hal_host_regs */
+extern uint8_t hal_host_regs[256];
+extern uint8_t hal_host_low_regs[256];
+
+/* 主机专用：I2C事务计数，每次HAL_I2C_Mem_Read()/HAL_I2C_Mem_Write()调用计一次 */
+extern uint32_t hal_host_i2c_reads;
+extern uint32_t hal_host_i2c_writes;
+
+/* 主机专用：非0时接下来的这么多次I2C写失败，寄存器不变 */
+extern uint32_t hal_host_i2c_write_fail;
+
+/* 主机专用：每写入一个寄存器字节调用一次，为NULL时不调用 */
+extern void (*hal_host_write_hook)(uint16_t reg, uint8_t value);
+
+/* 主机专用：每次I2C事务结束、返回驱动之前调用一次，为NULL时不调用 */
+extern void (*hal_host_i2c_hook)(void);
+
+/* 主机专用：每个寄存器被读取的字节数 */
+extern uint32_t hal_host_reg_reads[256];
+
+/* 主机专用：HAL_GetTick()的值，HAL_Delay()和__WFI()推进 */
+extern uint32_t hal_host_tick;
+
+/* 主机专用：INTENAB的SP_IEN位为1时，写入SP_EN后经过这么多毫秒INT拉低；0表示INT不会到来 */
+extern uint32_t hal_host_int_delay_ms;
+
+/* 主机专用：INT拉低时调用（相当于EXTI中断），为NULL时不调用 */
+extern void (*hal_host_int_hook)(void);
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t dev_address, uint16_t mem_address,
+                                    uint16_t mem_add_size, uint8_t *data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t dev_address, uint16_t mem_address,
+                                   uint16_t mem_add_size, uint8_t *data, uint16_t size, uint32_t timeout);
+void HAL_Delay(uint32_t delay);
+uint32_t HAL_GetTick(void);
+
+/* 主机上的__WFI()：休眠到下一个中断，即推进1ms（SysTick），其间到期的INT先触发 */
+void __WFI(void);
+
+#endif /* AS7341_HOST_HAL_H */
@@ -10,6 +10,48 @@
 #include "comm_internal.h"
 #include "comm_protocol.h"
 #include "comm_manager.h"
+#if COMM_ENABLE_PUBSUB
+#include "comm_pubsub.h"
+#endif
+#if COMM_ENABLE_RS485
+#include "comm_rs485.h"
+#endif
+#if COMM_ENABLE_ROUTER
+#include "comm_router.h"
+#endif
+#if COMM_ENABLE_PRIORITY
+#include "comm_priority.h"
+#endif
+#if COMM_ENABLE_CREDITS
+#include "comm_credit.h"
+#endif
+#if COMM_ENABLE_BAUD
+#include "comm_baud.h"
+#endif
+#if COMM_ENABLE_LINK
+#include "comm_link.h"
+#endif
+#if COMM_ENABLE_SESSION
+#include "comm_session.h"
+#endif
+#if COMM_ENABLE_RTOS
+#include "comm_rtos.h"
+#endif
+#if COMM_ENABLE_FEC
+#include "comm_fec.h"
+#endif
+#if COMM_ENABLE_BOND
+#include "comm_bond.h"
+#endif
+#if COMM_ENABLE_STORE
+#include "comm_store.h"
+#endif
+#if COMM_ENABLE_CLOCK
+#include "comm_clock.h"
+#endif
+#if COMM_ENABLE_CAPTURE
+#include "comm_capture.h"
+#endif
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -27,6 +69,27 @@ void comm_init(void)
 {
     // 调用管理器的初始化函数
     comm_manager_init();
+    comm_protocol_init();
+    
+#if COMM_ENABLE_ROUTER
+    comm_router_init();
+#endif
+    
+#if COMM_ENABLE_FEC
+    comm_fec_init();
+#endif
+    
+#if COMM_ENABLE_BOND
+    comm_bond_init();
+#endif
+    
+#if COMM_ENABLE_STORE
+    comm_store_init();
+#endif
+    
+#if COMM_ENABLE_CLOCK
+    comm_clock_init();
+#endif
 }
 
 /**
@@ -60,6 +123,40 @@ bool comm_add_uart(UART_HandleTypeDef *huart)
     return true;
 }
 
+/**
+ * @brief  使用用户提供的缓冲区添加UART
+ * @param  huart: UART句柄指针
+ * @param  rx_buffer: 接收缓冲区
+ * @param  rx_size: 接收缓冲区大小
+ * @param  tx_buffer: 发送缓冲区
+ * @param  tx_size: 发送缓冲区大小
+ * @retval true: 添加成功, false: 添加失败
+ */
+bool comm_add_uart_with_buffers(UART_HandleTypeDef *huart,
+                                char *rx_buffer, uint16_t rx_size,
+                                char *tx_buffer, uint16_t tx_size)
+{
+    if (huart == NULL || rx_buffer == NULL || tx_buffer == NULL) {
+        return false;
+    }
+    
+    if (comm_find_instance(huart) != NULL) {
+        return true;
+    }
+    
+    comm_instance_t *instance = comm_create_uart_instance_ex(huart, 1000, 3,
+                                                            rx_buffer, rx_size,
+                                                            tx_buffer, tx_size);
+    if (instance == NULL) {
+        return false;
+    }
+    
+    HAL_UART_Receive_IT(huart, &instance->rx_byte, 1);
+    instance->debug_enabled = true;
+    
+    return true;
+}
+
 /**
  * @brief  注册命令回调函数
  * @param  huart: UART句柄指针
@@ -121,6 +218,73 @@ bool comm_register_state_change_callback(UART_HandleTypeDef *huart,
     return true;
 }
 
+/**
+ * @brief  注册带上下文的命令回调函数
+ * @param  huart: UART句柄指针
+ * @param  cmd: 命令字符串
+ * @param  callback: 回调函数指针
+ * @param  user_ctx: 用户上下文
+ * @retval true: 注册成功, false: 注册失败
+ */
+bool comm_register_command_callback_ex(UART_HandleTypeDef *huart, 
+                                       const char *cmd, 
+                                       comm_callback_ex_t callback,
+                                       void *user_ctx)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        COMM_DEBUG_ERROR("未找到UART实例");
+        COMM_ERROR_OUTPUT("UART操作失败: 未找到UART实例 %p", huart);
+        return false;
+    }
+
+    return comm_register_callback_ex(instance, cmd, callback, user_ctx);
+}
+
+/**
+ * @brief  设置带上下文的失败回调函数
+ * @param  huart: UART句柄指针
+ * @param  callback: 失败回调函数指针
+ * @param  user_ctx: 用户上下文
+ * @retval true: 设置成功, false: 设置失败
+ */
+bool comm_register_fail_callback_ex(UART_HandleTypeDef *huart, 
+                                    comm_fail_callback_ex_t callback,
+                                    void *user_ctx)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        COMM_DEBUG_ERROR("未找到UART实例");
+        COMM_ERROR_OUTPUT("UART操作失败: 未找到UART实例 %p", huart);
+        return false;
+    }
+
+    comm_set_fail_callback_ex(instance, callback, user_ctx);
+    return true;
+}
+
+/**
+ * @brief  设置带上下文的状态变化回调函数
+ * @param  huart: UART句柄指针
+ * @param  callback: 状态变化回调函数指针
+ * @param  user_ctx: 用户上下文
+ * @retval true: 设置成功, false: 设置失败
+ */
+bool comm_register_state_change_callback_ex(UART_HandleTypeDef *huart, 
+                                            comm_state_change_callback_ex_t callback,
+                                            void *user_ctx)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        COMM_DEBUG_ERROR("未找到UART实例");
+        COMM_ERROR_OUTPUT("UART操作失败: 未找到UART实例 %p", huart);
+        return false;
+    }
+
+    comm_set_state_change_callback_ex(instance, callback, user_ctx);
+    return true;
+}
+
 /**
  * @brief  发送命令（异步）
  * @param  huart: UART句柄指针
@@ -137,6 +301,11 @@ bool comm_send_command(UART_HandleTypeDef *huart, const char *cmd, const char *d
         return false;
     }
 
+#if COMM_ENABLE_CAPTURE
+    // 回放时按同样的时刻重新调用
+    comm_capture_note_send(instance, cmd, data);
+#endif
+
     if (!comm_instance_is_ready(instance)) {
         return false;
     }
@@ -145,7 +314,8 @@ bool comm_send_command(UART_HandleTypeDef *huart, const char *cmd, const char *d
         return false;
     }
 
-    if (strlen(cmd) >= COMM_MAX_CMD_LENGTH || strlen(data) >= COMM_MAX_DATA_LENGTH) {
+    size_t data_len = strlen(data);
+    if (strlen(cmd) >= COMM_MAX_CMD_LENGTH || data_len >= COMM_MAX_DATA_LENGTH) {
         return false;
     }
 
@@ -155,6 +325,7 @@ bool comm_send_command(UART_HandleTypeDef *huart, const char *cmd, const char *d
     
     strncpy(instance->current_data, data, sizeof(instance->current_data) - 1);
     instance->current_data[sizeof(instance->current_data) - 1] = '\0';
+    instance->current_data_len = (uint16_t)data_len;
     instance->retry_count = 0;
 
     uint16_t frame_len;
@@ -163,28 +334,8 @@ bool comm_send_command(UART_HandleTypeDef *huart, const char *cmd, const char *d
     }
 
     instance->tx_length = frame_len;
-    
-
-    if (strlen(instance->pending_frame.cmd) > 0) {
-        memset(&instance->pending_frame, 0, sizeof(comm_frame_t));
-    }
 
-    char send_copy[COMM_TX_BUFFER_SIZE];
-    memcpy(send_copy, instance->tx_buffer, frame_len);
-    send_copy[frame_len] = '\0';
-    
-    HAL_StatusTypeDef status = HAL_UART_Transmit(instance->huart, 
-                                                (uint8_t*)send_copy, 
-                                                frame_len, 1000);  // 1秒超时
-
-    if (status == HAL_OK) {
-        comm_set_state(instance, COMM_STATE_WAIT_ACK);
-        instance->last_send_time = HAL_GetTick();
-
-        return true;
-    } else {
-        return false;
-    }
+    return comm_start_transmit(instance);
 }
 
 /**
@@ -194,7 +345,14 @@ bool comm_send_command(UART_HandleTypeDef *huart, const char *cmd, const char *d
  */
 bool comm_ping(UART_HandleTypeDef *huart)
 {
-    return comm_send_command(huart, COMM_CMD_PING, "TEST");
+    if (!comm_send_command(huart, COMM_CMD_PING, "TEST")) {
+        return false;
+    }
+    
+#if COMM_ENABLE_STATS
+    comm_find_instance(huart)->stats.ping_count++;
+#endif
+    return true;
 }
 
 /**
@@ -251,14 +409,77 @@ uint8_t comm_get_retry_count(UART_HandleTypeDef *huart)
     return instance->retry_count;
 }
 
+/**
+ * @brief  获取通信库RAM占用
+ * @param  footprint: 输出占用统计
+ * @retval None
+ */
+void comm_get_footprint(comm_footprint_t *footprint)
+{
+    if (footprint == NULL) {
+        return;
+    }
+    
+    memset(footprint, 0, sizeof(comm_footprint_t));
+    footprint->instance_bytes = sizeof(comm_instance_t);
+    footprint->instance_table_bytes = sizeof(comm_instance_t) * COMM_MAX_INSTANCES;
+    footprint->default_buffer_bytes = COMM_DEFAULT_BUFFER_BYTES;
+    footprint->static_bytes = COMM_STATIC_RAM_BYTES;
+    
+#if COMM_ENABLE_PUBSUB
+    footprint->feature_bytes += sizeof(comm_pubsub_t);
+#endif
+#if COMM_ENABLE_RS485
+    footprint->feature_bytes += sizeof(comm_rs485_t);
+#endif
+#if COMM_ENABLE_PRIORITY
+    footprint->feature_bytes += sizeof(comm_priority_queue_t);
+#endif
+#if COMM_ENABLE_CREDITS
+    footprint->feature_bytes += sizeof(comm_credit_t);
+#endif
+#if COMM_ENABLE_BAUD
+    footprint->feature_bytes += sizeof(comm_baud_t);
+#endif
+#if COMM_ENABLE_COMPRESS
+    footprint->feature_bytes += sizeof(comm_compress_t);
+#endif
+#if COMM_ENABLE_LINK
+    footprint->feature_bytes += sizeof(comm_link_t);
+#endif
+#if COMM_ENABLE_SESSION
+    footprint->feature_bytes += sizeof(comm_session_t);
+#endif
+#if COMM_ENABLE_FEC
+    footprint->feature_bytes += sizeof(comm_fec_t);
+#endif
+    
+    uint8_t count = comm_get_instance_count();
+    footprint->instances_used = count;
+    for (uint8_t i = 0; i < count; i++) {
+        comm_instance_t *instance = comm_get_instance_by_index(i);
+        if (instance->default_buffers) {
+            footprint->default_buffers_used++;
+        } else {
+            footprint->user_buffer_bytes += (uint32_t)instance->rx_slot_size * COMM_RX_FRAME_SLOTS +
+                                            instance->tx_buffer_size;
+        }
+    }
+}
+
 
 /**
  * @brief  定时处理函数（在定时器中断中调用）
  * @param  None
  * @retval None
+ * @note   启用COMM_ENABLE_RTOS时由通信任务调用，不要再在定时器中断中调用
  */
 void comm_tick(void)
 {
+#if COMM_ENABLE_CAPTURE
+    comm_capture_note_tick();
+#endif
+
     uint8_t count = comm_get_instance_count();
     for (uint8_t i = 0; i < count; i++) {
         comm_instance_t *instance = comm_get_instance_by_index(i);
@@ -272,13 +493,70 @@ void comm_tick(void)
             comm_handle_frame_timeout(instance);
         }
 
-        // 处理完整帧
-        if (instance->new_frame_available) {
-            comm_handle_complete_frame(instance, &instance->pending_frame);
-            instance->new_frame_available = false;
-            memset(&instance->pending_frame, 0, sizeof(comm_frame_t));
+        // 依次处理所有已完成的帧（视图直接指向各自的接收槽，处理完释放该槽即可，无需清零）
+        while (instance->rx_consumed != instance->rx_produced) {
+            uint8_t slot = instance->rx_consumed % COMM_RX_FRAME_SLOTS;
+#if COMM_ENABLE_FEC
+            // 纠错帧先纠错并解析字段，无法纠正的直接释放接收槽
+            if (comm_fec_decode_frame(instance, &instance->rx_frames[slot]))
+#endif
+            comm_handle_complete_frame(instance, &instance->rx_frames[slot]);
+            instance->rx_consumed++;
         }
+
+#if COMM_ENABLE_CREDITS
+        // 刚腾出的接收槽尽快通告给对端
+        comm_credit_process(instance);
+#endif
+
+#if COMM_ENABLE_PRIORITY
+        // 排队命令先于主题发布占用空闲的链路
+        comm_priority_process(instance);
+#endif
+
+#if COMM_ENABLE_PUBSUB
+        comm_pubsub_process(instance);
+#endif
+
+#if COMM_ENABLE_RS485
+        comm_rs485_process(instance);
+#endif
+
+#if COMM_ENABLE_BAUD
+        comm_baud_process(instance);
+#endif
+
+#if COMM_ENABLE_LINK
+        comm_link_process(instance);
+#endif
+
+#if COMM_ENABLE_SESSION
+        comm_session_process(instance);
+#endif
     }
+
+#if COMM_ENABLE_ROUTER
+    // 各实例本轮的ACK处理完后再转发，刚空闲的出口可以立即发送
+    comm_router_process();
+#endif
+
+#if COMM_ENABLE_BOND
+    // 同样在ACK处理完后结算分片，刚空闲的成员立即发送下一个分片
+    comm_bond_process();
+#endif
+
+#if COMM_ENABLE_STORE
+    // 持久化队列排在聚合通道之后，实例刚空闲时补发下一批
+    comm_store_process();
+#endif
+
+#if COMM_ENABLE_CLOCK
+    comm_clock_process();
+#endif
+
+#if COMM_ENABLE_CAPTURE
+    comm_capture_leave();
+#endif
 }
 
 
@@ -300,10 +578,19 @@ void comm_uart_rx_callback(UART_HandleTypeDef *huart)
     }
 
     uint32_t uart_errors = huart->ErrorCode;
+#if COMM_ENABLE_CAPTURE
+    comm_capture_note_rx(instance, instance->rx_byte, uart_errors);
+#endif
     if (uart_errors != HAL_UART_ERROR_NONE) {
         huart->ErrorCode = HAL_UART_ERROR_NONE;
 
         COMM_DEBUG_INSTANCE(instance, "UART错误: 0x%08lx", uart_errors);
+#if COMM_ENABLE_BAUD
+        comm_baud_note_error(instance);
+#endif
+#if COMM_ENABLE_LINK
+        comm_link_note_error(instance);
+#endif
 
         if (uart_errors & HAL_UART_ERROR_ORE) {
             HAL_UART_AbortReceive_IT(huart);
@@ -312,21 +599,56 @@ void comm_uart_rx_callback(UART_HandleTypeDef *huart)
         }
     }
     
+#if COMM_ENABLE_RTOS
+    uint8_t produced = instance->rx_produced;
+#endif
+
     // 处理接收的字节 - 使用实例内部的rx_byte
     comm_process_byte_in_interrupt(instance, instance->rx_byte);
+
+#if COMM_ENABLE_RTOS
+    // 收完一帧才唤醒通信任务
+    if (instance->rx_produced != produced) {
+        comm_rtos_notify_from_isr();
+    }
+#endif
     
     // 立即启动下一个字节接收，避免overrun
     HAL_UART_Receive_IT(huart, &instance->rx_byte, 1);
+
+#if COMM_ENABLE_CAPTURE
+    comm_capture_leave();
+#endif
 }
 
 /**
- * @brief  统一UART发送回调处理 - 不再使用(暂时留着 还有新想法 下次更新)
+ * @brief  统一UART发送回调处理 - 在HAL_UART_TxCpltCallback中调用
  * @param  huart: UART句柄指针
  * @retval None
+ * @note   中断方式发送完成(TC)后在这里释放RS-485总线
  */
 void comm_uart_tx_callback(UART_HandleTypeDef *huart)
 {
+#if COMM_ENABLE_RS485 || COMM_ENABLE_CAPTURE
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance != NULL) {
+#if COMM_ENABLE_CAPTURE
+        comm_capture_note_tx_done(instance);
+#endif
+#if COMM_ENABLE_RS485
+        comm_rs485_tx_end(instance);
+#endif
+#if COMM_ENABLE_CAPTURE
+        comm_capture_leave();
+#endif
+    }
+#else
+    (void)huart;
+#endif
 
+#if COMM_ENABLE_RTOS
+    comm_rtos_notify_from_isr();
+#endif
 }
 
 /**
@@ -338,6 +660,19 @@ void comm_uart_error_callback(UART_HandleTypeDef *huart)
 {
     comm_instance_t *instance = comm_find_instance(huart);
     if (instance != NULL) {
+#if COMM_ENABLE_CAPTURE
+        comm_capture_note_error(instance);
+#endif
+#if COMM_ENABLE_BAUD
+        // 帧错误/噪声多半是两端波特率不一致或线路质量不足
+        comm_baud_note_error(instance);
+#endif
+#if COMM_ENABLE_LINK
+        comm_link_note_error(instance);
+#endif
         HAL_UART_Receive_IT(huart, &instance->rx_byte, 1);
+#if COMM_ENABLE_CAPTURE
+        comm_capture_leave();
+#endif
     }
 }
\ No newline at end of file
@@ -39,6 +39,36 @@ typedef void (*comm_state_change_callback_t)(UART_HandleTypeDef *huart,
                                             const char* to_state, 
                                             uint8_t retry_count);
 
+/** @brief 通信库RAM占用（字节） */
+typedef struct {
+    uint32_t instance_bytes;                /**< 单个实例结构（不含缓冲区） */
+    uint32_t feature_bytes;                 /**< 其中可选功能占用的部分 */
+    uint32_t instance_table_bytes;          /**< 实例表（COMM_MAX_INSTANCES个实例） */
+    uint32_t default_buffer_bytes;          /**< 默认缓冲区池（COMM_DEFAULT_BUFFER_COUNT套） */
+    uint32_t static_bytes;                  /**< 库的静态RAM合计（COMM_STATIC_RAM_BYTES） */
+    uint32_t user_buffer_bytes;             /**< 已挂接的用户缓冲区 */
+    uint8_t instances_used;                 /**< 已添加的UART数 */
+    uint8_t default_buffers_used;           /**< 已分配的默认缓冲区套数 */
+} comm_footprint_t;
+
+/* 带用户上下文的回调函数类型：携带UART句柄、数据长度和注册时传入的user_ctx */
+typedef void (*comm_callback_ex_t)(UART_HandleTypeDef *huart,
+                                   const char *cmd,
+                                   const char *data,
+                                   uint16_t data_len,
+                                   void *user_ctx);
+typedef void (*comm_fail_callback_ex_t)(UART_HandleTypeDef *huart,
+                                        const char *cmd,
+                                        const char *data,
+                                        uint16_t data_len,
+                                        const char *reason,
+                                        void *user_ctx);
+typedef void (*comm_state_change_callback_ex_t)(UART_HandleTypeDef *huart,
+                                               const char *from_state,
+                                               const char *to_state,
+                                               uint8_t retry_count,
+                                               void *user_ctx);
+
 /* =============================================================================
  * 核心API
  * =============================================================================
@@ -59,6 +89,20 @@ void comm_init(void);
  */
 bool comm_add_uart(UART_HandleTypeDef *huart);
 
+/**
+ * @brief  使用用户提供的缓冲区添加UART
+ * @param  huart: UART句柄指针
+ * @param  rx_buffer: 接收缓冲区，平分为COMM_RX_FRAME_SLOTS个接收槽，每个槽要放得下最长的接收帧
+ * @param  rx_size: 接收缓冲区大小
+ * @param  tx_buffer: 发送缓冲区，要放得下最长的发送帧
+ * @param  tx_size: 发送缓冲区大小
+ * @retval true: 添加成功, false: 添加失败（缓冲区大小超出COMM_MIN_BUFFER_SIZE~默认大小）
+ * @note   不占用默认缓冲区池；缓冲区在整个运行期间必须有效（静态或全局变量）
+ */
+bool comm_add_uart_with_buffers(UART_HandleTypeDef *huart,
+                                char *rx_buffer, uint16_t rx_size,
+                                char *tx_buffer, uint16_t tx_size);
+
 /**
  * @brief  发送命令（异步）
  * @param  huart: UART句柄指针
@@ -95,11 +139,45 @@ bool comm_register_fail_callback(UART_HandleTypeDef *huart, comm_fail_callback_t
  */
 bool comm_register_state_change_callback(UART_HandleTypeDef *huart, comm_state_change_callback_t callback);
 
+/**
+ * @brief  注册带上下文的命令回调函数
+ * @param  huart: UART句柄指针
+ * @param  cmd: 要监听的命令字符串
+ * @param  callback: 回调函数指针
+ * @param  user_ctx: 用户上下文，回调时原样传回
+ * @retval true: 注册成功, false: 注册失败
+ * @note   回调参数中直接给出huart和数据长度，多个UART可共用同一个处理函数，
+ *         无需全局表反查来源链路；与普通回调注册到同一命令时，后注册者生效
+ */
+bool comm_register_command_callback_ex(UART_HandleTypeDef *huart, const char *cmd,
+                                       comm_callback_ex_t callback, void *user_ctx);
+
+/**
+ * @brief  注册带上下文的失败回调函数
+ * @param  huart: UART句柄指针
+ * @param  callback: 失败回调函数指针
+ * @param  user_ctx: 用户上下文，回调时原样传回
+ * @retval true: 注册成功, false: 注册失败
+ */
+bool comm_register_fail_callback_ex(UART_HandleTypeDef *huart,
+                                    comm_fail_callback_ex_t callback, void *user_ctx);
+
+/**
+ * @brief  注册带上下文的状态变化回调函数
+ * @param  huart: UART句柄指针
+ * @param  callback: 状态变化回调函数指针
+ * @param  user_ctx: 用户上下文，回调时原样传回
+ * @retval true: 注册成功, false: 注册失败
+ */
+bool comm_register_state_change_callback_ex(UART_HandleTypeDef *huart,
+                                            comm_state_change_callback_ex_t callback,
+                                            void *user_ctx);
+
 /**
  * @brief  处理通信事务（在定时器中断中调用）
  * @param  None
  * @retval None
- * @note   必须在定时器中断中调用（建议1ms间隔）
+ * @note   必须在定时器中断中调用（建议1ms间隔）；启用COMM_ENABLE_RTOS时由通信任务调用
  */
 void comm_tick(void);
 
@@ -136,6 +214,13 @@ const char* comm_get_state_string(UART_HandleTypeDef *huart);
  */
 uint8_t comm_get_retry_count(UART_HandleTypeDef *huart);
 
+/**
+ * @brief  获取通信库RAM占用
+ * @param  footprint: 输出占用统计
+ * @retval None
+ */
+void comm_get_footprint(comm_footprint_t *footprint);
+
 /* =============================================================================
  * HAL回调集成函数 - 在HAL回调中调用
  * =============================================================================
@@ -0,0 +1,138 @@
+/**
+ * @file    comm_batch.c
+ * @brief   通信库批量命令 - 多条命令合帧发送、接收端原地拆分分发
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_batch.h"
+
+#if COMM_ENABLE_BATCH
+
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#include <string.h>
+
+/* =============================================================================
+ * 批量构建API实现
+ * =============================================================================
+ */
+
+void comm_batch_begin(comm_batch_t *batch)
+{
+    if (batch == NULL) {
+        return;
+    }
+
+    batch->payload[0] = '\0';
+    batch->length = 0;
+    batch->count = 0;
+}
+
+bool comm_batch_add(comm_batch_t *batch, const char *cmd, const char *data)
+{
+    if (batch == NULL || cmd == NULL || data == NULL) {
+        return false;
+    }
+
+    size_t cmd_len = strlen(cmd);
+    size_t data_len = strlen(data);
+    if (cmd_len == 0 || cmd_len >= COMM_MAX_CMD_LENGTH ||
+        strchr(cmd, COMM_CMD_DATA_SEPARATOR) != NULL ||
+        strchr(cmd, COMM_BATCH_SEPARATOR) != NULL ||
+        strchr(data, COMM_BATCH_SEPARATOR) != NULL) {
+        return false;
+    }
+
+    // 第一条之后每条前面加分隔符
+    size_t needed = (batch->count > 0 ? 1 : 0) + cmd_len + 1 + data_len;
+    if (batch->length + needed > COMM_BATCH_MAX_LENGTH) {
+        return false;
+    }
+
+    char *p = &batch->payload[batch->length];
+    if (batch->count > 0) {
+        *p++ = COMM_BATCH_SEPARATOR;
+    }
+    memcpy(p, cmd, cmd_len);
+    p += cmd_len;
+    *p++ = COMM_CMD_DATA_SEPARATOR;
+    memcpy(p, data, data_len);
+    p += data_len;
+    *p = '\0';
+
+    batch->length = (uint16_t)(batch->length + needed);
+    batch->count++;
+    return true;
+}
+
+bool comm_batch_send(UART_HandleTypeDef *huart, const comm_batch_t *batch)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || batch == NULL || batch->count == 0) {
+        return false;
+    }
+
+    if (!comm_instance_is_ready(instance)) {
+        return false;
+    }
+
+    // 失败回调只需要能辨认是哪个批次，数据放不下时截断
+    strcpy(instance->current_cmd, COMM_CMD_BATCH);
+    strncpy(instance->current_data, batch->payload, sizeof(instance->current_data) - 1);
+    instance->current_data[sizeof(instance->current_data) - 1] = '\0';
+    instance->current_data_len = (uint16_t)strlen(instance->current_data);
+    instance->retry_count = 0;
+
+    uint16_t frame_len;
+    if (!comm_build_frame(instance, COMM_CMD_BATCH, batch->payload, instance->tx_buffer, &frame_len)) {
+        return false;
+    }
+
+    instance->tx_length = frame_len;
+
+    COMM_DEBUG_INSTANCE(instance, "发送批量帧: %d条命令, %d字节", batch->count, frame_len);
+    return comm_start_transmit(instance);
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+bool comm_batch_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    if (!comm_frame_cmd_is(instance, frame, COMM_CMD_BATCH)) {
+        return false;
+    }
+
+    // 数据视图指向实例自己的接收槽，可以原地切分
+    char *entry = (char *)COMM_FRAME_DATA(instance, frame);
+    char *end = entry + frame->data_len;
+
+    while (entry < end) {
+        char *next = memchr(entry, COMM_BATCH_SEPARATOR, (size_t)(end - entry));
+        if (next == NULL) {
+            next = end;
+        }
+        *next = '\0';
+
+        char *data = memchr(entry, COMM_CMD_DATA_SEPARATOR, (size_t)(next - entry));
+        if (data != NULL && data > entry && data - entry < COMM_MAX_CMD_LENGTH) {
+            *data++ = '\0';
+            uint8_t cmd_len = (uint8_t)(data - 1 - entry);
+            if (!comm_call_callback(instance, entry, cmd_len, data, (uint16_t)(next - data))) {
+                COMM_DEBUG_INSTANCE(instance, "批量帧中忽略未注册命令: %s", entry);
+            }
+        } else {
+            COMM_DEBUG_INSTANCE(instance, "批量帧条目格式错误: %s", entry);
+        }
+
+        entry = next + 1;
+    }
+
+    return true;
+}
+
+#endif /* COMM_ENABLE_BATCH */
@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ * @file           : comm_batch.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信批量命令
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 批量命令 - 多条小命令合并为一帧，一个序列号、一个CRC、一次ACK
+ *
+ * 帧格式: {BAT:CMD1:DATA1;CMD2:DATA2;...#SEQ#CRC}
+ *
+ * 接收方确认整帧后按顺序把每条命令分发给各自注册的回调，和逐条发送时一样。
+ * 整帧丢失时按普通命令重发，不会只执行其中一部分。
+ *
+ * 限制：
+ *   - 命令和数据中不能包含COMM_BATCH_SEPARATOR，命令中不能包含':'
+ *   - 数据部分总长不超过COMM_BATCH_MAX_LENGTH，放不下时comm_batch_add()返回false，
+ *     先发送当前批次再继续添加
+ *   - 用comm_add_uart_with_buffers()配置了较小缓冲区的实例，整帧还要放得下两端的缓冲区
+ *   - 批量中的命令只分发给用户回调，不经过发布/订阅等内置命令处理
+ *
+ * 使用示例:
+ *   comm_batch_t batch;
+ *   comm_batch_begin(&batch);
+ *   comm_batch_add(&batch, "KP", "1.20");
+ *   comm_batch_add(&batch, "KI", "0.05");
+ *   comm_batch_add(&batch, "KD", "0.30");
+ *   comm_batch_send(&huart2, &batch);
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_BATCH_H
+#define COMM_BATCH_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_BATCH
+
+#if COMM_BATCH_MAX_LENGTH >= COMM_RX_SLOT_SIZE
+#error "COMM_BATCH_MAX_LENGTH必须小于接收槽大小COMM_RX_SLOT_SIZE"
+#endif
+
+/** @brief 批量命令构建器（由调用方分配，发送后可重新开始） */
+typedef struct {
+    char payload[COMM_BATCH_MAX_LENGTH + 1];    /**< "CMD:DATA;CMD:DATA..." */
+    uint16_t length;                            /**< 内容长度 */
+    uint8_t count;                              /**< 命令条数 */
+} comm_batch_t;
+
+/* =============================================================================
+ * 批量构建API
+ * =============================================================================
+ */
+
+/**
+ * @brief  开始一个新批次
+ * @param  batch: 批量构建器
+ * @retval None
+ */
+void comm_batch_begin(comm_batch_t *batch);
+
+/**
+ * @brief  向批次添加一条命令
+ * @param  batch: 批量构建器
+ * @param  cmd: 命令字符串
+ * @param  data: 数据字符串
+ * @retval true: 添加成功, false: 批次已满或命令/数据不合法
+ */
+bool comm_batch_add(comm_batch_t *batch, const char *cmd, const char *data);
+
+/**
+ * @brief  以一帧发送整个批次
+ * @param  huart: UART句柄指针
+ * @param  batch: 批量构建器
+ * @retval true: 发送成功, false: 实例忙或批次为空
+ * @note   失败回调中cmd为"BAT"，data为批次内容（可能被截断）
+ */
+bool comm_batch_send(UART_HandleTypeDef *huart, const comm_batch_t *batch);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  拆分批量帧并逐条分发
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @retval true: 已作为批量帧处理, false: 不是批量帧
+ */
+bool comm_batch_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+#endif /* COMM_ENABLE_BATCH */
+
+#endif /* COMM_BATCH_H */
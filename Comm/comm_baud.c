@@ -0,0 +1,444 @@
+/**
+ * @file    comm_baud.c
+ * @brief   通信库波特率协商 - 能力探测、同步切换、验证与误码回退
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_baud.h"
+
+#if COMM_ENABLE_BAUD
+
+#include "comm.h"
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 协商操作（PING/PONG的数据字段） */
+#define COMM_BAUD_OP_CAP            "CAP"
+#define COMM_BAUD_OP_SET            "SET"
+#define COMM_BAUD_OP_CHECK          "CHK"
+#define COMM_BAUD_OP_ROLLBACK       "RB"
+
+/* 协商阶段 */
+typedef enum {
+    COMM_BAUD_IDLE = 0,             /**< 空闲，监测误码率 */
+    COMM_BAUD_CAP_WAIT,             /**< 发起方：等待对端能力 */
+    COMM_BAUD_SET_SEND,             /**< 发起方：选择下一个候选波特率并发送切换请求 */
+    COMM_BAUD_SET_WAIT,             /**< 发起方：等待对端同意切换 */
+    COMM_BAUD_SWITCH,               /**< 延时后切换 */
+    COMM_BAUD_VERIFY                /**< 已切换，验证新波特率 */
+} comm_baud_phase_t;
+
+static const uint32_t g_baud_rates[COMM_BAUD_RATE_COUNT] = COMM_BAUD_RATE_TABLE;
+
+/* Private function prototypes -----------------------------------------------*/
+static int8_t comm_baud_index(uint32_t baud);
+static bool comm_baud_op(const char *data, const char *op, const char **arg);
+static bool comm_baud_apply(comm_instance_t *instance, uint32_t baud);
+static void comm_baud_reply(comm_instance_t *instance, const char *cmd, const char *op, uint32_t value);
+static void comm_baud_schedule(comm_instance_t *instance, uint32_t baud, bool rolling_back);
+static void comm_baud_send_next(comm_instance_t *instance);
+static void comm_baud_check_errors(comm_instance_t *instance);
+
+/* =============================================================================
+ * 协商API实现
+ * =============================================================================
+ */
+
+bool comm_baud_set_supported(UART_HandleTypeDef *huart, uint16_t mask)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return false;
+    }
+
+    instance->baud.local_mask = mask & (uint16_t)((1UL << COMM_BAUD_RATE_COUNT) - 1);
+    return true;
+}
+
+bool comm_baud_negotiate(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || instance->baud.phase != COMM_BAUD_IDLE) {
+        return false;
+    }
+
+    if (!comm_send_command(huart, COMM_CMD_PING, COMM_BAUD_OP_CAP)) {
+        return false;
+    }
+
+    instance->baud.initiator = true;
+    instance->baud.phase = COMM_BAUD_CAP_WAIT;
+    instance->baud.phase_time = HAL_GetTick();
+    return true;
+}
+
+bool comm_baud_is_busy(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    return instance != NULL && instance->baud.phase != COMM_BAUD_IDLE;
+}
+
+uint32_t comm_baud_get_current(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return 0;
+    }
+
+    return huart->Init.BaudRate;
+}
+
+uint32_t comm_baud_get_rollbacks(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return 0;
+    }
+
+    return instance->baud.rollbacks;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_baud_init(comm_instance_t *instance)
+{
+    comm_baud_t *baud = &instance->baud;
+
+    memset(baud, 0, sizeof(comm_baud_t));
+    baud->base_baud = instance->huart->Init.BaudRate;
+    baud->fallback_baud = baud->base_baud;
+    baud->local_mask = (uint16_t)((1UL << COMM_BAUD_RATE_COUNT) - 1);
+    baud->window_start = HAL_GetTick();
+}
+
+void comm_baud_note_error(comm_instance_t *instance)
+{
+    // 与comm_tick中的累加偶有竞争，漏计一次不影响误码率判断
+    instance->baud.errors++;
+}
+
+bool comm_baud_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    comm_baud_t *baud = &instance->baud;
+    const char *data = COMM_FRAME_DATA(instance, frame);
+    const char *arg = NULL;
+
+    if (comm_frame_cmd_is(instance, frame, COMM_CMD_PING)) {
+        if (comm_baud_op(data, COMM_BAUD_OP_CAP, &arg)) {
+            comm_baud_reply(instance, COMM_CMD_PONG, COMM_BAUD_OP_CAP, baud->local_mask);
+        } else if (comm_baud_op(data, COMM_BAUD_OP_SET, &arg) && arg != NULL) {
+            uint32_t rate = strtoul(arg, NULL, 10);
+            int8_t index = comm_baud_index(rate);
+            if (index >= 0 && (baud->local_mask & (1U << index))) {
+                // 同意应答在旧波特率下发出后再延时切换
+                comm_baud_reply(instance, COMM_CMD_PONG, COMM_BAUD_OP_SET, rate);
+                baud->initiator = false;
+                comm_baud_schedule(instance, rate, false);
+            }
+        } else if (comm_baud_op(data, COMM_BAUD_OP_CHECK, &arg)) {
+            // 新波特率下收到检查帧即确认成功；应答丢失时发起方会再发，照常回复
+            comm_baud_reply(instance, COMM_CMD_PONG, COMM_BAUD_OP_CHECK, 0);
+            if (baud->phase == COMM_BAUD_VERIFY && !baud->initiator) {
+                baud->phase = COMM_BAUD_IDLE;
+                COMM_DEBUG_INSTANCE(instance, "波特率切换成功: %lu", (unsigned long)baud->target_baud);
+            }
+        } else if (comm_baud_op(data, COMM_BAUD_OP_ROLLBACK, &arg) && arg != NULL) {
+            uint32_t rate = strtoul(arg, NULL, 10);
+            if (comm_baud_index(rate) >= 0 || rate == baud->base_baud) {
+                baud->rollbacks++;
+                comm_baud_schedule(instance, rate, true);
+            }
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    if (comm_frame_cmd_is(instance, frame, COMM_CMD_PONG)) {
+        if (comm_baud_op(data, COMM_BAUD_OP_CAP, &arg) && arg != NULL) {
+            if (baud->phase == COMM_BAUD_CAP_WAIT) {
+                baud->candidates = baud->local_mask & (uint16_t)strtoul(arg, NULL, 16);
+                baud->phase = COMM_BAUD_SET_SEND;
+            }
+        } else if (comm_baud_op(data, COMM_BAUD_OP_SET, &arg) && arg != NULL) {
+            if (baud->phase == COMM_BAUD_SET_WAIT && strtoul(arg, NULL, 10) == baud->target_baud) {
+                comm_baud_schedule(instance, baud->target_baud, false);
+            }
+        } else if (comm_baud_op(data, COMM_BAUD_OP_CHECK, &arg)) {
+            if (baud->phase == COMM_BAUD_VERIFY && baud->initiator) {
+                baud->phase = COMM_BAUD_IDLE;
+                COMM_DEBUG_INSTANCE(instance, "波特率切换成功: %lu", (unsigned long)baud->target_baud);
+            }
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void comm_baud_process(comm_instance_t *instance)
+{
+    comm_baud_t *baud = &instance->baud;
+    uint32_t now = HAL_GetTick();
+
+    switch (baud->phase) {
+        case COMM_BAUD_CAP_WAIT:
+        case COMM_BAUD_SET_WAIT:
+            if (now - baud->phase_time >= COMM_BAUD_REPLY_TIMEOUT_MS) {
+                COMM_DEBUG_INSTANCE(instance, "对端无协商应答，保持%lu",
+                                   (unsigned long)instance->huart->Init.BaudRate);
+                baud->phase = COMM_BAUD_IDLE;
+            }
+            break;
+
+        case COMM_BAUD_SET_SEND:
+            comm_baud_send_next(instance);
+            break;
+
+        case COMM_BAUD_SWITCH: {
+            if (now - baud->phase_time < COMM_BAUD_SWITCH_DELAY_MS) {
+                break;
+            }
+
+            uint32_t previous = instance->huart->Init.BaudRate;
+            if (!comm_baud_apply(instance, baud->target_baud)) {
+                baud->phase = COMM_BAUD_IDLE;
+                break;
+            }
+
+            if (baud->rolling_back) {
+                // 回退后再出错只能回到初始波特率
+                baud->fallback_baud = baud->base_baud;
+                baud->phase = COMM_BAUD_IDLE;
+            } else {
+                baud->fallback_baud = previous;
+                baud->phase = COMM_BAUD_VERIFY;
+                baud->phase_time = HAL_GetTick();
+                baud->last_check = baud->phase_time - COMM_BAUD_CHECK_INTERVAL_MS;
+            }
+            break;
+        }
+
+        case COMM_BAUD_VERIFY: {
+            uint32_t elapsed = now - baud->phase_time;
+            uint32_t current = instance->huart->Init.BaudRate;
+
+            if (baud->initiator && elapsed < COMM_BAUD_VERIFY_TIMEOUT_MS) {
+                if (now - baud->last_check >= COMM_BAUD_CHECK_INTERVAL_MS) {
+                    baud->last_check = now;
+                    comm_send_datagram(instance, COMM_CMD_PING, COMM_BAUD_OP_CHECK);
+                }
+                break;
+            }
+
+            // 接收方多等一个周期，保证发起方的检查帧都已发完
+            uint32_t timeout = baud->initiator ? COMM_BAUD_VERIFY_TIMEOUT_MS : 2 * COMM_BAUD_VERIFY_TIMEOUT_MS;
+            if (elapsed >= timeout && current == baud->target_baud) {
+                COMM_DEBUG_INSTANCE(instance, "波特率%lu验证失败，回到%lu",
+                                   (unsigned long)baud->target_baud, (unsigned long)baud->fallback_baud);
+                int8_t index = comm_baud_index(baud->target_baud);
+                if (index >= 0) {
+                    baud->candidates &= (uint16_t)~(1U << index);
+                }
+                comm_baud_apply(instance, baud->fallback_baud);
+                if (!baud->initiator) {
+                    baud->phase = COMM_BAUD_IDLE;
+                }
+            }
+
+            // 发起方等对端也回到原波特率后再尝试下一个
+            if (baud->initiator && elapsed >= 3 * COMM_BAUD_VERIFY_TIMEOUT_MS) {
+                baud->phase = COMM_BAUD_SET_SEND;
+            }
+            break;
+        }
+
+        default:
+            comm_baud_check_errors(instance);
+            break;
+    }
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  波特率在表中的位置
+ * @retval 下标，不在表中返回-1
+ */
+static int8_t comm_baud_index(uint32_t baud)
+{
+    for (int8_t i = 0; i < COMM_BAUD_RATE_COUNT; i++) {
+        if (g_baud_rates[i] == baud) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief  匹配协商操作"OP"或"OP,参数"
+ * @param  arg: 输出参数起始位置，没有参数时为NULL
+ */
+static bool comm_baud_op(const char *data, const char *op, const char **arg)
+{
+    size_t len = strlen(op);
+    if (strncmp(data, op, len) != 0) {
+        return false;
+    }
+
+    if (data[len] == '\0') {
+        *arg = NULL;
+        return true;
+    }
+    if (data[len] == ',') {
+        *arg = &data[len + 1];
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief  重新初始化UART为指定波特率并恢复接收
+ */
+static bool comm_baud_apply(comm_instance_t *instance, uint32_t baud)
+{
+    UART_HandleTypeDef *huart = instance->huart;
+    uint32_t previous = huart->Init.BaudRate;
+
+    HAL_UART_AbortReceive_IT(huart);
+    huart->Init.BaudRate = baud;
+    bool ok = (HAL_UART_Init(huart) == HAL_OK);
+    if (!ok) {
+        huart->Init.BaudRate = previous;
+        HAL_UART_Init(huart);
+        COMM_ERROR_OUTPUT("UART %p 无法切换到波特率%lu", huart, (unsigned long)baud);
+    }
+
+    // 切换瞬间可能收到半帧，从头开始解析
+    instance->parse_state = FRAME_STATE_IDLE;
+    instance->rx_index = 0;
+    HAL_UART_Receive_IT(huart, &instance->rx_byte, 1);
+
+    instance->baud.window_start = HAL_GetTick();
+    instance->baud.window_errors = instance->baud.errors;
+    return ok;
+}
+
+/**
+ * @brief  发送协商应答数据报
+ */
+static void comm_baud_reply(comm_instance_t *instance, const char *cmd, const char *op, uint32_t value)
+{
+    char data[24];
+
+    if (strcmp(op, COMM_BAUD_OP_CAP) == 0) {
+        snprintf(data, sizeof(data), "%s,%04lX", op, (unsigned long)value);
+    } else if (strcmp(op, COMM_BAUD_OP_CHECK) == 0) {
+        snprintf(data, sizeof(data), "%s", op);
+    } else {
+        snprintf(data, sizeof(data), "%s,%lu", op, (unsigned long)value);
+    }
+
+    comm_send_datagram(instance, cmd, data);
+}
+
+/**
+ * @brief  计划在COMM_BAUD_SWITCH_DELAY_MS后切换波特率
+ */
+static void comm_baud_schedule(comm_instance_t *instance, uint32_t baud, bool rolling_back)
+{
+    instance->baud.target_baud = baud;
+    instance->baud.rolling_back = rolling_back;
+    instance->baud.phase = COMM_BAUD_SWITCH;
+    instance->baud.phase_time = HAL_GetTick();
+}
+
+/**
+ * @brief  发起方：请求切换到高于当前波特率的最高候选
+ */
+static void comm_baud_send_next(comm_instance_t *instance)
+{
+    comm_baud_t *baud = &instance->baud;
+    uint32_t current = instance->huart->Init.BaudRate;
+    int8_t best = -1;
+
+    for (int8_t i = COMM_BAUD_RATE_COUNT - 1; i >= 0; i--) {
+        if ((baud->candidates & (1U << i)) && g_baud_rates[i] > current) {
+            best = i;
+            break;
+        }
+    }
+
+    if (best < 0) {
+        COMM_DEBUG_INSTANCE(instance, "协商结束，波特率: %lu", (unsigned long)current);
+        baud->phase = COMM_BAUD_IDLE;
+        return;
+    }
+
+    // 等待前一条命令完成
+    if (!comm_instance_is_ready(instance)) {
+        return;
+    }
+
+    char data[24];
+    snprintf(data, sizeof(data), "%s,%lu", COMM_BAUD_OP_SET, (unsigned long)g_baud_rates[best]);
+    if (comm_send_command(instance->huart, COMM_CMD_PING, data)) {
+        baud->target_baud = g_baud_rates[best];
+        baud->phase = COMM_BAUD_SET_WAIT;
+        baud->phase_time = HAL_GetTick();
+    }
+}
+
+/**
+ * @brief  升速后误码过多时回退到升速前的波特率
+ */
+static void comm_baud_check_errors(comm_instance_t *instance)
+{
+    comm_baud_t *baud = &instance->baud;
+    uint32_t now = HAL_GetTick();
+    uint32_t current = instance->huart->Init.BaudRate;
+
+    if (now - baud->window_start >= COMM_BAUD_ERROR_WINDOW_MS) {
+        baud->window_start = now;
+        baud->window_errors = baud->errors;
+        return;
+    }
+
+    if ((uint16_t)(baud->errors - baud->window_errors) <= COMM_BAUD_ERROR_THRESHOLD ||
+        current == baud->base_baud) {
+        return;
+    }
+
+    uint32_t target = (baud->fallback_baud != current) ? baud->fallback_baud : baud->base_baud;
+    COMM_ERROR_OUTPUT("UART %p 误码过多，波特率%lu回退到%lu", instance->huart,
+                      (unsigned long)current, (unsigned long)target);
+
+    // 这个波特率不再参与后续协商
+    int8_t index = comm_baud_index(current);
+    if (index >= 0) {
+        baud->candidates &= (uint16_t)~(1U << index);
+    }
+
+    // 通知帧可能因误码丢失，对端收不到时会因同样的误码自行回退
+    char data[24];
+    snprintf(data, sizeof(data), "%s,%lu", COMM_BAUD_OP_ROLLBACK, (unsigned long)target);
+    comm_send_datagram(instance, COMM_CMD_PING, data);
+
+    baud->rollbacks++;
+    comm_baud_schedule(instance, target, true);
+}
+
+#endif /* COMM_ENABLE_BAUD */
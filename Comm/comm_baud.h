@@ -0,0 +1,118 @@
+/**
+ ******************************************************************************
+ * @file           : comm_baud.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信波特率协商
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 波特率协商 - 链路以CubeMX配置的波特率启动，协商后切换到双方都支持的最高波特率
+ *
+ * 协商过程（基于PING/PONG，数据字段区分操作）：
+ *   1. 发起方: {PING:CAP}            对端回复 {PONG:CAP,MMMM}，MMMM为支持的波特率位图
+ *   2. 发起方: {PING:SET,921600}     对端回复 {PONG:SET,921600}，双方延时后切换
+ *   3. 发起方在新波特率下发送 {PING:CHK}，收到 {PONG:CHK} 即确认成功
+ *      验证超时双方各自回到原波特率，发起方继续尝试下一个较低的波特率
+ *
+ * 误码回退: 升速后统计窗口内的接收错误（CRC错误、帧超时、UART错误）超过阈值时，
+ * 发送 {PING:RB,115200} 通知对端后回到升速前的波特率。
+ *
+ * 不是CAP/SET/CHK/RB的PING仍交给用户回调，comm_ping()不受影响。
+ *
+ * 使用示例:
+ *   comm_baud_set_supported(&huart2, 0x00FF);   // 表中前8个波特率
+ *   comm_baud_negotiate(&huart2);
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_BAUD_H
+#define COMM_BAUD_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_BAUD
+
+/* =============================================================================
+ * 协商API
+ * =============================================================================
+ */
+
+/**
+ * @brief  设置本端支持的波特率
+ * @param  huart: UART句柄指针
+ * @param  mask: 位图，位i对应COMM_BAUD_RATE_TABLE中第i个波特率
+ * @retval true: 设置成功, false: 未找到实例
+ * @note   默认支持表中全部波特率，应按UART时钟能准确分频的范围设置
+ */
+bool comm_baud_set_supported(UART_HandleTypeDef *huart, uint16_t mask);
+
+/**
+ * @brief  发起波特率协商
+ * @param  huart: UART句柄指针
+ * @retval true: 已开始协商, false: 实例忙或正在协商
+ * @note   协商在comm_tick()中完成，期间普通命令照常收发
+ */
+bool comm_baud_negotiate(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  判断是否正在协商或切换
+ * @param  huart: UART句柄指针
+ * @retval true: 协商中, false: 空闲
+ */
+bool comm_baud_is_busy(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取当前波特率
+ * @param  huart: UART句柄指针
+ * @retval 当前波特率，未找到实例返回0
+ */
+uint32_t comm_baud_get_current(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取误码回退次数
+ * @param  huart: UART句柄指针
+ * @retval 回退次数
+ */
+uint32_t comm_baud_get_rollbacks(UART_HandleTypeDef *huart);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  初始化协商状态，记录初始波特率
+ * @param  instance: 实例指针
+ * @retval None
+ */
+void comm_baud_init(comm_instance_t *instance);
+
+/**
+ * @brief  记录一次接收错误
+ * @param  instance: 实例指针
+ * @retval None
+ * @note   可在中断中调用
+ */
+void comm_baud_note_error(comm_instance_t *instance);
+
+/**
+ * @brief  处理协商用的PING/PONG帧
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @retval true: 已处理, false: 不是协商帧
+ */
+bool comm_baud_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+/**
+ * @brief  推进协商状态、检查误码率
+ * @param  instance: 实例指针
+ * @retval None
+ * @note   由comm_tick()调用
+ */
+void comm_baud_process(comm_instance_t *instance);
+
+#endif /* COMM_ENABLE_BAUD */
+
+#endif /* COMM_BAUD_H */
@@ -0,0 +1,629 @@
+/**
+ * @file    comm_bond.c
+ * @brief   通信库链路聚合 - 消息分片、按成员分发、失败改派、接收重排
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_bond.h"
+
+#if COMM_ENABLE_BOND
+
+#include "comm.h"
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#include <string.h>
+
+/* 分片数字段中表示第一条消息的标志位 */
+#define COMM_BOND_START_FLAG        0x08
+
+/* 发送窗口中的一条消息 */
+typedef struct {
+    char message[COMM_BOND_MAX_MESSAGE];    /**< "CMD:DATA" */
+    uint16_t length;                        /**< 消息长度 */
+    uint8_t id;                             /**< 消息号 */
+    uint8_t fragments;                      /**< 分片数 */
+    uint8_t done_mask;                      /**< 已确认的分片 */
+    bool start;                             /**< 建立通道后的第一条消息 */
+} comm_bond_tx_t;
+
+/* 重排窗口中的一条消息，按消息号对窗口取模存放 */
+typedef struct {
+    char message[COMM_BOND_MAX_MESSAGE + 1]; /**< 拼接中的"CMD:DATA"，收齐后以'\0'结尾 */
+    uint16_t length;                        /**< 收齐后的消息长度 */
+    uint8_t id;                             /**< 消息号 */
+    uint8_t fragments;                      /**< 分片数 */
+    uint8_t received_mask;                  /**< 已收到的分片 */
+    bool is_used;                           /**< 是否有分片到达 */
+    bool complete;                          /**< 是否已收齐 */
+    uint32_t complete_time;                 /**< 收齐的时刻 */
+} comm_bond_rx_t;
+
+typedef struct {
+    uint8_t index;                          /**< 管理器实例表中的序号 */
+    bool busy;                              /**< 有分片正在发送或尚未结算 */
+    bool done;                              /**< 正在发送的分片已结束，等待结算 */
+    bool failed;                            /**< 正在发送的分片未收到ACK就放弃 */
+    bool down;                              /**< 暂停使用 */
+    uint8_t message_id;                     /**< 正在发送的分片所属的消息号 */
+    uint8_t fragment;                       /**< 正在发送的分片序号 */
+    comm_seq_t sequence;                    /**< 正在发送的分片的序列号 */
+    uint32_t down_time;                     /**< 暂停的时刻 */
+} comm_bond_member_t;
+
+typedef struct {
+    bool is_used;                           /**< 是否已使用 */
+    uint8_t member_count;                   /**< 成员数 */
+    uint8_t next_member;                    /**< 轮转起点，分片轮流分给各成员 */
+    comm_bond_member_t members[COMM_BOND_MAX_MEMBERS];
+
+    comm_bond_tx_t tx[COMM_BOND_WINDOW];    /**< 发送窗口 */
+    uint8_t tx_head;                        /**< 最早未完成的消息 */
+    uint8_t tx_count;                       /**< 未完成的消息数 */
+    uint8_t tx_next_id;                     /**< 下一条消息的消息号 */
+    bool tx_started;                        /**< 已发出过第一条消息 */
+
+    comm_bond_rx_t rx[COMM_BOND_WINDOW];    /**< 重排窗口 */
+    uint8_t rx_next_id;                     /**< 下一条应交付的消息号 */
+    bool rx_synced;                         /**< 已收到过分片，rx_next_id有效 */
+
+    comm_bond_stats_t stats;                /**< 统计 */
+} comm_bond_t;
+
+static comm_bond_t g_comm_bonds[COMM_BOND_MAX_BONDS] = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+static comm_bond_t* comm_bond_find(comm_instance_t *instance);
+static comm_bond_t* comm_bond_find_by_huart(UART_HandleTypeDef *huart);
+static void comm_bond_settle(comm_bond_t *bond, uint32_t now);
+static comm_bond_tx_t* comm_bond_tx_find(comm_bond_t *bond, uint8_t id);
+static uint8_t comm_bond_senders(comm_bond_t *bond, const comm_bond_tx_t *tx, uint8_t fragment,
+                                 bool *retrying);
+static void comm_bond_assign(comm_bond_t *bond);
+static comm_bond_member_t* comm_bond_pick_member(comm_bond_t *bond);
+static bool comm_bond_send_fragment(comm_bond_member_t *member, comm_bond_tx_t *tx, uint8_t fragment);
+static void comm_bond_rx_reset(comm_bond_t *bond, uint8_t next_id);
+static void comm_bond_deliver(comm_bond_t *bond);
+static void comm_bond_check_reorder(comm_bond_t *bond, uint32_t now);
+
+/* =============================================================================
+ * 聚合通道API实现
+ * =============================================================================
+ */
+
+bool comm_bond_create(UART_HandleTypeDef *const *members, uint8_t count)
+{
+    if (members == NULL || count == 0 || count > COMM_BOND_MAX_MEMBERS) {
+        return false;
+    }
+
+    comm_bond_t *bond = NULL;
+    for (uint8_t i = 0; i < COMM_BOND_MAX_BONDS; i++) {
+        if (!g_comm_bonds[i].is_used) {
+            bond = &g_comm_bonds[i];
+            break;
+        }
+    }
+    if (bond == NULL) {
+        return false;
+    }
+
+    uint8_t indexes[COMM_BOND_MAX_MEMBERS];
+    for (uint8_t i = 0; i < count; i++) {
+        comm_instance_t *instance = comm_find_instance(members[i]);
+        int8_t index = comm_manager_instance_index(instance);
+        if (index < 0 || comm_bond_find(instance) != NULL) {
+            return false;
+        }
+        for (uint8_t j = 0; j < i; j++) {
+            if (indexes[j] == (uint8_t)index) {
+                return false;
+            }
+        }
+        indexes[i] = (uint8_t)index;
+    }
+
+    memset(bond, 0, sizeof(comm_bond_t));
+    for (uint8_t i = 0; i < count; i++) {
+        bond->members[i].index = indexes[i];
+    }
+    bond->member_count = count;
+    // 消息号从建立时的时刻开始，对端在短时间内重启时第一条消息不会落在刚交付过的消息号上
+    bond->tx_next_id = (uint8_t)HAL_GetTick();
+    bond->is_used = true;
+
+    COMM_DEBUG_INFO("建立聚合通道: %d个成员", count);
+    return true;
+}
+
+bool comm_bond_destroy(UART_HandleTypeDef *huart)
+{
+    comm_bond_t *bond = comm_bond_find_by_huart(huart);
+    if (bond == NULL) {
+        return false;
+    }
+
+    memset(bond, 0, sizeof(comm_bond_t));
+    return true;
+}
+
+bool comm_bond_send(UART_HandleTypeDef *huart, const char *cmd, const char *data)
+{
+    comm_bond_t *bond = comm_bond_find_by_huart(huart);
+    if (bond == NULL || cmd == NULL || data == NULL || bond->tx_count >= COMM_BOND_WINDOW) {
+        return false;
+    }
+
+    size_t cmd_len = strlen(cmd);
+    size_t data_len = strlen(data);
+    if (cmd_len == 0 || cmd_len >= COMM_MAX_CMD_LENGTH ||
+        cmd_len + 1 + data_len > COMM_BOND_MAX_MESSAGE) {
+        return false;
+    }
+
+    uint8_t slot = (uint8_t)((bond->tx_head + bond->tx_count) % COMM_BOND_WINDOW);
+    comm_bond_tx_t *tx = &bond->tx[slot];
+
+    memcpy(tx->message, cmd, cmd_len);
+    tx->message[cmd_len] = COMM_CMD_DATA_SEPARATOR;
+    memcpy(tx->message + cmd_len + 1, data, data_len);
+    tx->length = (uint16_t)(cmd_len + 1 + data_len);
+    tx->fragments = (uint8_t)((tx->length + COMM_BOND_FRAGMENT_SIZE - 1) / COMM_BOND_FRAGMENT_SIZE);
+    tx->done_mask = 0;
+    tx->id = bond->tx_next_id++;
+    tx->start = !bond->tx_started;
+    bond->tx_started = true;
+    bond->tx_count++;
+
+    // 有空闲成员时立即发出，不必等到下一次comm_tick()
+    comm_bond_assign(bond);
+    return true;
+}
+
+bool comm_bond_is_ready(UART_HandleTypeDef *huart)
+{
+    comm_bond_t *bond = comm_bond_find_by_huart(huart);
+    return bond != NULL && bond->tx_count < COMM_BOND_WINDOW;
+}
+
+bool comm_bond_get_stats(UART_HandleTypeDef *huart, comm_bond_stats_t *stats)
+{
+    comm_bond_t *bond = comm_bond_find_by_huart(huart);
+    if (bond == NULL || stats == NULL) {
+        return false;
+    }
+
+    *stats = bond->stats;
+    stats->members = bond->member_count;
+    stats->members_up = 0;
+    for (uint8_t i = 0; i < bond->member_count; i++) {
+        if (!bond->members[i].down) {
+            stats->members_up++;
+        }
+    }
+    stats->tx_pending = bond->tx_count;
+    return true;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_bond_init(void)
+{
+    memset(g_comm_bonds, 0, sizeof(g_comm_bonds));
+}
+
+void comm_bond_process(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint8_t i = 0; i < COMM_BOND_MAX_BONDS; i++) {
+        comm_bond_t *bond = &g_comm_bonds[i];
+        if (!bond->is_used) {
+            continue;
+        }
+
+        comm_bond_settle(bond, now);
+        comm_bond_assign(bond);
+        comm_bond_check_reorder(bond, now);
+    }
+}
+
+void comm_bond_on_send_done(comm_instance_t *instance, comm_seq_t sequence, bool acked)
+{
+    comm_bond_t *bond = comm_bond_find(instance);
+    if (bond == NULL) {
+        return;
+    }
+
+    int8_t index = comm_manager_instance_index(instance);
+    for (uint8_t i = 0; i < bond->member_count; i++) {
+        comm_bond_member_t *member = &bond->members[i];
+        if (member->index == (uint8_t)index && member->busy && sequence == member->sequence) {
+            member->done = true;
+            member->failed = !acked;
+        }
+    }
+}
+
+bool comm_bond_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    if (!comm_frame_cmd_is(instance, frame, COMM_CMD_BOND)) {
+        return false;
+    }
+
+    comm_bond_t *bond = comm_bond_find(instance);
+    if (bond == NULL) {
+        COMM_DEBUG_INSTANCE(instance, "丢弃分片: 实例不属于聚合通道");
+        return true;
+    }
+
+    const char *data = COMM_FRAME_DATA(instance, frame);
+    if (frame->data_len <= COMM_BOND_HEADER_SIZE) {
+        return true;
+    }
+
+    int8_t id_high = comm_hex_nibble((uint8_t)data[0]);
+    int8_t id_low = comm_hex_nibble((uint8_t)data[1]);
+    int8_t fragment = comm_hex_nibble((uint8_t)data[2]);
+    int8_t count = comm_hex_nibble((uint8_t)data[3]);
+    if (id_high < 0 || id_low < 0 || fragment < 0 || count < 0) {
+        return true;
+    }
+
+    uint8_t id = (uint8_t)((id_high << 4) | id_low);
+    bool start = (count & COMM_BOND_START_FLAG) != 0;
+    count &= ~COMM_BOND_START_FLAG;
+    uint16_t chunk_len = frame->data_len - COMM_BOND_HEADER_SIZE;
+
+    // 除最后一片外都是整片，总长不超过COMM_BOND_MAX_MESSAGE
+    if (count == 0 || fragment >= count || chunk_len > COMM_BOND_FRAGMENT_SIZE ||
+        (fragment < count - 1 && chunk_len != COMM_BOND_FRAGMENT_SIZE) ||
+        (uint16_t)fragment * COMM_BOND_FRAGMENT_SIZE + chunk_len > COMM_BOND_MAX_MESSAGE) {
+        COMM_DEBUG_INSTANCE(instance, "丢弃无效分片");
+        return true;
+    }
+
+    if (!bond->rx_synced) {
+        comm_bond_rx_reset(bond, id);
+    } else {
+        uint8_t ahead = (uint8_t)(id - bond->rx_next_id);
+        uint8_t behind = (uint8_t)(bond->rx_next_id - id);
+        if (ahead >= COMM_BOND_WINDOW) {
+            if (start ? (behind <= 2 * COMM_BOND_WINDOW) : (ahead >= 128)) {
+                // 已交付消息的分片经其它成员重发
+                bond->stats.rx_duplicates++;
+                return true;
+            }
+            // 对端重新建立了通道，或本端错过了整个窗口
+            COMM_DEBUG_INSTANCE(instance, "聚合通道消息号重新同步: %d -> %d", bond->rx_next_id, id);
+            comm_bond_rx_reset(bond, id);
+        }
+    }
+
+    comm_bond_rx_t *rx = &bond->rx[id % COMM_BOND_WINDOW];
+    if (!rx->is_used || rx->id != id) {
+        rx->is_used = true;
+        rx->id = id;
+        rx->fragments = (uint8_t)count;
+        rx->received_mask = 0;
+        rx->complete = false;
+    }
+
+    uint8_t bit = (uint8_t)(1u << fragment);
+    if (rx->fragments != count || (rx->received_mask & bit) != 0) {
+        bond->stats.rx_duplicates++;
+        return true;
+    }
+
+    memcpy(rx->message + (uint16_t)fragment * COMM_BOND_FRAGMENT_SIZE,
+           data + COMM_BOND_HEADER_SIZE, chunk_len);
+    rx->received_mask |= bit;
+    if (fragment == count - 1) {
+        rx->length = (uint16_t)((uint16_t)fragment * COMM_BOND_FRAGMENT_SIZE + chunk_len);
+    }
+
+    if (rx->received_mask == (uint8_t)((1u << count) - 1)) {
+        rx->message[rx->length] = '\0';
+        rx->complete = true;
+        rx->complete_time = HAL_GetTick();
+        comm_bond_deliver(bond);
+    }
+    return true;
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  查找实例所属的聚合通道
+ */
+static comm_bond_t* comm_bond_find(comm_instance_t *instance)
+{
+    int8_t index = comm_manager_instance_index(instance);
+    if (index < 0) {
+        return NULL;
+    }
+
+    for (uint8_t i = 0; i < COMM_BOND_MAX_BONDS; i++) {
+        comm_bond_t *bond = &g_comm_bonds[i];
+        if (!bond->is_used) {
+            continue;
+        }
+        for (uint8_t j = 0; j < bond->member_count; j++) {
+            if (bond->members[j].index == (uint8_t)index) {
+                return bond;
+            }
+        }
+    }
+    return NULL;
+}
+
+static comm_bond_t* comm_bond_find_by_huart(UART_HandleTypeDef *huart)
+{
+    return comm_bond_find(comm_find_instance(huart));
+}
+
+/**
+ * @brief  结算各成员上结束的分片，放弃的分片回到待发状态；移出已全部确认的消息
+ */
+static void comm_bond_settle(comm_bond_t *bond, uint32_t now)
+{
+    for (uint8_t i = 0; i < bond->member_count; i++) {
+        comm_bond_member_t *member = &bond->members[i];
+
+        if (member->down && (now - member->down_time) >= COMM_BOND_RETRY_MS) {
+            member->down = false;
+        }
+
+        if (!member->busy || !member->done) {
+            continue;
+        }
+
+        // 消息可能已由其它成员上的重复分片完成并移出窗口
+        comm_bond_tx_t *tx = comm_bond_tx_find(bond, member->message_id);
+        uint8_t bit = (uint8_t)(1u << member->fragment);
+        member->busy = false;
+
+        if (member->failed) {
+            member->down = true;
+            member->down_time = now;
+            if (tx != NULL && (tx->done_mask & bit) == 0) {
+                bond->stats.tx_reassigned++;
+            }
+            COMM_DEBUG_INSTANCE(comm_get_instance_by_index(member->index),
+                                "聚合成员发送失败，分片改由其它成员发送");
+        } else if (tx != NULL && (tx->done_mask & bit) == 0) {
+            tx->done_mask |= bit;
+            bond->stats.tx_fragments++;
+        }
+    }
+
+    while (bond->tx_count > 0) {
+        comm_bond_tx_t *tx = &bond->tx[bond->tx_head];
+        if (tx->done_mask != (uint8_t)((1u << tx->fragments) - 1)) {
+            break;
+        }
+        bond->tx_head = (uint8_t)((bond->tx_head + 1) % COMM_BOND_WINDOW);
+        bond->tx_count--;
+        bond->stats.tx_messages++;
+    }
+}
+
+/**
+ * @brief  在发送窗口中查找消息
+ */
+static comm_bond_tx_t* comm_bond_tx_find(comm_bond_t *bond, uint8_t id)
+{
+    for (uint8_t i = 0; i < bond->tx_count; i++) {
+        comm_bond_tx_t *tx = &bond->tx[(bond->tx_head + i) % COMM_BOND_WINDOW];
+        if (tx->id == id) {
+            return tx;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief  统计正在发送某个分片的成员数，retrying输出其中是否有成员已在重试
+ */
+static uint8_t comm_bond_senders(comm_bond_t *bond, const comm_bond_tx_t *tx, uint8_t fragment,
+                                 bool *retrying)
+{
+    uint8_t count = 0;
+    *retrying = false;
+
+    for (uint8_t i = 0; i < bond->member_count; i++) {
+        comm_bond_member_t *member = &bond->members[i];
+        if (member->busy && member->message_id == tx->id && member->fragment == fragment) {
+            count++;
+            if (comm_get_instance_by_index(member->index)->retry_count > 0) {
+                *retrying = true;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief  按消息顺序把待发分片分给空闲的成员
+ * @note   待发分片都已发出后，还空闲的成员重复发送正在别的成员上重试的分片，
+ *         一条出故障的链路不会在判定失败之前卡住整个发送窗口
+ */
+static void comm_bond_assign(comm_bond_t *bond)
+{
+    bool retrying;
+
+    for (uint8_t i = 0; i < bond->tx_count; i++) {
+        comm_bond_tx_t *tx = &bond->tx[(bond->tx_head + i) % COMM_BOND_WINDOW];
+
+        for (uint8_t fragment = 0; fragment < tx->fragments; fragment++) {
+            if ((tx->done_mask & (1u << fragment)) != 0 ||
+                comm_bond_senders(bond, tx, fragment, &retrying) > 0) {
+                continue;
+            }
+
+            comm_bond_member_t *member = comm_bond_pick_member(bond);
+            if (member == NULL) {
+                return;
+            }
+            comm_bond_send_fragment(member, tx, fragment);
+        }
+    }
+
+    for (uint8_t i = 0; i < bond->tx_count; i++) {
+        comm_bond_tx_t *tx = &bond->tx[(bond->tx_head + i) % COMM_BOND_WINDOW];
+
+        for (uint8_t fragment = 0; fragment < tx->fragments; fragment++) {
+            if ((tx->done_mask & (1u << fragment)) != 0 ||
+                comm_bond_senders(bond, tx, fragment, &retrying) != 1 || !retrying) {
+                continue;
+            }
+
+            comm_bond_member_t *member = comm_bond_pick_member(bond);
+            if (member == NULL) {
+                return;
+            }
+            if (comm_bond_send_fragment(member, tx, fragment)) {
+                bond->stats.tx_duplicated++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief  从轮转起点开始找一个可用且空闲的成员
+ */
+static comm_bond_member_t* comm_bond_pick_member(comm_bond_t *bond)
+{
+    for (uint8_t i = 0; i < bond->member_count; i++) {
+        uint8_t k = (uint8_t)((bond->next_member + i) % bond->member_count);
+        comm_bond_member_t *member = &bond->members[k];
+        if (member->busy || member->down ||
+            !comm_instance_is_ready(comm_get_instance_by_index(member->index))) {
+            continue;
+        }
+
+        bond->next_member = (uint8_t)((k + 1) % bond->member_count);
+        return member;
+    }
+    return NULL;
+}
+
+/**
+ * @brief  在成员上可靠发送一个分片
+ */
+static bool comm_bond_send_fragment(comm_bond_member_t *member, comm_bond_tx_t *tx, uint8_t fragment)
+{
+    comm_instance_t *instance = comm_get_instance_by_index(member->index);
+    char data[COMM_BOND_HEADER_SIZE + COMM_BOND_FRAGMENT_SIZE + 1];
+
+    uint16_t offset = (uint16_t)fragment * COMM_BOND_FRAGMENT_SIZE;
+    uint16_t chunk_len = tx->length - offset;
+    if (chunk_len > COMM_BOND_FRAGMENT_SIZE) {
+        chunk_len = COMM_BOND_FRAGMENT_SIZE;
+    }
+
+    comm_hex_encode(&data[0], tx->id, 2);
+    comm_hex_encode(&data[2], fragment, 1);
+    comm_hex_encode(&data[3], (uint32_t)(tx->fragments | (tx->start ? COMM_BOND_START_FLAG : 0)), 1);
+    memcpy(data + COMM_BOND_HEADER_SIZE, tx->message + offset, chunk_len);
+    data[COMM_BOND_HEADER_SIZE + chunk_len] = '\0';
+
+    if (!comm_send_command(instance->huart, COMM_CMD_BOND, data)) {
+        // 构建或启动发送失败，暂停该成员，分片留给其它成员
+        member->down = true;
+        member->down_time = HAL_GetTick();
+        return false;
+    }
+
+    member->busy = true;
+    member->done = false;
+    member->failed = false;
+    member->message_id = tx->id;
+    member->fragment = fragment;
+    member->sequence = instance->current_sequence;
+    return true;
+}
+
+/**
+ * @brief  清空重排窗口，从指定消息号开始接收
+ */
+static void comm_bond_rx_reset(comm_bond_t *bond, uint8_t next_id)
+{
+    for (uint8_t i = 0; i < COMM_BOND_WINDOW; i++) {
+        bond->rx[i].is_used = false;
+    }
+    bond->rx_next_id = next_id;
+    bond->rx_synced = true;
+}
+
+/**
+ * @brief  按顺序交付收齐的消息给第一个成员上注册的命令回调
+ */
+static void comm_bond_deliver(comm_bond_t *bond)
+{
+    comm_instance_t *instance = comm_get_instance_by_index(bond->members[0].index);
+
+    for (;;) {
+        comm_bond_rx_t *rx = &bond->rx[bond->rx_next_id % COMM_BOND_WINDOW];
+        if (!rx->is_used || rx->id != bond->rx_next_id || !rx->complete) {
+            break;
+        }
+
+        // 回调中可能发送新消息，先让出窗口位置
+        rx->is_used = false;
+        bond->rx_next_id++;
+        bond->stats.rx_messages++;
+
+        char *separator = memchr(rx->message, COMM_CMD_DATA_SEPARATOR, rx->length);
+        if (separator == NULL || separator == rx->message ||
+            separator - rx->message >= COMM_MAX_CMD_LENGTH) {
+            COMM_DEBUG_INSTANCE(instance, "丢弃无效的聚合消息");
+            continue;
+        }
+
+        *separator = '\0';
+        uint8_t cmd_len = (uint8_t)(separator - rx->message);
+        if (!comm_call_callback(instance, rx->message, cmd_len, separator + 1,
+                                (uint16_t)(rx->length - cmd_len - 1))) {
+            COMM_DEBUG_INSTANCE(instance, "忽略未注册命令: %s", rx->message);
+        }
+    }
+}
+
+/**
+ * @brief  后面的消息收齐超过COMM_BOND_REORDER_TIMEOUT_MS仍缺当前消息时跳过当前消息
+ */
+static void comm_bond_check_reorder(comm_bond_t *bond, uint32_t now)
+{
+    while (bond->rx_synced) {
+        bool waiting = false;
+        uint32_t oldest = 0;
+
+        for (uint8_t i = 0; i < COMM_BOND_WINDOW; i++) {
+            comm_bond_rx_t *rx = &bond->rx[i];
+            if (rx->is_used && rx->complete && rx->id != bond->rx_next_id &&
+                (!waiting || (now - rx->complete_time) > (now - oldest))) {
+                waiting = true;
+                oldest = rx->complete_time;
+            }
+        }
+
+        if (!waiting || (now - oldest) < COMM_BOND_REORDER_TIMEOUT_MS) {
+            return;
+        }
+
+        bond->rx[bond->rx_next_id % COMM_BOND_WINDOW].is_used = false;
+        bond->rx_next_id++;
+        bond->stats.rx_skipped++;
+        comm_bond_deliver(bond);
+    }
+}
+
+#endif /* COMM_ENABLE_BOND */
@@ -0,0 +1,153 @@
+/**
+ ******************************************************************************
+ * @file           : comm_bond.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信链路聚合
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 链路聚合 - 把多个UART绑定为一个逻辑通道，单条链路带宽不够时分担批量传输
+ *
+ * 聚合通道由管理器实例表中已添加的若干实例组成，第一个成员的UART句柄代表整个通道:
+ *   - comm_bond_send()把"CMD:DATA"按COMM_BOND_FRAGMENT_SIZE切成分片，放入发送窗口
+ *   - comm_tick()把待发分片分给空闲的成员，每个分片作为BND命令在该成员上可靠发送，
+ *     各成员各自等待ACK，N条链路同时各有一个分片在途
+ *   - 成员放弃发送（重试用尽、链路断开）时分片改由其它成员重发，该成员暂停
+ *     COMM_BOND_RETRY_MS后再试，只要还有一条成员可用消息就不会丢失
+ *   - 成员开始重试时，空闲的成员重复发送同一分片，不必等到判定失败
+ *   - 接收端按消息号重排，收齐的消息按发送顺序交给第一个成员上注册的命令回调，
+ *     回调的data_len可以超过COMM_MAX_DATA_LENGTH
+ *
+ * 分片格式: {BND:MMIN<分片内容>#SEQ#CRC}
+ *   - MM为消息号（2位十六进制，循环使用）
+ *   - I为分片序号，N为分片数（各1位十六进制），N加8表示发送端建立通道后的第一条消息，
+ *     接收端据此在对端重启后重新同步消息号
+ *   - 分片改由其它成员重发可能造成重复，接收端按分片去重
+ *
+ * 注意：
+ *   - 通信双方用同样的成员建立聚合通道，成员顺序可以不同，但回调注册在各自的第一个成员上
+ *   - 成员链路上仍可单独收发普通命令，但会和分片争用链路，批量传输期间应通过聚合通道发送
+ *   - 消息内容不能包含'#'
+ *
+ * 使用示例:
+ *   UART_HandleTypeDef *members[] = { &huart2, &huart3, &huart6 };
+ *   comm_bond_create(members, 3);
+ *   comm_register_command_callback_ex(&huart2, "BLK", on_block, NULL);
+ *   comm_bond_send(&huart2, "BLK", block_hex);      // 放不下发送窗口时返回false，稍后再试
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_BOND_H
+#define COMM_BOND_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_BOND
+
+/** @brief 分片头长度（MMIN） */
+#define COMM_BOND_HEADER_SIZE       4
+
+/** @brief 聚合通道统计 */
+typedef struct {
+    uint8_t members;                        /**< 成员数 */
+    uint8_t members_up;                     /**< 当前可用的成员数 */
+    uint8_t tx_pending;                     /**< 发送窗口中未完成的消息数 */
+    uint32_t tx_messages;                   /**< 已发送完成的消息数 */
+    uint32_t tx_fragments;                  /**< 已确认的分片数 */
+    uint32_t tx_reassigned;                 /**< 成员失败后改由其它成员重发的分片数 */
+    uint32_t tx_duplicated;                 /**< 成员重试期间在空闲成员上重复发送的分片数 */
+    uint32_t rx_messages;                   /**< 已交付的消息数 */
+    uint32_t rx_duplicates;                 /**< 丢弃的重复分片数 */
+    uint32_t rx_skipped;                    /**< 重排超时跳过的消息数 */
+} comm_bond_stats_t;
+
+/* =============================================================================
+ * 聚合通道API
+ * =============================================================================
+ */
+
+/**
+ * @brief  用已添加的UART建立聚合通道
+ * @param  members: 成员UART句柄数组，第一个成员代表整个通道
+ * @param  count: 成员数，1~COMM_BOND_MAX_MEMBERS
+ * @retval true: 建立成功, false: 成员未添加、已属于其它通道或通道已满
+ */
+bool comm_bond_create(UART_HandleTypeDef *const *members, uint8_t count);
+
+/**
+ * @brief  解除聚合通道
+ * @param  huart: 通道中任一成员的UART句柄
+ * @retval true: 解除成功, false: 不属于任何通道
+ * @note   发送窗口和重排窗口中未完成的消息一并丢弃，成员上正在发送的分片照常结束
+ */
+bool comm_bond_destroy(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  通过聚合通道发送一条消息
+ * @param  huart: 通道中任一成员的UART句柄
+ * @param  cmd: 命令字符串
+ * @param  data: 数据字符串，"CMD:DATA"不超过COMM_BOND_MAX_MESSAGE
+ * @retval true: 已放入发送窗口, false: 参数无效或窗口已满
+ * @note   由comm_tick()分片发送，对端按顺序收到
+ */
+bool comm_bond_send(UART_HandleTypeDef *huart, const char *cmd, const char *data);
+
+/**
+ * @brief  发送窗口是否还有空位
+ * @param  huart: 通道中任一成员的UART句柄
+ * @retval true: 可以发送, false: 窗口已满或不属于任何通道
+ */
+bool comm_bond_is_ready(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取聚合通道统计
+ * @param  huart: 通道中任一成员的UART句柄
+ * @param  stats: 统计输出
+ * @retval true: 获取成功, false: 不属于任何通道
+ */
+bool comm_bond_get_stats(UART_HandleTypeDef *huart, comm_bond_stats_t *stats);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  初始化聚合通道表
+ * @param  None
+ * @retval None
+ * @note   由comm_init()调用
+ */
+void comm_bond_init(void);
+
+/**
+ * @brief  结算成员上完成的分片，把待发分片分给空闲的成员，检查重排超时
+ * @param  None
+ * @retval None
+ * @note   由comm_tick()在处理完所有实例后调用
+ */
+void comm_bond_process(void);
+
+/**
+ * @brief  成员的命令发送结束，结束的是正在发送的分片时记录结果
+ * @param  instance: 实例指针
+ * @param  sequence: 结束的命令的序列号
+ * @param  acked: 是否收到ACK
+ * @retval None
+ * @note   由comm_call_send_done()调用
+ */
+void comm_bond_on_send_done(comm_instance_t *instance, comm_seq_t sequence, bool acked);
+
+/**
+ * @brief  处理分片帧
+ * @param  instance: 实例指针
+ * @param  frame: 接收到的帧
+ * @retval true: 已处理（BND帧）, false: 不是BND帧
+ */
+bool comm_bond_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+#endif /* COMM_ENABLE_BOND */
+
+#endif /* COMM_BOND_H */
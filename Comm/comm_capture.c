@@ -0,0 +1,712 @@
+/**
+ * @file    comm_capture.c
+ * @brief   通信库抓包与回放 - 紧凑记录收发字节流、时刻和comm_tick()调用，主机上按原时序回放
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_capture.h"
+
+#if COMM_ENABLE_CAPTURE
+
+#include "comm.h"
+#include "comm_manager.h"
+#include <string.h>
+
+/* 记录类型（记录头高3位） */
+typedef enum {
+    COMM_CAPTURE_TIME = 0,                  /**< 时刻变化 */
+    COMM_CAPTURE_TICK,                      /**< 连续的comm_tick()调用 */
+    COMM_CAPTURE_RX,                        /**< 接收字节 */
+    COMM_CAPTURE_RXERR,                     /**< 带UART错误码的接收字节 */
+    COMM_CAPTURE_ERROR,                     /**< UART错误回调 */
+    COMM_CAPTURE_TX,                        /**< 发送字节流 */
+    COMM_CAPTURE_TXDONE,                    /**< 发送完成中断 */
+    COMM_CAPTURE_SEND                       /**< 应用发出的命令 */
+} comm_capture_type_t;
+
+/* 功能开关掩码，回放端必须一致 */
+#define COMM_CAPTURE_FEATURES       COMM_FEATURE_MASK
+
+/* RX记录的最大字节数（长度占1字节） */
+#define COMM_CAPTURE_RX_RUN_MAX     255
+
+/* 解析出的一条记录 */
+typedef struct {
+    comm_capture_type_t type;
+    uint8_t index;                          /**< 实例序号 */
+    uint32_t value;                         /**< TIME/TICK的时刻增量，RXERR的错误码 */
+    uint32_t count;                         /**< TICK的调用次数，RX/TX的字节数 */
+    const uint8_t *data;                    /**< RX/RXERR/TX的字节，SEND的命令 */
+    const char *text;                       /**< SEND的数据 */
+} comm_capture_record_t;
+
+/* 回放核对游标：每个实例下一条待核对的TX记录 */
+typedef struct {
+    uint32_t pos;                           /**< 记录位置 */
+    uint32_t time;                          /**< 该位置对应的时刻 */
+} comm_capture_cursor_t;
+
+/* 回放状态 */
+typedef struct {
+    const uint8_t *log;                     /**< 正在回放的记录，NULL表示未在回放 */
+    uint32_t length;                        /**< 记录长度 */
+    uint32_t start;                         /**< 起始时刻 */
+    uint8_t instance_count;                 /**< 抓包端实例数 */
+    bool diverged;                          /**< 已出现过不一致 */
+    comm_capture_cursor_t cursor[COMM_MAX_INSTANCES];
+    comm_capture_stats_t stats;
+} comm_capture_replay_t;
+
+typedef struct {
+    uint8_t *buffer;                        /**< 记录缓冲区 */
+    uint32_t size;                          /**< 缓冲区大小 */
+    uint32_t length;                        /**< 已记录字节数 */
+    uint32_t last_time;                     /**< 最近一条记录对应的时刻 */
+
+    uint32_t run_start;                     /**< 尚未写出的comm_tick()调用：起始时刻 */
+    uint32_t run_last;                      /**< 尚未写出的comm_tick()调用：最近时刻 */
+    uint32_t run_count;                     /**< 尚未写出的comm_tick()调用次数 */
+
+    uint32_t rx_len_pos;                    /**< 最近一条RX记录长度字节的位置 */
+    uint8_t rx_instance;                    /**< 最近一条RX记录的实例序号 */
+    bool rx_open;                           /**< 最近一条记录是RX，可以继续追加 */
+
+    volatile uint8_t depth;                 /**< comm_tick()/中断回调嵌套深度 */
+    bool active;                            /**< 正在抓包 */
+    bool overflow;                          /**< 缓冲区写满过 */
+
+    comm_capture_replay_t replay;           /**< 回放状态 */
+} comm_capture_t;
+
+static comm_capture_t g_comm_capture = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t comm_capture_index(const comm_instance_t *instance);
+static uint8_t *comm_capture_reserve(uint32_t size);
+static uint8_t comm_capture_put_varint(uint8_t *out, uint32_t value);
+static bool comm_capture_get_varint(const uint8_t *log, uint32_t length, uint32_t *pos, uint32_t *value);
+static bool comm_capture_parse(const uint8_t *log, uint32_t length, uint32_t *pos, comm_capture_record_t *record);
+static bool comm_capture_next_tx(uint8_t index, const uint8_t **data, uint32_t *len, uint32_t *time);
+static void comm_capture_check_tx(comm_instance_t *instance, const uint8_t *data, uint16_t len);
+static void comm_capture_note_mismatch(uint32_t time);
+static void comm_capture_flush_ticks(void);
+static void comm_capture_begin_event(uint32_t now);
+static void comm_capture_write(comm_capture_type_t type, uint8_t index, uint32_t value, bool has_value,
+                               const uint8_t *data, uint32_t data_len);
+
+/* =============================================================================
+ * API实现
+ * =============================================================================
+ */
+
+bool comm_capture_start(uint8_t *buffer, uint32_t size)
+{
+    if (buffer == NULL || size < COMM_CAPTURE_HEADER_SIZE || g_comm_capture.active) {
+        return false;
+    }
+
+    uint32_t now = HAL_GetTick();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    g_comm_capture.buffer = buffer;
+    g_comm_capture.size = size;
+    g_comm_capture.last_time = now;
+    g_comm_capture.run_count = 0;
+    g_comm_capture.rx_open = false;
+    g_comm_capture.overflow = false;
+
+    buffer[0] = 'C';
+    buffer[1] = 'C';
+    buffer[2] = 'A';
+    buffer[3] = 'P';
+    buffer[4] = COMM_CAPTURE_VERSION;
+    buffer[5] = comm_get_instance_count();
+    buffer[6] = (uint8_t)(COMM_CAPTURE_FEATURES & 0xFF);
+    buffer[7] = (uint8_t)(COMM_CAPTURE_FEATURES >> 8);
+    for (uint8_t i = 0; i < 4; i++) {
+        buffer[8 + i] = (uint8_t)(now >> (8 * i));
+    }
+    g_comm_capture.length = COMM_CAPTURE_HEADER_SIZE;
+    g_comm_capture.active = true;
+
+    __set_PRIMASK(primask);
+    return true;
+}
+
+uint32_t comm_capture_stop(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t length = 0;
+    if (g_comm_capture.active) {
+        // 末尾尚未写出的comm_tick()调用也要保留，回放才能走到同一时刻
+        comm_capture_flush_ticks();
+        g_comm_capture.active = false;
+        length = g_comm_capture.length;
+    }
+
+    __set_PRIMASK(primask);
+    return length;
+}
+
+bool comm_capture_is_overflow(void)
+{
+    return g_comm_capture.overflow;
+}
+
+bool comm_capture_replay(const uint8_t *log, uint32_t length, comm_capture_tick_setter_t set_tick,
+                         comm_capture_stats_t *stats)
+{
+    if (log == NULL || set_tick == NULL || length < COMM_CAPTURE_HEADER_SIZE || g_comm_capture.active) {
+        return false;
+    }
+
+    if (memcmp(log, "CCAP", 4) != 0 || log[4] != COMM_CAPTURE_VERSION) {
+        COMM_ERROR_OUTPUT("回放失败: 不是抓包记录或版本不符");
+        return false;
+    }
+
+    uint16_t features = (uint16_t)(log[6] | (log[7] << 8));
+    if (features != COMM_CAPTURE_FEATURES) {
+        COMM_ERROR_OUTPUT("回放失败: 功能开关不一致 (抓包 0x%04x, 本地 0x%04x)",
+                          features, COMM_CAPTURE_FEATURES);
+        return false;
+    }
+
+    uint8_t instance_count = log[5];
+    if (instance_count > comm_get_instance_count()) {
+        COMM_ERROR_OUTPUT("回放失败: 抓包有%d个实例, 本地只有%d个", instance_count, comm_get_instance_count());
+        return false;
+    }
+
+    uint32_t start = (uint32_t)log[8] | ((uint32_t)log[9] << 8) | ((uint32_t)log[10] << 16) |
+                     ((uint32_t)log[11] << 24);
+
+    // 每个实例一个核对游标，库重新产生的发送按顺序与记录比较
+    comm_capture_replay_t *replay = &g_comm_capture.replay;
+    memset(replay, 0, sizeof(*replay));
+    replay->log = log;
+    replay->length = length;
+    replay->start = start;
+    replay->instance_count = instance_count;
+    for (uint8_t i = 0; i < instance_count; i++) {
+        replay->cursor[i].pos = COMM_CAPTURE_HEADER_SIZE;
+        replay->cursor[i].time = start;
+    }
+
+    uint32_t now = start;
+    uint32_t pos = COMM_CAPTURE_HEADER_SIZE;
+    comm_capture_record_t record;
+    bool ok = true;
+
+    set_tick(now);
+
+    while (pos < length) {
+        if (!comm_capture_parse(log, length, &pos, &record) ||
+            (record.type >= COMM_CAPTURE_RX && record.index >= instance_count)) {
+            ok = false;
+            break;
+        }
+
+        comm_instance_t *instance = comm_get_instance_by_index(record.index);
+
+        switch (record.type) {
+        case COMM_CAPTURE_TIME:
+            now += record.value;
+            set_tick(now);
+            break;
+
+        case COMM_CAPTURE_TICK:
+            now += record.value;
+            for (uint32_t i = 0; i < record.count; i++) {
+                set_tick(now + i);
+                comm_tick();
+            }
+            now += record.count - 1;
+            replay->stats.ticks += record.count;
+            break;
+
+        case COMM_CAPTURE_RX:
+            for (uint32_t i = 0; i < record.count; i++) {
+                instance->huart->ErrorCode = HAL_UART_ERROR_NONE;
+                instance->rx_byte = record.data[i];
+                comm_uart_rx_callback(instance->huart);
+            }
+            replay->stats.rx_bytes += record.count;
+            break;
+
+        case COMM_CAPTURE_RXERR:
+            instance->huart->ErrorCode = record.value;
+            instance->rx_byte = record.data[0];
+            comm_uart_rx_callback(instance->huart);
+            replay->stats.rx_bytes++;
+            break;
+
+        case COMM_CAPTURE_ERROR:
+            comm_uart_error_callback(instance->huart);
+            break;
+
+        case COMM_CAPTURE_TX:
+            // 发送内容由库重新产生，在comm_capture_note_tx()中核对
+            replay->stats.tx_bytes += record.count;
+            break;
+
+        case COMM_CAPTURE_TXDONE:
+            comm_uart_tx_callback(instance->huart);
+            break;
+
+        case COMM_CAPTURE_SEND:
+            comm_send_command(instance->huart, (const char *)record.data, record.text);
+            break;
+        }
+
+        replay->stats.records++;
+    }
+
+    if (!ok) {
+        COMM_ERROR_OUTPUT("回放中止: 第%lu字节处记录损坏", (unsigned long)pos);
+    }
+
+    // 记录中还没有被重新产生的发送
+    for (uint8_t i = 0; i < instance_count; i++) {
+        const uint8_t *data;
+        uint32_t len;
+        uint32_t time;
+        while (comm_capture_next_tx(i, &data, &len, &time)) {
+            comm_capture_note_mismatch(time);
+            replay->stats.tx_missing++;
+        }
+    }
+
+    replay->stats.duration_ms = now - start;
+    if (stats != NULL) {
+        *stats = replay->stats;
+    }
+    replay->log = NULL;
+    return ok;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_capture_note_tick(void)
+{
+    g_comm_capture.depth++;
+    if (!g_comm_capture.active) {
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (g_comm_capture.run_count > 0 && now == g_comm_capture.run_last + 1) {
+        // 定时器每1ms调用一次，整段空闲只占一条记录
+        g_comm_capture.run_last = now;
+        g_comm_capture.run_count++;
+    } else {
+        comm_capture_flush_ticks();
+        g_comm_capture.run_start = now;
+        g_comm_capture.run_last = now;
+        g_comm_capture.run_count = 1;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+void comm_capture_note_send(comm_instance_t *instance, const char *cmd, const char *data)
+{
+    // 库内部或回调中的发送在回放时会自然重现
+    if (!g_comm_capture.active || g_comm_capture.depth > 0 || cmd == NULL || data == NULL) {
+        return;
+    }
+
+    uint32_t cmd_len = (uint32_t)strlen(cmd) + 1;
+    uint32_t data_len = (uint32_t)strlen(data) + 1;
+    uint32_t now = HAL_GetTick();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    comm_capture_begin_event(now);
+    uint8_t *out = comm_capture_reserve(1 + cmd_len + data_len);
+    if (out != NULL) {
+        out[0] = (uint8_t)((COMM_CAPTURE_SEND << 5) | (comm_capture_index(instance) << 2));
+        memcpy(&out[1], cmd, cmd_len);
+        memcpy(&out[1 + cmd_len], data, data_len);
+    }
+
+    __set_PRIMASK(primask);
+}
+
+void comm_capture_leave(void)
+{
+    if (g_comm_capture.depth > 0) {
+        g_comm_capture.depth--;
+    }
+}
+
+void comm_capture_note_rx(comm_instance_t *instance, uint8_t byte, uint32_t uart_errors)
+{
+    g_comm_capture.depth++;
+    if (!g_comm_capture.active) {
+        return;
+    }
+
+    uint8_t index = comm_capture_index(instance);
+    uint32_t now = HAL_GetTick();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    comm_capture_begin_event(now);
+
+    if (uart_errors != HAL_UART_ERROR_NONE) {
+        comm_capture_write(COMM_CAPTURE_RXERR, index, uart_errors, true, &byte, 1);
+    } else if (g_comm_capture.rx_open && g_comm_capture.rx_instance == index &&
+               g_comm_capture.buffer[g_comm_capture.rx_len_pos] < COMM_CAPTURE_RX_RUN_MAX) {
+        // 同一实例同一时刻的连续字节追加到上一条RX记录
+        uint8_t *out = comm_capture_reserve(1);
+        if (out != NULL) {
+            out[0] = byte;
+            g_comm_capture.buffer[g_comm_capture.rx_len_pos]++;
+            g_comm_capture.rx_open = true;
+        }
+    } else {
+        uint8_t *out = comm_capture_reserve(3);
+        if (out != NULL) {
+            out[0] = (uint8_t)((COMM_CAPTURE_RX << 5) | (index << 2));
+            out[1] = 1;
+            out[2] = byte;
+            g_comm_capture.rx_len_pos = (uint32_t)(&out[1] - g_comm_capture.buffer);
+            g_comm_capture.rx_instance = index;
+            g_comm_capture.rx_open = true;
+        }
+    }
+
+    __set_PRIMASK(primask);
+}
+
+void comm_capture_note_error(comm_instance_t *instance)
+{
+    g_comm_capture.depth++;
+    if (!g_comm_capture.active) {
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    comm_capture_begin_event(now);
+    comm_capture_write(COMM_CAPTURE_ERROR, comm_capture_index(instance), 0, false, NULL, 0);
+    __set_PRIMASK(primask);
+}
+
+void comm_capture_note_tx(comm_instance_t *instance, const uint8_t *data, uint16_t len)
+{
+    if (g_comm_capture.replay.log != NULL) {
+        comm_capture_check_tx(instance, data, len);
+        return;
+    }
+
+    if (!g_comm_capture.active || data == NULL || len == 0) {
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    comm_capture_begin_event(now);
+    comm_capture_write(COMM_CAPTURE_TX, comm_capture_index(instance), len, true, data, len);
+    __set_PRIMASK(primask);
+}
+
+void comm_capture_note_tx_done(comm_instance_t *instance)
+{
+    g_comm_capture.depth++;
+    if (!g_comm_capture.active) {
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    comm_capture_begin_event(now);
+    comm_capture_write(COMM_CAPTURE_TXDONE, comm_capture_index(instance), 0, false, NULL, 0);
+    __set_PRIMASK(primask);
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  实例在管理器中的序号，未添加的实例记为0
+ */
+static uint8_t comm_capture_index(const comm_instance_t *instance)
+{
+    int8_t index = comm_manager_instance_index(instance);
+    return (index < 0) ? 0 : (uint8_t)index;
+}
+
+/**
+ * @brief  在缓冲区末尾预留空间
+ * @retval 预留区域指针，空间不足时置溢出标志并返回NULL（之后不再记录）
+ * @note   调用方已关中断
+ */
+static uint8_t *comm_capture_reserve(uint32_t size)
+{
+    if (g_comm_capture.overflow || size > g_comm_capture.size - g_comm_capture.length) {
+        // 写满后丢弃后续所有记录，保证已记录部分按时序完整
+        g_comm_capture.overflow = true;
+        g_comm_capture.rx_open = false;
+        return NULL;
+    }
+
+    uint8_t *out = &g_comm_capture.buffer[g_comm_capture.length];
+    g_comm_capture.length += size;
+    g_comm_capture.rx_open = false;
+    return out;
+}
+
+/**
+ * @brief  写入变长整数（每字节7位，最高位表示后面还有字节）
+ * @retval 写入的字节数（1~5）
+ */
+static uint8_t comm_capture_put_varint(uint8_t *out, uint32_t value)
+{
+    uint8_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+/**
+ * @brief  读取变长整数
+ * @retval true: 成功, false: 超出记录末尾或超过5字节
+ */
+static bool comm_capture_get_varint(const uint8_t *log, uint32_t length, uint32_t *pos, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (*pos >= length) {
+            return false;
+        }
+        uint8_t byte = log[(*pos)++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief  解析一条记录
+ * @retval true: 成功, false: 记录不完整
+ */
+static bool comm_capture_parse(const uint8_t *log, uint32_t length, uint32_t *pos, comm_capture_record_t *record)
+{
+    if (*pos >= length) {
+        return false;
+    }
+
+    uint8_t header = log[(*pos)++];
+    memset(record, 0, sizeof(*record));
+    record->type = (comm_capture_type_t)(header >> 5);
+    record->index = (header >> 2) & 0x07;
+
+    switch (record->type) {
+    case COMM_CAPTURE_TIME:
+        return comm_capture_get_varint(log, length, pos, &record->value);
+
+    case COMM_CAPTURE_TICK:
+        return comm_capture_get_varint(log, length, pos, &record->value) &&
+               comm_capture_get_varint(log, length, pos, &record->count) && record->count > 0;
+
+    case COMM_CAPTURE_RX:
+        if (*pos >= length || log[*pos] > length - *pos - 1) {
+            return false;
+        }
+        record->count = log[(*pos)++];
+        break;
+
+    case COMM_CAPTURE_RXERR:
+        if (!comm_capture_get_varint(log, length, pos, &record->value) || *pos >= length) {
+            return false;
+        }
+        record->count = 1;
+        break;
+
+    case COMM_CAPTURE_TX:
+        if (!comm_capture_get_varint(log, length, pos, &record->count) || record->count > length - *pos) {
+            return false;
+        }
+        break;
+
+    case COMM_CAPTURE_SEND: {
+        // 命令\0数据\0
+        const uint8_t *cmd_end = memchr(&log[*pos], '\0', length - *pos);
+        if (cmd_end == NULL) {
+            return false;
+        }
+        const uint8_t *data_end = memchr(cmd_end + 1, '\0', (size_t)(&log[length] - (cmd_end + 1)));
+        if (data_end == NULL) {
+            return false;
+        }
+        record->data = &log[*pos];
+        record->text = (const char *)(cmd_end + 1);
+        *pos = (uint32_t)(data_end - log) + 1;
+        return true;
+    }
+
+    default:
+        return true;
+    }
+
+    record->data = &log[*pos];
+    *pos += record->count;
+    return true;
+}
+
+/**
+ * @brief  找到实例的下一条TX记录并推进核对游标
+ * @retval true: 找到, false: 记录中已没有该实例的发送
+ */
+static bool comm_capture_next_tx(uint8_t index, const uint8_t **data, uint32_t *len, uint32_t *time)
+{
+    comm_capture_replay_t *replay = &g_comm_capture.replay;
+    comm_capture_cursor_t *cursor = &replay->cursor[index];
+    comm_capture_record_t record;
+
+    while (comm_capture_parse(replay->log, replay->length, &cursor->pos, &record)) {
+        if (record.type == COMM_CAPTURE_TIME) {
+            cursor->time += record.value;
+        } else if (record.type == COMM_CAPTURE_TICK) {
+            cursor->time += record.value + record.count - 1;
+        } else if (record.type == COMM_CAPTURE_TX && record.index == index) {
+            *data = record.data;
+            *len = record.count;
+            *time = cursor->time;
+            return true;
+        }
+    }
+
+    cursor->pos = replay->length;
+    return false;
+}
+
+/**
+ * @brief  回放中核对库重新产生的发送：内容和时刻都要与记录一致
+ */
+static void comm_capture_check_tx(comm_instance_t *instance, const uint8_t *data, uint16_t len)
+{
+    comm_capture_replay_t *replay = &g_comm_capture.replay;
+    uint8_t index = comm_capture_index(instance);
+    uint32_t now = HAL_GetTick();
+
+    const uint8_t *expected;
+    uint32_t expected_len;
+    uint32_t expected_time;
+    if (index >= replay->instance_count || !comm_capture_next_tx(index, &expected, &expected_len, &expected_time)) {
+        comm_capture_note_mismatch(now);
+        replay->stats.tx_extra++;
+        return;
+    }
+
+    if (expected_len == len && memcmp(expected, data, len) == 0 && expected_time == now) {
+        replay->stats.tx_matched++;
+    } else {
+        comm_capture_note_mismatch(now);
+        replay->stats.tx_mismatched++;
+    }
+}
+
+/**
+ * @brief  记录第一次不一致的时刻
+ */
+static void comm_capture_note_mismatch(uint32_t time)
+{
+    comm_capture_replay_t *replay = &g_comm_capture.replay;
+    if (!replay->diverged) {
+        replay->diverged = true;
+        replay->stats.first_mismatch_ms = time - replay->start;
+    }
+}
+
+/**
+ * @brief  写出尚未写出的comm_tick()调用
+ * @note   调用方已关中断
+ */
+static void comm_capture_flush_ticks(void)
+{
+    if (g_comm_capture.run_count == 0) {
+        return;
+    }
+
+    uint8_t encoded[11];
+    uint8_t n = comm_capture_put_varint(encoded, g_comm_capture.run_start - g_comm_capture.last_time);
+    n += comm_capture_put_varint(&encoded[n], g_comm_capture.run_count);
+
+    uint8_t *out = comm_capture_reserve(1u + n);
+    if (out != NULL) {
+        out[0] = (uint8_t)(COMM_CAPTURE_TICK << 5);
+        memcpy(&out[1], encoded, n);
+    }
+
+    g_comm_capture.last_time = g_comm_capture.run_last;
+    g_comm_capture.run_count = 0;
+}
+
+/**
+ * @brief  事件开始：先写出之前的comm_tick()调用，时刻变化时写TIME记录
+ * @note   调用方已关中断
+ */
+static void comm_capture_begin_event(uint32_t now)
+{
+    comm_capture_flush_ticks();
+    if (now != g_comm_capture.last_time) {
+        comm_capture_write(COMM_CAPTURE_TIME, 0, now - g_comm_capture.last_time, true, NULL, 0);
+        g_comm_capture.last_time = now;
+    }
+}
+
+/**
+ * @brief  写一条记录：记录头 [变长整数] [数据]
+ * @note   调用方已关中断
+ */
+static void comm_capture_write(comm_capture_type_t type, uint8_t index, uint32_t value, bool has_value,
+                               const uint8_t *data, uint32_t data_len)
+{
+    uint8_t encoded[5];
+    uint8_t n = has_value ? comm_capture_put_varint(encoded, value) : 0;
+
+    uint8_t *out = comm_capture_reserve(1u + n + data_len);
+    if (out == NULL) {
+        return;
+    }
+
+    out[0] = (uint8_t)((type << 5) | ((index & 0x07) << 2));
+    memcpy(&out[1], encoded, n);
+    if (data_len > 0) {
+        memcpy(&out[1 + n], data, data_len);
+    }
+}
+
+#endif /* COMM_ENABLE_CAPTURE */
@@ -0,0 +1,199 @@
+/**
+ ******************************************************************************
+ * @file           : comm_capture.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信抓包与回放
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 抓包回放 - 把现场的收发过程原样记录下来，在主机上按相同的时序重新执行
+ *
+ * 很多现场问题取决于字节到达的准确时刻（帧超时、ACK超时、重试与对端报文交错），
+ * 在台架上很难复现。启用后，所有实例的以下事件按发生顺序写入用户提供的缓冲区：
+ *   - 接收中断收到的每个字节（连同当时的UART错误码）
+ *   - 应用调用comm_send_command()发出的命令（库内部和回调中的发送不重复记录）
+ *   - 发送的字节流、发送完成中断、UART错误回调
+ *   - comm_tick()的调用时刻
+ *   - HAL_GetTick()的变化
+ *
+ * 主机上用comm_capture_replay()回放：以同样的顺序把字节交给comm_uart_rx_callback()、
+ * 在同样的时刻调用comm_tick()，HAL_GetTick()由回放设置为抓包时的值，
+ * 因此超时、重试等与时间有关的行为完全一致。
+ * 记录中的发送字节流不回放，而是与库重新产生的发送逐条核对内容和时刻，
+ * 据此判断代码修改是否改变了行为（见tools/comm_replay.c）。
+ *
+ * 记录格式（紧凑，小端）:
+ *   文件头 12字节: "CCAP" 版本 实例数 功能掩码(2) 起始时刻(4)
+ *   记录头 1字节: 高3位类型，中间3位实例序号
+ *   - TIME   变长整数: 时刻增量
+ *   - TICK   变长整数: 起始时刻增量, 连续调用次数（每次间隔1ms的调用合并为一条）
+ *   - RX     1字节长度 + 字节（同一实例同一时刻连续收到的字节合并为一条）
+ *   - RXERR  变长整数错误码 + 1字节
+ *   - ERROR  无
+ *   - TX     变长整数长度 + 字节
+ *   - TXDONE 无
+ *   - SEND   命令\0数据\0
+ *
+ * 注意：
+ *   - 缓冲区写满后停止记录并置溢出标志，已记录部分仍可回放
+ *   - 在comm_add_uart()之后、开始通信之前启动抓包，回放才能从相同的初始状态开始
+ *   - 回放端的实例顺序、参数、回调和功能开关必须与抓包端一致，功能开关不一致时拒绝回放
+ *   - 事件内部的耗时（如阻塞发送）不记录，回放时事件内部时间不前进
+ *   - 接收中断打断comm_tick()时，回放在该次comm_tick()之后注入这些字节
+ *   - 应用侧只记录comm_send_command()，发布、批量等其它发送API需由回放程序自行重现
+ *
+ * 使用示例:
+ *   static uint8_t capture_buf[8192];
+ *
+ *   comm_add_uart(&huart2);
+ *   comm_capture_start(capture_buf, sizeof(capture_buf));
+ *   ...
+ *   uint32_t len = comm_capture_stop();   // 用调试器导出capture_buf前len字节
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_CAPTURE_H
+#define COMM_CAPTURE_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_CAPTURE
+
+/** @brief 文件头长度 */
+#define COMM_CAPTURE_HEADER_SIZE    12
+
+/** @brief 记录格式版本 */
+#define COMM_CAPTURE_VERSION        1
+
+/** @brief 回放时设置HAL_GetTick()返回值的函数 */
+typedef void (*comm_capture_tick_setter_t)(uint32_t now);
+
+/** @brief 回放统计 */
+typedef struct {
+    uint32_t records;                       /**< 处理的记录数 */
+    uint32_t rx_bytes;                      /**< 注入的接收字节数 */
+    uint32_t tx_bytes;                      /**< 抓包中记录的发送字节数 */
+    uint32_t ticks;                         /**< comm_tick()调用次数 */
+    uint32_t duration_ms;                   /**< 抓包覆盖的时长（毫秒） */
+
+    uint32_t tx_matched;                    /**< 与记录一致的发送次数（内容和时刻） */
+    uint32_t tx_mismatched;                 /**< 内容或时刻与记录不一致的发送次数 */
+    uint32_t tx_missing;                    /**< 记录中有、回放没有产生的发送次数 */
+    uint32_t tx_extra;                      /**< 回放多产生的发送次数 */
+    uint32_t first_mismatch_ms;             /**< 第一次不一致距起始的时间（毫秒），全部一致时为0 */
+} comm_capture_stats_t;
+
+/* =============================================================================
+ * 抓包API
+ * =============================================================================
+ */
+
+/**
+ * @brief  开始抓包
+ * @param  buffer: 记录缓冲区
+ * @param  size: 缓冲区大小
+ * @retval true: 已开始, false: 参数错误或已在抓包
+ * @note   写入文件头，记录当前实例数和HAL_GetTick()
+ */
+bool comm_capture_start(uint8_t *buffer, uint32_t size);
+
+/**
+ * @brief  停止抓包
+ * @param  None
+ * @retval 已记录的字节数（含文件头），未在抓包时返回0
+ */
+uint32_t comm_capture_stop(void);
+
+/**
+ * @brief  查询缓冲区是否写满过
+ * @param  None
+ * @retval true: 写满后丢弃了记录
+ */
+bool comm_capture_is_overflow(void);
+
+/**
+ * @brief  回放抓包记录
+ * @param  log: 记录
+ * @param  length: 记录长度
+ * @param  set_tick: 设置HAL_GetTick()返回值的函数
+ * @param  stats: 回放统计输出，可为NULL
+ * @retval true: 回放完成, false: 格式错误、版本或功能开关不一致、实例不足、正在抓包
+ * @note   仅用于主机测试环境；回放前按抓包端相同的顺序和参数添加实例并注册回调。
+ *         返回true只表示记录完整回放，行为是否一致看stats中的tx_mismatched/tx_missing/tx_extra
+ */
+bool comm_capture_replay(const uint8_t *log, uint32_t length, comm_capture_tick_setter_t set_tick,
+                         comm_capture_stats_t *stats);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  记录一次comm_tick()调用
+ * @param  None
+ * @retval None
+ * @note   由comm_tick()开头调用
+ */
+void comm_capture_note_tick(void);
+
+/**
+ * @brief  记录应用发出的命令
+ * @param  instance: 实例指针
+ * @param  cmd: 命令字符串
+ * @param  data: 数据字符串
+ * @retval None
+ * @note   由comm_send_command()调用；在comm_tick()或中断回调内部调用时不记录
+ */
+void comm_capture_note_send(comm_instance_t *instance, const char *cmd, const char *data);
+
+/**
+ * @brief  离开comm_tick()或中断回调
+ * @param  None
+ * @retval None
+ * @note   与comm_capture_note_tick()/note_rx()/note_error()/note_tx_done()成对调用，
+ *         区分应用发出的命令和库内部（包括回调中）发出的命令
+ */
+void comm_capture_leave(void);
+
+/**
+ * @brief  记录接收中断收到的字节
+ * @param  instance: 实例指针
+ * @param  byte: 收到的字节
+ * @param  uart_errors: 本次中断的UART错误码
+ * @retval None
+ * @note   由comm_uart_rx_callback()调用
+ */
+void comm_capture_note_rx(comm_instance_t *instance, uint8_t byte, uint32_t uart_errors);
+
+/**
+ * @brief  记录UART错误回调
+ * @param  instance: 实例指针
+ * @retval None
+ * @note   由comm_uart_error_callback()调用
+ */
+void comm_capture_note_error(comm_instance_t *instance);
+
+/**
+ * @brief  记录发送的字节流
+ * @param  instance: 实例指针
+ * @param  data: 数据
+ * @param  len: 长度
+ * @retval None
+ * @note   由comm_uart_transmit()和comm_uart_transmit_it()调用
+ */
+void comm_capture_note_tx(comm_instance_t *instance, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief  记录发送完成中断
+ * @param  instance: 实例指针
+ * @retval None
+ * @note   由comm_uart_tx_callback()调用
+ */
+void comm_capture_note_tx_done(comm_instance_t *instance);
+
+#endif /* COMM_ENABLE_CAPTURE */
+
+#endif /* COMM_CAPTURE_H */
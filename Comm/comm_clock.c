@@ -0,0 +1,435 @@
+/**
+ * @file    comm_clock.c
+ * @brief   通信库时钟同步 - 四时间戳交换、延迟筛选、偏差和漂移拟合、时间戳换算
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_clock.h"
+
+#if COMM_ENABLE_CLOCK
+
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#include <string.h>
+
+/* 一次交换得到的样本 */
+typedef struct {
+    uint32_t local_us;                      /**< 交换中点的本地时间 */
+    uint32_t offset_us;                     /**< 偏差（主时钟 - 本地，32位回绕） */
+    uint32_t delay_us;                      /**< 往返延迟 */
+} comm_clock_sample_t;
+
+typedef struct {
+    bool is_used;                           /**< 是否已使用 */
+    uint8_t index;                          /**< 管理器实例表中的序号 */
+    uint32_t interval_ms;                   /**< 同步间隔 */
+    uint32_t last_request;                  /**< 上次发起请求的时刻（毫秒） */
+
+    uint8_t exchange_id;                    /**< 当前交换的编号 */
+    bool waiting;                           /**< 已发出请求，等待应答 */
+    bool replied;                           /**< 已收到应答，等待跟随 */
+    uint32_t t1;                            /**< 请求发送完成的本地时间 */
+    uint32_t t2;                            /**< 对端收到请求的时间 */
+    uint32_t t4;                            /**< 收到应答的本地时间 */
+
+    comm_clock_sample_t samples[COMM_CLOCK_WINDOW]; /**< 样本环形窗口 */
+    uint8_t sample_head;                    /**< 下一个样本的写入位置 */
+    uint8_t sample_count;                   /**< 样本数 */
+    uint8_t reject_streak;                  /**< 连续丢弃的样本数 */
+
+    uint32_t ref_local_us;                  /**< 拟合的参考本地时间 */
+    uint32_t ref_offset_us;                 /**< 参考时间处的偏差 */
+    int32_t drift_ppb;                      /**< 拟合的漂移 */
+
+    comm_clock_status_t status;             /**< 状态 */
+} comm_clock_peer_t;
+
+static comm_clock_peer_t g_comm_clock_peers[COMM_CLOCK_MAX_PEERS] = {0};
+
+static comm_clock_source_t g_comm_clock_source = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+static comm_clock_peer_t* comm_clock_find(comm_instance_t *instance);
+static comm_clock_peer_t* comm_clock_find_by_huart(UART_HandleTypeDef *huart);
+static bool comm_clock_parse(const char *data, uint16_t length, char *type, uint8_t *id, uint32_t *value);
+static void comm_clock_send_request(comm_clock_peer_t *peer, comm_instance_t *instance);
+static void comm_clock_answer(comm_instance_t *instance, uint8_t id, uint32_t t2);
+static void comm_clock_add_sample(comm_clock_peer_t *peer, uint32_t t3);
+static void comm_clock_fit(comm_clock_peer_t *peer);
+static uint32_t comm_clock_offset_at(const comm_clock_peer_t *peer, uint32_t local_us);
+
+/* =============================================================================
+ * 时钟同步API实现
+ * =============================================================================
+ */
+
+void comm_clock_set_source(comm_clock_source_t source)
+{
+    g_comm_clock_source = source;
+}
+
+uint32_t comm_clock_local_us(UART_HandleTypeDef *huart)
+{
+    if (g_comm_clock_source != NULL) {
+        return g_comm_clock_source(huart);
+    }
+    return HAL_GetTick() * 1000u;
+}
+
+bool comm_clock_sync_start(UART_HandleTypeDef *huart, uint32_t interval_ms)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    int8_t index = comm_manager_instance_index(instance);
+    if (index < 0) {
+        return false;
+    }
+
+    if (interval_ms == 0) {
+        interval_ms = COMM_CLOCK_INTERVAL_MS;
+    }
+
+    comm_clock_peer_t *peer = comm_clock_find(instance);
+    if (peer != NULL) {
+        peer->interval_ms = interval_ms;
+        return true;
+    }
+
+    for (uint8_t i = 0; i < COMM_CLOCK_MAX_PEERS; i++) {
+        if (!g_comm_clock_peers[i].is_used) {
+            peer = &g_comm_clock_peers[i];
+            break;
+        }
+    }
+    if (peer == NULL) {
+        return false;
+    }
+
+    memset(peer, 0, sizeof(comm_clock_peer_t));
+    peer->index = (uint8_t)index;
+    peer->interval_ms = interval_ms;
+    peer->exchange_id = (uint8_t)HAL_GetTick();
+    // 立即发起第一次交换
+    peer->last_request = HAL_GetTick() - interval_ms;
+    peer->is_used = true;
+    return true;
+}
+
+bool comm_clock_sync_stop(UART_HandleTypeDef *huart)
+{
+    comm_clock_peer_t *peer = comm_clock_find_by_huart(huart);
+    if (peer == NULL) {
+        return false;
+    }
+
+    peer->is_used = false;
+    return true;
+}
+
+bool comm_clock_is_synced(UART_HandleTypeDef *huart)
+{
+    comm_clock_peer_t *peer = comm_clock_find_by_huart(huart);
+    return peer != NULL && peer->status.synced;
+}
+
+bool comm_clock_to_master(UART_HandleTypeDef *huart, uint32_t local_us, uint32_t *master_us)
+{
+    comm_clock_peer_t *peer = comm_clock_find_by_huart(huart);
+    if (peer == NULL || !peer->status.synced || master_us == NULL) {
+        return false;
+    }
+
+    *master_us = local_us + comm_clock_offset_at(peer, local_us);
+    return true;
+}
+
+bool comm_clock_from_master(UART_HandleTypeDef *huart, uint32_t master_us, uint32_t *local_us)
+{
+    comm_clock_peer_t *peer = comm_clock_find_by_huart(huart);
+    if (peer == NULL || !peer->status.synced || local_us == NULL) {
+        return false;
+    }
+
+    // 漂移项很小，先按参考偏差估计本地时间，再用该时刻的偏差修正一次
+    uint32_t local = master_us - peer->ref_offset_us;
+    *local_us = master_us - comm_clock_offset_at(peer, local);
+    return true;
+}
+
+bool comm_clock_get_status(UART_HandleTypeDef *huart, comm_clock_status_t *status)
+{
+    comm_clock_peer_t *peer = comm_clock_find_by_huart(huart);
+    if (peer == NULL || status == NULL) {
+        return false;
+    }
+
+    *status = peer->status;
+    status->offset_us = (int32_t)comm_clock_offset_at(peer, comm_clock_local_us(huart));
+    return true;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_clock_init(void)
+{
+    memset(g_comm_clock_peers, 0, sizeof(g_comm_clock_peers));
+}
+
+void comm_clock_process(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint8_t i = 0; i < COMM_CLOCK_MAX_PEERS; i++) {
+        comm_clock_peer_t *peer = &g_comm_clock_peers[i];
+        if (!peer->is_used || (now - peer->last_request) < peer->interval_ms) {
+            continue;
+        }
+
+        // 上一次交换没有完成（请求、应答或跟随丢失）时直接开始新的交换
+        peer->last_request = now;
+        comm_clock_send_request(peer, comm_get_instance_by_index(peer->index));
+    }
+}
+
+uint32_t comm_clock_read(comm_instance_t *instance)
+{
+    return comm_clock_local_us(instance->huart);
+}
+
+bool comm_clock_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    if (!comm_frame_cmd_is(instance, frame, COMM_CMD_CLOCK)) {
+        return false;
+    }
+
+    char type;
+    uint8_t id;
+    uint32_t value;
+    if (!comm_clock_parse(COMM_FRAME_DATA(instance, frame), frame->data_len, &type, &id, &value)) {
+        COMM_DEBUG_INSTANCE(instance, "时钟同步帧格式错误");
+        return true;
+    }
+
+    if (type == 'Q') {
+        comm_clock_answer(instance, id, frame->rx_time_us);
+        return true;
+    }
+
+    comm_clock_peer_t *peer = comm_clock_find(instance);
+    if (peer == NULL || id != peer->exchange_id) {
+        return true;        // 没有在同步，或是过期交换的应答
+    }
+
+    if (type == 'R' && peer->waiting) {
+        peer->t2 = value;
+        peer->t4 = frame->rx_time_us;
+        peer->waiting = false;
+        peer->replied = true;
+    } else if (type == 'F' && peer->replied) {
+        peer->replied = false;
+        comm_clock_add_sample(peer, value);
+    }
+    return true;
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+static comm_clock_peer_t* comm_clock_find(comm_instance_t *instance)
+{
+    int8_t index = comm_manager_instance_index(instance);
+    if (index < 0) {
+        return NULL;
+    }
+
+    for (uint8_t i = 0; i < COMM_CLOCK_MAX_PEERS; i++) {
+        if (g_comm_clock_peers[i].is_used && g_comm_clock_peers[i].index == (uint8_t)index) {
+            return &g_comm_clock_peers[i];
+        }
+    }
+    return NULL;
+}
+
+static comm_clock_peer_t* comm_clock_find_by_huart(UART_HandleTypeDef *huart)
+{
+    return comm_clock_find(comm_find_instance(huart));
+}
+
+/**
+ * @brief  解析"T,ID[,VALUE]"
+ */
+static bool comm_clock_parse(const char *data, uint16_t length, char *type, uint8_t *id, uint32_t *value)
+{
+    if (length < 4 || data[1] != ',') {
+        return false;
+    }
+
+    *type = data[0];
+    uint32_t parsed_id;
+    if (!comm_hex_decode(&data[2], 2, &parsed_id)) {
+        return false;
+    }
+    *id = (uint8_t)parsed_id;
+
+    if (*type == 'Q') {
+        *value = 0;
+        return length == 4;
+    }
+    if (*type != 'R' && *type != 'F') {
+        return false;
+    }
+    return length > 5 && data[4] == ',' && comm_hex_decode(&data[5], (uint16_t)(length - 5), value);
+}
+
+static void comm_clock_send_request(comm_clock_peer_t *peer, comm_instance_t *instance)
+{
+    char data[8];
+    peer->exchange_id++;
+    data[0] = 'Q';
+    data[1] = ',';
+    comm_hex_encode(&data[2], peer->exchange_id, 2);
+    data[4] = '\0';
+
+    peer->waiting = false;
+    peer->replied = false;
+    if (!comm_send_datagram(instance, COMM_CMD_CLOCK, data)) {
+        return;
+    }
+
+    // 阻塞发送返回时最后一个停止位已移出，与对端收到帧尾的时刻对应
+    peer->t1 = comm_clock_read(instance);
+    peer->waiting = true;
+}
+
+/**
+ * @brief  作为主时钟应答请求，应答发送完成后再跟随发送T3
+ */
+static void comm_clock_answer(comm_instance_t *instance, uint8_t id, uint32_t t2)
+{
+    char data[16];
+    data[0] = 'R';
+    data[1] = ',';
+    comm_hex_encode(&data[2], id, 2);
+    data[4] = ',';
+    comm_hex_encode(&data[5], t2, 8);
+    data[13] = '\0';
+    if (!comm_send_datagram(instance, COMM_CMD_CLOCK, data)) {
+        return;
+    }
+
+    uint32_t t3 = comm_clock_read(instance);
+    data[0] = 'F';
+    comm_hex_encode(&data[5], t3, 8);
+    comm_send_datagram(instance, COMM_CMD_CLOCK, data);
+}
+
+static void comm_clock_add_sample(comm_clock_peer_t *peer, uint32_t t3)
+{
+    // 差值都在一次往返之内，按有符号数处理；时钟抖动可能使延迟略小于0
+    int32_t delay = (int32_t)(peer->t4 - peer->t1) - (int32_t)(t3 - peer->t2);
+    if (delay < 0) {
+        delay = 0;
+    }
+
+    comm_clock_sample_t sample;
+    sample.delay_us = (uint32_t)delay;
+    sample.offset_us = (peer->t2 - peer->t1) - (uint32_t)(delay / 2);
+    sample.local_us = peer->t1 + (peer->t4 - peer->t1) / 2;
+
+    peer->status.exchanges++;
+    peer->status.delay_us = sample.delay_us;
+
+    // 延迟明显大于窗口内最小延迟的样本被排队或中断耽搁过，不对称，丢弃；
+    // 连续丢弃半个窗口说明线路延迟变了，接受新的延迟
+    if (peer->sample_count > 0 &&
+        sample.delay_us > 2 * peer->status.min_delay_us + COMM_CLOCK_DELAY_MARGIN_US &&
+        peer->reject_streak < COMM_CLOCK_WINDOW / 2) {
+        peer->reject_streak++;
+        peer->status.rejected++;
+        return;
+    }
+    peer->reject_streak = 0;
+
+    // 与拟合结果相差太大说明对端时钟跳变（重启或被设置），丢弃旧样本
+    if (peer->sample_count > 0) {
+        int32_t residual = (int32_t)(sample.offset_us - comm_clock_offset_at(peer, sample.local_us));
+        if (residual > COMM_CLOCK_STEP_US || residual < -COMM_CLOCK_STEP_US) {
+            peer->sample_count = 0;
+            peer->sample_head = 0;
+            peer->status.steps++;
+            COMM_DEBUG_INSTANCE(comm_get_instance_by_index(peer->index),
+                                "对端时钟跳变 %ld us，重新同步", (long)residual);
+        }
+    }
+
+    peer->samples[peer->sample_head] = sample;
+    peer->sample_head = (uint8_t)((peer->sample_head + 1) % COMM_CLOCK_WINDOW);
+    if (peer->sample_count < COMM_CLOCK_WINDOW) {
+        peer->sample_count++;
+    }
+
+    comm_clock_fit(peer);
+}
+
+/**
+ * @brief  窗口内样本的偏差对本地时间做最小二乘拟合
+ * @note   以最早的样本为原点，差值在窗口跨度之内，64位整数运算不会溢出
+ */
+static void comm_clock_fit(comm_clock_peer_t *peer)
+{
+    uint8_t n = peer->sample_count;
+    uint8_t first = (uint8_t)((peer->sample_head + COMM_CLOCK_WINDOW - n) % COMM_CLOCK_WINDOW);
+    const comm_clock_sample_t *origin = &peer->samples[first];
+
+    int64_t sum_x = 0;
+    int64_t sum_y = 0;
+    uint32_t min_delay = UINT32_MAX;
+    for (uint8_t i = 0; i < n; i++) {
+        const comm_clock_sample_t *s = &peer->samples[(first + i) % COMM_CLOCK_WINDOW];
+        sum_x += (int32_t)(s->local_us - origin->local_us);
+        sum_y += (int32_t)(s->offset_us - origin->offset_us);
+        if (s->delay_us < min_delay) {
+            min_delay = s->delay_us;
+        }
+    }
+    int64_t mean_x = sum_x / n;
+    int64_t mean_y = sum_y / n;
+
+    int64_t sxx = 0;
+    int64_t sxy = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        const comm_clock_sample_t *s = &peer->samples[(first + i) % COMM_CLOCK_WINDOW];
+        int64_t dx = (int32_t)(s->local_us - origin->local_us) - mean_x;
+        int64_t dy = (int32_t)(s->offset_us - origin->offset_us) - mean_y;
+        sxx += dx * dx;
+        sxy += dx * dy;
+    }
+
+    // 漂移 = sxy / sxx，换算为ppb；sxx按1e6缩小避免乘1e9溢出，跨度太短时不估计漂移
+    int64_t scaled_sxx = sxx / 1000000;
+    peer->drift_ppb = (scaled_sxx > 0) ? (int32_t)((sxy * 1000) / scaled_sxx) : 0;
+    peer->ref_local_us = origin->local_us + (uint32_t)mean_x;
+    peer->ref_offset_us = origin->offset_us + (uint32_t)mean_y;
+
+    peer->status.samples = n;
+    peer->status.min_delay_us = min_delay;
+    peer->status.drift_ppb = peer->drift_ppb;
+    peer->status.synced = (n >= COMM_CLOCK_MIN_SAMPLES);
+}
+
+/**
+ * @brief  本地时刻local_us处的偏差（主时钟 - 本地）
+ */
+static uint32_t comm_clock_offset_at(const comm_clock_peer_t *peer, uint32_t local_us)
+{
+    int64_t elapsed = (int32_t)(local_us - peer->ref_local_us);
+    return peer->ref_offset_us + (uint32_t)(int32_t)((elapsed * peer->drift_ppb) / 1000000000);
+}
+
+#endif /* COMM_ENABLE_CLOCK */
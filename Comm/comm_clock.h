@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ * @file           : comm_clock.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信时钟同步
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 时钟同步 - 多块板的采样时间戳换算到同一时间基准（主时钟）
+ *
+ * 向对端同步的一方按间隔发起一次四时间戳交换（NTP/PTP两步法），对端即为主时钟:
+ *   本端  T1 ── {CLK:Q,ID} ──────────▶ T2  对端
+ *   本端  T4 ◀── {CLK:R,ID,T2} ─────── T3  对端
+ *            ◀── {CLK:F,ID,T3} ───────     （T3在应答发送完成后才确定，单独跟随发送）
+ *   偏差 = ((T2 - T1) + (T3 - T4)) / 2，往返延迟 = (T4 - T1) - (T3 - T2)
+ *
+ * 时间戳取在帧尾: 发送端在阻塞发送返回（最后一个停止位移出）时读取，接收端在接收中断
+ * 收到'}'时读取，两个方向的线路时间和中断延迟相互抵消，请求和应答长度不同也不影响。
+ *
+ * 最近COMM_CLOCK_WINDOW个样本做最小二乘拟合，同时得到偏差和漂移(ppb)；往返延迟明显
+ * 大于窗口内最小延迟的样本（被其它帧或中断耽搁）丢弃，对端时钟跳变时重新开始拟合。
+ *
+ * 时间源与分辨率:
+ *   换算精度受时间源分辨率限制。未设置时使用HAL_GetTick() * 1000，单位是微秒但分辨率只有
+ *   1毫秒，换算误差可达±1毫秒。需要亚毫秒精度时必须用comm_clock_set_source()提供真正的
+ *   微秒计数，例如DWT->CYCCNT换算或1MHz的自由运行定时器，误差在几十微秒之内
+ *   （tools/comm_clock_test.c）。计数按32位回绕，两端各自独立。
+ *
+ * 注意：
+ *   - 所有实例都会应答同步请求，只有调用comm_clock_sync_start()的一方跟随对端
+ *   - 时间源在接收中断中调用，必须可重入且足够快
+ *   - 主时钟与本地时间戳的差按32位回绕处理，换算的时间戳距最近的样本不要超过35分钟
+ *
+ * 使用示例:
+ *   static uint32_t timer_us(UART_HandleTypeDef *huart) { return TIM2->CNT; }
+ *   comm_clock_set_source(timer_us);
+ *   comm_clock_sync_start(&huart2, 1000);
+ *   ...
+ *   uint32_t master_us;
+ *   if (comm_clock_to_master(&huart2, sample_time_us, &master_us)) {
+ *       // master_us与主板上的时间戳可直接比较
+ *   }
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_CLOCK_H
+#define COMM_CLOCK_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_CLOCK
+
+/**
+ * @brief 微秒时间源
+ * @param huart: 打时间戳的实例，同一块板上通常忽略；同一进程模拟多块板时可据此区分
+ * @retval 自由运行的微秒计数（32位回绕）
+ */
+typedef uint32_t (*comm_clock_source_t)(UART_HandleTypeDef *huart);
+
+/** @brief 时钟同步状态 */
+typedef struct {
+    bool synced;                            /**< 样本数已达到COMM_CLOCK_MIN_SAMPLES */
+    uint8_t samples;                        /**< 窗口中的样本数 */
+    int32_t offset_us;                      /**< 当前的偏差（主时钟 - 本地时钟，按32位回绕解释） */
+    int32_t drift_ppb;                      /**< 漂移，主时钟每秒比本地多走的纳秒数 */
+    uint32_t delay_us;                      /**< 最近一个样本的往返延迟 */
+    uint32_t min_delay_us;                  /**< 窗口内的最小往返延迟 */
+    uint32_t exchanges;                     /**< 完成的交换次数 */
+    uint32_t rejected;                      /**< 延迟过大而丢弃的样本数 */
+    uint32_t steps;                         /**< 检测到对端时钟跳变的次数 */
+} comm_clock_status_t;
+
+/* =============================================================================
+ * 时钟同步API
+ * =============================================================================
+ */
+
+/**
+ * @brief  设置微秒时间源（所有实例共用）
+ * @param  source: 时间源，NULL恢复为HAL_GetTick() * 1000（1毫秒分辨率）
+ * @retval None
+ */
+void comm_clock_set_source(comm_clock_source_t source);
+
+/**
+ * @brief  读取本地时间戳
+ * @param  huart: UART句柄指针
+ * @retval 时间源的当前值（微秒）
+ */
+uint32_t comm_clock_local_us(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  开始向对端同步时钟，对端为主时钟
+ * @param  huart: UART句柄指针
+ * @param  interval_ms: 同步间隔，0使用COMM_CLOCK_INTERVAL_MS
+ * @retval true: 开始成功, false: 实例未添加或同步表已满
+ * @note   已在同步时只更新间隔
+ */
+bool comm_clock_sync_start(UART_HandleTypeDef *huart, uint32_t interval_ms);
+
+/**
+ * @brief  停止同步
+ * @param  huart: UART句柄指针
+ * @retval true: 已停止, false: 未在同步
+ */
+bool comm_clock_sync_stop(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  是否已同步
+ * @param  huart: UART句柄指针
+ * @retval true: 可以换算时间戳, false: 未同步或样本不足
+ */
+bool comm_clock_is_synced(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  把本地时间戳换算到主时钟
+ * @param  huart: UART句柄指针
+ * @param  local_us: 本地时间戳（comm_clock_local_us()或同一时间源的读数）
+ * @param  master_us: 输出主时钟时间戳
+ * @retval true: 换算成功, false: 未同步
+ */
+bool comm_clock_to_master(UART_HandleTypeDef *huart, uint32_t local_us, uint32_t *master_us);
+
+/**
+ * @brief  把主时钟时间戳换算回本地时间
+ * @param  huart: UART句柄指针
+ * @param  master_us: 主时钟时间戳
+ * @param  local_us: 输出本地时间戳
+ * @retval true: 换算成功, false: 未同步
+ * @note   用于在主时钟约定的时刻动作（例如各板同时采样）
+ */
+bool comm_clock_from_master(UART_HandleTypeDef *huart, uint32_t master_us, uint32_t *local_us);
+
+/**
+ * @brief  获取同步状态
+ * @param  huart: UART句柄指针
+ * @param  status: 状态输出
+ * @retval true: 获取成功, false: 未在同步
+ */
+bool comm_clock_get_status(UART_HandleTypeDef *huart, comm_clock_status_t *status);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  初始化同步表
+ * @param  None
+ * @retval None
+ * @note   由comm_init()调用
+ */
+void comm_clock_init(void);
+
+/**
+ * @brief  按间隔发起同步请求
+ * @param  None
+ * @retval None
+ * @note   由comm_tick()调用
+ */
+void comm_clock_process(void);
+
+/**
+ * @brief  读取实例的时间戳
+ * @param  instance: 实例指针
+ * @retval 时间源的当前值（微秒）
+ * @note   由接收中断在收完一帧时调用
+ */
+uint32_t comm_clock_read(comm_instance_t *instance);
+
+/**
+ * @brief  处理时钟同步帧
+ * @param  instance: 实例指针
+ * @param  frame: 接收到的帧
+ * @retval true: 已处理（CLK帧）, false: 不是CLK帧
+ */
+bool comm_clock_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+#endif /* COMM_ENABLE_CLOCK */
+
+#endif /* COMM_CLOCK_H */
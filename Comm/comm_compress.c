@@ -0,0 +1,270 @@
+/**
+ * @file    comm_compress.c
+ * @brief   通信库数据压缩 - 可打印小窗口LZ77、能力通告、接收端原地解压
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_compress.h"
+
+#if COMM_ENABLE_COMPRESS
+
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#include <string.h>
+
+/* 回溯引用的距离/长度编码为 '$' + 值，范围'$'~'}'，不含'#'和压缩标记 */
+#define COMM_COMPRESS_CODE_BASE     '$'
+#define COMM_COMPRESS_CODE_COUNT    90
+#define COMM_COMPRESS_LITERAL_MARK  '!'     /**< "~!"表示原始数据中的'~' */
+
+#define COMM_COMPRESS_WINDOW        COMM_COMPRESS_CODE_COUNT
+#define COMM_COMPRESS_MIN_MATCH     4       /**< 引用占3字节，至少匹配4字节才划算 */
+#define COMM_COMPRESS_MAX_MATCH     (COMM_COMPRESS_MIN_MATCH + COMM_COMPRESS_CODE_COUNT - 1)
+
+/* Private function prototypes -----------------------------------------------*/
+static int16_t comm_compress_code_value(char c);
+
+/* =============================================================================
+ * 压缩API实现
+ * =============================================================================
+ */
+
+bool comm_compress_enable(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return false;
+    }
+
+    return comm_send_datagram(instance, COMM_CMD_COMPRESS, "1");
+}
+
+bool comm_compress_is_active(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    return instance != NULL && instance->compress.peer_supported;
+}
+
+bool comm_compress_get_stats(UART_HandleTypeDef *huart, uint32_t *raw_bytes, uint32_t *wire_bytes)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return false;
+    }
+
+    if (raw_bytes != NULL) {
+        *raw_bytes = instance->compress.raw_bytes;
+    }
+    if (wire_bytes != NULL) {
+        *wire_bytes = instance->compress.wire_bytes;
+    }
+    return true;
+}
+
+int comm_compress_encode(const char *in, uint16_t in_len, char *out, uint16_t out_size)
+{
+    uint16_t i = 0;
+    uint16_t o = 0;
+
+    while (i < in_len) {
+        uint16_t best_len = 0;
+        uint16_t best_dist = 0;
+        uint16_t window = (i < COMM_COMPRESS_WINDOW) ? i : COMM_COMPRESS_WINDOW;
+
+        // 窗口只有90字节，直接逐个距离比较；允许重叠（连续重复字符）
+        for (uint16_t dist = 1; dist <= window; dist++) {
+            uint16_t len = 0;
+            while (i + len < in_len && len < COMM_COMPRESS_MAX_MATCH &&
+                   in[i + len - dist] == in[i + len]) {
+                len++;
+            }
+            if (len > best_len) {
+                best_len = len;
+                best_dist = dist;
+            }
+        }
+
+        if (best_len >= COMM_COMPRESS_MIN_MATCH) {
+            if (o + 3 > out_size) {
+                return -1;
+            }
+            out[o++] = COMM_COMPRESS_MARK;
+            out[o++] = (char)(COMM_COMPRESS_CODE_BASE + best_dist - 1);
+            out[o++] = (char)(COMM_COMPRESS_CODE_BASE + best_len - COMM_COMPRESS_MIN_MATCH);
+            i += best_len;
+        } else if (in[i] == COMM_COMPRESS_MARK) {
+            if (o + 2 > out_size) {
+                return -1;
+            }
+            out[o++] = COMM_COMPRESS_MARK;
+            out[o++] = COMM_COMPRESS_LITERAL_MARK;
+            i++;
+        } else {
+            if (o + 1 > out_size) {
+                return -1;
+            }
+            out[o++] = in[i++];
+        }
+    }
+
+    return o;
+}
+
+int comm_compress_decode(const char *in, uint16_t in_len, char *out, uint16_t out_size)
+{
+    uint16_t i = 0;
+    uint16_t o = 0;
+
+    while (i < in_len) {
+        if (in[i] != COMM_COMPRESS_MARK) {
+            if (o >= out_size) {
+                return -1;
+            }
+            out[o++] = in[i++];
+            continue;
+        }
+
+        if (i + 1 < in_len && in[i + 1] == COMM_COMPRESS_LITERAL_MARK) {
+            if (o >= out_size) {
+                return -1;
+            }
+            out[o++] = COMM_COMPRESS_MARK;
+            i += 2;
+            continue;
+        }
+
+        if (i + 2 >= in_len) {
+            return -1;
+        }
+
+        int16_t dist = comm_compress_code_value(in[i + 1]);
+        int16_t len = comm_compress_code_value(in[i + 2]);
+        if (dist < 0 || len < 0) {
+            return -1;
+        }
+        dist += 1;
+        len += COMM_COMPRESS_MIN_MATCH;
+
+        if (dist > o || o + len > out_size) {
+            return -1;
+        }
+
+        // 逐字节拷贝，重叠引用会重复刚输出的内容
+        for (int16_t k = 0; k < len; k++) {
+            out[o] = out[o - dist];
+            o++;
+        }
+        i += 3;
+    }
+
+    return o;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+bool comm_compress_pack(comm_instance_t *instance, const char **cmd, const char **data,
+                        char *cmd_buf, char *data_buf)
+{
+    if (!instance->compress.peer_supported) {
+        return false;
+    }
+
+    size_t cmd_len = strlen(*cmd);
+    size_t data_len = strlen(*data);
+    if (data_len < COMM_COMPRESS_MIN_LENGTH || data_len >= COMM_TX_BUFFER_SIZE ||
+        cmd_len >= COMM_MAX_CMD_LENGTH) {
+        return false;
+    }
+
+    int packed = comm_compress_encode(*data, (uint16_t)data_len, data_buf, COMM_TX_BUFFER_SIZE - 1);
+
+    instance->compress.raw_bytes += (uint32_t)data_len;
+
+    // 加上命令后缀后不再变短就按原样发送
+    if (packed < 0 || (size_t)packed + 1 >= data_len) {
+        instance->compress.wire_bytes += (uint32_t)data_len;
+        return false;
+    }
+
+    instance->compress.wire_bytes += (uint32_t)packed + 1;
+
+    data_buf[packed] = '\0';
+    memcpy(cmd_buf, *cmd, cmd_len);
+    cmd_buf[cmd_len] = COMM_COMPRESS_MARK;
+    cmd_buf[cmd_len + 1] = '\0';
+
+    *cmd = cmd_buf;
+    *data = data_buf;
+    return true;
+}
+
+const comm_frame_t *comm_compress_inflate(comm_instance_t *instance, const comm_frame_t *frame,
+                                          comm_frame_t *inflated)
+{
+    const char *cmd = COMM_FRAME_CMD(instance, frame);
+    if (frame->cmd_len < 2 || cmd[frame->cmd_len - 1] != COMM_COMPRESS_MARK) {
+        return frame;
+    }
+
+    // 解压到临时缓冲区，再写回帧所在的接收槽，视图位置不变
+    char out[COMM_RX_SLOT_SIZE];
+    uint16_t room = (uint16_t)(instance->rx_slot_size - frame->data_offset - 1);
+    int len = comm_compress_decode(COMM_FRAME_DATA(instance, frame), frame->data_len, out, room);
+    if (len < 0) {
+        COMM_DEBUG_INSTANCE(instance, "解压失败: %s", cmd);
+        return NULL;
+    }
+
+    char *slot = instance->rx_buffer[frame->slot];
+    memcpy(&slot[frame->data_offset], out, (size_t)len);
+    slot[frame->data_offset + len] = '\0';
+    slot[frame->cmd_offset + frame->cmd_len - 1] = '\0';
+
+    *inflated = *frame;
+    inflated->cmd_len--;
+    inflated->data_len = (uint16_t)len;
+    return inflated;
+}
+
+bool comm_compress_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    if (!comm_frame_cmd_is(instance, frame, COMM_CMD_COMPRESS)) {
+        return false;
+    }
+
+    bool was_supported = instance->compress.peer_supported;
+    instance->compress.peer_supported = (COMM_FRAME_DATA(instance, frame)[0] == '1');
+
+    // 对端刚开始通告时回复一次，双方都不必再调用comm_compress_enable()
+    if (instance->compress.peer_supported && !was_supported) {
+        comm_send_datagram(instance, COMM_CMD_COMPRESS, "1");
+    }
+
+    COMM_DEBUG_INSTANCE(instance, "对端压缩能力: %d", instance->compress.peer_supported);
+    return true;
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  引用编码字符转数值
+ * @retval 0 ~ COMM_COMPRESS_CODE_COUNT-1，非法字符返回-1
+ */
+static int16_t comm_compress_code_value(char c)
+{
+    int16_t value = (int16_t)((uint8_t)c - COMM_COMPRESS_CODE_BASE);
+    if (value < 0 || value >= COMM_COMPRESS_CODE_COUNT) {
+        return -1;
+    }
+    return value;
+}
+
+#endif /* COMM_ENABLE_COMPRESS */
@@ -0,0 +1,129 @@
+/**
+ ******************************************************************************
+ * @file           : comm_compress.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信数据字段压缩
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 数据压缩 - 重复度高的ASCII数据（光谱、日志）压缩后发送，节省低速链路带宽
+ *
+ * 算法为小窗口LZ77，压缩结果仍是可打印字符且不含'#'，帧格式不变：
+ *   - 普通字节原样输出，'~'输出为"~!"
+ *   - 回溯引用输出为"~DL"，D为距离(1~90)，L为长度(4~93)，都编码为'$'+值
+ *   - 命令加后缀'~'表示数据已压缩: {SPEC~:F1=1~$+,F2=...#SEQ#CRC}
+ *
+ * 压缩在构建帧时、计算CRC之前进行；接收方在分发前原地解压，回调看到的是原始命令和数据。
+ * 只有压缩后更短时才使用压缩结果。窗口为数据本身，不需要额外的RAM。
+ *
+ * 协商: comm_compress_enable()发送{CMP:1}，收到对端的{CMP:1}后才开始压缩，
+ * 收到通告的一方会回复一次自己的通告。接收方向总是能解压。
+ *
+ * 注意：解压后的数据必须放得下接收槽（默认COMM_RX_SLOT_SIZE）；经路由转发时，出口对端未通告
+ *       解压能力则由网关解压后转发（出口对端已通告时原样转发）
+ *
+ * 使用示例:
+ *   comm_compress_enable(&huart2);
+ *   comm_send_command(&huart2, "SPEC", "F1=0123,F2=0456,F3=0789,...");  // 自动压缩
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_COMPRESS_H
+#define COMM_COMPRESS_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_COMPRESS
+
+/* =============================================================================
+ * 压缩API
+ * =============================================================================
+ */
+
+/**
+ * @brief  向对端通告本端可以解压
+ * @param  huart: UART句柄指针
+ * @retval true: 通告已发送, false: 发送失败
+ * @note   对端也通告后双方开始压缩，通告丢失时可再次调用
+ */
+bool comm_compress_enable(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  对端是否支持解压
+ * @param  huart: UART句柄指针
+ * @retval true: 发送的数据会被压缩, false: 按原样发送
+ */
+bool comm_compress_is_active(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取压缩统计
+ * @param  huart: UART句柄指针
+ * @param  raw_bytes: 输出参与压缩的原始字节数（可为NULL）
+ * @param  wire_bytes: 输出实际发送的字节数（可为NULL）
+ * @retval true: 获取成功, false: 未找到实例
+ * @note   压缩率 = wire_bytes / raw_bytes
+ */
+bool comm_compress_get_stats(UART_HandleTypeDef *huart, uint32_t *raw_bytes, uint32_t *wire_bytes);
+
+/**
+ * @brief  压缩一段数据
+ * @param  in: 原始数据
+ * @param  in_len: 原始数据长度
+ * @param  out: 输出缓冲区
+ * @param  out_size: 输出缓冲区大小
+ * @retval 压缩后长度，输出放不下返回-1
+ * @note   输出不以'\0'结尾
+ */
+int comm_compress_encode(const char *in, uint16_t in_len, char *out, uint16_t out_size);
+
+/**
+ * @brief  解压一段数据
+ * @param  in: 压缩数据
+ * @param  in_len: 压缩数据长度
+ * @param  out: 输出缓冲区
+ * @param  out_size: 输出缓冲区大小
+ * @retval 解压后长度，数据错误或输出放不下返回-1
+ * @note   输出不以'\0'结尾
+ */
+int comm_compress_decode(const char *in, uint16_t in_len, char *out, uint16_t out_size);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  构建帧前压缩数据
+ * @param  instance: 实例指针
+ * @param  cmd: 命令指针，压缩时改为指向cmd_buf（带压缩后缀）
+ * @param  data: 数据指针，压缩时改为指向data_buf
+ * @param  cmd_buf: 命令缓冲区，至少COMM_MAX_CMD_LENGTH + 2字节
+ * @param  data_buf: 数据缓冲区，至少COMM_TX_BUFFER_SIZE字节
+ * @retval true: 已压缩, false: 按原样发送
+ */
+bool comm_compress_pack(comm_instance_t *instance, const char **cmd, const char **data,
+                        char *cmd_buf, char *data_buf);
+
+/**
+ * @brief  分发前原地解压
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @param  inflated: 解压后的帧视图
+ * @retval 未压缩返回frame，已解压返回inflated，数据错误返回NULL
+ */
+const comm_frame_t *comm_compress_inflate(comm_instance_t *instance, const comm_frame_t *frame,
+                                          comm_frame_t *inflated);
+
+/**
+ * @brief  处理压缩能力通告
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @retval true: 已处理, false: 不是通告帧
+ */
+bool comm_compress_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+#endif /* COMM_ENABLE_COMPRESS */
+
+#endif /* COMM_COMPRESS_H */
@@ -0,0 +1,227 @@
+/**
+ * @file    comm_credit.c
+ * @brief   通信库流控层 - 接收槽额度通告、发送暂停、额度查询
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_credit.h"
+
+#if COMM_ENABLE_CREDITS
+
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Private function prototypes -----------------------------------------------*/
+static bool comm_credit_enabled(const comm_instance_t *instance);
+static uint8_t comm_credit_free_slots(const comm_instance_t *instance);
+static uint8_t comm_credit_grant(comm_instance_t *instance, uint8_t releasing);
+static void comm_credit_update_peer(comm_instance_t *instance, uint8_t credits);
+static void comm_credit_send(comm_instance_t *instance, const char *data);
+
+/* =============================================================================
+ * 查询API实现
+ * =============================================================================
+ */
+
+uint8_t comm_get_peer_credits(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return 0;
+    }
+
+    return instance->credit.peer_credits;
+}
+
+uint32_t comm_get_credit_stalls(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return 0;
+    }
+
+    return instance->credit.stalls;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_credit_init(comm_instance_t *instance)
+{
+    memset(&instance->credit, 0, sizeof(comm_credit_t));
+    instance->credit.peer_credits = COMM_RX_FRAME_SLOTS;
+    instance->credit.granted = COMM_RX_FRAME_SLOTS;
+}
+
+bool comm_credit_available(const comm_instance_t *instance)
+{
+    return !comm_credit_enabled(instance) || instance->credit.peer_credits > 0;
+}
+
+void comm_credit_consume(comm_instance_t *instance)
+{
+    comm_credit_t *credit = &instance->credit;
+    if (!comm_credit_enabled(instance) || credit->peer_credits == COMM_CREDIT_UNLIMITED ||
+        credit->peer_credits == 0) {
+        return;
+    }
+
+    credit->peer_credits--;
+    if (credit->peer_credits == 0) {
+        credit->blocked_since = HAL_GetTick();
+        credit->last_probe = credit->blocked_since;
+        credit->stalls++;
+        COMM_DEBUG_INSTANCE(instance, "对端额度耗尽，暂停发送");
+    }
+}
+
+uint8_t comm_credit_advertise(comm_instance_t *instance)
+{
+    if (!comm_credit_enabled(instance)) {
+        return COMM_CREDIT_UNLIMITED;
+    }
+
+    // 被确认的帧要等回调返回后才释放，不计入
+    return comm_credit_grant(instance, 0);
+}
+
+void comm_credit_handle_ack(comm_instance_t *instance, const char *data, uint16_t data_len)
+{
+    if (!comm_credit_enabled(instance)) {
+        return;
+    }
+
+    const char *credits = memchr(data, ',', data_len);
+    if (credits == NULL) {
+        // 对端未启用流控
+        comm_credit_update_peer(instance, COMM_CREDIT_UNLIMITED);
+        return;
+    }
+
+    comm_credit_update_peer(instance, (uint8_t)strtoul(credits + 1, NULL, 16));
+}
+
+bool comm_credit_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    if (!comm_credit_enabled(instance)) {
+        return false;
+    }
+
+    if (!comm_frame_cmd_is(instance, frame, COMM_CMD_CREDIT)) {
+        // 普通帧占用了对端的一个额度
+        if (instance->credit.used < UINT8_MAX) {
+            instance->credit.used++;
+        }
+        return false;
+    }
+
+    const char *data = COMM_FRAME_DATA(instance, frame);
+    if (data[0] == '?') {
+        char reply[4];
+        // 查询帧处理完立即释放，它占用的槽也可以通告
+        snprintf(reply, sizeof(reply), "%X", comm_credit_grant(instance, 1));
+        comm_credit_send(instance, reply);
+    } else {
+        comm_credit_update_peer(instance, (uint8_t)strtoul(data, NULL, 16));
+    }
+    return true;
+}
+
+void comm_credit_process(comm_instance_t *instance)
+{
+    if (!comm_credit_enabled(instance)) {
+        return;
+    }
+
+    comm_credit_t *credit = &instance->credit;
+
+    // 对端已用完上次通告的额度，腾出接收槽后主动通告，不必等下一个ACK
+    if (credit->used >= credit->granted && comm_credit_free_slots(instance) > 0) {
+        char grant[4];
+        snprintf(grant, sizeof(grant), "%X", comm_credit_grant(instance, 0));
+        comm_credit_send(instance, grant);
+    }
+
+    // 通告帧可能丢失，额度耗尽太久时主动查询
+    if (credit->peer_credits == 0 && HAL_GetTick() - credit->last_probe >= COMM_CREDIT_PROBE_MS) {
+        credit->last_probe = HAL_GetTick();
+        comm_credit_send(instance, "?");
+    }
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  判断实例是否做流控（RS-485多点总线的额度无法按对端区分，不做流控）
+ */
+static bool comm_credit_enabled(const comm_instance_t *instance)
+{
+#if COMM_ENABLE_RS485
+    if (instance->rs485.enabled) {
+        return false;
+    }
+#endif
+    (void)instance;
+    return true;
+}
+
+/**
+ * @brief  空闲接收槽数量（不含已接收但尚未处理完的帧）
+ */
+static uint8_t comm_credit_free_slots(const comm_instance_t *instance)
+{
+    uint8_t pending = (uint8_t)(instance->rx_produced - instance->rx_consumed);
+    return (pending >= COMM_RX_FRAME_SLOTS) ? 0 : (uint8_t)(COMM_RX_FRAME_SLOTS - pending);
+}
+
+/**
+ * @brief  记录并返回通告给对端的额度
+ * @param  releasing: 正在处理、马上释放的槽数
+ */
+static uint8_t comm_credit_grant(comm_instance_t *instance, uint8_t releasing)
+{
+    uint8_t credits = (uint8_t)(comm_credit_free_slots(instance) + releasing);
+    if (credits > COMM_RX_FRAME_SLOTS) {
+        credits = COMM_RX_FRAME_SLOTS;
+    }
+
+    instance->credit.granted = credits;
+    instance->credit.used = 0;
+    return credits;
+}
+
+/**
+ * @brief  更新对端额度，额度恢复时结束暂停
+ */
+static void comm_credit_update_peer(comm_instance_t *instance, uint8_t credits)
+{
+    comm_credit_t *credit = &instance->credit;
+
+    if (credit->peer_credits == 0 && credits > 0) {
+        COMM_DEBUG_INSTANCE(instance, "对端额度恢复: %d，暂停%lums", credits,
+                           (unsigned long)(HAL_GetTick() - credit->blocked_since));
+    }
+    credit->peer_credits = credits;
+}
+
+/**
+ * @brief  发送CRD帧（数据报，不消耗额度）
+ */
+static void comm_credit_send(comm_instance_t *instance, const char *data)
+{
+    if (!comm_send_datagram(instance, COMM_CMD_CREDIT, data)) {
+        COMM_DEBUG_INSTANCE(instance, "额度帧发送失败: %s", data);
+    }
+}
+
+#endif /* COMM_ENABLE_CREDITS */
@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ * @file           : comm_credit.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信基于额度的流控
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 额度流控 - 发送方不再压垮主循环繁忙的接收方
+ *
+ * 接收方有COMM_RX_FRAME_SLOTS个接收槽，空闲槽数即可接收的帧数（额度）：
+ *   - ACK帧携带额度: {ACK:SS,C#00#CRC}，C为十六进制空闲槽数
+ *   - 对端用完上次通告的额度后，接收方处理完积压的帧主动通告: {CRD:C#00#CRC}
+ *   - 额度耗尽超过COMM_CREDIT_PROBE_MS仍未收到通告时发送方查询: {CRD:?#00#CRC}
+ *
+ * 发送方每发出一帧命令或数据报消耗一个额度，额度为0时comm_send_command()、
+ * 数据报、优先级队列和路由转发都暂停，而不是发出去被丢弃再靠超时重发。
+ * 重发帧和ACK/NAK/CRD控制帧不消耗额度。
+ *
+ * 注意：
+ *   - 通信双方都需启用，ACK中不带额度的对端视为不限额度
+ *   - 只用于点对点链路，启用RS-485寻址的实例不做流控
+ *   - 额度通告与对端的发送可能交错，极少数情况下仍会丢帧，此时由原有的重发机制兜底
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_CREDIT_H
+#define COMM_CREDIT_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_CREDITS
+
+/* =============================================================================
+ * 查询API
+ * =============================================================================
+ */
+
+/**
+ * @brief  获取对端当前可接收的帧数
+ * @param  huart: UART句柄指针
+ * @retval 剩余额度，COMM_CREDIT_UNLIMITED表示对端未启用流控
+ */
+uint8_t comm_get_peer_credits(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取因额度耗尽暂停发送的次数
+ * @param  huart: UART句柄指针
+ * @retval 暂停次数
+ */
+uint32_t comm_get_credit_stalls(UART_HandleTypeDef *huart);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  初始化额度状态（假定对端与本端接收槽数量相同）
+ * @param  instance: 实例指针
+ * @retval None
+ */
+void comm_credit_init(comm_instance_t *instance);
+
+/**
+ * @brief  判断是否还有额度发送新帧
+ * @param  instance: 实例指针
+ * @retval true: 可以发送, false: 等待对端通告额度
+ */
+bool comm_credit_available(const comm_instance_t *instance);
+
+/**
+ * @brief  发出一帧后消耗一个额度
+ * @param  instance: 实例指针
+ * @retval None
+ */
+void comm_credit_consume(comm_instance_t *instance);
+
+/**
+ * @brief  计算本端空闲接收槽数并记为已通告额度
+ * @param  instance: 实例指针
+ * @retval 空闲槽数，不做流控的实例返回COMM_CREDIT_UNLIMITED（ACK不带额度）
+ * @note   由comm_send_ack()调用，通告的是正在处理的帧之外的空闲槽
+ */
+uint8_t comm_credit_advertise(comm_instance_t *instance);
+
+/**
+ * @brief  根据ACK数据更新对端额度
+ * @param  instance: 实例指针
+ * @param  data: ACK数据（"SS"或"SS,C"）
+ * @param  data_len: 数据长度
+ * @retval None
+ */
+void comm_credit_handle_ack(comm_instance_t *instance, const char *data, uint16_t data_len);
+
+/**
+ * @brief  处理CRD帧，并统计收到的普通帧
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @retval true: 已作为CRD帧处理, false: 继续按普通帧处理
+ */
+bool comm_credit_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+/**
+ * @brief  接收方通告额度，发送方额度耗尽时查询
+ * @param  instance: 实例指针
+ * @retval None
+ * @note   由comm_tick()在处理完接收帧后调用
+ */
+void comm_credit_process(comm_instance_t *instance);
+
+#endif /* COMM_ENABLE_CREDITS */
+
+#endif /* COMM_CREDIT_H */
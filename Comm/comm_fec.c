@@ -0,0 +1,456 @@
+/**
+ * @file    comm_fec.c
+ * @brief   通信库前向纠错 - GF(256) Reed-Solomon编解码、纠错外壳、纠错请求
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_fec.h"
+
+#if COMM_ENABLE_FEC
+
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#if COMM_ENABLE_RS485
+#include "comm_rs485.h"
+#endif
+#if COMM_ENABLE_BAUD
+#include "comm_baud.h"
+#endif
+#if COMM_ENABLE_LINK
+#include "comm_link.h"
+#endif
+#include <string.h>
+
+/* RS码块最大长度（GF(256)） */
+#define COMM_FEC_BLOCK_MAX          255
+
+/* GF(256)，本原多项式x^8+x^4+x^3+x^2+1（0x11D），生成元α=2 */
+static const uint8_t g_gf_exp[255] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26,
+    0x4C, 0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0,
+    0x9D, 0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23,
+    0x46, 0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1,
+    0x5F, 0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0,
+    0xFD, 0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2,
+    0xD9, 0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE,
+    0x81, 0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC,
+    0x85, 0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54,
+    0xA8, 0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73,
+    0xE6, 0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF,
+    0xE3, 0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41,
+    0x82, 0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6,
+    0x51, 0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09,
+    0x12, 0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16,
+    0x2C, 0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E
+};
+
+static const uint8_t g_gf_log[256] = {
+    0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1A, 0xC6, 0x03, 0xDF, 0x33, 0xEE, 0x1B, 0x68, 0xC7, 0x4B,
+    0x04, 0x64, 0xE0, 0x0E, 0x34, 0x8D, 0xEF, 0x81, 0x1C, 0xC1, 0x69, 0xF8, 0xC8, 0x08, 0x4C, 0x71,
+    0x05, 0x8A, 0x65, 0x2F, 0xE1, 0x24, 0x0F, 0x21, 0x35, 0x93, 0x8E, 0xDA, 0xF0, 0x12, 0x82, 0x45,
+    0x1D, 0xB5, 0xC2, 0x7D, 0x6A, 0x27, 0xF9, 0xB9, 0xC9, 0x9A, 0x09, 0x78, 0x4D, 0xE4, 0x72, 0xA6,
+    0x06, 0xBF, 0x8B, 0x62, 0x66, 0xDD, 0x30, 0xFD, 0xE2, 0x98, 0x25, 0xB3, 0x10, 0x91, 0x22, 0x88,
+    0x36, 0xD0, 0x94, 0xCE, 0x8F, 0x96, 0xDB, 0xBD, 0xF1, 0xD2, 0x13, 0x5C, 0x83, 0x38, 0x46, 0x40,
+    0x1E, 0x42, 0xB6, 0xA3, 0xC3, 0x48, 0x7E, 0x6E, 0x6B, 0x3A, 0x28, 0x54, 0xFA, 0x85, 0xBA, 0x3D,
+    0xCA, 0x5E, 0x9B, 0x9F, 0x0A, 0x15, 0x79, 0x2B, 0x4E, 0xD4, 0xE5, 0xAC, 0x73, 0xF3, 0xA7, 0x57,
+    0x07, 0x70, 0xC0, 0xF7, 0x8C, 0x80, 0x63, 0x0D, 0x67, 0x4A, 0xDE, 0xED, 0x31, 0xC5, 0xFE, 0x18,
+    0xE3, 0xA5, 0x99, 0x77, 0x26, 0xB8, 0xB4, 0x7C, 0x11, 0x44, 0x92, 0xD9, 0x23, 0x20, 0x89, 0x2E,
+    0x37, 0x3F, 0xD1, 0x5B, 0x95, 0xBC, 0xCF, 0xCD, 0x90, 0x87, 0x97, 0xB2, 0xDC, 0xFC, 0xBE, 0x61,
+    0xF2, 0x56, 0xD3, 0xAB, 0x14, 0x2A, 0x5D, 0x9E, 0x84, 0x3C, 0x39, 0x53, 0x47, 0x6D, 0x41, 0xA2,
+    0x1F, 0x2D, 0x43, 0xD8, 0xB7, 0x7B, 0xA4, 0x76, 0xC4, 0x17, 0x49, 0xEC, 0x7F, 0x0C, 0x6F, 0xF6,
+    0x6C, 0xA1, 0x3B, 0x52, 0x29, 0x9D, 0x55, 0xAA, 0xFB, 0x60, 0x86, 0xB1, 0xBB, 0xCC, 0x3E, 0x5A,
+    0xCB, 0x59, 0x5F, 0xB0, 0x9C, 0xA9, 0xA0, 0x51, 0x0B, 0xF5, 0x16, 0xEB, 0x7A, 0x75, 0x2C, 0xD7,
+    0x4F, 0xAE, 0xD5, 0xE9, 0xE6, 0xE7, 0xAD, 0xE8, 0x74, 0xD6, 0xF4, 0xEA, 0xA8, 0x50, 0x58, 0xAF
+};
+
+/* 生成多项式 (x+α^0)(x+α^1)...(x+α^(P-1))，高次项在前，g[0]=1 */
+static uint8_t g_comm_fec_generator[COMM_FEC_PARITY + 1];
+
+/* Private function prototypes -----------------------------------------------*/
+static inline uint8_t comm_gf_mul(uint8_t a, uint8_t b);
+static inline uint8_t comm_gf_div(uint8_t a, uint8_t b);
+static inline uint8_t comm_gf_alpha(int16_t power);
+static int16_t comm_fec_vote(const char *header, uint8_t pos);
+static bool comm_fec_request(UART_HandleTypeDef *huart, const char *request);
+static void comm_fec_note_failure(comm_instance_t *instance);
+
+/* =============================================================================
+ * 纠错API实现
+ * =============================================================================
+ */
+
+bool comm_fec_enable(UART_HandleTypeDef *huart)
+{
+    return comm_fec_request(huart, "1");
+}
+
+bool comm_fec_disable(UART_HandleTypeDef *huart)
+{
+    return comm_fec_request(huart, "0");
+}
+
+bool comm_fec_is_active(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    return instance != NULL && instance->fec.tx_enabled;
+}
+
+bool comm_fec_get_stats(UART_HandleTypeDef *huart, comm_fec_stats_t *stats)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || stats == NULL) {
+        return false;
+    }
+
+    stats->tx_frames = instance->fec.tx_frames;
+    stats->rx_frames = instance->fec.rx_frames;
+    stats->rx_corrected = instance->fec.rx_corrected;
+    stats->rx_symbols = instance->fec.rx_symbols;
+    stats->rx_failed = instance->fec.rx_failed;
+    return true;
+}
+
+void comm_fec_encode(const uint8_t *data, uint16_t length, uint8_t *parity)
+{
+    // 系统码：校验字节为 m(x)·x^P 除以生成多项式的余式，移位寄存器逐字节计算
+    memset(parity, 0, COMM_FEC_PARITY);
+    for (uint16_t i = 0; i < length; i++) {
+        uint8_t feedback = data[i] ^ parity[0];
+        memmove(parity, &parity[1], COMM_FEC_PARITY - 1);
+        parity[COMM_FEC_PARITY - 1] = 0;
+        if (feedback != 0) {
+            for (uint8_t j = 0; j < COMM_FEC_PARITY; j++) {
+                parity[j] ^= comm_gf_mul(g_comm_fec_generator[j + 1], feedback);
+            }
+        }
+    }
+}
+
+int comm_fec_decode(uint8_t *block, uint16_t length)
+{
+    if (length <= COMM_FEC_PARITY || length > COMM_FEC_BLOCK_MAX) {
+        return -1;
+    }
+
+    // 伴随式 S_i = r(α^i)，全为0说明没有错误（绝大多数帧到此为止）
+    uint8_t syndrome[COMM_FEC_PARITY];
+    bool has_error = false;
+    for (uint8_t i = 0; i < COMM_FEC_PARITY; i++) {
+        uint8_t s = 0;
+        uint8_t root = comm_gf_alpha(i);
+        for (uint16_t k = 0; k < length; k++) {
+            s = comm_gf_mul(s, root) ^ block[k];
+        }
+        syndrome[i] = s;
+        has_error = has_error || (s != 0);
+    }
+    if (!has_error) {
+        return 0;
+    }
+
+    // Berlekamp-Massey求错误位置多项式Λ(x)，低次项在前
+    uint8_t lambda[COMM_FEC_PARITY + 1] = { 1 };
+    uint8_t prev[COMM_FEC_PARITY + 1] = { 1 };
+    uint8_t temp[COMM_FEC_PARITY + 1];
+    uint8_t errors = 0;
+    uint8_t shift = 1;
+    uint8_t prev_discrepancy = 1;
+
+    for (uint8_t n = 0; n < COMM_FEC_PARITY; n++) {
+        uint8_t d = syndrome[n];
+        for (uint8_t i = 1; i <= errors; i++) {
+            d ^= comm_gf_mul(lambda[i], syndrome[n - i]);
+        }
+        if (d == 0) {
+            shift++;
+            continue;
+        }
+
+        uint8_t coef = comm_gf_div(d, prev_discrepancy);
+        bool grow = (2u * errors <= n);
+        if (grow) {
+            memcpy(temp, lambda, sizeof(lambda));
+        }
+        for (uint8_t i = 0; i + shift <= COMM_FEC_PARITY; i++) {
+            lambda[i + shift] ^= comm_gf_mul(coef, prev[i]);
+        }
+        if (grow) {
+            errors = (uint8_t)(n + 1 - errors);
+            memcpy(prev, temp, sizeof(prev));
+            prev_discrepancy = d;
+            shift = 1;
+        } else {
+            shift++;
+        }
+    }
+    if (errors > COMM_FEC_PARITY / 2) {
+        return -1;
+    }
+
+    // Chien搜索：位置k的定位子X=α^(length-1-k)，Λ(X^-1)=0处有错
+    uint16_t positions[COMM_FEC_PARITY / 2];
+    uint8_t found = 0;
+    for (uint16_t k = 0; k < length; k++) {
+        uint8_t x_inv = comm_gf_alpha(-(int16_t)(length - 1 - k));
+        uint8_t sum = 0;
+        uint8_t power = 1;
+        for (uint8_t i = 0; i <= errors; i++) {
+            sum ^= comm_gf_mul(lambda[i], power);
+            power = comm_gf_mul(power, x_inv);
+        }
+        if (sum == 0) {
+            if (found == errors) {
+                return -1;
+            }
+            positions[found++] = k;
+        }
+    }
+    if (found != errors) {
+        // 根落在缩短码之外，错误数超出纠错能力
+        return -1;
+    }
+
+    // 错误值多项式Ω(x) = S(x)Λ(x) mod x^P
+    uint8_t omega[COMM_FEC_PARITY];
+    for (uint8_t k = 0; k < COMM_FEC_PARITY; k++) {
+        uint8_t v = 0;
+        for (uint8_t i = 0; i <= k && i <= errors; i++) {
+            v ^= comm_gf_mul(lambda[i], syndrome[k - i]);
+        }
+        omega[k] = v;
+    }
+
+    // Forney算法：e = X·Ω(X^-1) / Λ'(X^-1)
+    for (uint8_t j = 0; j < found; j++) {
+        int16_t power = (int16_t)(length - 1 - positions[j]);
+        uint8_t x = comm_gf_alpha(power);
+        uint8_t x_inv = comm_gf_alpha(-power);
+
+        uint8_t num = 0;
+        uint8_t xp = 1;
+        for (uint8_t k = 0; k < COMM_FEC_PARITY; k++) {
+            num ^= comm_gf_mul(omega[k], xp);
+            xp = comm_gf_mul(xp, x_inv);
+        }
+
+        // 特征2下形式导数只保留奇次项
+        uint8_t den = 0;
+        uint8_t x_inv2 = comm_gf_mul(x_inv, x_inv);
+        xp = 1;
+        for (uint8_t i = 1; i <= errors; i += 2) {
+            den ^= comm_gf_mul(lambda[i], xp);
+            xp = comm_gf_mul(xp, x_inv2);
+        }
+        if (den == 0) {
+            return -1;
+        }
+
+        block[positions[j]] ^= comm_gf_mul(x, comm_gf_div(num, den));
+    }
+
+    return found;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_fec_init(void)
+{
+    uint8_t *g = g_comm_fec_generator;
+    memset(g, 0, sizeof(g_comm_fec_generator));
+    g[0] = 1;
+    for (uint8_t i = 0; i < COMM_FEC_PARITY; i++) {
+        // 乘以(x + α^i)
+        uint8_t root = comm_gf_alpha(i);
+        for (uint8_t j = (uint8_t)(i + 1); j > 0; j--) {
+            g[j] ^= comm_gf_mul(g[j - 1], root);
+        }
+    }
+}
+
+int16_t comm_fec_header_length(const char *header, uint16_t slot_size)
+{
+    int16_t high = comm_fec_vote(header, 0);
+    int16_t low = comm_fec_vote(header, 1);
+    if (high < 0 || low < 0) {
+        return -1;
+    }
+
+    int16_t length = (int16_t)((high << 4) | low);
+    if (length < 2 || length + COMM_FEC_PARITY > COMM_FEC_BLOCK_MAX ||
+        length + COMM_FEC_PARITY >= slot_size) {
+        return -1;
+    }
+    return length;
+}
+
+void comm_fec_wrap(comm_instance_t *instance, char *buffer, uint16_t size, uint16_t *length)
+{
+    uint16_t len = *length;
+    if (!instance->fec.tx_enabled) {
+        return;
+    }
+
+    // 放不下时按普通帧发送，对端总能接收
+    if (len + COMM_FEC_PARITY > COMM_FEC_BLOCK_MAX || len + COMM_FEC_OVERHEAD >= size) {
+        COMM_DEBUG_INSTANCE(instance, "帧过长，不加纠错外壳: %u字节", len);
+        return;
+    }
+
+    char *body = &buffer[1 + COMM_FEC_HEADER_SIZE];
+    memmove(body, buffer, len);
+
+    buffer[0] = COMM_FEC_FRAME_START;
+    for (uint8_t i = 0; i < COMM_FEC_HEADER_SIZE; i += 2) {
+        comm_hex_encode(&buffer[1 + i], len, 2);
+    }
+
+    uint8_t parity[COMM_FEC_PARITY];
+    comm_fec_encode((const uint8_t *)body, len, parity);
+
+    char *out = &body[len];
+    for (uint8_t i = 0; i < COMM_FEC_PARITY; i++) {
+        out += comm_hex_encode(out, parity[i], 2);
+    }
+    *out = '\0';
+
+    *length = (uint16_t)(len + COMM_FEC_OVERHEAD);
+    instance->fec.tx_frames++;
+}
+
+bool comm_fec_decode_frame(comm_instance_t *instance, comm_frame_t *frame)
+{
+    if (frame->fec_length == 0) {
+        return true;
+    }
+
+    instance->fec.rx_frames++;
+
+    uint8_t *block = (uint8_t *)instance->rx_buffer[frame->slot];
+    int corrected = comm_fec_decode(block, (uint16_t)(frame->fec_length + COMM_FEC_PARITY));
+
+    // 纠正后仍要通过内层帧CRC，防止超出纠错能力时的误纠正
+    if (corrected < 0 || !comm_parse_frame(instance, frame, frame->fec_length)) {
+        instance->fec.rx_failed++;
+        COMM_DEBUG_INSTANCE(instance, "纠错失败: 内层帧%u字节", frame->fec_length);
+        comm_fec_note_failure(instance);
+        return false;
+    }
+
+    if (corrected > 0) {
+        instance->fec.rx_corrected++;
+        instance->fec.rx_symbols += (uint32_t)corrected;
+        COMM_DEBUG_INSTANCE(instance, "纠正%d个错误字节", corrected);
+    }
+
+#if COMM_ENABLE_RS485
+    // 普通帧在中断里过滤，纠错帧到这里才知道地址
+    if (!comm_rs485_accept_frame(instance, frame)) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool comm_fec_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    if (!comm_frame_cmd_is(instance, frame, COMM_CMD_FEC)) {
+        return false;
+    }
+
+    bool was_enabled = instance->fec.tx_enabled;
+    instance->fec.tx_enabled = (COMM_FRAME_DATA(instance, frame)[0] == '1');
+
+    // 状态变化时回复一次同样的请求，两个方向保持一致
+    if (instance->fec.tx_enabled != was_enabled) {
+        comm_send_datagram(instance, COMM_CMD_FEC, instance->fec.tx_enabled ? "1" : "0");
+    }
+
+    COMM_DEBUG_INSTANCE(instance, "对端纠错请求: %d", instance->fec.tx_enabled);
+    return true;
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  GF(256)乘法
+ */
+static inline uint8_t comm_gf_mul(uint8_t a, uint8_t b)
+{
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    uint16_t sum = (uint16_t)g_gf_log[a] + g_gf_log[b];
+    return g_gf_exp[sum >= 255 ? sum - 255 : sum];
+}
+
+/**
+ * @brief  GF(256)除法，b不能为0
+ */
+static inline uint8_t comm_gf_div(uint8_t a, uint8_t b)
+{
+    if (a == 0) {
+        return 0;
+    }
+    int16_t diff = (int16_t)g_gf_log[a] - g_gf_log[b];
+    return g_gf_exp[diff < 0 ? diff + 255 : diff];
+}
+
+/**
+ * @brief  α的幂，power可为负
+ */
+static inline uint8_t comm_gf_alpha(int16_t power)
+{
+    power %= 255;
+    return g_gf_exp[power < 0 ? power + 255 : power];
+}
+
+/**
+ * @brief  长度字段某一位的三取二表决
+ * @retval 0-15，三份互不相同或不是十六进制字符返回-1
+ */
+static int16_t comm_fec_vote(const char *header, uint8_t pos)
+{
+    char a = header[pos];
+    char b = header[pos + 2];
+    char c = header[pos + 4];
+    char v = (a == b || a == c) ? a : ((b == c) ? b : 0);
+
+    return comm_hex_nibble((uint8_t)v);
+}
+
+/**
+ * @brief  发送纠错请求
+ */
+static bool comm_fec_request(UART_HandleTypeDef *huart, const char *request)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return false;
+    }
+
+    return comm_send_datagram(instance, COMM_CMD_FEC, request);
+}
+
+/**
+ * @brief  无法纠正的帧按CRC错误计入误码统计
+ */
+static void comm_fec_note_failure(comm_instance_t *instance)
+{
+#if COMM_ENABLE_BAUD
+    comm_baud_note_error(instance);
+#endif
+#if COMM_ENABLE_LINK
+    comm_link_note_error(instance);
+#endif
+    (void)instance;
+}
+
+#endif /* COMM_ENABLE_FEC */
@@ -0,0 +1,167 @@
+/**
+ ******************************************************************************
+ * @file           : comm_fec.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信前向纠错
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 前向纠错 - 噪声较大的链路（长线、电机附近、无线透传模块）上纠正少量错误字节，
+ * 减少CRC失败后等待超时重发造成的吞吐下降
+ *
+ * 纠错帧在普通帧外加一层外壳，内层帧不变:
+ *   [LLLLLL{CMD:DATA#SEQ#CRC}PPPP...PP
+ *   - '['为纠错帧起始符
+ *   - LL为内层帧长度（2位十六进制），重复3次，接收方逐位三取二表决
+ *   - 内层帧原样发送，RS码直接以内层帧的字节为信息符号
+ *   - PP为COMM_FEC_PARITY个RS(GF(256))校验字节，每字节2位十六进制，按长度收齐即结束
+ * 每帧最多纠正COMM_FEC_PARITY/2个错误字节（含校验字符出错），错误落在'['或长度字段两份以上时整帧丢失。
+ * '['丢失时内层帧仍按普通帧解析，无错误时照常收下。
+ *
+ * 接收中断只把纠错帧原样存入接收槽，纠错和字段解析在comm_tick()中进行，
+ * 纠错后仍要通过内层帧的CRC校验，纠错失败或误纠正时按CRC错误处理。
+ *
+ * 协商: comm_fec_enable()发送{FEC:1}请求对端编码，收到请求的一方开始编码并回复一次自己的请求，
+ * 之后双向都编码；comm_fec_disable()发送{FEC:0}取消。启用FEC的一端总能接收纠错帧，
+ * 所以切换过程中不丢帧。开销为每帧7+2*COMM_FEC_PARITY字符，加外壳后放不下发送缓冲区的帧按普通帧发送。
+ *
+ * 注意：
+ *   - COMM_FEC_PARITY通信双方必须一致
+ *   - 接收槽需放得下内层帧加COMM_FEC_PARITY字节，内层帧长度不超过255-COMM_FEC_PARITY
+ *   - 在链路上比较有无纠错时的有效吞吐见tools/comm_fec_bench.c
+ *
+ * 使用示例:
+ *   comm_fec_enable(&huart2);
+ *   comm_send_command(&huart2, "TEMP", "25.6");   // 对端回复请求后自动编码
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_FEC_H
+#define COMM_FEC_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_FEC
+
+/** @brief 长度字段字符数（2位十六进制重复3次） */
+#define COMM_FEC_HEADER_SIZE        6
+
+/** @brief 每帧外壳开销（字符） */
+#define COMM_FEC_OVERHEAD           (1 + COMM_FEC_HEADER_SIZE + 2 * COMM_FEC_PARITY)
+
+/** @brief 纠错统计 */
+typedef struct {
+    uint32_t tx_frames;                     /**< 编码发送的帧数 */
+    uint32_t rx_frames;                     /**< 收到的纠错帧数 */
+    uint32_t rx_corrected;                  /**< 纠正过错误的帧数 */
+    uint32_t rx_symbols;                    /**< 纠正的错误字节数 */
+    uint32_t rx_failed;                     /**< 无法纠正（或纠正后CRC仍错误）的帧数 */
+} comm_fec_stats_t;
+
+/* =============================================================================
+ * 纠错API
+ * =============================================================================
+ */
+
+/**
+ * @brief  请求对端对发往本端的帧编码
+ * @param  huart: UART句柄指针
+ * @retval true: 请求已发送, false: 发送失败
+ * @note   对端回复请求后本端也开始编码，请求丢失时可再次调用
+ */
+bool comm_fec_enable(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  请求对端停止编码
+ * @param  huart: UART句柄指针
+ * @retval true: 请求已发送, false: 发送失败
+ */
+bool comm_fec_disable(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  发送的帧是否加纠错外壳
+ * @param  huart: UART句柄指针
+ * @retval true: 编码发送, false: 按普通帧发送
+ */
+bool comm_fec_is_active(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取纠错统计
+ * @param  huart: UART句柄指针
+ * @param  stats: 统计输出
+ * @retval true: 获取成功, false: 未找到实例
+ */
+bool comm_fec_get_stats(UART_HandleTypeDef *huart, comm_fec_stats_t *stats);
+
+/**
+ * @brief  计算RS校验字节
+ * @param  data: 信息字节
+ * @param  length: 信息字节数，不超过255-COMM_FEC_PARITY
+ * @param  parity: 输出COMM_FEC_PARITY个校验字节
+ * @retval None
+ */
+void comm_fec_encode(const uint8_t *data, uint16_t length, uint8_t *parity);
+
+/**
+ * @brief  原地纠正一个码块
+ * @param  block: 信息字节后紧跟COMM_FEC_PARITY个校验字节
+ * @param  length: 码块总长度（含校验字节），不超过255
+ * @retval 纠正的字节数（0表示无错误），无法纠正返回-1
+ */
+int comm_fec_decode(uint8_t *block, uint16_t length);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  初始化纠错模块（计算生成多项式）
+ * @param  None
+ * @retval None
+ * @note   由comm_init()调用，之后comm_fec_encode()才能使用
+ */
+void comm_fec_init(void);
+
+/**
+ * @brief  表决长度字段
+ * @param  header: COMM_FEC_HEADER_SIZE个长度字符
+ * @param  slot_size: 接收槽大小
+ * @retval 内层帧长度，表决失败或放不下接收槽返回-1
+ * @note   在接收中断中调用
+ */
+int16_t comm_fec_header_length(const char *header, uint16_t slot_size);
+
+/**
+ * @brief  对端请求纠错时给构建好的帧加外壳
+ * @param  instance: 实例指针
+ * @param  buffer: 帧缓冲区，帧从开头开始
+ * @param  size: 缓冲区大小
+ * @param  length: 输入帧长度，输出加外壳后的长度
+ * @retval None
+ * @note   由帧序列化器在帧结束时调用；放不下时保持普通帧
+ */
+void comm_fec_wrap(comm_instance_t *instance, char *buffer, uint16_t size, uint16_t *length);
+
+/**
+ * @brief  纠正并解析接收槽中的纠错帧
+ * @param  instance: 实例指针
+ * @param  frame: 接收槽中的帧
+ * @retval true: 普通帧或纠错成功（字段已解析）, false: 丢弃该帧
+ * @note   由comm_tick()在处理帧之前调用
+ */
+bool comm_fec_decode_frame(comm_instance_t *instance, comm_frame_t *frame);
+
+/**
+ * @brief  处理纠错请求帧
+ * @param  instance: 实例指针
+ * @param  frame: 接收到的帧
+ * @retval true: 已处理（FEC帧）, false: 不是FEC帧
+ */
+bool comm_fec_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+#endif /* COMM_ENABLE_FEC */
+
+#endif /* COMM_FEC_H */
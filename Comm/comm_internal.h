@@ -24,15 +24,45 @@
  * =============================================================================
  */
 
-/** @brief 最大支持的UART实例数量 */
-#define COMM_MAX_INSTANCES          8
+/** @brief 最大支持的UART实例数量，实例表按此静态分配，请按实际使用的UART数设置 */
+#define COMM_MAX_INSTANCES          4
 
-/** @brief 接收缓冲区大小（字节） */
+/** @brief 默认接收缓冲区大小（字节），也是comm_add_uart_with_buffers()接收缓冲区的上限 */
 #define COMM_RX_BUFFER_SIZE         256
 
-/** @brief 发送缓冲区大小（字节） */
+/** @brief 接收帧槽数量（2的幂），中断可在前面的帧等待处理时继续接收 */
+#define COMM_RX_FRAME_SLOTS         2
+
+/** @brief 每个接收槽的大小（接收缓冲区平分给各个槽） */
+#define COMM_RX_SLOT_SIZE           (COMM_RX_BUFFER_SIZE / COMM_RX_FRAME_SLOTS)
+
+#if (COMM_RX_FRAME_SLOTS & (COMM_RX_FRAME_SLOTS - 1)) != 0
+#error "COMM_RX_FRAME_SLOTS必须是2的幂"
+#endif
+
+/** @brief 默认发送缓冲区大小（字节），也是comm_add_uart_with_buffers()发送缓冲区的上限 */
 #define COMM_TX_BUFFER_SIZE         128
 
+/** @brief comm_add_uart()使用的默认缓冲区套数，其余实例需用comm_add_uart_with_buffers()提供缓冲区 */
+#define COMM_DEFAULT_BUFFER_COUNT   COMM_MAX_INSTANCES
+
+/** @brief 用户缓冲区下限（字节）：每个接收槽和发送缓冲区都要放得下ACK和各种通告数据报 */
+#define COMM_MIN_BUFFER_SIZE        32
+
+/** @brief 静态RAM预算（字节），非0时编译期检查COMM_STATIC_RAM_BYTES不超过该值，并输出当前配置 */
+#define COMM_RAM_BUDGET             0
+
+/** @brief 默认缓冲区池总大小（字节） */
+#define COMM_DEFAULT_BUFFER_BYTES   (COMM_DEFAULT_BUFFER_COUNT * (COMM_RX_BUFFER_SIZE + COMM_TX_BUFFER_SIZE))
+
+#if COMM_DEFAULT_BUFFER_COUNT > COMM_MAX_INSTANCES
+#error "COMM_DEFAULT_BUFFER_COUNT不能大于COMM_MAX_INSTANCES"
+#endif
+
+#if COMM_RX_SLOT_SIZE < COMM_MIN_BUFFER_SIZE || COMM_TX_BUFFER_SIZE < COMM_MIN_BUFFER_SIZE
+#error "默认接收槽和发送缓冲区不能小于COMM_MIN_BUFFER_SIZE"
+#endif
+
 /** @brief 每个UART最大回调函数数量 */
 #define COMM_MAX_CALLBACKS          8
 
@@ -79,8 +109,8 @@
 /** @brief 帧接收超时时间（毫秒） */
 #define COMM_FRAME_TIMEOUT_MS       100
 
-/** @brief 序列号最大值（8位） */
-#define COMM_MAX_SEQUENCE           255
+/** @brief 序列号接受窗口：比上次接收的序列号大1~该值的帧视为新帧（允许中间丢帧） */
+#define COMM_SEQ_ACCEPT_WINDOW      10
 
 /* =============================================================================
  * 特殊命令定义
@@ -99,6 +129,410 @@
 /** @brief PONG心跳响应命令 */
 #define COMM_CMD_PONG               "PONG"
 
+/** @brief 订阅主题命令，数据格式: TOPIC,PERIOD_MS */
+#define COMM_CMD_SUB                "SUB"
+
+/** @brief 取消订阅命令，数据格式: TOPIC */
+#define COMM_CMD_UNSUB              "USUB"
+
+/** @brief 主题发布命令，数据格式: TOPIC=VALUE;TOPIC=VALUE */
+#define COMM_CMD_PUB                "PUB"
+
+/** @brief NAK原因：接收方队列满，发送方应等待一个超时周期再重发，数据格式: SS,BUSY */
+#define COMM_NAK_REASON_BUSY        "BUSY"
+
+/** @brief NAK原因：序列号不在接受窗口内（只在启用会话时发给对端，对端据此重新通告序列号） */
+#define COMM_NAK_REASON_SEQ         "SEQ_ERROR"
+
+/** @brief RS-485主站轮询命令，从站收到后发送积压的命令或回复PRDY */
+#define COMM_CMD_POLL               "POLL"
+
+/** @brief RS-485从站轮询应答：无待发送命令 */
+#define COMM_CMD_POLL_EMPTY         "PRDY"
+
+/** @brief 流控额度通告，数据为空闲接收槽数量；数据为"?"时请求对端通告 */
+#define COMM_CMD_CREDIT             "CRD"
+
+/** @brief 批量命令帧，数据为以COMM_BATCH_SEPARATOR分隔的多条"CMD:DATA" */
+#define COMM_CMD_BATCH              "BAT"
+
+/** @brief 压缩能力通告，数据为"1"表示本端可以解压 */
+#define COMM_CMD_COMPRESS           "CMP"
+
+/** @brief 链路探测，数据格式: Q,ID[,S]（探测）/ R,ID[,S]（应答），S表示序列号已重新同步 */
+#define COMM_CMD_LINK               "LNK"
+
+/** @brief 会话握手，数据格式: H,EPOCH,SEQ（通告）/ A,EPOCH,SEQ（应答），SEQ为对端应接受的下一个序列号 */
+#define COMM_CMD_SESSION            "SES"
+
+/** @brief 纠错请求，数据为"1"请求对端对发往本端的帧编码，"0"取消 */
+#define COMM_CMD_FEC                "FEC"
+
+/** @brief 聚合链路分片，数据格式: MMIN+分片内容，MM为消息号，I为分片序号，N为分片数（见comm_bond.h） */
+#define COMM_CMD_BOND               "BND"
+
+/** @brief 远程查询，数据格式: Q,K[,IDX]（查询）/ R,K,IDX,字段...（应答）/ E,K,IDX（不支持），见comm_query.h */
+#define COMM_CMD_QUERY              "QRY"
+
+/** @brief 时钟同步，数据格式: Q,ID（请求）/ R,ID,T2（应答）/ F,ID,T3（跟随），见comm_clock.h */
+#define COMM_CMD_CLOCK              "CLK"
+
+/* =============================================================================
+ * 发布/订阅配置
+ * =============================================================================
+ */
+
+/** @brief 启用发布/订阅主题层 */
+#define COMM_ENABLE_PUBSUB          0
+
+/** @brief 每个UART最多主题数量（发布和订阅各自独立计数） */
+#define COMM_PUBSUB_MAX_TOPICS      4
+
+/** @brief 主题名最大长度 */
+#define COMM_PUBSUB_MAX_TOPIC_LENGTH 8
+
+/** @brief 主题值最大长度 */
+#define COMM_PUBSUB_MAX_VALUE_LENGTH 24
+
+/** @brief 一条PUB帧中多个主题之间的分隔符 */
+#define COMM_PUBSUB_ENTRY_SEPARATOR ';'
+
+/** @brief 主题名和值之间的分隔符 */
+#define COMM_PUBSUB_VALUE_SEPARATOR '='
+
+/* =============================================================================
+ * RS-485多点总线配置
+ * =============================================================================
+ */
+
+/** @brief 启用RS-485节点寻址和半双工收发控制 */
+#define COMM_ENABLE_RS485           0
+
+/** @brief 地址分隔符，寻址帧格式: {CMD:DATA#SEQ@DDSS#CRC}，DD目标地址，SS源地址 */
+#define COMM_ADDR_SEPARATOR         '@'
+
+/** @brief 总线最大节点数（节点地址范围0 ~ COMM_RS485_MAX_NODES-1） */
+#define COMM_RS485_MAX_NODES        32
+
+/** @brief 广播地址，广播帧所有节点接收且不回ACK */
+#define COMM_RS485_BROADCAST_ADDR   0xFF
+
+/** @brief 主站默认地址，从站命令默认发往该地址 */
+#define COMM_RS485_MASTER_ADDR      0x00
+
+/** @brief 主站轮询的默认应答时限（毫秒），超时视为该从站无应答 */
+#define COMM_RS485_DEFAULT_TURNAROUND_MS 20
+
+/* =============================================================================
+ * 帧路由配置
+ * =============================================================================
+ */
+
+/** @brief 启用实例间帧路由/桥接 */
+#define COMM_ENABLE_ROUTER          0
+
+/** @brief 最大路由条目数 */
+#define COMM_ROUTER_MAX_ROUTES      4
+
+/** @brief 每条路由的转发队列深度（帧） */
+#define COMM_ROUTE_QUEUE_DEPTH      4
+
+/* =============================================================================
+ * 发送优先级配置
+ * =============================================================================
+ */
+
+/** @brief 启用发送优先级队列 */
+#define COMM_ENABLE_PRIORITY        0
+
+/** @brief 每个优先级队列的深度（命令数） */
+#define COMM_PRIORITY_QUEUE_DEPTH   4
+
+/** @brief 调度方式：0严格优先级，1加权（高优先级连续发送WEIGHT帧后让低优先级发送一帧） */
+#define COMM_PRIORITY_WEIGHTED      0
+
+/** @brief 加权调度时高优先级连续发送的帧数 */
+#define COMM_PRIORITY_URGENT_WEIGHT 4
+
+/* =============================================================================
+ * 流控配置
+ * =============================================================================
+ */
+
+/** @brief 启用基于额度的流控（接收方通告空闲接收槽，发送方额度用完时暂停） */
+#define COMM_ENABLE_CREDITS         0
+
+/** @brief 额度耗尽后多久（毫秒）向对端发送额度查询，防止通告帧丢失后一直等待 */
+#define COMM_CREDIT_PROBE_MS        50
+
+/* =============================================================================
+ * 波特率协商配置
+ * =============================================================================
+ */
+
+/** @brief 启用波特率协商和运行时升速/回退 */
+#define COMM_ENABLE_BAUD            0
+
+/** @brief 可协商的波特率（从低到高，最多16个），双方的表必须一致 */
+#define COMM_BAUD_RATE_TABLE        { 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600 }
+
+/** @brief 波特率表长度 */
+#define COMM_BAUD_RATE_COUNT        8
+
+/** @brief 收到切换确认后等待多久（毫秒）再切换，需大于旧波特率下一帧的传输时间 */
+#define COMM_BAUD_SWITCH_DELAY_MS   20
+
+/** @brief 等待对端能力/切换应答的时限（毫秒），需覆盖命令的全部重试 */
+#define COMM_BAUD_REPLY_TIMEOUT_MS  1000
+
+/** @brief 切换后验证新波特率的时限（毫秒），超时回到原波特率 */
+#define COMM_BAUD_VERIFY_TIMEOUT_MS 100
+
+/** @brief 验证期间发送检查帧的间隔（毫秒） */
+#define COMM_BAUD_CHECK_INTERVAL_MS 20
+
+/** @brief 误码统计窗口（毫秒） */
+#define COMM_BAUD_ERROR_WINDOW_MS   1000
+
+/** @brief 窗口内接收错误（CRC/帧超时/UART错误）超过该值时回退到升速前的波特率 */
+#define COMM_BAUD_ERROR_THRESHOLD   5
+
+/* =============================================================================
+ * 批量命令配置
+ * =============================================================================
+ */
+
+/** @brief 启用批量命令（多条命令合并为一帧、一个ACK） */
+#define COMM_ENABLE_BATCH           0
+
+/** @brief 批量帧中命令之间的分隔符，批量发送的数据中不能包含该字符 */
+#define COMM_BATCH_SEPARATOR        ';'
+
+/** @brief 批量帧数据部分最大长度（发送缓冲区减去帧头、序列号、地址和CRC） */
+#define COMM_BATCH_MAX_LENGTH       (COMM_TX_BUFFER_SIZE - 24)
+
+/* =============================================================================
+ * 数据压缩配置
+ * =============================================================================
+ */
+
+/** @brief 启用数据字段压缩（双方通告后才压缩） */
+#define COMM_ENABLE_COMPRESS        0
+
+/** @brief 压缩标记：命令后缀表示数据已压缩，数据中作为回溯引用的转义符 */
+#define COMM_COMPRESS_MARK          '~'
+
+/** @brief 数据短于该长度时不尝试压缩 */
+#define COMM_COMPRESS_MIN_LENGTH    16
+
+/* =============================================================================
+ * 链路监测配置
+ * =============================================================================
+ */
+
+/** @brief 启用后台心跳和链路质量监测 */
+#define COMM_ENABLE_LINK            0
+
+/** @brief 心跳探测间隔（毫秒） */
+#define COMM_LINK_INTERVAL_MS       100
+
+/** @brief 超过该时间（毫秒）没有收到探测应答判定链路断开，应大于两个探测间隔 */
+#define COMM_LINK_DOWN_MS           350
+
+/** @brief 链路恢复后重新同步序列号（与comm_instance_reset()一样从1开始） */
+#define COMM_LINK_RESYNC            1
+
+/* =============================================================================
+ * 会话配置
+ * =============================================================================
+ */
+
+/** @brief 启用会话握手和16位序列号（通信双方必须一致） */
+#define COMM_ENABLE_SESSION         0
+
+/** @brief 本端会话纪元，每次上电应不同（0保留）；有RNG外设的芯片建议改为硬件随机数 */
+#define COMM_SESSION_EPOCH()        ((uint16_t)((HAL_GetTick() << 8) ^ SysTick->VAL))
+
+/** @brief 启动时会话通告的重发间隔（毫秒） */
+#define COMM_SESSION_HELLO_MS       200
+
+/** @brief 启动时会话通告最多发送次数，对端未启用会话时不再打扰 */
+#define COMM_SESSION_HELLO_COUNT    5
+
+#if COMM_ENABLE_SESSION
+/** @brief 序列号最大值（16位） */
+#define COMM_MAX_SEQUENCE           0xFFFF
+/** @brief 帧中序列号的十六进制位数 */
+#define COMM_SEQ_DIGITS             4
+#else
+/** @brief 序列号最大值（8位） */
+#define COMM_MAX_SEQUENCE           255
+/** @brief 帧中序列号的十六进制位数 */
+#define COMM_SEQ_DIGITS             2
+#endif
+
+#if COMM_SEQ_ACCEPT_WINDOW < 1 || COMM_SEQ_ACCEPT_WINDOW >= COMM_MAX_SEQUENCE / 2
+#error "COMM_SEQ_ACCEPT_WINDOW必须在1到序列号空间的一半之间"
+#endif
+
+/* =============================================================================
+ * 前向纠错配置
+ * =============================================================================
+ */
+
+/** @brief 启用前向纠错（Reed-Solomon，对端请求后才对发送的帧编码，接收方向总是能纠错） */
+#define COMM_ENABLE_FEC             0
+
+/** @brief 每帧的RS校验字节数，最多纠正一半数量的错误字节（通信双方必须一致） */
+#define COMM_FEC_PARITY             8
+
+/** @brief 纠错帧起始符，纠错帧格式: [LLLLLL{CMD:DATA#SEQ#CRC}PP..PP]，见comm_fec.h */
+#define COMM_FEC_FRAME_START        '['
+
+#if COMM_FEC_PARITY < 2 || COMM_FEC_PARITY > 32 || (COMM_FEC_PARITY & 1) != 0
+#error "COMM_FEC_PARITY必须是2~32之间的偶数"
+#endif
+
+/* =============================================================================
+ * 链路聚合配置
+ * =============================================================================
+ */
+
+/** @brief 启用链路聚合（一个逻辑通道的消息分片后分散到多个UART发送） */
+#define COMM_ENABLE_BOND            0
+
+/** @brief 最大聚合通道数 */
+#define COMM_BOND_MAX_BONDS         1
+
+/** @brief 每个聚合通道最多的成员链路数 */
+#define COMM_BOND_MAX_MEMBERS       4
+
+/** @brief 每个分片携带的消息字节数，加4字符分片头后须小于COMM_MAX_DATA_LENGTH */
+#define COMM_BOND_FRAGMENT_SIZE     56
+
+/** @brief 一条消息（"CMD:DATA"）的最大长度 */
+#define COMM_BOND_MAX_MESSAGE       224
+
+/** @brief 发送和重排窗口（消息条数，2的幂），各占COMM_BOND_WINDOW * COMM_BOND_MAX_MESSAGE字节 */
+#define COMM_BOND_WINDOW            4
+
+/** @brief 成员链路发送失败后暂停使用的时间（毫秒），到期后再试 */
+#define COMM_BOND_RETRY_MS          1000
+
+/** @brief 后面的消息已收齐而当前消息仍缺分片时，等待多久（毫秒）后跳过，应大于成员链路重试放弃的总时间 */
+#define COMM_BOND_REORDER_TIMEOUT_MS 5000
+
+#if COMM_BOND_FRAGMENT_SIZE + 4 >= COMM_MAX_DATA_LENGTH
+#error "COMM_BOND_FRAGMENT_SIZE加分片头必须小于COMM_MAX_DATA_LENGTH"
+#endif
+
+#if COMM_BOND_MAX_MESSAGE > 7 * COMM_BOND_FRAGMENT_SIZE
+#error "COMM_BOND_MAX_MESSAGE最多为7个分片"
+#endif
+
+#if COMM_BOND_WINDOW > 32 || (COMM_BOND_WINDOW & (COMM_BOND_WINDOW - 1)) != 0
+#error "COMM_BOND_WINDOW必须是不超过32的2的幂"
+#endif
+
+/* =============================================================================
+ * 远程查询配置
+ * =============================================================================
+ */
+
+/** @brief 启用远程查询（库直接应答QRY命令，返回统计、状态、队列深度和配置快照） */
+#define COMM_ENABLE_QUERY           0
+
+/** @brief 允许通过一个实例查询其它实例（0时只应答收到查询的实例自身） */
+#define COMM_QUERY_ANY_INSTANCE     1
+
+/* =============================================================================
+ * 持久化发送队列配置
+ * =============================================================================
+ */
+
+/** @brief 启用持久化发送队列（消息写入Flash等存储，链路断开和重启后保留，恢复后按顺序补发） */
+#define COMM_ENABLE_STORE           0
+
+/** @brief 最多挂接持久化队列的实例数 */
+#define COMM_STORE_MAX_QUEUES       1
+
+/** @brief 存储的擦除单位（字节），存储区大小必须是它的整数倍 */
+#define COMM_STORE_SECTOR_SIZE      2048
+
+/** @brief 补发失败（对端无应答）后暂停补发的时间（毫秒） */
+#define COMM_STORE_RETRY_MS         1000
+
+/** @brief 启用批量命令时每帧最多合并的消息条数 */
+#define COMM_STORE_BATCH_MAX        8
+
+/* =============================================================================
+ * 时钟同步配置
+ * =============================================================================
+ */
+
+/** @brief 启用时钟同步（估计与对端时钟的偏差和漂移，把本地时间戳换算到主时钟） */
+#define COMM_ENABLE_CLOCK           0
+
+/** @brief 最多同时向对端同步时钟的实例数（作为主时钟应答不受限制） */
+#define COMM_CLOCK_MAX_PEERS        1
+
+/** @brief 默认同步间隔（毫秒） */
+#define COMM_CLOCK_INTERVAL_MS      1000
+
+/** @brief 参与拟合偏差和漂移的样本数，窗口跨度（样本数 x 间隔）不要超过15分钟 */
+#define COMM_CLOCK_WINDOW           8
+
+/** @brief 至少有这么多样本才认为已同步 */
+#define COMM_CLOCK_MIN_SAMPLES      3
+
+/** @brief 往返延迟超过窗口内最小延迟的2倍再加这个余量（微秒）时丢弃样本 */
+#define COMM_CLOCK_DELAY_MARGIN_US  200
+
+/** @brief 样本偏离拟合结果超过这个值（微秒）时认为对端时钟跳变，重新开始拟合 */
+#define COMM_CLOCK_STEP_US          5000
+
+/* =============================================================================
+ * RTOS运行时配置
+ * =============================================================================
+ */
+
+/** @brief 启用FreeRTOS运行时（通信任务代替定时器中断调用comm_tick()，需要静态分配） */
+#define COMM_ENABLE_RTOS            0
+
+/** @brief 通信任务栈大小（字） */
+#define COMM_RTOS_STACK_WORDS       384
+
+/** @brief 通信任务优先级，应高于发送命令的应用任务 */
+#define COMM_RTOS_TASK_PRIORITY     3
+
+/** @brief 发送请求队列长度（所有实例共用） */
+#define COMM_RTOS_QUEUE_LENGTH      8
+
+/** @brief 没有任何期限时通信任务的最长休眠时间（毫秒），用于心跳、通告等周期处理 */
+#define COMM_RTOS_IDLE_MS           10
+
+/** @brief 异步发送请求等待链路空闲的最长时间（毫秒），过期按失败回调通知 */
+#define COMM_RTOS_REQUEST_TTL_MS    1000
+
+/* =============================================================================
+ * 抓包回放配置
+ * =============================================================================
+ */
+
+/** @brief 启用抓包（记录收发字节流、时刻和comm_tick()调用，供主机回放） */
+#define COMM_ENABLE_CAPTURE         0
+
+/* 功能开关掩码，远程查询的配置快照和抓包日志头中使用（RTOS、抓包本身不影响线路上的行为，不计入） */
+#define COMM_FEATURE_MASK ((uint16_t)(                             \
+    (COMM_ENABLE_PUBSUB   << 0) | (COMM_ENABLE_RS485    << 1) |     \
+    (COMM_ENABLE_ROUTER   << 2) | (COMM_ENABLE_PRIORITY << 3) |     \
+    (COMM_ENABLE_CREDITS  << 4) | (COMM_ENABLE_BAUD     << 5) |     \
+    (COMM_ENABLE_BATCH    << 6) | (COMM_ENABLE_COMPRESS << 7) |     \
+    (COMM_ENABLE_LINK     << 8) | (COMM_ENABLE_SESSION  << 9) |     \
+    (COMM_ENABLE_FEC      << 10) | (COMM_ENABLE_BOND     << 11) |   \
+    (COMM_ENABLE_QUERY    << 12) | (COMM_ENABLE_STORE    << 13) |   \
+    (COMM_ENABLE_CLOCK    << 14)))
+
 /* =============================================================================
  * 调试和性能配置
  * =============================================================================
@@ -110,6 +544,9 @@
 /** @brief 启用统计功能 */
 #define COMM_ENABLE_STATS           0
 
+/** @brief ACK延迟直方图的桶数：第0个桶为0~1ms，第i个桶为[2^i, 2^(i+1))ms，最后一个桶含更长的延迟 */
+#define COMM_STATS_DELAY_BUCKETS    8
+
 /** @brief 启用快速CRC计算 */
 #define COMM_ENABLE_FAST_CRC        1
 
@@ -126,6 +563,30 @@ typedef void (*comm_state_change_callback_t)(UART_HandleTypeDef *huart,
                                             const char* from_state, 
                                             const char* to_state, 
                                             uint8_t retry_count);
+typedef void (*comm_callback_ex_t)(UART_HandleTypeDef *huart,
+                                   const char *cmd,
+                                   const char *data,
+                                   uint16_t data_len,
+                                   void *user_ctx);
+typedef void (*comm_fail_callback_ex_t)(UART_HandleTypeDef *huart,
+                                        const char *cmd,
+                                        const char *data,
+                                        uint16_t data_len,
+                                        const char *reason,
+                                        void *user_ctx);
+typedef void (*comm_state_change_callback_ex_t)(UART_HandleTypeDef *huart,
+                                               const char *from_state,
+                                               const char *to_state,
+                                               uint8_t retry_count,
+                                               void *user_ctx);
+typedef void (*comm_topic_callback_t)(UART_HandleTypeDef *huart,
+                                      const char *topic,
+                                      const char *value,
+                                      uint16_t value_len,
+                                      void *user_ctx);
+typedef void (*comm_link_callback_t)(UART_HandleTypeDef *huart,
+                                     bool link_up,
+                                     void *user_ctx);
 
 /* =============================================================================
  * 内部错误码定义
@@ -175,9 +636,13 @@ typedef enum {
     FRAME_STATE_DATA,               /**< 解析数据部分 */
     FRAME_STATE_WAIT_HASH1,         /**< 等待第一个井号 '#' */
     FRAME_STATE_SEQ,                /**< 解析序列号 */
+    FRAME_STATE_ADDR,               /**< 解析地址（RS-485寻址帧） */
     FRAME_STATE_WAIT_HASH2,         /**< 等待第二个井号 '#' */
     FRAME_STATE_CRC,                /**< 解析CRC */
     FRAME_STATE_WAIT_END,           /**< 等待帧结束 '}' */
+    FRAME_STATE_FEC_HEADER,         /**< 纠错帧：接收长度字段 */
+    FRAME_STATE_FEC_BODY,           /**< 纠错帧：原样接收内层帧 */
+    FRAME_STATE_FEC_PARITY,         /**< 纠错帧：接收校验字节 */
     FRAME_STATE_COMPLETE,           /**< 帧解析完成 */
     FRAME_STATE_ERROR               /**< 解析错误状态 */
 } frame_parse_state_t;
@@ -189,7 +654,10 @@ typedef enum {
 
 typedef struct {
     char cmd[COMM_MAX_CMD_LENGTH + 1];      /**< 命令字符串 */
+    uint8_t cmd_len;                        /**< 命令长度（匹配时先比长度） */
     comm_callback_t callback;               /**< 回调函数指针 */
+    comm_callback_ex_t callback_ex;         /**< 带上下文的回调函数指针 */
+    void *user_ctx;                         /**< 用户上下文 */
     bool is_used;                           /**< 是否已使用 */
 } comm_handler_t;
 
@@ -216,9 +684,10 @@ struct comm_stats_t {
     uint32_t rx_seq_error;                  /**< 序列号错误次数 */
     
     /* 性能统计 */
-    uint32_t avg_delay_ms;                  /**< 平均响应延迟(ms) */
+    uint32_t avg_delay_ms;                  /**< 平均响应延迟(ms)，按1/8权重滑动平均 */
     uint32_t max_delay_ms;                  /**< 最大响应延迟(ms) */
     uint32_t min_delay_ms;                  /**< 最小响应延迟(ms) */
+    uint32_t delay_hist[COMM_STATS_DELAY_BUCKETS]; /**< 响应延迟直方图 */
     
     /* 其他统计 */
     uint32_t ping_count;                    /**< PING次数 */
@@ -238,14 +707,49 @@ typedef struct comm_stats_t comm_stats_t;
  * =============================================================================
  */
 
+/** @brief 序列号类型（启用会话后为16位） */
+#if COMM_ENABLE_SESSION
+typedef uint16_t comm_seq_t;
+#else
+typedef uint8_t comm_seq_t;
+#endif
+
+/*
+ * 接收帧不再拷贝字段内容，只记录命令/数据在所属接收槽rx_buffer[slot]中的位置。
+ * 解析时分隔符':'和'#'的位置被原地改写为'\0'，因此视图既有长度也以'\0'结尾。
+ * 视图在comm_handle_complete_frame()返回前有效，回调中如需保留数据请自行拷贝。
+ */
 typedef struct {
-    char cmd[COMM_MAX_CMD_LENGTH + 1];      /**< 命令字符串 */
-    char data[COMM_MAX_DATA_LENGTH + 1];    /**< 数据字符串 */
-    uint8_t sequence;                       /**< 序列号 */
+    uint8_t slot;                           /**< 所在接收槽 */
+    uint16_t cmd_offset;                    /**< 命令在rx_buffer中的偏移 */
+    uint8_t cmd_len;                        /**< 命令长度 */
+    uint16_t data_offset;                   /**< 数据在rx_buffer中的偏移 */
+    uint16_t data_len;                      /**< 数据长度 */
+    comm_seq_t sequence;                    /**< 序列号 */
     uint8_t crc;                            /**< CRC校验值 */
     bool is_valid;                          /**< 帧是否有效 */
+#if COMM_ENABLE_ROUTER
+    uint8_t crc_partial;                    /**< "CMD:DATA#"部分的CRC，转发时只需续算新的序列号 */
+#endif
+#if COMM_ENABLE_RS485
+    bool has_address;                       /**< 是否为寻址帧 */
+    uint8_t dst_addr;                       /**< 目标地址 */
+    uint8_t src_addr;                       /**< 源地址 */
+#endif
+#if COMM_ENABLE_FEC
+    uint8_t fec_length;                     /**< 纠错帧内层帧的长度，0为普通帧；纠错帧在comm_tick()中纠错后才解析字段 */
+#endif
+#if COMM_ENABLE_CLOCK
+    uint32_t rx_time_us;                    /**< 收到帧尾时的本地时间戳（微秒） */
+#endif
 } comm_frame_t;
 
+/** @brief 获取帧命令视图 */
+#define COMM_FRAME_CMD(instance, frame)     ((const char *)&(instance)->rx_buffer[(frame)->slot][(frame)->cmd_offset])
+
+/** @brief 获取帧数据视图 */
+#define COMM_FRAME_DATA(instance, frame)    ((const char *)&(instance)->rx_buffer[(frame)->slot][(frame)->data_offset])
+
 /* =============================================================================
  * 环形缓冲区（可选）
  * =============================================================================
@@ -261,6 +765,232 @@ typedef struct {
 } comm_ring_buffer_t;
 #endif
 
+/* =============================================================================
+ * 发布/订阅主题表（可选）
+ * =============================================================================
+ */
+
+#if COMM_ENABLE_PUBSUB
+/* 本端发布的主题：只保存最新值，按对端订阅的周期合并发送 */
+typedef struct {
+    char name[COMM_PUBSUB_MAX_TOPIC_LENGTH + 1];    /**< 主题名 */
+    char value[COMM_PUBSUB_MAX_VALUE_LENGTH + 1];   /**< 最新值 */
+    uint8_t qos;                            /**< 可靠性，见comm_topic_qos_t */
+    bool is_used;                           /**< 是否已使用 */
+    bool advertised;                        /**< 本端已声明；为false时只记录了先到的订阅 */
+    bool dirty;                             /**< 有未发布的新值 */
+    bool subscribed;                        /**< 对端已订阅 */
+    uint16_t period_ms;                     /**< 对端期望的最小发布间隔 */
+    uint32_t last_publish_time;             /**< 上次发布时间 */
+} comm_topic_t;
+
+/* 本端订阅的主题 */
+typedef struct {
+    char name[COMM_PUBSUB_MAX_TOPIC_LENGTH + 1];    /**< 主题名 */
+    uint16_t period_ms;                     /**< 期望的发布间隔 */
+    comm_topic_callback_t callback;         /**< 主题更新回调 */
+    void *user_ctx;                         /**< 用户上下文 */
+    bool is_used;                           /**< 是否已使用 */
+    bool request_pending;                   /**< SUB/USUB请求待发送 */
+} comm_subscription_t;
+
+typedef struct {
+    comm_topic_t topics[COMM_PUBSUB_MAX_TOPICS];                /**< 发布的主题 */
+    comm_subscription_t subscriptions[COMM_PUBSUB_MAX_TOPICS];  /**< 订阅的主题 */
+} comm_pubsub_t;
+#endif
+
+/* =============================================================================
+ * RS-485总线状态（可选）
+ * =============================================================================
+ */
+
+#if COMM_ENABLE_RS485
+/*
+ * 同一条总线上每个对端节点各自维护一套收发序列号，
+ * tx_sequence/rx_sequence始终对应peer_addr/rx_peer，切换对端时与序列号表交换。
+ */
+typedef struct {
+    bool enabled;                           /**< 是否启用寻址帧 */
+    uint8_t role;                           /**< 节点角色，见comm_rs485_role_t */
+    uint8_t node_addr;                      /**< 本节点地址 */
+    uint8_t peer_addr;                      /**< 命令和数据报的目标地址 */
+    uint8_t rx_peer;                        /**< 最近一帧的源地址，ACK/NAK发往该地址 */
+    GPIO_TypeDef *de_port;                  /**< DE/RE控制端口，NULL表示收发器自动切换方向 */
+    uint16_t de_pin;                        /**< DE/RE控制引脚（高电平发送） */
+    volatile bool de_active;                /**< 正在驱动总线 */
+    bool tx_deferred;                       /**< 从站：命令已在tx_buffer中，等待被轮询时发送 */
+    comm_seq_t tx_seq_table[COMM_RS485_MAX_NODES]; /**< 各节点的发送序列号 */
+    comm_seq_t rx_seq_table[COMM_RS485_MAX_NODES]; /**< 各节点的接收序列号 */
+    
+    /* 主站轮询 */
+    uint8_t slaves[COMM_RS485_MAX_NODES];   /**< 轮询列表 */
+    uint8_t slave_count;                    /**< 轮询列表长度 */
+    uint8_t poll_index;                     /**< 下一个轮询位置 */
+    uint8_t polled_addr;                    /**< 正在等待应答的从站 */
+    bool polling;                           /**< 轮询已启动 */
+    bool poll_outstanding;                  /**< 正在等待从站应答 */
+    uint16_t poll_interval_ms;              /**< 两次轮询之间的最小间隔 */
+    uint16_t turnaround_ms;                 /**< 从站应答时限 */
+    uint32_t poll_start_time;               /**< 本次轮询发出时间 */
+    uint32_t last_poll_time;                /**< 上次轮询结束时间 */
+    uint32_t poll_timeouts;                 /**< 轮询无应答次数 */
+} comm_rs485_t;
+#endif
+
+/* =============================================================================
+ * 发送优先级队列（可选）
+ * =============================================================================
+ */
+
+#if COMM_ENABLE_PRIORITY
+/** @brief 排队的命令数量（URGENT/NORMAL/BULK三个队列），ACK/NAK等控制帧不排队 */
+#define COMM_PRIORITY_LANES         3
+
+/** @brief 没有排队命令在发送 */
+#define COMM_PRIORITY_NONE          0xFF
+
+typedef struct {
+    char cmd[COMM_MAX_CMD_LENGTH];          /**< 命令 */
+    char data[COMM_MAX_DATA_LENGTH];        /**< 数据 */
+} comm_queued_cmd_t;
+
+typedef struct {
+    comm_queued_cmd_t items[COMM_PRIORITY_QUEUE_DEPTH];  /**< 环形队列 */
+    uint8_t head;                           /**< 队头 */
+    uint8_t count;                          /**< 队列长度 */
+} comm_lane_t;
+
+typedef struct {
+    comm_lane_t lanes[COMM_PRIORITY_LANES]; /**< 各优先级队列，下标即优先级 */
+    uint8_t in_flight;                      /**< 正在发送/等待ACK的命令所属优先级 */
+    uint8_t streak;                         /**< 加权调度：高优先级已连续发送的帧数 */
+    uint32_t preempted;                     /**< BULK命令被抢占的次数 */
+} comm_priority_queue_t;
+#endif
+
+/* =============================================================================
+ * 流控额度（可选）
+ * =============================================================================
+ */
+
+#if COMM_ENABLE_CREDITS
+/** @brief 对端未通告额度（未启用流控），发送不受限制 */
+#define COMM_CREDIT_UNLIMITED       0xFF
+
+typedef struct {
+    uint8_t peer_credits;                   /**< 对端还能接收的帧数 */
+    uint8_t granted;                        /**< 上次通告给对端的额度 */
+    uint8_t used;                           /**< 通告之后已收到的帧数 */
+    uint32_t blocked_since;                 /**< 额度耗尽的时间 */
+    uint32_t last_probe;                    /**< 上次查询额度的时间 */
+    uint32_t stalls;                        /**< 因额度耗尽暂停发送的次数 */
+} comm_credit_t;
+#endif
+
+/* =============================================================================
+ * 波特率协商（可选）
+ * =============================================================================
+ */
+
+#if COMM_ENABLE_BAUD
+typedef struct {
+    uint32_t base_baud;                     /**< 初始（CubeMX配置的）波特率 */
+    uint32_t fallback_baud;                 /**< 升速前的波特率，误码过多时回退 */
+    uint32_t target_baud;                   /**< 正在切换的目标波特率 */
+    uint16_t local_mask;                    /**< 本端支持的波特率（位i对应表中第i个） */
+    uint16_t candidates;                    /**< 双方都支持且尚未失败的波特率 */
+    uint8_t phase;                          /**< 协商阶段 */
+    bool initiator;                         /**< 本端发起协商 */
+    bool rolling_back;                      /**< 本次切换是误码回退，不需要验证 */
+    uint32_t phase_time;                    /**< 当前阶段的开始（或计划切换）时间 */
+    uint32_t last_check;                    /**< 上次发送检查帧的时间 */
+    volatile uint16_t errors;               /**< 接收错误计数（中断中累加） */
+    uint16_t window_errors;                 /**< 统计窗口开始时的错误计数 */
+    uint32_t window_start;                  /**< 统计窗口开始时间 */
+    uint32_t rollbacks;                     /**< 误码回退次数 */
+} comm_baud_t;
+#endif
+
+/* =============================================================================
+ * 数据压缩（可选）
+ * =============================================================================
+ */
+
+#if COMM_ENABLE_COMPRESS
+typedef struct {
+    bool peer_supported;                    /**< 对端已通告可以解压 */
+    uint32_t raw_bytes;                     /**< 参与压缩的原始数据字节数 */
+    uint32_t wire_bytes;                    /**< 这些数据实际发送的字节数 */
+} comm_compress_t;
+#endif
+
+/* =============================================================================
+ * 链路监测（可选）
+ * =============================================================================
+ */
+
+#if COMM_ENABLE_LINK
+/** @brief 链路状态 */
+typedef enum {
+    COMM_LINK_UNKNOWN = 0,                  /**< 尚未收到过探测应答 */
+    COMM_LINK_UP,                           /**< 链路正常 */
+    COMM_LINK_DOWN                          /**< 链路断开 */
+} comm_link_state_t;
+
+typedef struct {
+    bool enabled;                           /**< 已启用心跳探测 */
+    uint8_t state;                          /**< 链路状态（comm_link_state_t） */
+    bool sync_pending;                      /**< 已重置发送序列号，等待对端确认 */
+    bool probe_outstanding;                 /**< 最近一次探测尚未收到应答 */
+    uint8_t probe_id;                       /**< 最近一次探测的编号 */
+    uint8_t history_count;                  /**< 丢失位图中的有效探测数（最多32） */
+    uint32_t history;                       /**< 最近32次探测的丢失位图（1为丢失） */
+    uint32_t last_probe;                    /**< 上次发送探测的时间 */
+    uint32_t last_alive;                    /**< 上次收到探测应答的时间 */
+    uint16_t rtt_ms;                        /**< 最近一次往返时间 */
+    uint16_t srtt_ms;                       /**< 平滑往返时间 */
+    uint32_t probes_sent;                   /**< 已发送探测数 */
+    uint32_t probes_lost;                   /**< 丢失探测数 */
+    volatile uint32_t rx_errors;            /**< 接收错误计数（中断中累加） */
+    uint32_t downs;                         /**< 链路断开次数 */
+    comm_link_callback_t callback;          /**< 链路状态变化回调 */
+    void *user_ctx;                         /**< 回调用户上下文 */
+} comm_link_t;
+#endif
+
+/* =============================================================================
+ * 会话（可选）
+ * =============================================================================
+ */
+
+#if COMM_ENABLE_SESSION
+typedef struct {
+    uint16_t local_epoch;                   /**< 本端会话纪元 */
+    uint16_t peer_epoch;                    /**< 对端会话纪元，0表示尚未握手 */
+    uint8_t hello_left;                     /**< 启动通告剩余发送次数 */
+    uint32_t last_hello;                    /**< 上次发送通告的时间 */
+    uint32_t peer_restarts;                 /**< 检测到对端重启的次数 */
+    uint32_t realigns;                      /**< 按对端通告重新对齐接收序列号的次数 */
+} comm_session_t;
+#endif
+
+/* =============================================================================
+ * 前向纠错（可选）
+ * =============================================================================
+ */
+
+#if COMM_ENABLE_FEC
+typedef struct {
+    bool tx_enabled;                        /**< 对端已请求纠错，发送的帧加纠错外壳 */
+    uint32_t tx_frames;                     /**< 编码发送的帧数 */
+    uint32_t rx_frames;                     /**< 收到的纠错帧数 */
+    uint32_t rx_corrected;                  /**< 纠正过错误的帧数 */
+    uint32_t rx_symbols;                    /**< 纠正的错误字节数 */
+    uint32_t rx_failed;                     /**< 无法纠正的帧数 */
+} comm_fec_t;
+#endif
+
 /* =============================================================================
  * UART实例管理结构
  * =============================================================================
@@ -275,20 +1005,27 @@ typedef struct comm_instance {
     frame_parse_state_t parse_state;        /**< 帧解析状态 */
     
     /* 序列号管理 */
-    uint8_t tx_sequence;                    /**< 发送序列号 */
-    uint8_t rx_sequence;                    /**< 接收序列号 */
-    uint8_t expected_ack_seq;               /**< 期望的ACK序列号 */
+    comm_seq_t tx_sequence;                 /**< 发送序列号 */
+    comm_seq_t rx_sequence;                 /**< 接收序列号 */
+    comm_seq_t expected_ack_seq;            /**< 期望的ACK序列号 */
     
-    /* 缓冲区管理 */
-    char rx_buffer[COMM_RX_BUFFER_SIZE];    /**< 接收缓冲区 */
-    char tx_buffer[COMM_TX_BUFFER_SIZE];    /**< 发送缓冲区 */
+    /* 缓冲区管理（默认缓冲区池或用户提供的存储，重新初始化时保留） */
+    char *rx_buffer[COMM_RX_FRAME_SLOTS];   /**< 接收槽（帧内容原地存放） */
+    char *tx_buffer;                        /**< 发送缓冲区 */
+    uint16_t rx_slot_size;                  /**< 每个接收槽的大小 */
+    uint16_t tx_buffer_size;                /**< 发送缓冲区大小 */
+    bool default_buffers;                   /**< 缓冲区来自默认缓冲区池 */
     uint16_t rx_index;                      /**< 接收缓冲区索引 */
     uint16_t tx_length;                     /**< 发送数据长度 */
     
     /* 中断接收相关 */
     uint8_t rx_byte;                        /**< 单字节接收缓冲 */
-    volatile bool new_frame_available;      /**< 新帧可用标志 */
-    comm_frame_t pending_frame;             /**< 待处理的完整帧 */
+    uint8_t rx_crc;                         /**< 接收时逐字节累积的CRC */
+    uint16_t rx_hex_value;                  /**< SEQ/地址/CRC十六进制字段累积值 */
+    uint8_t rx_hex_count;                   /**< SEQ/地址/CRC十六进制字段已收字符数 */
+    volatile uint8_t rx_produced;           /**< 已接收完成的帧数（只由接收中断修改） */
+    volatile uint8_t rx_consumed;           /**< 已处理的帧数（只由comm_tick修改） */
+    comm_frame_t rx_frames[COMM_RX_FRAME_SLOTS]; /**< 各接收槽的帧 */
     uint32_t frame_timeout;                 /**< 帧接收超时时间 */
     
 #if COMM_ENABLE_RING_BUFFER
@@ -299,6 +1036,42 @@ typedef struct comm_instance {
     comm_handler_t handlers[COMM_MAX_CALLBACKS];  /**< 回调函数数组 */
     uint8_t handler_count;                  /**< 已注册回调数量 */
     
+#if COMM_ENABLE_PUBSUB
+    comm_pubsub_t pubsub;                   /**< 发布/订阅主题表 */
+#endif
+    
+#if COMM_ENABLE_RS485
+    comm_rs485_t rs485;                     /**< RS-485总线状态 */
+#endif
+    
+#if COMM_ENABLE_PRIORITY
+    comm_priority_queue_t priority;         /**< 发送优先级队列 */
+#endif
+    
+#if COMM_ENABLE_CREDITS
+    comm_credit_t credit;                   /**< 流控额度 */
+#endif
+    
+#if COMM_ENABLE_BAUD
+    comm_baud_t baud;                       /**< 波特率协商状态 */
+#endif
+    
+#if COMM_ENABLE_COMPRESS
+    comm_compress_t compress;               /**< 数据压缩状态 */
+#endif
+    
+#if COMM_ENABLE_LINK
+    comm_link_t link;                       /**< 链路监测状态 */
+#endif
+    
+#if COMM_ENABLE_SESSION
+    comm_session_t session;                 /**< 会话状态 */
+#endif
+    
+#if COMM_ENABLE_FEC
+    comm_fec_t fec;                         /**< 前向纠错状态 */
+#endif
+    
     /* 超时和重试管理 */
     uint32_t timeout_ms;                    /**< 超时时间 */
     uint8_t max_retry;                      /**< 最大重试次数 */
@@ -308,7 +1081,8 @@ typedef struct comm_instance {
     /* 当前发送任务信息 - 用于失败回调 */
     char current_cmd[COMM_MAX_CMD_LENGTH];  /**< 当前发送的命令 */
     char current_data[COMM_MAX_DATA_LENGTH]; /**< 当前发送的数据 */
-    uint8_t current_sequence;               /**< 当前发送任务的序列号 */
+    uint16_t current_data_len;              /**< 当前发送的数据长度 */
+    comm_seq_t current_sequence;            /**< 当前发送任务的序列号 */
     
     /* 调试和统计 */
     bool debug_enabled;                     /**< 调试开关 */
@@ -317,6 +1091,10 @@ typedef struct comm_instance {
     /* 回调函数 */
     comm_fail_callback_t fail_callback;    /**< 发送失败回调 */
     comm_state_change_callback_t state_change_callback; /**< 状态变化回调 */
+    comm_fail_callback_ex_t fail_callback_ex;           /**< 带上下文的失败回调 */
+    void *fail_ctx;                                     /**< 失败回调用户上下文 */
+    comm_state_change_callback_ex_t state_change_callback_ex; /**< 带上下文的状态变化回调 */
+    void *state_change_ctx;                             /**< 状态变化回调用户上下文 */
     
 #if COMM_ENABLE_ERROR_CALLBACK
     comm_callback_t error_callback;         /**< 错误处理回调 */
@@ -332,16 +1110,22 @@ typedef struct comm_instance {
 typedef struct {
     comm_instance_t instances[COMM_MAX_INSTANCES];  /**< 实例数组 */
     uint8_t instance_count;                         /**< 已使用实例数量 */
+    uint8_t default_buffers_used;                   /**< 已分配的默认缓冲区套数 */
 } comm_manager_t;
 
+/** @brief 库的静态RAM（字节）：实例表加默认缓冲区池，编译期常量，可用于工程自己的静态断言 */
+#define COMM_STATIC_RAM_BYTES       (sizeof(comm_manager_t) + COMM_DEFAULT_BUFFER_BYTES)
+
 
 /* 统计功能 */
 #if COMM_ENABLE_STATS
 void comm_update_tx_stats(comm_instance_t *instance, bool success);
 void comm_update_rx_stats(comm_instance_t *instance, bool success, comm_error_t error);
+void comm_update_delay_stats(comm_instance_t *instance, uint32_t delay_ms);
 #else
 #define comm_update_tx_stats(instance, success) ((void)0)
 #define comm_update_rx_stats(instance, success, error) ((void)0)
+#define comm_update_delay_stats(instance, delay_ms) ((void)0)
 #endif
 
 /* 调试输出 */
@@ -0,0 +1,332 @@
+/**
+ * @file    comm_link.c
+ * @brief   通信库链路监测 - 心跳探测、丢包率/往返时间统计、断开/恢复事件、序列号重新同步
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_link.h"
+
+#if COMM_ENABLE_LINK
+
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#if COMM_ENABLE_BAUD
+#include "comm_baud.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 探测数据的类型字符和同步标志 */
+#define COMM_LINK_OP_PROBE          'Q'
+#define COMM_LINK_OP_REPLY          'R'
+#define COMM_LINK_SYNC_FLAG         'S'
+
+/* Private function prototypes -----------------------------------------------*/
+static void comm_link_send(comm_instance_t *instance, char op, uint8_t id, bool sync);
+static void comm_link_record(comm_link_t *link, bool lost);
+static void comm_link_handle_reply(comm_instance_t *instance, uint8_t id, bool sync);
+static void comm_link_set_down(comm_instance_t *instance);
+static void comm_link_set_up(comm_instance_t *instance);
+
+/* =============================================================================
+ * 链路监测API实现
+ * =============================================================================
+ */
+
+bool comm_link_enable(UART_HandleTypeDef *huart, comm_link_callback_t callback, void *user_ctx)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return false;
+    }
+
+#if COMM_ENABLE_RS485
+    if (instance->rs485.enabled) {
+        return false;
+    }
+#endif
+
+    comm_link_t *link = &instance->link;
+    link->callback = callback;
+    link->user_ctx = user_ctx;
+
+    if (!link->enabled) {
+        // 从启用时刻开始计算断开时限，下一次comm_tick()立即探测
+        link->enabled = true;
+        link->state = COMM_LINK_UNKNOWN;
+        link->probe_outstanding = false;
+        link->last_alive = HAL_GetTick();
+        link->last_probe = link->last_alive - COMM_LINK_INTERVAL_MS;
+    }
+    return true;
+}
+
+void comm_link_disable(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return;
+    }
+
+    instance->link.enabled = false;
+    instance->link.state = COMM_LINK_UNKNOWN;
+    instance->link.sync_pending = false;
+}
+
+comm_link_state_t comm_link_get_state(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return COMM_LINK_UNKNOWN;
+    }
+
+    return (comm_link_state_t)instance->link.state;
+}
+
+bool comm_link_get_quality(UART_HandleTypeDef *huart, comm_link_quality_t *quality)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || quality == NULL) {
+        return false;
+    }
+
+    const comm_link_t *link = &instance->link;
+    uint8_t lost = 0;
+    for (uint8_t i = 0; i < link->history_count; i++) {
+        if (link->history & (1UL << i)) {
+            lost++;
+        }
+    }
+
+    quality->state = (comm_link_state_t)link->state;
+    quality->rtt_ms = link->rtt_ms;
+    quality->srtt_ms = link->srtt_ms;
+    quality->loss_percent = (link->history_count > 0) ? (uint8_t)(lost * 100U / link->history_count) : 0;
+    quality->probes_sent = link->probes_sent;
+    quality->probes_lost = link->probes_lost;
+    quality->rx_errors = link->rx_errors;
+    quality->downs = link->downs;
+    return true;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+bool comm_link_tx_allowed(const comm_instance_t *instance)
+{
+    const comm_link_t *link = &instance->link;
+    return !link->enabled || (link->state != COMM_LINK_DOWN && !link->sync_pending);
+}
+
+void comm_link_note_error(comm_instance_t *instance)
+{
+    instance->link.rx_errors++;
+}
+
+bool comm_link_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    if (!comm_frame_cmd_is(instance, frame, COMM_CMD_LINK)) {
+        return false;
+    }
+
+    // 数据格式: OP,ID[,S]
+    const char *data = COMM_FRAME_DATA(instance, frame);
+    if (frame->data_len < 4 || data[1] != ',') {
+        COMM_DEBUG_INSTANCE(instance, "链路探测格式错误: %s", data);
+        return true;
+    }
+
+    uint8_t id = (uint8_t)strtoul(&data[2], NULL, 16);
+    const char *flag = memchr(&data[2], ',', frame->data_len - 2);
+    bool sync = (flag != NULL && flag[1] == COMM_LINK_SYNC_FLAG);
+
+    if (data[0] == COMM_LINK_OP_PROBE) {
+        if (sync) {
+            // 对端从序列号1重新开始发送
+            instance->rx_sequence = 0;
+            COMM_DEBUG_INSTANCE(instance, "对端请求序列号同步");
+        }
+        // 不论本端是否启用监测都应答，只需监测的一方调用comm_link_enable()
+        comm_link_send(instance, COMM_LINK_OP_REPLY, id, sync);
+    } else if (data[0] == COMM_LINK_OP_REPLY) {
+        comm_link_handle_reply(instance, id, sync);
+    }
+
+    return true;
+}
+
+void comm_link_process(comm_instance_t *instance)
+{
+    comm_link_t *link = &instance->link;
+    if (!link->enabled) {
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+
+#if COMM_ENABLE_BAUD
+    // 切换波特率期间探测必然丢失，暂停判定，结束后重新计时
+    if (comm_baud_is_busy(instance->huart)) {
+        link->probe_outstanding = false;
+        link->last_alive = now;
+        link->last_probe = now;
+        return;
+    }
+#endif
+
+    if (link->state != COMM_LINK_DOWN && now - link->last_alive >= COMM_LINK_DOWN_MS) {
+        comm_link_set_down(instance);
+    }
+
+    if (now - link->last_probe < COMM_LINK_INTERVAL_MS) {
+        return;
+    }
+
+    // 上一次探测到现在都没有应答，记为丢失
+    if (link->probe_outstanding) {
+        link->probe_outstanding = false;
+        comm_link_record(link, true);
+    }
+
+    // 发送失败（链路忙、额度耗尽）时下一次comm_tick()再试
+    link->probe_id++;
+    link->last_probe = now;
+    comm_link_send(instance, COMM_LINK_OP_PROBE, link->probe_id, link->sync_pending);
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  发送探测或应答
+ */
+static void comm_link_send(comm_instance_t *instance, char op, uint8_t id, bool sync)
+{
+    char data[8];
+    snprintf(data, sizeof(data), "%c,%02X%s", op, id, sync ? ",S" : "");
+
+    if (!comm_send_datagram(instance, COMM_CMD_LINK, data)) {
+        if (op == COMM_LINK_OP_PROBE) {
+            instance->link.last_probe -= COMM_LINK_INTERVAL_MS;
+        }
+        return;
+    }
+
+    if (op == COMM_LINK_OP_PROBE) {
+        instance->link.probe_outstanding = true;
+        instance->link.probes_sent++;
+    }
+}
+
+/**
+ * @brief  记录一次探测结果到丢失位图
+ */
+static void comm_link_record(comm_link_t *link, bool lost)
+{
+    link->history = (link->history << 1) | (lost ? 1UL : 0UL);
+    if (link->history_count < 32) {
+        link->history_count++;
+    }
+    if (lost) {
+        link->probes_lost++;
+    }
+}
+
+/**
+ * @brief  处理探测应答：统计往返时间，刷新存活时间，确认序列号同步
+ */
+static void comm_link_handle_reply(comm_instance_t *instance, uint8_t id, bool sync)
+{
+    comm_link_t *link = &instance->link;
+    if (!link->enabled) {
+        return;
+    }
+
+    // 迟到的旧应答同样证明链路是通的，但不计入往返时间
+    if (link->probe_outstanding && id == link->probe_id) {
+        link->probe_outstanding = false;
+        comm_link_record(link, false);
+
+        uint32_t rtt = HAL_GetTick() - link->last_probe;
+        link->rtt_ms = (uint16_t)((rtt > UINT16_MAX) ? UINT16_MAX : rtt);
+        link->srtt_ms = (link->srtt_ms == 0) ? link->rtt_ms
+                      : (uint16_t)((7U * link->srtt_ms + link->rtt_ms) / 8U);
+    }
+
+    link->last_alive = HAL_GetTick();
+
+    if (sync && link->sync_pending) {
+        link->sync_pending = false;
+        COMM_DEBUG_INSTANCE(instance, "序列号同步已确认");
+    }
+
+    if (link->state != COMM_LINK_UP) {
+        comm_link_set_up(instance);
+    }
+}
+
+/**
+ * @brief  判定链路断开：立即结束正在等待ACK的命令并通知上层
+ */
+static void comm_link_set_down(comm_instance_t *instance)
+{
+    comm_link_t *link = &instance->link;
+    link->state = COMM_LINK_DOWN;
+    link->downs++;
+
+    COMM_DEBUG_INSTANCE(instance, "链路断开: %lu ms未收到探测应答",
+                       (unsigned long)(HAL_GetTick() - link->last_alive));
+
+    if (instance->state == COMM_STATE_SENDING || instance->state == COMM_STATE_WAIT_ACK ||
+        instance->state == COMM_STATE_RETRY) {
+        comm_call_fail_callback(instance, instance->current_cmd,
+                               instance->current_data, "链路断开");
+#if COMM_ENABLE_PRIORITY
+        instance->priority.in_flight = COMM_PRIORITY_NONE;
+#endif
+        instance->retry_count = 0;
+        comm_set_state(instance, COMM_STATE_IDLE);
+
+        comm_update_tx_stats(instance, false);
+        comm_call_send_done(instance, false);
+    }
+
+    if (link->callback != NULL) {
+        link->callback(instance->huart, false, link->user_ctx);
+    }
+}
+
+/**
+ * @brief  判定链路恢复（或首次建立），断开后恢复时重新同步序列号
+ */
+static void comm_link_set_up(comm_instance_t *instance)
+{
+    comm_link_t *link = &instance->link;
+    bool was_down = (link->state == COMM_LINK_DOWN);
+    link->state = COMM_LINK_UP;
+
+    COMM_DEBUG_INSTANCE(instance, "链路%s, RTT=%u ms", was_down ? "恢复" : "建立", link->rtt_ms);
+
+#if COMM_LINK_RESYNC
+    if (was_down) {
+        // 断开期间的帧是否到达对端无法确定，本端从序列号1重新开始，立即发送同步探测通知对端
+        instance->tx_sequence = 0;
+        instance->expected_ack_seq = 0;
+        link->sync_pending = true;
+        link->last_probe = HAL_GetTick() - COMM_LINK_INTERVAL_MS;
+    }
+#endif
+
+    if (link->callback != NULL) {
+        link->callback(instance->huart, true, link->user_ctx);
+    }
+}
+
+#endif /* COMM_ENABLE_LINK */
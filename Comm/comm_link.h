@@ -0,0 +1,141 @@
+/**
+ ******************************************************************************
+ * @file           : comm_link.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信链路心跳与质量监测
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 链路监测 - 后台心跳，毫秒级发现对端失联，而不是等一条命令重试完（默认约3秒）
+ *
+ * 协议（数据报，不占用序列号和重试状态）:
+ *   - 每COMM_LINK_INTERVAL_MS发送探测: {LNK:Q,ID#00#CRC}
+ *   - 对端立即应答: {LNK:R,ID#00#CRC}，收到应答即证明双向都通
+ *   - 超过COMM_LINK_DOWN_MS没有应答判定断开，再次收到应答判定恢复
+ *
+ * 链路断开时:
+ *   - 正在等待ACK的命令立即按失败回调通知（原因"链路断开"）
+ *   - comm_is_ready()返回false，comm_send_command()直接失败，上层可马上切换备用链路
+ *
+ * 链路恢复时（COMM_LINK_RESYNC为1）:
+ *   - 按comm_instance_reset()的语义从序列号1重新开始发送，探测带同步标志S
+ *   - 对端收到S后清零接收序列号并在应答中回带S，确认之前不发送新命令
+ *   - 对端重启过（序列号已清零）也能直接恢复，不会被当成序列号倒退
+ *
+ * 质量统计: 最近32次探测的丢失率、往返时间（最近一次和平滑值）、接收错误计数、断开次数
+ *
+ * 注意：
+ *   - 通信双方都需编译链路监测（应答由库自动完成），只需要监测的一方调用comm_link_enable()
+ *   - 只用于点对点链路，启用RS-485寻址的实例不能启用
+ *   - 波特率协商期间暂停判定，切换过程中丢失的探测不计入统计
+ *
+ * 使用示例:
+ *   static void on_link(UART_HandleTypeDef *huart, bool link_up, void *ctx)
+ *   {
+ *       active_uart = link_up ? huart : &huart3;   // 主链路断开时切换到备用链路
+ *   }
+ *   comm_link_enable(&huart2, on_link, NULL);
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_LINK_H
+#define COMM_LINK_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_LINK
+
+#if COMM_LINK_DOWN_MS <= 2 * COMM_LINK_INTERVAL_MS
+#error "COMM_LINK_DOWN_MS必须大于两个探测间隔，否则一次丢包就会判定断开"
+#endif
+
+/** @brief 链路质量快照 */
+typedef struct {
+    comm_link_state_t state;                /**< 链路状态 */
+    uint16_t rtt_ms;                        /**< 最近一次往返时间 */
+    uint16_t srtt_ms;                       /**< 平滑往返时间（1/8加权） */
+    uint8_t loss_percent;                   /**< 最近32次探测的丢失率 */
+    uint32_t probes_sent;                   /**< 已发送探测数 */
+    uint32_t probes_lost;                   /**< 丢失探测数 */
+    uint32_t rx_errors;                     /**< 接收错误（CRC/帧超时/UART错误）次数 */
+    uint32_t downs;                         /**< 链路断开次数 */
+} comm_link_quality_t;
+
+/* =============================================================================
+ * 链路监测API
+ * =============================================================================
+ */
+
+/**
+ * @brief  启用后台心跳
+ * @param  huart: UART句柄指针
+ * @param  callback: 链路断开/恢复回调（可为NULL）
+ * @param  user_ctx: 用户上下文，原样传给回调
+ * @retval true: 启用成功, false: 未找到实例或实例启用了RS-485寻址
+ * @note   回调在comm_tick()中调用
+ */
+bool comm_link_enable(UART_HandleTypeDef *huart, comm_link_callback_t callback, void *user_ctx);
+
+/**
+ * @brief  停止后台心跳
+ * @param  huart: UART句柄指针
+ * @retval None
+ * @note   停止后不再限制发送，统计保留
+ */
+void comm_link_disable(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取链路状态
+ * @param  huart: UART句柄指针
+ * @retval 链路状态，未启用时为COMM_LINK_UNKNOWN
+ */
+comm_link_state_t comm_link_get_state(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取链路质量
+ * @param  huart: UART句柄指针
+ * @param  quality: 输出链路质量
+ * @retval true: 获取成功, false: 未找到实例
+ */
+bool comm_link_get_quality(UART_HandleTypeDef *huart, comm_link_quality_t *quality);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  判断链路状态是否允许发送新命令
+ * @param  instance: 实例指针
+ * @retval true: 允许, false: 链路断开或正在等待序列号同步确认
+ */
+bool comm_link_tx_allowed(const comm_instance_t *instance);
+
+/**
+ * @brief  记录一次接收错误（可在中断中调用）
+ * @param  instance: 实例指针
+ * @retval None
+ */
+void comm_link_note_error(comm_instance_t *instance);
+
+/**
+ * @brief  处理LNK探测/应答帧
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @retval true: 已处理, false: 不是链路探测帧
+ */
+bool comm_link_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+/**
+ * @brief  发送探测、判定断开
+ * @param  instance: 实例指针
+ * @retval None
+ * @note   由comm_tick()在处理完接收帧后调用
+ */
+void comm_link_process(comm_instance_t *instance);
+
+#endif /* COMM_ENABLE_LINK */
+
+#endif /* COMM_LINK_H */
@@ -8,13 +8,63 @@
 
 #include "comm_manager.h"
 #include "comm_protocol.h"
+#if COMM_ENABLE_RS485
+#include "comm_rs485.h"
+#endif
+#if COMM_ENABLE_PRIORITY
+#include "comm_priority.h"
+#endif
+#if COMM_ENABLE_CREDITS
+#include "comm_credit.h"
+#endif
+#if COMM_ENABLE_BAUD
+#include "comm_baud.h"
+#endif
+#if COMM_ENABLE_LINK
+#include "comm_link.h"
+#endif
+#if COMM_ENABLE_SESSION
+#include "comm_session.h"
+#endif
+#if COMM_ENABLE_RTOS
+#include "comm_rtos.h"
+#endif
+#if COMM_ENABLE_BOND
+#include "comm_bond.h"
+#endif
+#if COMM_ENABLE_STORE
+#include "comm_store.h"
+#endif
+#if COMM_ENABLE_CAPTURE
+#include "comm_capture.h"
+#endif
 #include <string.h>
 
 static comm_manager_t g_comm_manager = {0};
 
+#if COMM_DEFAULT_BUFFER_COUNT > 0
+/* 默认缓冲区池：comm_add_uart()按顺序分配，用户提供缓冲区的实例不占用 */
+static char g_comm_rx_pool[COMM_DEFAULT_BUFFER_COUNT][COMM_RX_BUFFER_SIZE];
+static char g_comm_tx_pool[COMM_DEFAULT_BUFFER_COUNT][COMM_TX_BUFFER_SIZE];
+#endif
+
+#if COMM_RAM_BUDGET > 0
+#define COMM_RAM_STR_(x)    #x
+#define COMM_RAM_STR(x)     COMM_RAM_STR_(x)
+#pragma message("Comm RAM: COMM_MAX_INSTANCES=" COMM_RAM_STR(COMM_MAX_INSTANCES) \
+                ", COMM_DEFAULT_BUFFER_COUNT=" COMM_RAM_STR(COMM_DEFAULT_BUFFER_COUNT) \
+                " x (" COMM_RAM_STR(COMM_RX_BUFFER_SIZE) " + " COMM_RAM_STR(COMM_TX_BUFFER_SIZE) \
+                "), COMM_RAM_BUDGET=" COMM_RAM_STR(COMM_RAM_BUDGET))
+/* 超出预算时减小COMM_MAX_INSTANCES/COMM_DEFAULT_BUFFER_COUNT或关闭不用的功能（GCC无法正常显示中文断言信息） */
+_Static_assert(COMM_STATIC_RAM_BYTES <= COMM_RAM_BUDGET, "Comm static RAM exceeds COMM_RAM_BUDGET");
+#endif
+
 /* Private function prototypes -----------------------------------------------*/
-static int comm_find_callback_index(comm_instance_t *instance, const char *cmd);
+static int comm_find_callback_index(comm_instance_t *instance, const char *cmd, uint8_t cmd_len);
+static comm_handler_t* comm_alloc_handler(comm_instance_t *instance, const char *cmd);
 static comm_instance_t* comm_create_instance(UART_HandleTypeDef *huart);
+static bool comm_check_buffers(UART_HandleTypeDef *huart, uint16_t rx_size,
+                               const char *tx_buffer, uint16_t tx_size);
 static const char* comm_state_to_string(uint8_t state);
 
 /* =============================================================================
@@ -40,6 +90,20 @@ comm_instance_t* comm_get_instance_by_index(uint8_t index)
     return &g_comm_manager.instances[index];
 }
 
+int8_t comm_manager_instance_index(const comm_instance_t *instance)
+{
+    if (instance == NULL) {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < g_comm_manager.instance_count; i++) {
+        if (&g_comm_manager.instances[i] == instance) {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
 /* =============================================================================
  * 实例管理函数实现
  * =============================================================================
@@ -54,8 +118,21 @@ bool comm_instance_init(comm_instance_t *instance,
         return false;
     }
     
-    // 清零实例结构
+    // 清零实例结构，挂接的缓冲区保留
+    char *rx_buffer[COMM_RX_FRAME_SLOTS];
+    memcpy(rx_buffer, instance->rx_buffer, sizeof(rx_buffer));
+    char *tx_buffer = instance->tx_buffer;
+    uint16_t rx_slot_size = instance->rx_slot_size;
+    uint16_t tx_buffer_size = instance->tx_buffer_size;
+    bool default_buffers = instance->default_buffers;
+
     memset(instance, 0, sizeof(comm_instance_t));
+
+    memcpy(instance->rx_buffer, rx_buffer, sizeof(rx_buffer));
+    instance->tx_buffer = tx_buffer;
+    instance->rx_slot_size = rx_slot_size;
+    instance->tx_buffer_size = tx_buffer_size;
+    instance->default_buffers = default_buffers;
     
     // 设置基本参数
     instance->huart = huart;
@@ -75,10 +152,34 @@ bool comm_instance_init(comm_instance_t *instance,
     // 清除所有回调
     for (int i = 0; i < COMM_MAX_CALLBACKS; i++) {
         memset(instance->handlers[i].cmd, 0, COMM_MAX_CMD_LENGTH);
+        instance->handlers[i].cmd_len = 0;
         instance->handlers[i].callback = NULL;
+        instance->handlers[i].callback_ex = NULL;
+        instance->handlers[i].user_ctx = NULL;
+        instance->handlers[i].is_used = false;
     }
     instance->fail_callback = NULL;
     instance->state_change_callback = NULL;
+    instance->fail_callback_ex = NULL;
+    instance->fail_ctx = NULL;
+    instance->state_change_callback_ex = NULL;
+    instance->state_change_ctx = NULL;
+    
+    #if COMM_ENABLE_PRIORITY
+    instance->priority.in_flight = COMM_PRIORITY_NONE;
+    #endif
+    
+    #if COMM_ENABLE_CREDITS
+    comm_credit_init(instance);
+    #endif
+    
+    #if COMM_ENABLE_BAUD
+    comm_baud_init(instance);
+    #endif
+    
+    #if COMM_ENABLE_SESSION
+    comm_session_init(instance);
+    #endif
     
     #if COMM_ENABLE_STATS
     // 初始化统计信息
@@ -96,6 +197,27 @@ bool comm_instance_is_ready(comm_instance_t *instance)
         return false;
     }
     
+#if COMM_ENABLE_RS485
+    // 主站轮询等待应答期间总线属于被轮询的从站
+    if (instance->rs485.poll_outstanding) {
+        return false;
+    }
+#endif
+    
+#if COMM_ENABLE_CREDITS
+    // 对端没有空闲接收槽，发出去也会被丢弃
+    if (!comm_credit_available(instance)) {
+        return false;
+    }
+#endif
+    
+#if COMM_ENABLE_LINK
+    // 链路断开时直接失败，上层可以立即切换备用链路
+    if (!comm_link_tx_allowed(instance)) {
+        return false;
+    }
+#endif
+    
     return (instance->state == COMM_STATE_IDLE);
 }
 
@@ -114,6 +236,11 @@ void comm_instance_reset(comm_instance_t *instance)
         return;
     }
     
+    // 正在发送的命令随重置放弃
+    if (instance->state != COMM_STATE_IDLE) {
+        comm_call_send_done(instance, false);
+    }
+    
     // 保存必要的配置
     UART_HandleTypeDef *huart = instance->huart;
     uint32_t timeout_ms = instance->timeout_ms;
@@ -145,54 +272,59 @@ bool comm_register_callback(comm_instance_t *instance, const char *cmd, comm_cal
         return false;
     }
     
-    // 检查命令长度
-    if (strlen(cmd) >= COMM_MAX_CMD_LENGTH) {
-        COMM_DEBUG_INSTANCE(instance, "命令过长，无法注册: %s", cmd);
+    comm_handler_t *handler = comm_alloc_handler(instance, cmd);
+    if (handler == NULL) {
         return false;
     }
     
-    // 检查是否已存在该命令的回调
-    int existing_index = comm_find_callback_index(instance, cmd);
-    if (existing_index >= 0) {
-        // 更新现有回调
-        instance->handlers[existing_index].callback = callback;
-        COMM_DEBUG_INSTANCE(instance, "更新回调: %s", cmd);
-        return true;
+    handler->callback = callback;
+    handler->callback_ex = NULL;
+    handler->user_ctx = NULL;
+    return true;
+}
+
+bool comm_register_callback_ex(comm_instance_t *instance, const char *cmd,
+                               comm_callback_ex_t callback, void *user_ctx)
+{
+    if (instance == NULL || cmd == NULL || callback == NULL) {
+        return false;
     }
     
-    // 寻找空闲位置
-    for (int i = 0; i < COMM_MAX_CALLBACKS; i++) {
-        if (instance->handlers[i].callback == NULL) {
-            strncpy(instance->handlers[i].cmd, cmd, COMM_MAX_CMD_LENGTH - 1);
-            instance->handlers[i].cmd[COMM_MAX_CMD_LENGTH - 1] = '\0';
-            instance->handlers[i].callback = callback;
-            
-            COMM_DEBUG_INSTANCE(instance, "注册回调成功: %s (位置 %d)", cmd, i);
-            return true;
-        }
+    comm_handler_t *handler = comm_alloc_handler(instance, cmd);
+    if (handler == NULL) {
+        return false;
     }
     
-    COMM_DEBUG_INSTANCE(instance, "回调表已满，无法注册: %s", cmd);
-    return false;
+    handler->callback = NULL;
+    handler->callback_ex = callback;
+    handler->user_ctx = user_ctx;
+    return true;
 }
 
-bool comm_call_callback(comm_instance_t *instance, const char *cmd, const char *data)
+bool comm_call_callback(comm_instance_t *instance, const char *cmd, uint8_t cmd_len,
+                        const char *data, uint16_t data_len)
 {
     if (instance == NULL || cmd == NULL || data == NULL) {
         return false;
     }
     
-    int index = comm_find_callback_index(instance, cmd);
-    if (index >= 0 && instance->handlers[index].callback != NULL) {
-        // 执行用户回调
-        instance->handlers[index].callback(cmd, data);
-        
-        COMM_DEBUG_INSTANCE(instance, "执行回调: %s -> %s", cmd, data);
-        return true;
+    int index = comm_find_callback_index(instance, cmd, cmd_len);
+    if (index < 0) {
+        COMM_DEBUG_INSTANCE(instance, "未找到命令回调: %s", cmd);
+        return false;
     }
     
-    COMM_DEBUG_INSTANCE(instance, "未找到命令回调: %s", cmd);
-    return false;
+    comm_handler_t *handler = &instance->handlers[index];
+    
+    // 执行用户回调，带上下文的版本优先
+    if (handler->callback_ex != NULL) {
+        handler->callback_ex(instance->huart, cmd, data, data_len, handler->user_ctx);
+    } else if (handler->callback != NULL) {
+        handler->callback(cmd, data);
+    }
+    
+    COMM_DEBUG_INSTANCE(instance, "执行回调: %s -> %s", cmd, data);
+    return true;
 }
 
 void comm_set_fail_callback(comm_instance_t *instance, comm_fail_callback_t callback)
@@ -210,6 +342,28 @@ void comm_set_fail_callback(comm_instance_t *instance, comm_fail_callback_t call
     }
 }
 
+void comm_set_fail_callback_ex(comm_instance_t *instance, comm_fail_callback_ex_t callback, void *user_ctx)
+{
+    if (instance == NULL) {
+        return;
+    }
+    
+    instance->fail_callback_ex = callback;
+    instance->fail_ctx = user_ctx;
+}
+
+void comm_set_state_change_callback_ex(comm_instance_t *instance,
+                                       comm_state_change_callback_ex_t callback,
+                                       void *user_ctx)
+{
+    if (instance == NULL) {
+        return;
+    }
+    
+    instance->state_change_callback_ex = callback;
+    instance->state_change_ctx = user_ctx;
+}
+
 void comm_call_fail_callback(comm_instance_t *instance, const char *cmd, const char *data, const char *reason)
 {
     if (instance == NULL || cmd == NULL || data == NULL || reason == NULL) {
@@ -220,6 +374,34 @@ void comm_call_fail_callback(comm_instance_t *instance, const char *cmd, const c
         instance->fail_callback(cmd, data, reason);
         COMM_DEBUG_INSTANCE(instance, "调用失败回调: %s:%s - %s", cmd, data, reason);
     }
+    
+    if (instance->fail_callback_ex != NULL) {
+        // 失败的总是当前发送任务，长度在发送时已记录
+        uint16_t data_len = (data == instance->current_data) ? instance->current_data_len
+                                                             : (uint16_t)strlen(data);
+        instance->fail_callback_ex(instance->huart, cmd, data, data_len, reason, instance->fail_ctx);
+    }
+}
+
+void comm_call_send_done(comm_instance_t *instance, bool acked)
+{
+    if (instance == NULL) {
+        return;
+    }
+
+#if COMM_ENABLE_RTOS
+    comm_rtos_on_send_done(instance, instance->current_sequence, acked);
+#endif
+
+#if COMM_ENABLE_BOND
+    comm_bond_on_send_done(instance, instance->current_sequence, acked);
+#endif
+
+#if COMM_ENABLE_STORE
+    comm_store_on_send_done(instance, instance->current_sequence, acked);
+#endif
+
+    (void)acked;
 }
 
 /* =============================================================================
@@ -261,8 +443,16 @@ void comm_handle_timeout(comm_instance_t *instance)
         instance->stats.tx_retry++;
         #endif
         
+#if COMM_ENABLE_RS485
+        // 从站不能主动占用总线，重发同样等到下一次被轮询
+        if (comm_rs485_defer_tx(instance)) {
+            comm_set_state(instance, COMM_STATE_SENDING);
+            return;
+        }
+#endif
+        
         // 重新发送
-        HAL_StatusTypeDef status = HAL_UART_Transmit_IT(instance->huart, 
+        HAL_StatusTypeDef status = comm_uart_transmit_it(instance, 
                                                        (uint8_t*)instance->tx_buffer, 
                                                        instance->tx_length);
         
@@ -294,9 +484,8 @@ void comm_handle_timeout(comm_instance_t *instance)
         comm_set_state(instance, COMM_STATE_IDLE);
         instance->retry_count = 0;
         
-        #if COMM_ENABLE_STATS
-        instance->stats.tx_failed++;
-        #endif
+        comm_update_tx_stats(instance, false);
+        comm_call_send_done(instance, false);
     }
 }
 
@@ -321,11 +510,18 @@ void comm_handle_frame_timeout(comm_instance_t *instance)
     // 重置帧解析状态
     instance->parse_state = FRAME_STATE_IDLE;
     instance->rx_index = 0;
-    instance->new_frame_available = false;
     
     #if COMM_ENABLE_STATS
     instance->stats.rx_error++;
     #endif
+    
+    #if COMM_ENABLE_BAUD
+    comm_baud_note_error(instance);
+    #endif
+    
+    #if COMM_ENABLE_LINK
+    comm_link_note_error(instance);
+    #endif
 }
 
 void comm_set_state(comm_instance_t *instance, uint8_t new_state)
@@ -351,6 +547,14 @@ void comm_set_state(comm_instance_t *instance, uint8_t new_state)
                                            new_state_str, 
                                            instance->retry_count);
         }
+        
+        if (instance->state_change_callback_ex != NULL) {
+            instance->state_change_callback_ex(instance->huart, 
+                                              old_state_str, 
+                                              new_state_str, 
+                                              instance->retry_count,
+                                              instance->state_change_ctx);
+        }
     }
 }
 
@@ -360,10 +564,10 @@ bool comm_send_raw(comm_instance_t *instance, const char *data, uint16_t length)
         return false;
     }
     
-    HAL_StatusTypeDef status = HAL_UART_Transmit(instance->huart, 
-                                                (uint8_t*)data, 
-                                                length, 
-                                                1000);  // 1秒超时
+    HAL_StatusTypeDef status = comm_uart_transmit(instance, 
+                                                 (const uint8_t*)data, 
+                                                 length, 
+                                                 1000);  // 1秒超时
     
     if (status == HAL_OK) {
         instance->last_send_time = HAL_GetTick();
@@ -374,6 +578,164 @@ bool comm_send_raw(comm_instance_t *instance, const char *data, uint16_t length)
     }
 }
 
+bool comm_start_transmit(comm_instance_t *instance)
+{
+    if (instance == NULL || instance->tx_length == 0) {
+        return false;
+    }
+    
+#if COMM_ENABLE_PRIORITY
+    // 不经过优先级队列的命令按NORMAL处理，不可被抢占
+    instance->priority.in_flight = COMM_PRIORITY_NORMAL;
+#endif
+    
+#if COMM_ENABLE_RS485
+    // 从站的命令留在tx_buffer中，等主站轮询到本节点时再发送
+    if (comm_rs485_defer_tx(instance)) {
+        comm_set_state(instance, COMM_STATE_SENDING);
+        return true;
+    }
+#endif
+    
+    // 阻塞发送期间tx_buffer不会被改写，直接从中发送
+    HAL_StatusTypeDef status = comm_uart_transmit(instance, 
+                                                 (uint8_t*)instance->tx_buffer, 
+                                                 instance->tx_length, 1000);  // 1秒超时
+    
+    if (status == HAL_OK) {
+#if COMM_ENABLE_CREDITS
+        comm_credit_consume(instance);
+#endif
+        comm_set_state(instance, COMM_STATE_WAIT_ACK);
+        instance->last_send_time = HAL_GetTick();
+        return true;
+    } else {
+        return false;
+    }
+}
+
+HAL_StatusTypeDef comm_uart_transmit(comm_instance_t *instance, const uint8_t *data,
+                                     uint16_t length, uint32_t timeout)
+{
+    if (instance == NULL || data == NULL || length == 0) {
+        return HAL_ERROR;
+    }
+    
+#if COMM_ENABLE_RS485
+    comm_rs485_tx_begin(instance);
+#endif
+
+#if COMM_ENABLE_CAPTURE
+    comm_capture_note_tx(instance, data, length);
+#endif
+    
+    HAL_StatusTypeDef status = HAL_UART_Transmit(instance->huart, (uint8_t*)data, length, timeout);
+    
+#if COMM_ENABLE_RS485
+    // 阻塞发送在最后一个停止位移出(TC)后才返回，此时释放总线不会截断帧尾
+    comm_rs485_tx_end(instance);
+#endif
+    
+    return status;
+}
+
+HAL_StatusTypeDef comm_uart_transmit_it(comm_instance_t *instance, const uint8_t *data,
+                                        uint16_t length)
+{
+    if (instance == NULL || data == NULL || length == 0) {
+        return HAL_ERROR;
+    }
+    
+#if COMM_ENABLE_RS485
+    comm_rs485_tx_begin(instance);
+#endif
+
+#if COMM_ENABLE_CAPTURE
+    comm_capture_note_tx(instance, data, length);
+#endif
+    
+    HAL_StatusTypeDef status = HAL_UART_Transmit_IT(instance->huart, (uint8_t*)data, length);
+    
+#if COMM_ENABLE_RS485
+    if (status != HAL_OK) {
+        comm_rs485_tx_end(instance);
+    }
+#endif
+    
+    return status;
+}
+
+/* =============================================================================
+ * 统计功能实现
+ * =============================================================================
+ */
+
+#if COMM_ENABLE_STATS
+void comm_update_tx_stats(comm_instance_t *instance, bool success)
+{
+    if (instance == NULL) {
+        return;
+    }
+    
+    // 每条可靠命令结束时计一次：收到ACK或放弃
+    instance->stats.tx_count++;
+    if (success) {
+        instance->stats.tx_success++;
+        if (strcmp(instance->current_cmd, COMM_CMD_PING) == 0) {
+            instance->stats.ping_success++;
+        }
+    } else {
+        instance->stats.tx_failed++;
+    }
+}
+
+void comm_update_rx_stats(comm_instance_t *instance, bool success, comm_error_t error)
+{
+    if (instance == NULL) {
+        return;
+    }
+    
+    // 每个通过CRC的帧计一次；CRC错误的帧不会到达这里，rx_crc_error由接收中断单独累加
+    instance->stats.rx_count++;
+    if (success) {
+        instance->stats.rx_success++;
+        return;
+    }
+    
+    instance->stats.rx_error++;
+    switch (error) {
+        case COMM_ERR_FRAME_FORMAT:     instance->stats.rx_frame_error++; break;
+        case COMM_ERR_SEQUENCE_ERROR:   instance->stats.rx_seq_error++;   break;
+        default:                        break;
+    }
+}
+
+void comm_update_delay_stats(comm_instance_t *instance, uint32_t delay_ms)
+{
+    if (instance == NULL) {
+        return;
+    }
+    
+    comm_stats_t *stats = &instance->stats;
+    if (delay_ms < stats->min_delay_ms) stats->min_delay_ms = delay_ms;
+    if (delay_ms > stats->max_delay_ms) stats->max_delay_ms = delay_ms;
+    
+    // 第一个样本直接作为平均值，之后按1/8权重滑动
+    if (stats->tx_success <= 1) {
+        stats->avg_delay_ms = delay_ms;
+    } else {
+        stats->avg_delay_ms = (uint32_t)((int32_t)stats->avg_delay_ms +
+                                         ((int32_t)delay_ms - (int32_t)stats->avg_delay_ms) / 8);
+    }
+    
+    uint8_t bucket = 0;
+    while ((delay_ms >> (bucket + 1)) != 0 && bucket < COMM_STATS_DELAY_BUCKETS - 1) {
+        bucket++;
+    }
+    stats->delay_hist[bucket]++;
+}
+#endif
+
 /* =============================================================================
  * 全局实例查找函数实现
  * =============================================================================
@@ -397,18 +759,57 @@ comm_instance_t* comm_find_instance(UART_HandleTypeDef *huart)
 comm_instance_t* comm_create_uart_instance(UART_HandleTypeDef *huart, 
                                           uint32_t timeout_ms, 
                                           uint8_t max_retry)
+{
+    return comm_create_uart_instance_ex(huart, timeout_ms, max_retry, NULL, 0, NULL, 0);
+}
+
+comm_instance_t* comm_create_uart_instance_ex(UART_HandleTypeDef *huart,
+                                             uint32_t timeout_ms,
+                                             uint8_t max_retry,
+                                             char *rx_buffer, uint16_t rx_size,
+                                             char *tx_buffer, uint16_t tx_size)
 {
     if (huart == NULL) {
         return NULL;
     }
     
-    // 查找或创建实例
+    // 查找或创建实例，已存在的实例保留原有缓冲区
     comm_instance_t *instance = comm_find_instance(huart);
     if (instance == NULL) {
+        bool from_pool = (rx_buffer == NULL);
+        if (from_pool) {
+#if COMM_DEFAULT_BUFFER_COUNT > 0
+            if (g_comm_manager.default_buffers_used < COMM_DEFAULT_BUFFER_COUNT) {
+                rx_buffer = g_comm_rx_pool[g_comm_manager.default_buffers_used];
+                tx_buffer = g_comm_tx_pool[g_comm_manager.default_buffers_used];
+                rx_size = COMM_RX_BUFFER_SIZE;
+                tx_size = COMM_TX_BUFFER_SIZE;
+            }
+#endif
+            if (rx_buffer == NULL) {
+                COMM_ERROR_OUTPUT("默认缓冲区已用完(%d套)，请用comm_add_uart_with_buffers()添加: %p",
+                                  COMM_DEFAULT_BUFFER_COUNT, huart);
+                return NULL;
+            }
+        } else if (!comm_check_buffers(huart, rx_size, tx_buffer, tx_size)) {
+            return NULL;
+        }
+        
         instance = comm_create_instance(huart);
         if (instance == NULL) {
             return NULL;
         }
+        
+        if (from_pool) {
+            g_comm_manager.default_buffers_used++;
+            instance->default_buffers = true;
+        }
+        instance->rx_slot_size = rx_size / COMM_RX_FRAME_SLOTS;
+        for (uint8_t i = 0; i < COMM_RX_FRAME_SLOTS; i++) {
+            instance->rx_buffer[i] = &rx_buffer[i * instance->rx_slot_size];
+        }
+        instance->tx_buffer = tx_buffer;
+        instance->tx_buffer_size = tx_size;
     }
     
     // 初始化实例
@@ -422,15 +823,17 @@ comm_instance_t* comm_create_uart_instance(UART_HandleTypeDef *huart,
 }
 
 
-static int comm_find_callback_index(comm_instance_t *instance, const char *cmd)
+static int comm_find_callback_index(comm_instance_t *instance, const char *cmd, uint8_t cmd_len)
 {
     if (instance == NULL || cmd == NULL) {
         return -1;
     }
     
+    // 先比长度再比内容，避免逐个strcmp
     for (int i = 0; i < COMM_MAX_CALLBACKS; i++) {
-        if (instance->handlers[i].callback != NULL &&
-            strcmp(instance->handlers[i].cmd, cmd) == 0) {
+        if (instance->handlers[i].is_used &&
+            instance->handlers[i].cmd_len == cmd_len &&
+            memcmp(instance->handlers[i].cmd, cmd, cmd_len) == 0) {
             return i;
         }
     }
@@ -438,6 +841,41 @@ static int comm_find_callback_index(comm_instance_t *instance, const char *cmd)
     return -1;
 }
 
+static comm_handler_t* comm_alloc_handler(comm_instance_t *instance, const char *cmd)
+{
+    size_t cmd_len = strlen(cmd);
+    
+    // 检查命令长度
+    if (cmd_len >= COMM_MAX_CMD_LENGTH) {
+        COMM_DEBUG_INSTANCE(instance, "命令过长，无法注册: %s", cmd);
+        return NULL;
+    }
+    
+    // 检查是否已存在该命令的回调
+    int existing_index = comm_find_callback_index(instance, cmd, (uint8_t)cmd_len);
+    if (existing_index >= 0) {
+        // 更新现有回调
+        COMM_DEBUG_INSTANCE(instance, "更新回调: %s", cmd);
+        return &instance->handlers[existing_index];
+    }
+    
+    // 寻找空闲位置
+    for (int i = 0; i < COMM_MAX_CALLBACKS; i++) {
+        if (!instance->handlers[i].is_used) {
+            memcpy(instance->handlers[i].cmd, cmd, cmd_len);
+            instance->handlers[i].cmd[cmd_len] = '\0';
+            instance->handlers[i].cmd_len = (uint8_t)cmd_len;
+            instance->handlers[i].is_used = true;
+            
+            COMM_DEBUG_INSTANCE(instance, "注册回调成功: %s (位置 %d)", cmd, i);
+            return &instance->handlers[i];
+        }
+    }
+    
+    COMM_DEBUG_INSTANCE(instance, "回调表已满，无法注册: %s", cmd);
+    return NULL;
+}
+
 static comm_instance_t* comm_create_instance(UART_HandleTypeDef *huart)
 {
     if (huart == NULL) {
@@ -467,6 +905,25 @@ static comm_instance_t* comm_create_instance(UART_HandleTypeDef *huart)
     return instance;
 }
 
+/**
+ * @brief  检查用户提供的缓冲区大小
+ */
+static bool comm_check_buffers(UART_HandleTypeDef *huart, uint16_t rx_size,
+                               const char *tx_buffer, uint16_t tx_size)
+{
+    // 上限与默认大小一致，协议层的栈上临时缓冲区按默认大小分配
+    uint16_t slot_size = rx_size / COMM_RX_FRAME_SLOTS;
+    if (tx_buffer == NULL ||
+        slot_size < COMM_MIN_BUFFER_SIZE || slot_size > COMM_RX_SLOT_SIZE ||
+        tx_size < COMM_MIN_BUFFER_SIZE || tx_size > COMM_TX_BUFFER_SIZE) {
+        COMM_ERROR_OUTPUT("UART缓冲区大小无效: %p, 接收%u(每槽%d~%d), 发送%u(%d~%d)",
+                          huart, rx_size, COMM_MIN_BUFFER_SIZE, COMM_RX_SLOT_SIZE,
+                          tx_size, COMM_MIN_BUFFER_SIZE, COMM_TX_BUFFER_SIZE);
+        return false;
+    }
+    return true;
+}
+
 static const char* comm_state_to_string(uint8_t state)
 {
     switch (state) {
@@ -43,6 +43,13 @@ uint8_t comm_get_instance_count(void);
  */
 comm_instance_t* comm_get_instance_by_index(uint8_t index);
 
+/**
+ * @brief  获取实例在管理器中的索引
+ * @param  instance: 实例指针
+ * @retval 实例索引，实例为NULL或未添加到管理器返回-1
+ */
+int8_t comm_manager_instance_index(const comm_instance_t *instance);
+
 /* =============================================================================
  * 实例管理函数
  * =============================================================================
@@ -96,14 +103,28 @@ void comm_instance_reset(comm_instance_t *instance);
  */
 bool comm_register_callback(comm_instance_t *instance, const char *cmd, comm_callback_t callback);
 
+/**
+ * @brief  注册带上下文的命令回调函数
+ * @param  instance: 实例指针
+ * @param  cmd: 命令字符串
+ * @param  callback: 回调函数指针
+ * @param  user_ctx: 用户上下文
+ * @retval true: 注册成功, false: 注册失败
+ */
+bool comm_register_callback_ex(comm_instance_t *instance, const char *cmd,
+                               comm_callback_ex_t callback, void *user_ctx);
+
 /**
  * @brief  查找并调用命令回调函数
  * @param  instance: 实例指针
  * @param  cmd: 命令字符串
+ * @param  cmd_len: 命令长度
  * @param  data: 数据字符串
+ * @param  data_len: 数据长度
  * @retval true: 找到并调用了回调, false: 未找到回调
  */
-bool comm_call_callback(comm_instance_t *instance, const char *cmd, const char *data);
+bool comm_call_callback(comm_instance_t *instance, const char *cmd, uint8_t cmd_len,
+                        const char *data, uint16_t data_len);
 
 /**
  * @brief  设置失败回调函数
@@ -113,6 +134,26 @@ bool comm_call_callback(comm_instance_t *instance, const char *cmd, const char *
  */
 void comm_set_fail_callback(comm_instance_t *instance, comm_fail_callback_t callback);
 
+/**
+ * @brief  设置带上下文的失败回调函数
+ * @param  instance: 实例指针
+ * @param  callback: 失败回调函数指针
+ * @param  user_ctx: 用户上下文
+ * @retval None
+ */
+void comm_set_fail_callback_ex(comm_instance_t *instance, comm_fail_callback_ex_t callback, void *user_ctx);
+
+/**
+ * @brief  设置带上下文的状态变化回调函数
+ * @param  instance: 实例指针
+ * @param  callback: 状态变化回调函数指针
+ * @param  user_ctx: 用户上下文
+ * @retval None
+ */
+void comm_set_state_change_callback_ex(comm_instance_t *instance,
+                                       comm_state_change_callback_ex_t callback,
+                                       void *user_ctx);
+
 /**
  * @brief  调用失败回调函数
  * @param  instance: 实例指针
@@ -123,6 +164,16 @@ void comm_set_fail_callback(comm_instance_t *instance, comm_fail_callback_t call
  */
 void comm_call_fail_callback(comm_instance_t *instance, const char *cmd, const char *data, const char *reason);
 
+/**
+ * @brief  通知需确认的命令发送结束
+ * @param  instance: 实例指针
+ * @param  acked: true: 收到ACK, false: 放弃（重试用尽、链路断开、被抢占或实例重置）
+ * @retval None
+ * @note   在回到空闲之后调用，结束的是序列号为current_sequence的命令；
+ *         跟踪自己发出的命令的模块（RTOS运行时、聚合通道、持久化队列）按序列号认领结果
+ */
+void comm_call_send_done(comm_instance_t *instance, bool acked);
+
 /* =============================================================================
  * 超时和重试管理函数
  * =============================================================================
@@ -173,6 +224,37 @@ void comm_set_state(comm_instance_t *instance, uint8_t new_state);
  */
 bool comm_send_raw(comm_instance_t *instance, const char *data, uint16_t length);
 
+/**
+ * @brief  发送tx_buffer中已构建好的命令帧并进入等待ACK状态
+ * @param  instance: 实例指针
+ * @retval true: 已发送（RS-485从站为已排队）, false: 发送失败
+ * @note   调用前需设置好tx_buffer/tx_length和current_cmd/current_data
+ */
+bool comm_start_transmit(comm_instance_t *instance);
+
+/**
+ * @brief  阻塞发送，库内所有阻塞发送都经过这里
+ * @param  instance: 实例指针
+ * @param  data: 数据指针
+ * @param  length: 数据长度
+ * @param  timeout: 超时时间（毫秒）
+ * @retval HAL状态
+ * @note   启用RS-485时在发送前拉高DE，HAL等到发送完成(TC)返回后释放总线
+ */
+HAL_StatusTypeDef comm_uart_transmit(comm_instance_t *instance, const uint8_t *data,
+                                     uint16_t length, uint32_t timeout);
+
+/**
+ * @brief  中断方式发送
+ * @param  instance: 实例指针
+ * @param  data: 数据指针（发送完成前必须保持有效）
+ * @param  length: 数据长度
+ * @retval HAL状态
+ * @note   启用RS-485时DE在comm_uart_tx_callback()中释放
+ */
+HAL_StatusTypeDef comm_uart_transmit_it(comm_instance_t *instance, const uint8_t *data,
+                                        uint16_t length);
+
 /* =============================================================================
  * 全局实例查找函数
  * =============================================================================
@@ -196,4 +278,22 @@ comm_instance_t* comm_create_uart_instance(UART_HandleTypeDef *huart,
                                           uint32_t timeout_ms, 
                                           uint8_t max_retry);
 
+/**
+ * @brief  使用指定缓冲区创建新的UART实例
+ * @param  huart: UART句柄指针
+ * @param  timeout_ms: 超时时间（毫秒）
+ * @param  max_retry: 最大重试次数
+ * @param  rx_buffer: 接收缓冲区，平分为COMM_RX_FRAME_SLOTS个接收槽；NULL表示使用默认缓冲区池
+ * @param  rx_size: 接收缓冲区大小
+ * @param  tx_buffer: 发送缓冲区
+ * @param  tx_size: 发送缓冲区大小
+ * @retval 实例指针，创建失败返回NULL
+ * @note   实例已存在时只重新初始化，保留原有缓冲区
+ */
+comm_instance_t* comm_create_uart_instance_ex(UART_HandleTypeDef *huart,
+                                             uint32_t timeout_ms,
+                                             uint8_t max_retry,
+                                             char *rx_buffer, uint16_t rx_size,
+                                             char *tx_buffer, uint16_t tx_size);
+
 #endif /* COMM_MANAGER_H */
\ No newline at end of file
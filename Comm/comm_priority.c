@@ -0,0 +1,215 @@
+/**
+ * @file    comm_priority.c
+ * @brief   通信库发送优先级 - 分级队列、严格/加权调度、BULK抢占
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_priority.h"
+
+#if COMM_ENABLE_PRIORITY
+
+#include "comm.h"
+#include "comm_manager.h"
+#include <string.h>
+
+/* Private function prototypes -----------------------------------------------*/
+static bool comm_lane_push(comm_lane_t *lane, const char *cmd, const char *data, bool to_front);
+static void comm_priority_preempt(comm_instance_t *instance);
+static int8_t comm_priority_pick(comm_instance_t *instance);
+
+/* =============================================================================
+ * 发送API实现
+ * =============================================================================
+ */
+
+bool comm_send_command_prio(UART_HandleTypeDef *huart, const char *cmd, const char *data,
+                            comm_priority_t prio)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || cmd == NULL || data == NULL || prio > COMM_PRIORITY_BULK) {
+        return false;
+    }
+
+    // 入队时检查长度，避免出队后发送必然失败
+    if (strlen(cmd) >= COMM_MAX_CMD_LENGTH || strlen(data) >= COMM_MAX_DATA_LENGTH) {
+        return false;
+    }
+
+    if (!comm_lane_push(&instance->priority.lanes[prio], cmd, data, false)) {
+        COMM_DEBUG_INSTANCE(instance, "优先级%d队列已满: %s", prio, cmd);
+        return false;
+    }
+
+    return true;
+}
+
+uint8_t comm_get_queue_length(UART_HandleTypeDef *huart, comm_priority_t prio)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || prio > COMM_PRIORITY_BULK) {
+        return 0;
+    }
+
+    return instance->priority.lanes[prio].count;
+}
+
+uint32_t comm_get_preempt_count(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return 0;
+    }
+
+    return instance->priority.preempted;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_priority_process(comm_instance_t *instance)
+{
+    comm_priority_preempt(instance);
+
+    if (!comm_instance_is_ready(instance)) {
+        return;
+    }
+
+    int8_t prio = comm_priority_pick(instance);
+    if (prio < 0) {
+        return;
+    }
+
+    comm_lane_t *lane = &instance->priority.lanes[prio];
+    comm_queued_cmd_t *item = &lane->items[lane->head];
+
+    // 发送失败（UART忙等）时保留在队头，下个tick再试
+    if (comm_send_command(instance->huart, item->cmd, item->data)) {
+        instance->priority.in_flight = (uint8_t)prio;
+        lane->head = (uint8_t)((lane->head + 1) % COMM_PRIORITY_QUEUE_DEPTH);
+        lane->count--;
+    }
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  命令入队
+ * @param  to_front: true插到队头（被抢占的命令优先恢复）
+ */
+static bool comm_lane_push(comm_lane_t *lane, const char *cmd, const char *data, bool to_front)
+{
+    if (lane->count >= COMM_PRIORITY_QUEUE_DEPTH) {
+        return false;
+    }
+
+    uint8_t index;
+    if (to_front) {
+        lane->head = (uint8_t)((lane->head + COMM_PRIORITY_QUEUE_DEPTH - 1) % COMM_PRIORITY_QUEUE_DEPTH);
+        index = lane->head;
+    } else {
+        index = (uint8_t)((lane->head + lane->count) % COMM_PRIORITY_QUEUE_DEPTH);
+    }
+
+    // 长度已由调用方检查，这里只做防御性截断
+    comm_queued_cmd_t *item = &lane->items[index];
+    size_t cmd_len = strlen(cmd);
+    size_t data_len = strlen(data);
+    if (cmd_len >= sizeof(item->cmd)) {
+        cmd_len = sizeof(item->cmd) - 1;
+    }
+    if (data_len >= sizeof(item->data)) {
+        data_len = sizeof(item->data) - 1;
+    }
+    memcpy(item->cmd, cmd, cmd_len);
+    item->cmd[cmd_len] = '\0';
+    memcpy(item->data, data, data_len);
+    item->data[data_len] = '\0';
+    lane->count++;
+    return true;
+}
+
+/**
+ * @brief  有URGENT命令等待时，放弃正在等待ACK的BULK命令并放回队头
+ */
+static void comm_priority_preempt(comm_instance_t *instance)
+{
+    comm_priority_queue_t *queue = &instance->priority;
+
+    if (queue->lanes[COMM_PRIORITY_URGENT].count == 0 || queue->in_flight != COMM_PRIORITY_BULK) {
+        return;
+    }
+
+    if (instance->state != COMM_STATE_WAIT_ACK && instance->state != COMM_STATE_SENDING) {
+        return;
+    }
+
+    if (!comm_lane_push(&queue->lanes[COMM_PRIORITY_BULK], instance->current_cmd,
+                        instance->current_data, true)) {
+        // BULK队列已满，只能放弃这条命令
+        comm_call_fail_callback(instance, instance->current_cmd,
+                               instance->current_data, "被紧急命令抢占");
+    }
+
+#if COMM_ENABLE_RS485
+    instance->rs485.tx_deferred = false;
+#endif
+
+    // 迟到的ACK与新命令的序列号不匹配，会被忽略
+    queue->in_flight = COMM_PRIORITY_NONE;
+    queue->preempted++;
+    instance->retry_count = 0;
+    comm_set_state(instance, COMM_STATE_IDLE);
+    comm_call_send_done(instance, false);
+
+    COMM_DEBUG_INSTANCE(instance, "BULK命令被抢占: %s", instance->current_cmd);
+}
+
+/**
+ * @brief  选择下一个要发送的优先级
+ * @retval 优先级，没有排队命令返回-1
+ */
+static int8_t comm_priority_pick(comm_instance_t *instance)
+{
+    comm_priority_queue_t *queue = &instance->priority;
+    int8_t highest = -1;
+    int8_t lowest = -1;
+
+    for (int8_t i = 0; i < COMM_PRIORITY_LANES; i++) {
+        if (queue->lanes[i].count > 0) {
+            if (highest < 0) {
+                highest = i;
+            }
+            lowest = i;
+        }
+    }
+
+    if (highest < 0) {
+        return -1;
+    }
+
+#if COMM_PRIORITY_WEIGHTED
+    // 低优先级等待时，高优先级连续发送WEIGHT帧后让出一帧
+    if (highest != lowest) {
+        if (queue->streak >= COMM_PRIORITY_URGENT_WEIGHT) {
+            queue->streak = 0;
+            return lowest;
+        }
+        queue->streak++;
+        return highest;
+    }
+#else
+    (void)lowest;
+#endif
+
+    queue->streak = 0;
+    return highest;
+}
+
+#endif /* COMM_ENABLE_PRIORITY */
@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ * @file           : comm_priority.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信发送优先级队列
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 发送优先级 - 紧急命令不再排在慢速命令的重试后面
+ *
+ * 优先级从高到低：
+ *   - 控制帧: ACK/NAK/POLL等，总是立即发送，不排队
+ *   - COMM_PRIORITY_URGENT: 急停等安全命令，可抢占正在等待ACK的BULK命令
+ *   - COMM_PRIORITY_NORMAL: 普通命令，comm_send_command()直接发送的命令也按此级别
+ *   - COMM_PRIORITY_BULK:   大批量数据，逐帧调度，每帧之间都可被更高优先级插队
+ *
+ * 被抢占的BULK命令放回队头，之后用新的序列号重发，接收方可能收到两次，
+ * 因此BULK命令必须是幂等的（例如带偏移量的分片写入）。
+ *
+ * URGENT命令的最坏等待时间 = 一个comm_tick周期 + 线上正在传输的一帧。
+ *
+ * 使用示例:
+ *   comm_send_command_prio(&huart2, "LOG", "chunk0...", COMM_PRIORITY_BULK);
+ *   comm_send_command_prio(&huart2, "STOP", "ALL", COMM_PRIORITY_URGENT);
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_PRIORITY_H
+#define COMM_PRIORITY_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_PRIORITY
+
+typedef enum {
+    COMM_PRIORITY_URGENT = 0,       /**< 紧急，可抢占BULK */
+    COMM_PRIORITY_NORMAL,           /**< 普通 */
+    COMM_PRIORITY_BULK              /**< 批量，可被抢占 */
+} comm_priority_t;
+
+/* =============================================================================
+ * 发送API
+ * =============================================================================
+ */
+
+/**
+ * @brief  按优先级排队发送命令
+ * @param  huart: UART句柄指针
+ * @param  cmd: 命令字符串
+ * @param  data: 数据字符串
+ * @param  prio: 优先级
+ * @retval true: 已排队, false: 队列满或参数错误
+ * @note   实际发送在comm_tick()中进行，失败仍通过失败回调通知
+ */
+bool comm_send_command_prio(UART_HandleTypeDef *huart, const char *cmd, const char *data,
+                            comm_priority_t prio);
+
+/**
+ * @brief  获取某个优先级队列中等待的命令数
+ * @param  huart: UART句柄指针
+ * @param  prio: 优先级
+ * @retval 等待的命令数
+ */
+uint8_t comm_get_queue_length(UART_HandleTypeDef *huart, comm_priority_t prio);
+
+/**
+ * @brief  获取BULK命令被抢占的次数
+ * @param  huart: UART句柄指针
+ * @retval 抢占次数
+ */
+uint32_t comm_get_preempt_count(UART_HandleTypeDef *huart);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  抢占和调度排队的命令
+ * @param  instance: 实例指针
+ * @retval None
+ * @note   由comm_tick()调用
+ */
+void comm_priority_process(comm_instance_t *instance);
+
+#endif /* COMM_ENABLE_PRIORITY */
+
+#endif /* COMM_PRIORITY_H */
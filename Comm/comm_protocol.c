@@ -9,6 +9,45 @@
 
 #include "comm_protocol.h"
 #include "comm_manager.h"
+#if COMM_ENABLE_PUBSUB
+#include "comm_pubsub.h"
+#endif
+#if COMM_ENABLE_RS485
+#include "comm_rs485.h"
+#endif
+#if COMM_ENABLE_ROUTER
+#include "comm_router.h"
+#endif
+#if COMM_ENABLE_CREDITS
+#include "comm_credit.h"
+#endif
+#if COMM_ENABLE_BAUD
+#include "comm_baud.h"
+#endif
+#if COMM_ENABLE_BATCH
+#include "comm_batch.h"
+#endif
+#if COMM_ENABLE_COMPRESS
+#include "comm_compress.h"
+#endif
+#if COMM_ENABLE_LINK
+#include "comm_link.h"
+#endif
+#if COMM_ENABLE_SESSION
+#include "comm_session.h"
+#endif
+#if COMM_ENABLE_FEC
+#include "comm_fec.h"
+#endif
+#if COMM_ENABLE_BOND
+#include "comm_bond.h"
+#endif
+#if COMM_ENABLE_QUERY
+#include "comm_query.h"
+#endif
+#if COMM_ENABLE_CLOCK
+#include "comm_clock.h"
+#endif
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -51,6 +90,67 @@ static const uint8_t crc8_table[256] = {
 };
 #endif
 
+/* 帧序列化器：一次遍历直接写入目标缓冲区，边写边累积CRC */
+typedef struct {
+    char *buf;                              /**< 目标缓冲区 */
+    uint16_t limit;                         /**< 缓冲区大小，最多写入limit-1个字符（保留'\0'） */
+    uint16_t len;                           /**< 已写入长度 */
+    uint8_t crc;                            /**< 起始符之后内容的CRC累积值 */
+    bool overflow;                          /**< 缓冲区不足 */
+} comm_frame_writer_t;
+
+/* 固定命令帧模板："CMD:"部分的CRC预先算好，构建时整段拷贝 */
+typedef struct {
+    const char *cmd;                        /**< 命令 */
+    uint8_t cmd_len;                        /**< 命令长度 */
+    uint8_t crc;                            /**< "CMD:"的CRC累积值 */
+} comm_frame_template_t;
+
+static comm_frame_template_t g_comm_frame_templates[] = {
+    { COMM_CMD_ACK,  sizeof(COMM_CMD_ACK) - 1,  0 },
+    { COMM_CMD_NAK,  sizeof(COMM_CMD_NAK) - 1,  0 },
+    { COMM_CMD_PING, sizeof(COMM_CMD_PING) - 1, 0 },
+    { COMM_CMD_PONG, sizeof(COMM_CMD_PONG) - 1, 0 },
+};
+
+#define COMM_TEMPLATE_ACK   (&g_comm_frame_templates[0])
+#define COMM_TEMPLATE_NAK   (&g_comm_frame_templates[1])
+
+static const char g_comm_hex_digits[16] = "0123456789ABCDEF";
+
+/* Private function prototypes -----------------------------------------------*/
+static void comm_writer_begin(comm_frame_writer_t *w, char *buf, uint16_t size);
+static void comm_writer_put(comm_frame_writer_t *w, char c);
+static void comm_writer_puts(comm_frame_writer_t *w, const char *str);
+static void comm_writer_put_hex(comm_frame_writer_t *w, uint32_t value, uint8_t digits);
+#if COMM_ENABLE_CREDITS
+static void comm_writer_put_hex_var(comm_frame_writer_t *w, uint32_t value);
+#endif
+static void comm_writer_put_command(comm_frame_writer_t *w, const char *cmd);
+static void comm_writer_put_template(comm_frame_writer_t *w, const comm_frame_template_t *tpl);
+static void comm_writer_put_address(comm_frame_writer_t *w, const comm_instance_t *instance, uint8_t dst);
+static bool comm_writer_finish(comm_frame_writer_t *w, comm_instance_t *instance, uint16_t *frame_length);
+
+/**
+ * @brief  CRC8累积一个字节
+ */
+static inline uint8_t comm_crc8_step(uint8_t crc, uint8_t byte)
+{
+#if COMM_ENABLE_FAST_CRC
+    return crc8_table[crc ^ byte];
+#else
+    crc ^= byte;
+    for (int j = 0; j < 8; j++) {
+        if (crc & 0x80) {
+            crc = (crc << 1) ^ 0x07;
+        } else {
+            crc <<= 1;
+        }
+    }
+    return crc;
+#endif
+}
+
 /* =============================================================================
  * CRC计算函数实现
  * =============================================================================
@@ -92,12 +192,221 @@ bool comm_crc8_verify(const uint8_t *data, uint16_t length, uint8_t expected_crc
     return (calculated_crc == expected_crc);
 }
 
+uint8_t comm_crc8_update(uint8_t crc, uint8_t byte)
+{
+    return comm_crc8_step(crc, byte);
+}
+
+void comm_protocol_init(void)
+{
+    // 固定命令的"CMD:"部分不变，CRC只算一次
+    for (uint8_t i = 0; i < sizeof(g_comm_frame_templates) / sizeof(g_comm_frame_templates[0]); i++) {
+        comm_frame_template_t *tpl = &g_comm_frame_templates[i];
+        uint8_t crc = comm_crc8_calculate((const uint8_t *)tpl->cmd, tpl->cmd_len);
+        tpl->crc = comm_crc8_step(crc, COMM_CMD_DATA_SEPARATOR);
+    }
+}
+
+/* =============================================================================
+ * 字段解析辅助函数
+ * =============================================================================
+ */
+
+int8_t comm_hex_nibble(uint8_t c)
+{
+    if (c >= '0' && c <= '9') return (int8_t)(c - '0');
+    if (c >= 'A' && c <= 'F') return (int8_t)(c - 'A' + 10);
+    if (c >= 'a' && c <= 'f') return (int8_t)(c - 'a' + 10);
+    return -1;
+}
+
+uint8_t comm_hex_encode(char *out, uint32_t value, uint8_t digits)
+{
+    for (uint8_t i = 0; i < digits; i++) {
+        out[i] = g_comm_hex_digits[(value >> (4 * (digits - 1 - i))) & 0x0F];
+    }
+    return digits;
+}
+
+bool comm_hex_decode(const char *text, uint16_t length, uint32_t *value)
+{
+    if (text == NULL || value == NULL || length == 0 || length > 8) {
+        return false;
+    }
+
+    uint32_t result = 0;
+    for (uint16_t i = 0; i < length; i++) {
+        int8_t nibble = comm_hex_nibble((uint8_t)text[i]);
+        if (nibble < 0) {
+            return false;
+        }
+        result = (result << 4) | (uint32_t)nibble;
+    }
+    *value = result;
+    return true;
+}
+
+/**
+ * @brief  解析定长十六进制字段，遇到非十六进制字符停止
+ */
+static uint16_t comm_parse_hex(const char *str, uint16_t length)
+{
+    uint16_t value = 0;
+    for (uint16_t i = 0; i < length && i < 4; i++) {
+        int8_t nibble = comm_hex_nibble((uint8_t)str[i]);
+        if (nibble < 0) {
+            break;
+        }
+        value = (uint16_t)((value << 4) | (uint16_t)nibble);
+    }
+    return value;
+}
+
+bool comm_frame_cmd_is(const comm_instance_t *instance, const comm_frame_t *frame, const char *expected)
+{
+    if (instance == NULL || frame == NULL || expected == NULL) {
+        return false;
+    }
+    
+    size_t expected_len = strlen(expected);
+    return (frame->cmd_len == expected_len) &&
+           (memcmp(COMM_FRAME_CMD(instance, frame), expected, expected_len) == 0);
+}
+
+#if COMM_ENABLE_FEC
+/**
+ * @brief  扫描十六进制字段，可选累积CRC
+ * @retval 字段位数，超过max_digits时返回max_digits+1
+ */
+static uint8_t comm_scan_hex(const char *text, uint16_t *pos, uint16_t end, uint8_t max_digits,
+                             uint16_t *value, uint8_t *crc)
+{
+    uint8_t digits = 0;
+    *value = 0;
+    while (*pos < end) {
+        int8_t nibble = comm_hex_nibble((uint8_t)text[*pos]);
+        if (nibble < 0) {
+            break;
+        }
+        if (++digits > max_digits) {
+            break;
+        }
+        *value = (uint16_t)((*value << 4) | (uint16_t)nibble);
+        if (crc != NULL) {
+            *crc = comm_crc8_step(*crc, (uint8_t)text[*pos]);
+        }
+        (*pos)++;
+    }
+    return digits;
+}
+
+bool comm_parse_frame(comm_instance_t *instance, comm_frame_t *frame, uint16_t length)
+{
+    char *text = instance->rx_buffer[frame->slot];
+    frame->is_valid = false;
+#if COMM_ENABLE_RS485
+    frame->has_address = false;
+#endif
+    if (length < 2 || text[0] != COMM_FRAME_START || text[length - 1] != COMM_FRAME_END) {
+        return false;
+    }
+    
+    uint16_t end = length - 1;
+    uint16_t pos = 1;
+    uint8_t crc = 0;
+    
+    // 命令
+    while (pos < end && text[pos] != COMM_CMD_DATA_SEPARATOR) {
+        crc = comm_crc8_step(crc, (uint8_t)text[pos++]);
+    }
+    if (pos >= end || pos - 1 > COMM_MAX_CMD_LENGTH) {
+        return false;
+    }
+    frame->cmd_offset = 1;
+    frame->cmd_len = (uint8_t)(pos - 1);
+    crc = comm_crc8_step(crc, COMM_CMD_DATA_SEPARATOR);
+    text[pos++] = '\0';
+    
+    // 数据
+    frame->data_offset = pos;
+    while (pos < end && text[pos] != COMM_FIELD_SEPARATOR) {
+        crc = comm_crc8_step(crc, (uint8_t)text[pos++]);
+    }
+    if (pos >= end) {
+        return false;
+    }
+    frame->data_len = pos - frame->data_offset;
+    crc = comm_crc8_step(crc, COMM_FIELD_SEPARATOR);
+    text[pos++] = '\0';
+#if COMM_ENABLE_ROUTER
+    frame->crc_partial = crc;
+#endif
+    
+    // 序列号[@地址]
+    uint16_t value;
+    uint8_t digits = comm_scan_hex(text, &pos, end, COMM_SEQ_DIGITS, &value, &crc);
+    if (digits == 0 || digits > COMM_SEQ_DIGITS) {
+        return false;
+    }
+    frame->sequence = (comm_seq_t)value;
+#if COMM_ENABLE_RS485
+    if (text[pos] == COMM_ADDR_SEPARATOR) {
+        crc = comm_crc8_step(crc, (uint8_t)text[pos++]);
+        if (comm_scan_hex(text, &pos, end, 4, &value, &crc) != 4) {
+            return false;
+        }
+        frame->dst_addr = (uint8_t)(value >> 8);
+        frame->src_addr = (uint8_t)(value & 0xFF);
+        frame->has_address = true;
+    }
+#endif
+    if (text[pos++] != COMM_FIELD_SEPARATOR) {
+        return false;
+    }
+    
+    // CRC，之后必须正好是结束符
+    digits = comm_scan_hex(text, &pos, end, 2, &value, NULL);
+    if (digits == 0 || digits > 2 || pos != end) {
+        return false;
+    }
+    frame->crc = (uint8_t)value;
+    frame->is_valid = (crc == frame->crc);
+    return frame->is_valid;
+}
+#endif
+
+/**
+ * @brief  命令和数据报的目标地址
+ */
+static uint8_t comm_tx_address(const comm_instance_t *instance)
+{
+#if COMM_ENABLE_RS485
+    return instance->rs485.peer_addr;
+#else
+    (void)instance;
+    return 0;
+#endif
+}
+
+/**
+ * @brief  ACK/NAK的目标地址（最近一帧的源地址）
+ */
+static uint8_t comm_reply_address(const comm_instance_t *instance)
+{
+#if COMM_ENABLE_RS485
+    return instance->rs485.rx_peer;
+#else
+    (void)instance;
+    return 0;
+#endif
+}
+
 /* =============================================================================
  * 序列号管理函数实现
  * =============================================================================
  */
 
-uint8_t comm_get_next_tx_sequence(comm_instance_t *instance)
+comm_seq_t comm_get_next_tx_sequence(comm_instance_t *instance)
 {
     if (instance == NULL) {
         return 0;
@@ -113,55 +422,44 @@ uint8_t comm_get_next_tx_sequence(comm_instance_t *instance)
     return instance->tx_sequence;
 }
 
-bool comm_is_valid_rx_sequence(comm_instance_t *instance, uint8_t rx_seq)
+bool comm_is_valid_rx_sequence(comm_instance_t *instance, comm_seq_t rx_seq)
 {
     if (instance == NULL) {
         return false;
     }
 
-    int16_t diff = (int16_t)rx_seq - (int16_t)instance->rx_sequence;
-
-    if (diff < -128) {
-        diff += 256;  // 正向回绕：255->1
-    } else if (diff > 128) {
-        diff -= 256;
+    // 按序列号空间取模求差，超过半个空间视为倒退（正向回绕：MAX->1）
+    int32_t diff = (comm_seq_t)(rx_seq - instance->rx_sequence);
+    if (diff > COMM_MAX_SEQUENCE / 2) {
+        diff -= (int32_t)COMM_MAX_SEQUENCE + 1;
     }
     
     // 接受策略：
     // 1. 序列号递增1（正常情况）
-    // 2. 序列号递增2-10（允许少量丢包）
+    // 2. 序列号递增2~COMM_SEQ_ACCEPT_WINDOW（允许少量丢包）
     // 3. 拒绝重复序列号（diff <= 0）
-    // 4. 拒绝跳跃过大的序列号（diff > 10）
+    // 4. 拒绝跳跃过大的序列号（diff > COMM_SEQ_ACCEPT_WINDOW）
     
-    if (diff >= 1 && diff <= 10) {
+    if (diff >= 1 && diff <= COMM_SEQ_ACCEPT_WINDOW) {
         return true;
     } else if (diff == 0) {
         // 重复序列号，需要重发ACK
-        #if COMM_ENABLE_STATS
-        instance->stats.rx_seq_error++;
-        #endif
         COMM_DEBUG_INSTANCE(instance, "重复序列号: %d", rx_seq);
         return false;
     } else if (diff < 0) {
         // 序列号倒退，拒绝
-        #if COMM_ENABLE_STATS
-        instance->stats.rx_seq_error++;
-        #endif
-        COMM_DEBUG_INSTANCE(instance, "序列号倒退: %d -> %d (差值=%d)", 
-                           instance->rx_sequence, rx_seq, diff);
+        COMM_DEBUG_INSTANCE(instance, "序列号倒退: %d -> %d (差值=%ld)", 
+                           instance->rx_sequence, rx_seq, (long)diff);
         return false;
     } else {
         // 序列号跳跃过大，拒绝
-        #if COMM_ENABLE_STATS
-        instance->stats.rx_seq_error++;
-        #endif
-        COMM_DEBUG_INSTANCE(instance, "序列号跳跃过大: %d -> %d (差值=%d)", 
-                           instance->rx_sequence, rx_seq, diff);
+        COMM_DEBUG_INSTANCE(instance, "序列号跳跃过大: %d -> %d (差值=%ld)", 
+                           instance->rx_sequence, rx_seq, (long)diff);
         return false;
     }
 }
 
-void comm_update_rx_sequence(comm_instance_t *instance, uint8_t rx_seq)
+void comm_update_rx_sequence(comm_instance_t *instance, comm_seq_t rx_seq)
 {
     if (instance != NULL) {
         instance->rx_sequence = rx_seq;
@@ -180,14 +478,14 @@ bool comm_build_frame(comm_instance_t *instance, const char *cmd, const char *da
         return false;
     }
     
-    // 检查命令和数据长度
-    if (strlen(cmd) > COMM_MAX_CMD_LENGTH || strlen(data) > COMM_MAX_DATA_LENGTH) {
-        COMM_DEBUG_INSTANCE(instance, "帧构建失败: 命令或数据过长");
+    // 检查命令长度；数据长度由调用方检查（批量帧可超过COMM_MAX_DATA_LENGTH），这里只受发送缓冲区限制
+    if (strlen(cmd) > COMM_MAX_CMD_LENGTH) {
+        COMM_DEBUG_INSTANCE(instance, "帧构建失败: 命令过长");
         return false;
     }
     
     // 获取序列号（如果是重试，使用保存的序列号；否则获取新序列号）
-    uint8_t seq;
+    comm_seq_t seq;
     if (instance->retry_count > 0) {
         // 重试时使用保存的序列号
         seq = instance->current_sequence;
@@ -197,31 +495,27 @@ bool comm_build_frame(comm_instance_t *instance, const char *cmd, const char *da
         instance->current_sequence = seq;
     }
 
-    char frame_content[COMM_TX_BUFFER_SIZE];
-    int content_len = snprintf(frame_content, sizeof(frame_content), 
-                              "%c%s%c%s%c%02X", 
-                              COMM_FRAME_START, cmd, COMM_CMD_DATA_SEPARATOR, 
-                              data, COMM_FIELD_SEPARATOR, seq);
-    
-    if (content_len < 0 || content_len >= sizeof(frame_content)) {
-        COMM_DEBUG_INSTANCE(instance, "帧构建失败: 格式化错误");
-        return false;
-    }
-    
-    // 计算CRC（只对内容部分，不包括起始符）
-    uint8_t crc = comm_crc8_calculate((uint8_t*)(frame_content + 1), content_len - 1);
-    
-    // 构建完整帧
-    int total_len = snprintf(frame_buffer, COMM_TX_BUFFER_SIZE, 
-                            "%s%c%02X%c",
-                            frame_content, COMM_FIELD_SEPARATOR, crc, COMM_FRAME_END);
+#if COMM_ENABLE_COMPRESS
+    // 压缩在CRC之前进行，重试时对同样的数据重新压缩，结果不变
+    char packed_cmd[COMM_MAX_CMD_LENGTH + 2];
+    char packed_data[COMM_TX_BUFFER_SIZE];
+    comm_compress_pack(instance, &cmd, &data, packed_cmd, packed_data);
+#endif
+
+    // 直接写入发送缓冲区: {CMD:DATA#SEQ[@DDSS]#CRC}
+    comm_frame_writer_t w;
+    comm_writer_begin(&w, frame_buffer, instance->tx_buffer_size);
+    comm_writer_put_command(&w, cmd);
+    comm_writer_puts(&w, data);
+    comm_writer_put(&w, COMM_FIELD_SEPARATOR);
+    comm_writer_put_hex(&w, seq, COMM_SEQ_DIGITS);
+    comm_writer_put_address(&w, instance, comm_tx_address(instance));
     
-    if (total_len < 0 || total_len >= COMM_TX_BUFFER_SIZE) {
+    if (!comm_writer_finish(&w, instance, frame_length)) {
         COMM_DEBUG_INSTANCE(instance, "帧构建失败: 输出缓冲区溢出");
         return false;
     }
     
-    *frame_length = (uint16_t)total_len;
     instance->expected_ack_seq = seq;  // 期望收到确认这个序列号的ACK
     
     COMM_DEBUG_INSTANCE(instance, "设置expected_ack_seq=%d (发送seq=%d)", 
@@ -236,29 +530,56 @@ void comm_process_byte_in_interrupt(comm_instance_t *instance, uint8_t byte)
         return;
     }
     
-
-    if (instance->new_frame_available) {
-        return;
-    }
+    // 正在写入的槽：前面的帧处理完之前不会被复用
+    uint8_t slot = instance->rx_produced % COMM_RX_FRAME_SLOTS;
+    comm_frame_t *frame = &instance->rx_frames[slot];
+    char *rx_buffer = instance->rx_buffer[slot];
     
     switch (instance->parse_state) {
         case FRAME_STATE_IDLE:
             if (byte == COMM_FRAME_START) {
+                if ((uint8_t)(instance->rx_produced - instance->rx_consumed) >= COMM_RX_FRAME_SLOTS) {
+                    // 所有槽都在等待处理，丢弃这一帧
+                    break;
+                }
+                frame->slot = slot;
                 instance->parse_state = FRAME_STATE_CMD;
                 instance->rx_index = 0;
+                instance->rx_crc = 0;
                 instance->frame_timeout = HAL_GetTick() + COMM_FRAME_TIMEOUT_MS;
-                // 确保清空pending_frame缓冲区
-                memset(&instance->pending_frame, 0, sizeof(comm_frame_t));
+                frame->cmd_offset = 0;
+                frame->is_valid = false;
+#if COMM_ENABLE_RS485
+                frame->has_address = false;
+#endif
+#if COMM_ENABLE_FEC
+                frame->fec_length = 0;
+#endif
             }
+#if COMM_ENABLE_FEC
+            else if (byte == COMM_FEC_FRAME_START &&
+                     (uint8_t)(instance->rx_produced - instance->rx_consumed) < COMM_RX_FRAME_SLOTS) {
+                // 纠错帧先原样收下，纠错和字段解析留给comm_tick()
+                frame->slot = slot;
+                frame->is_valid = false;
+                instance->parse_state = FRAME_STATE_FEC_HEADER;
+                instance->rx_index = 0;
+                instance->frame_timeout = HAL_GetTick() + COMM_FRAME_TIMEOUT_MS;
+            }
+#endif
             break;
             
         case FRAME_STATE_CMD:
             if (byte == COMM_CMD_DATA_SEPARATOR) {
-                instance->pending_frame.cmd[instance->rx_index] = '\0';
+                // 分隔符原地改写为'\0'，命令视图直接以'\0'结尾
+                rx_buffer[instance->rx_index++] = '\0';
+                instance->rx_crc = comm_crc8_update(instance->rx_crc, byte);
+                frame->cmd_len = (uint8_t)(instance->rx_index - 1 - frame->cmd_offset);
+                frame->data_offset = instance->rx_index;
                 instance->parse_state = FRAME_STATE_DATA;
-                instance->rx_index = 0;
             } else if (instance->rx_index < COMM_MAX_CMD_LENGTH) {
-                instance->pending_frame.cmd[instance->rx_index++] = byte;
+                rx_buffer[instance->rx_index++] = byte;
+                instance->rx_crc = comm_crc8_update(instance->rx_crc, byte);
             } else {
                 // 命令过长，重置
                 instance->parse_state = FRAME_STATE_IDLE;
@@ -267,11 +588,19 @@ void comm_process_byte_in_interrupt(comm_instance_t *instance, uint8_t byte)
             
         case FRAME_STATE_DATA:
             if (byte == COMM_FIELD_SEPARATOR) {
-                instance->pending_frame.data[instance->rx_index] = '\0';
+                rx_buffer[instance->rx_index] = '\0';
+                instance->rx_crc = comm_crc8_update(instance->rx_crc, byte);
+                frame->data_len = instance->rx_index - frame->data_offset;
+#if COMM_ENABLE_ROUTER
+                frame->crc_partial = instance->rx_crc;
+#endif
+                instance->rx_hex_value = 0;
+                instance->rx_hex_count = 0;
                 instance->parse_state = FRAME_STATE_SEQ;
-                instance->rx_index = 0;
-            } else if (instance->rx_index < COMM_MAX_DATA_LENGTH) {
-                instance->pending_frame.data[instance->rx_index++] = byte;
+            } else if (instance->rx_index < instance->rx_slot_size - 1) {
+                // 数据长度只受接收槽大小限制（保留1字节给结尾'\0'）
+                rx_buffer[instance->rx_index++] = byte;
+                instance->rx_crc = comm_crc8_update(instance->rx_crc, byte);
             } else {
                 // 数据过长，重置
                 instance->parse_state = FRAME_STATE_IDLE;
@@ -279,52 +608,143 @@ void comm_process_byte_in_interrupt(comm_instance_t *instance, uint8_t byte)
             break;
             
         case FRAME_STATE_SEQ:
-            if (byte == COMM_FIELD_SEPARATOR) {
-                // 解析序列号（十六进制字符串）
-                instance->rx_buffer[instance->rx_index] = '\0';
-                instance->pending_frame.sequence = (uint8_t)strtol(instance->rx_buffer, NULL, 16);
+        case FRAME_STATE_CRC: {
+            bool is_seq = (instance->parse_state == FRAME_STATE_SEQ);
+            uint8_t terminator = is_seq ? COMM_FIELD_SEPARATOR : COMM_FRAME_END;
+            int8_t nibble = comm_hex_nibble(byte);
+            
+            if (byte == terminator && instance->rx_hex_count > 0) {
+                if (is_seq) {
+                    frame->sequence = (comm_seq_t)instance->rx_hex_value;
+                    instance->rx_hex_value = 0;
+                    instance->rx_hex_count = 0;
+                    instance->parse_state = FRAME_STATE_CRC;
+                } else {
+                    // CRC已随接收逐字节累积，这里直接比较
+                    frame->crc = (uint8_t)instance->rx_hex_value;
+                    frame->is_valid = (instance->rx_crc == frame->crc);
+#if COMM_ENABLE_STATS
+                    if (!frame->is_valid) {
+                        instance->stats.rx_crc_error++;
+                    }
+#endif
+#if COMM_ENABLE_BAUD
+                    if (!frame->is_valid) {
+                        comm_baud_note_error(instance);
+                    }
+#endif
+#if COMM_ENABLE_LINK
+                    if (!frame->is_valid) {
+                        comm_link_note_error(instance);
+                    }
+#endif
+#if COMM_ENABLE_RS485
+                    // 发给其他节点的帧在中断里直接丢弃，不占用待处理帧
+                    if (frame->is_valid && !comm_rs485_accept_frame(instance, frame)) {
+                        frame->is_valid = false;
+                    } else
+#endif
+                    if (frame->is_valid) {
+#if COMM_ENABLE_CLOCK
+                        frame->rx_time_us = comm_clock_read(instance);
+#endif
+                        instance->rx_produced++;
+                    }
+                    instance->parse_state = FRAME_STATE_IDLE;
+                    instance->rx_index = 0;
+                }
+            } else if (nibble >= 0 && instance->rx_hex_count < (is_seq ? COMM_SEQ_DIGITS : 2)) {
+                instance->rx_hex_value = (uint16_t)((instance->rx_hex_value << 4) | nibble);
+                instance->rx_hex_count++;
+                if (is_seq) {
+                    instance->rx_crc = comm_crc8_update(instance->rx_crc, byte);
+                }
+#if COMM_ENABLE_RS485
+            } else if (is_seq && byte == COMM_ADDR_SEPARATOR && instance->rx_hex_count > 0) {
+                // 寻址帧：序列号后紧跟"@DDSS"，地址字段参与CRC
+                frame->sequence = (comm_seq_t)instance->rx_hex_value;
+                instance->rx_crc = comm_crc8_update(instance->rx_crc, byte);
+                instance->rx_hex_value = 0;
+                instance->rx_hex_count = 0;
+                instance->parse_state = FRAME_STATE_ADDR;
+#endif
+            } else {
+                // 序列号/CRC格式错误，重置
+                instance->parse_state = FRAME_STATE_IDLE;
+            }
+            break;
+        }
+            
+#if COMM_ENABLE_RS485
+        case FRAME_STATE_ADDR: {
+            int8_t nibble = comm_hex_nibble(byte);
+            
+            if (byte == COMM_FIELD_SEPARATOR && instance->rx_hex_count == 4) {
+                frame->dst_addr = (uint8_t)(instance->rx_hex_value >> 8);
+                frame->src_addr = (uint8_t)(instance->rx_hex_value & 0xFF);
+                frame->has_address = true;
+                instance->rx_hex_value = 0;
+                instance->rx_hex_count = 0;
                 instance->parse_state = FRAME_STATE_CRC;
-                instance->rx_index = 0;  // 重置索引为CRC解析做准备
-            } else if (instance->rx_index < 2) { // 序列号最多2个十六进制字符
-                instance->rx_buffer[instance->rx_index++] = byte;
+            } else if (nibble >= 0 && instance->rx_hex_count < 4) {
+                instance->rx_hex_value = (uint16_t)((instance->rx_hex_value << 4) | nibble);
+                instance->rx_hex_count++;
+                instance->rx_crc = comm_crc8_update(instance->rx_crc, byte);
             } else {
-                // 序列号格式错误，重置
+                // 地址格式错误，重置
                 instance->parse_state = FRAME_STATE_IDLE;
             }
             break;
+        }
+#endif
             
-        case FRAME_STATE_CRC:
-            if (byte == COMM_FRAME_END) {
-                // 解析CRC（十六进制字符串）
-                instance->rx_buffer[instance->rx_index] = '\0';
-                instance->pending_frame.crc = (uint8_t)strtol(instance->rx_buffer, NULL, 16);
-                
-                // 验证CRC
-                char frame_for_crc[COMM_RX_BUFFER_SIZE];
-                int crc_len = snprintf(frame_for_crc, sizeof(frame_for_crc), 
-                                      "%s%c%s%c%02X",
-                                      instance->pending_frame.cmd, COMM_CMD_DATA_SEPARATOR,
-                                      instance->pending_frame.data, COMM_FIELD_SEPARATOR,
-                                      instance->pending_frame.sequence);
-                
-                uint8_t calculated_crc = comm_crc8_calculate((uint8_t*)frame_for_crc, crc_len);
-                
-                if (crc_len > 0 && comm_crc8_verify((uint8_t*)frame_for_crc, crc_len, instance->pending_frame.crc)) {
-                    instance->pending_frame.is_valid = true;
-                    instance->new_frame_available = true;
-                } else {
-                    instance->pending_frame.is_valid = false;
+#if COMM_ENABLE_FEC
+        case FRAME_STATE_FEC_HEADER: {
+            // 长度字段收齐后逐位表决
+            rx_buffer[instance->rx_index++] = byte;
+            if (instance->rx_index == COMM_FEC_HEADER_SIZE) {
+                int16_t length = comm_fec_header_length(rx_buffer, instance->rx_slot_size);
+                if (length < 0) {
+                    instance->parse_state = FRAME_STATE_IDLE;
+                    break;
                 }
-                
-                instance->parse_state = FRAME_STATE_IDLE;
+                frame->fec_length = (uint8_t)length;
                 instance->rx_index = 0;
-            } else if (instance->rx_index < 2) { // CRC最多2个十六进制字符
-                instance->rx_buffer[instance->rx_index++] = byte;
-            } else {
-                // CRC格式错误，重置
-                instance->parse_state = FRAME_STATE_IDLE;
+                instance->parse_state = FRAME_STATE_FEC_BODY;
             }
             break;
+        }
+            
+        case FRAME_STATE_FEC_BODY:
+            // 内层帧按长度原样接收，其中的分隔符可能已出错，不能据此判断结构
+            rx_buffer[instance->rx_index++] = byte;
+            if (instance->rx_index == frame->fec_length) {
+                instance->rx_hex_value = 0;
+                instance->rx_hex_count = 0;
+                instance->parse_state = FRAME_STATE_FEC_PARITY;
+            }
+            break;
+            
+        case FRAME_STATE_FEC_PARITY: {
+            // 非十六进制字符按0计入，相当于一个错误的校验字节，由纠错修正
+            int8_t nibble = comm_hex_nibble(byte);
+            instance->rx_hex_value = (uint16_t)((instance->rx_hex_value << 4) | (nibble >= 0 ? nibble : 0));
+            if (++instance->rx_hex_count == 2) {
+                rx_buffer[instance->rx_index++] = (char)instance->rx_hex_value;
+                instance->rx_hex_value = 0;
+                instance->rx_hex_count = 0;
+                if (instance->rx_index == frame->fec_length + COMM_FEC_PARITY) {
+#if COMM_ENABLE_CLOCK
+                    frame->rx_time_us = comm_clock_read(instance);
+#endif
+                    instance->rx_produced++;
+                    instance->parse_state = FRAME_STATE_IDLE;
+                    instance->rx_index = 0;
+                }
+            }
+            break;
+        }
+#endif
             
         default:
             instance->parse_state = FRAME_STATE_IDLE;
@@ -332,6 +752,85 @@ void comm_process_byte_in_interrupt(comm_instance_t *instance, uint8_t byte)
     }
 }
 
+/**
+ * @brief  分发已通过校验的帧：先交给库内置的命令处理，未被消费再调用用户回调
+ */
+static void comm_dispatch_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+#if COMM_ENABLE_COMPRESS
+    comm_frame_t inflated;
+    frame = comm_compress_inflate(instance, frame, &inflated);
+    if (frame == NULL) {
+        return;
+    }
+    
+    if (comm_compress_handle_frame(instance, frame)) {
+        return;
+    }
+#endif
+    
+#if COMM_ENABLE_FEC
+    if (comm_fec_handle_frame(instance, frame)) {
+        return;
+    }
+#endif
+    
+    const char *cmd = COMM_FRAME_CMD(instance, frame);
+    const char *data = COMM_FRAME_DATA(instance, frame);
+    
+#if COMM_ENABLE_PUBSUB
+    if (comm_pubsub_handle_frame(instance, frame)) {
+        return;
+    }
+#endif
+    
+#if COMM_ENABLE_BAUD
+    if (comm_baud_handle_frame(instance, frame)) {
+        return;
+    }
+#endif
+    
+#if COMM_ENABLE_LINK
+    if (comm_link_handle_frame(instance, frame)) {
+        return;
+    }
+#endif
+    
+#if COMM_ENABLE_SESSION
+    if (comm_session_handle_frame(instance, frame)) {
+        return;
+    }
+#endif
+    
+#if COMM_ENABLE_BOND
+    if (comm_bond_handle_frame(instance, frame)) {
+        return;
+    }
+#endif
+    
+#if COMM_ENABLE_BATCH
+    if (comm_batch_handle_frame(instance, frame)) {
+        return;
+    }
+#endif
+    
+#if COMM_ENABLE_QUERY
+    if (comm_query_handle_frame(instance, frame)) {
+        return;
+    }
+#endif
+    
+#if COMM_ENABLE_CLOCK
+    if (comm_clock_handle_frame(instance, frame)) {
+        return;
+    }
+#endif
+    
+    if (!comm_call_callback(instance, cmd, frame->cmd_len, data, frame->data_len)) {
+        COMM_DEBUG_INSTANCE(instance, "忽略未注册命令: %s", cmd);
+    }
+}
+
 void comm_handle_complete_frame(comm_instance_t *instance, const comm_frame_t *frame)
 {
     if (instance == NULL || frame == NULL) {
@@ -339,32 +838,47 @@ void comm_handle_complete_frame(comm_instance_t *instance, const comm_frame_t *f
     }
 
     if (!frame->is_valid) {
-        char frame_for_crc[COMM_RX_BUFFER_SIZE];
-        int crc_len = snprintf(frame_for_crc, sizeof(frame_for_crc), 
-                              "%s%c%s%c%02X",
-                              frame->cmd, COMM_CMD_DATA_SEPARATOR,
-                              frame->data, COMM_FIELD_SEPARATOR,
-                              frame->sequence);
-        
-        uint8_t calculated_crc = comm_crc8_calculate((uint8_t*)frame_for_crc, crc_len);
-        COMM_DEBUG_INSTANCE(instance, "CRC校验失败: 接收=%02X, 计算=%02X, 数据='%s'", 
-                           frame->crc, calculated_crc, frame_for_crc);
+        COMM_DEBUG_INSTANCE(instance, "CRC校验失败: 接收=%02X, 计算=%02X", 
+                           frame->crc, instance->rx_crc);
         return;  // CRC失败，不处理帧
     }
+    
+    const char *data = COMM_FRAME_DATA(instance, frame);
+    bool is_datagram = (frame->sequence == 0);
+    bool from_peer = true;
 
-    if (strcmp(frame->cmd, COMM_CMD_ACK) == 0) {
-        uint8_t ack_seq = (uint8_t)strtol(frame->data, NULL, 16);
+#if COMM_ENABLE_RS485
+    // 切换到该源节点的接收序列号，ACK/NAK回给它
+    comm_rs485_select_rx_peer(instance, frame);
+    if (comm_rs485_handle_frame(instance, frame)) {
+        return;
+    }
+    from_peer = comm_rs485_is_from_tx_peer(instance, frame);
+    // 广播帧所有节点同时收到，不回ACK，按数据报处理
+    if (frame->has_address && frame->dst_addr == COMM_RS485_BROADCAST_ADDR) {
+        is_datagram = true;
+    }
+#endif
+
+    if (comm_frame_cmd_is(instance, frame, COMM_CMD_ACK)) {
+        comm_seq_t ack_seq = (comm_seq_t)comm_parse_hex(data, frame->data_len);
+        
+#if COMM_ENABLE_CREDITS
+        // 重复的ACK同样带有对端最新的空闲槽数
+        if (from_peer) {
+            comm_credit_handle_ack(instance, data, frame->data_len);
+        }
+#endif
         
-        if (ack_seq == instance->expected_ack_seq && instance->state == COMM_STATE_WAIT_ACK) {
+        if (from_peer && ack_seq == instance->expected_ack_seq && instance->state == COMM_STATE_WAIT_ACK) {
             comm_set_state(instance, COMM_STATE_IDLE);
             instance->retry_count = 0;
             
             #if COMM_ENABLE_STATS
             comm_update_tx_stats(instance, true);
-            uint32_t delay = HAL_GetTick() - instance->last_send_time;
-            if (delay < instance->stats.min_delay_ms) instance->stats.min_delay_ms = delay;
-            if (delay > instance->stats.max_delay_ms) instance->stats.max_delay_ms = delay;
+            comm_update_delay_stats(instance, HAL_GetTick() - instance->last_send_time);
             #endif
+            comm_call_send_done(instance, true);
         } else {
             COMM_DEBUG_INSTANCE(instance, "ACK不匹配: ack_seq=%d vs expected=%d, state=%d", 
                                ack_seq, instance->expected_ack_seq, instance->state);
@@ -372,50 +886,90 @@ void comm_handle_complete_frame(comm_instance_t *instance, const comm_frame_t *f
         return;
     }
     
-    if (strcmp(frame->cmd, COMM_CMD_NAK) == 0) {
-        uint8_t nak_seq = (uint8_t)strtol(frame->data, NULL, 16);
+    if (comm_frame_cmd_is(instance, frame, COMM_CMD_NAK)) {
+        comm_seq_t nak_seq = (comm_seq_t)comm_parse_hex(data, frame->data_len);
         
-        if (nak_seq == instance->expected_ack_seq && instance->state == COMM_STATE_WAIT_ACK) {
+        if (from_peer && nak_seq == instance->expected_ack_seq && instance->state == COMM_STATE_WAIT_ACK) {
+            const char *reason = memchr(data, ',', frame->data_len);
+            if (reason != NULL && strcmp(reason + 1, COMM_NAK_REASON_BUSY) == 0) {
+                // 对端暂时无法接收：不立即重发，等完整的超时周期后再按重试流程处理
+                COMM_DEBUG_INSTANCE(instance, "对端忙，seq=%d 延后重发", nak_seq);
+                instance->last_send_time = HAL_GetTick();
+                return;
+            }
             COMM_DEBUG_INSTANCE(instance, "收到NAK否认，seq=%d", nak_seq);
+#if COMM_ENABLE_SESSION
+            if (reason != NULL && strcmp(reason + 1, COMM_NAK_REASON_SEQ) == 0) {
+                // 对端序列号与本端失去同步（重启或连续丢帧超过窗口），先通告再重发
+                comm_session_announce(instance, false);
+            }
+#endif
             comm_handle_timeout(instance);
         }
         return;
     }
     
+#if COMM_ENABLE_CREDITS
+    if (comm_credit_handle_frame(instance, frame)) {
+        return;
+    }
+#endif
+    
+    // 序列号00的帧为无确认数据报：不做序列号检查、不回ACK，直接分发
+    if (is_datagram) {
+#if COMM_ENABLE_ROUTER
+        // 数据报出口队列满时直接丢弃（已计数）
+        if (comm_router_route(instance, frame) != COMM_ROUTE_NONE) {
+            return;
+        }
+#endif
+        comm_dispatch_frame(instance, frame);
+        return;
+    }
+    
     // 处理普通命令帧
     if (comm_is_valid_rx_sequence(instance, frame->sequence)) {
         if (instance->state == COMM_STATE_WAIT_ACK && 
             frame->sequence == instance->expected_ack_seq) {
             COMM_DEBUG_INSTANCE(instance, "软件防回环：忽略seq=%d的%s帧", 
-                               frame->sequence, frame->cmd);
+                               frame->sequence, COMM_FRAME_CMD(instance, frame));
+            return;
+        }
+
+#if COMM_ENABLE_ROUTER
+        comm_route_result_t route = comm_router_route(instance, frame);
+        if (route == COMM_ROUTE_BUSY) {
+            // 出口队列满：不更新序列号，发送方退避后用同一序列号重发
+            comm_send_nak(instance, frame->sequence, COMM_NAK_REASON_BUSY);
             return;
         }
+#endif
 
         comm_update_rx_sequence(instance, frame->sequence);
         comm_send_ack(instance, frame->sequence);
         
-        // 调用用户回调函数
-        if (comm_call_callback(instance, frame->cmd, frame->data)) {
-        } else {
-            COMM_DEBUG_INSTANCE(instance, "忽略未注册命令: %s", frame->cmd);
+#if COMM_ENABLE_ROUTER
+        // 已进入转发队列，ACK只表示本跳已接收
+        if (route == COMM_ROUTE_QUEUED) {
+            return;
         }
+#endif
+        
+        // 内置命令或用户回调函数
+        comm_dispatch_frame(instance, frame);
         
         #if COMM_ENABLE_STATS
         comm_update_rx_stats(instance, true, COMM_ERR_NONE);
         #endif
     } else {
         // 检查是否为重复序列号
-        int16_t diff = (int16_t)frame->sequence - (int16_t)instance->rx_sequence;
-        if (diff < -128) diff += 256;
-        else if (diff > 128) diff -= 256;
-        
-        if (diff == 0) {
+        if (frame->sequence == instance->rx_sequence) {
             // 重复序列号：重发ACK但不更新序列号，不调用回调
             COMM_DEBUG_INSTANCE(instance, "重复序列号，重发ACK: %d", frame->sequence);
             comm_send_ack(instance, frame->sequence);
         } else {
             COMM_DEBUG_INSTANCE(instance, "序列号错误，发送NAK: %d", frame->sequence);
-            comm_send_nak(instance, frame->sequence, "SEQ_ERROR");
+            comm_send_nak(instance, frame->sequence, COMM_NAK_REASON_SEQ);
         }
         
         #if COMM_ENABLE_STATS
@@ -424,7 +978,7 @@ void comm_handle_complete_frame(comm_instance_t *instance, const comm_frame_t *f
     }
 }
 
-bool comm_send_ack(comm_instance_t *instance, uint8_t ack_seq)
+bool comm_send_ack(comm_instance_t *instance, comm_seq_t ack_seq)
 {
     if (instance == NULL) {
         return false;
@@ -432,41 +986,38 @@ bool comm_send_ack(comm_instance_t *instance, uint8_t ack_seq)
     
     COMM_DEBUG_INSTANCE(instance, "准备发送ACK: 目标seq=%d", ack_seq);
     
-    char ack_data[8];
-    snprintf(ack_data, sizeof(ack_data), "%02X", ack_seq);
-    
     // ACK帧直接构建，不参与序列号管理
     // 格式: {ACK:01#00#CRC}，序列号固定为00
-    char frame_content[COMM_TX_BUFFER_SIZE];
-    int content_len = snprintf(frame_content, sizeof(frame_content), 
-                              "%s%c%s%c00",
-                              COMM_CMD_ACK, COMM_CMD_DATA_SEPARATOR,
-                              ack_data, COMM_FIELD_SEPARATOR);
+    char ack_frame[COMM_TX_BUFFER_SIZE];
+    comm_frame_writer_t w;
+    comm_writer_begin(&w, ack_frame, sizeof(ack_frame));
+    comm_writer_put_template(&w, COMM_TEMPLATE_ACK);
+    comm_writer_put_hex(&w, ack_seq, COMM_SEQ_DIGITS);
     
-    if (content_len < 0 || content_len >= sizeof(frame_content)) {
-        return false;
+#if COMM_ENABLE_CREDITS
+    // 附带空闲接收槽数: SS,C
+    uint8_t credits = comm_credit_advertise(instance);
+    if (credits != COMM_CREDIT_UNLIMITED) {
+        comm_writer_put(&w, ',');
+        comm_writer_put_hex_var(&w, credits);
     }
+#endif
     
-    // 计算CRC
-    uint8_t crc = comm_crc8_calculate((uint8_t*)frame_content, content_len);
-    
-    // 构建完整ACK帧
-    char ack_frame[COMM_TX_BUFFER_SIZE];
-    int total_len = snprintf(ack_frame, sizeof(ack_frame),
-                            "%c%s%c%02X%c",
-                            COMM_FRAME_START, frame_content, 
-                            COMM_FIELD_SEPARATOR, crc, COMM_FRAME_END);
+    comm_writer_put(&w, COMM_FIELD_SEPARATOR);
+    comm_writer_puts(&w, "00");
+    comm_writer_put_address(&w, instance, comm_reply_address(instance));
     
-    if (total_len < 0 || total_len >= sizeof(ack_frame)) {
+    uint16_t total_len;
+    if (!comm_writer_finish(&w, instance, &total_len)) {
         return false;
     }
     
     COMM_DEBUG_INSTANCE(instance, "发送ACK帧: %s", ack_frame);
     COMM_DEBUG_INSTANCE(instance, "*** 即将发送ACK，UART地址=0x%08lx", (uint32_t)instance->huart);
     
-    HAL_StatusTypeDef status = HAL_UART_Transmit(instance->huart, 
-                                                (uint8_t*)ack_frame, 
-                                                total_len, 500);  // 500ms超时
+    HAL_StatusTypeDef status = comm_uart_transmit(instance, 
+                                                 (uint8_t*)ack_frame, 
+                                                 total_len, 500);  // 500ms超时
     
     if (status == HAL_OK) {
         COMM_DEBUG_INSTANCE(instance, "ACK发送成功");
@@ -477,38 +1028,37 @@ bool comm_send_ack(comm_instance_t *instance, uint8_t ack_seq)
     }
 }
 
-bool comm_send_nak(comm_instance_t *instance, uint8_t nak_seq, const char *reason)
+bool comm_send_nak(comm_instance_t *instance, comm_seq_t nak_seq, const char *reason)
 {
     if (instance == NULL) {
         return false;
     }
     
-    char nak_data[16];
-    snprintf(nak_data, sizeof(nak_data), "%02X", nak_seq);
-    
     // NAK帧直接构建，不参与序列号管理  
     // 格式: {NAK:01#00#CRC}，序列号固定为00
-    char frame_content[COMM_TX_BUFFER_SIZE];
-    int content_len = snprintf(frame_content, sizeof(frame_content),
-                              "%s%c%s%c00", 
-                              COMM_CMD_NAK, COMM_CMD_DATA_SEPARATOR,
-                              nak_data, COMM_FIELD_SEPARATOR);
+    char nak_frame[COMM_TX_BUFFER_SIZE];
+    comm_frame_writer_t w;
+    comm_writer_begin(&w, nak_frame, sizeof(nak_frame));
+    comm_writer_put_template(&w, COMM_TEMPLATE_NAK);
+    comm_writer_put_hex(&w, nak_seq, COMM_SEQ_DIGITS);
     
-    if (content_len < 0 || content_len >= sizeof(frame_content)) {
-        return false;
+    bool send_reason = (reason != NULL && strcmp(reason, COMM_NAK_REASON_BUSY) == 0);
+#if COMM_ENABLE_SESSION
+    // 启用会话时发送方据此重新通告序列号
+    send_reason = send_reason || (reason != NULL && strcmp(reason, COMM_NAK_REASON_SEQ) == 0);
+#endif
+    if (send_reason) {
+        // 队列满/序列号错误需要告知发送方；其他原因只在本地记录
+        comm_writer_put(&w, ',');
+        comm_writer_puts(&w, reason);
     }
     
-    // 计算CRC
-    uint8_t crc = comm_crc8_calculate((uint8_t*)frame_content, content_len);
+    comm_writer_put(&w, COMM_FIELD_SEPARATOR);
+    comm_writer_puts(&w, "00");
+    comm_writer_put_address(&w, instance, comm_reply_address(instance));
     
-    // 构建完整NAK帧
-    char nak_frame[COMM_TX_BUFFER_SIZE];
-    int total_len = snprintf(nak_frame, sizeof(nak_frame),
-                            "%c%s%c%02X%c",
-                            COMM_FRAME_START, frame_content,
-                            COMM_FIELD_SEPARATOR, crc, COMM_FRAME_END);
-                            
-    if (total_len < 0 || total_len >= sizeof(nak_frame)) {
+    uint16_t total_len;
+    if (!comm_writer_finish(&w, instance, &total_len)) {
         return false;
     }
     
@@ -516,4 +1066,305 @@ bool comm_send_nak(comm_instance_t *instance, uint8_t nak_seq, const char *reaso
     
 
     return comm_send_raw(instance, nak_frame, total_len);
-}
\ No newline at end of file
+}
+
+bool comm_send_prefolded(comm_instance_t *instance, const char *payload, uint16_t payload_len,
+                         uint8_t cmd_len, uint8_t crc_partial, bool datagram)
+{
+    if (instance == NULL || payload == NULL || payload_len < (uint16_t)cmd_len + 2) {
+        return false;
+    }
+    
+    uint16_t data_len = payload_len - cmd_len - 2;  // 去掉':'和'#'
+    if (cmd_len >= COMM_MAX_CMD_LENGTH || data_len >= COMM_MAX_DATA_LENGTH) {
+        return false;
+    }
+    
+    if (!datagram && !comm_instance_is_ready(instance)) {
+        return false;
+    }
+    
+#if COMM_ENABLE_CREDITS
+    if (datagram && !comm_credit_available(instance)) {
+        return false;
+    }
+#endif
+    
+    // 数据报不占用tx_buffer，命令帧要留在tx_buffer中供重发
+    char dgram_frame[COMM_TX_BUFFER_SIZE];
+    char *frame_buffer = datagram ? dgram_frame : instance->tx_buffer;
+    uint16_t frame_size = datagram ? sizeof(dgram_frame) : instance->tx_buffer_size;
+    if (1u + payload_len >= frame_size) {
+        return false;
+    }
+    
+    // 放不下的帧不消耗序列号
+    comm_seq_t seq = 0;
+    if (!datagram) {
+        seq = comm_get_next_tx_sequence(instance);
+        instance->current_sequence = seq;
+    }
+    
+    // payload原样拷贝并接上它的CRC，只有尾部SS[@DDSS]需要续算
+    comm_frame_writer_t w;
+    comm_writer_begin(&w, frame_buffer, frame_size);
+    memcpy(&frame_buffer[w.len], payload, payload_len);
+    w.len += payload_len;
+    w.crc = crc_partial;
+    comm_writer_put_hex(&w, seq, COMM_SEQ_DIGITS);
+    comm_writer_put_address(&w, instance, comm_tx_address(instance));
+    
+    uint16_t len;
+    if (!comm_writer_finish(&w, instance, &len)) {
+        return false;
+    }
+    
+    if (datagram) {
+        if (comm_uart_transmit(instance, (uint8_t*)dgram_frame, len, 500) != HAL_OK) {
+            return false;
+        }
+#if COMM_ENABLE_CREDITS
+        comm_credit_consume(instance);
+#endif
+        return true;
+    }
+    
+    // 失败回调需要命令和数据的副本
+    memcpy(instance->current_cmd, payload, cmd_len);
+    instance->current_cmd[cmd_len] = '\0';
+    memcpy(instance->current_data, &payload[cmd_len + 1], data_len);
+    instance->current_data[data_len] = '\0';
+    instance->current_data_len = data_len;
+    instance->retry_count = 0;
+    instance->expected_ack_seq = seq;
+    instance->tx_length = len;
+    
+    return comm_start_transmit(instance);
+}
+
+bool comm_send_datagram(comm_instance_t *instance, const char *cmd, const char *data)
+{
+    if (instance == NULL) {
+        return false;
+    }
+    
+    return comm_send_datagram_to(instance, comm_tx_address(instance), cmd, data);
+}
+
+bool comm_send_datagram_to(comm_instance_t *instance, uint8_t dst, const char *cmd, const char *data)
+{
+    if (instance == NULL || cmd == NULL || data == NULL) {
+        return false;
+    }
+    
+#if COMM_ENABLE_CREDITS
+    // 额度帧本身不受额度限制，否则双方额度耗尽后无法恢复
+    bool uses_credit = (strcmp(cmd, COMM_CMD_CREDIT) != 0);
+    if (uses_credit && !comm_credit_available(instance)) {
+        COMM_DEBUG_INSTANCE(instance, "对端额度耗尽，数据报未发送: %s", cmd);
+        return false;
+    }
+#endif
+    
+#if COMM_ENABLE_COMPRESS
+    char packed_cmd[COMM_MAX_CMD_LENGTH + 2];
+    char packed_data[COMM_TX_BUFFER_SIZE];
+    if (strcmp(cmd, COMM_CMD_COMPRESS) != 0) {
+        comm_compress_pack(instance, &cmd, &data, packed_cmd, packed_data);
+    }
+#endif
+    
+    // 数据报不参与序列号管理，也不占用tx_buffer和重试状态
+    // 格式: {CMD:DATA#00#CRC}，序列号固定为00
+    char dgram_frame[COMM_TX_BUFFER_SIZE];
+    comm_frame_writer_t w;
+    comm_writer_begin(&w, dgram_frame, sizeof(dgram_frame));
+    comm_writer_put_command(&w, cmd);
+    comm_writer_puts(&w, data);
+    comm_writer_put(&w, COMM_FIELD_SEPARATOR);
+    comm_writer_puts(&w, "00");
+    comm_writer_put_address(&w, instance, dst);
+    
+    uint16_t total_len;
+    if (!comm_writer_finish(&w, instance, &total_len)) {
+        COMM_DEBUG_INSTANCE(instance, "数据报构建失败: 内容过长");
+        return false;
+    }
+    
+    HAL_StatusTypeDef status = comm_uart_transmit(instance, 
+                                                 (uint8_t*)dgram_frame, 
+                                                 total_len, 500);  // 500ms超时
+    
+    if (status != HAL_OK) {
+        COMM_DEBUG_INSTANCE(instance, "数据报发送失败，状态: %d", status);
+        return false;
+    }
+    
+#if COMM_ENABLE_CREDITS
+    if (uses_credit) {
+        comm_credit_consume(instance);
+    }
+#endif
+    return true;
+}
+
+/* =============================================================================
+ * 帧序列化器实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  开始一帧：写入起始符，CRC从起始符之后算起
+ */
+static void comm_writer_begin(comm_frame_writer_t *w, char *buf, uint16_t size)
+{
+    w->buf = buf;
+    w->limit = size;
+    w->len = 0;
+    w->crc = 0;
+    w->overflow = (size < 2);
+    if (!w->overflow) {
+        w->buf[w->len++] = COMM_FRAME_START;
+    }
+}
+
+/**
+ * @brief  写入一个字符并累积CRC
+ */
+static void comm_writer_put(comm_frame_writer_t *w, char c)
+{
+    if (w->len + 1u >= w->limit) {
+        w->overflow = true;
+        return;
+    }
+    w->buf[w->len++] = c;
+    w->crc = comm_crc8_step(w->crc, (uint8_t)c);
+}
+
+/**
+ * @brief  写入字符串并累积CRC，不需要预先求长度
+ */
+static void comm_writer_puts(comm_frame_writer_t *w, const char *str)
+{
+    char *out = &w->buf[w->len];
+    const char *end = &w->buf[w->limit - 1];
+    uint8_t crc = w->crc;
+
+    while (*str != '\0') {
+        if (out >= end) {
+            w->overflow = true;
+            break;
+        }
+        crc = comm_crc8_step(crc, (uint8_t)*str);
+        *out++ = *str++;
+    }
+
+    w->len = (uint16_t)(out - w->buf);
+    w->crc = crc;
+}
+
+/**
+ * @brief  写入定长大写十六进制数（高位补0）
+ */
+static void comm_writer_put_hex(comm_frame_writer_t *w, uint32_t value, uint8_t digits)
+{
+    while (digits > 0) {
+        digits--;
+        comm_writer_put(w, g_comm_hex_digits[(value >> (4 * digits)) & 0x0F]);
+    }
+}
+
+#if COMM_ENABLE_CREDITS
+/**
+ * @brief  写入不补0的大写十六进制数（与"%X"相同）
+ */
+static void comm_writer_put_hex_var(comm_frame_writer_t *w, uint32_t value)
+{
+    uint8_t digits = 1;
+    while (digits < 8 && (value >> (4 * digits)) != 0) {
+        digits++;
+    }
+    comm_writer_put_hex(w, value, digits);
+}
+#endif
+
+/**
+ * @brief  写入"CMD:"，固定命令使用预先算好CRC的模板
+ */
+static void comm_writer_put_command(comm_frame_writer_t *w, const char *cmd)
+{
+    if (w->crc == 0 && w->len == 1) {
+        for (uint8_t i = 0; i < sizeof(g_comm_frame_templates) / sizeof(g_comm_frame_templates[0]); i++) {
+            const comm_frame_template_t *tpl = &g_comm_frame_templates[i];
+            if (cmd[0] == tpl->cmd[0] && strcmp(cmd, tpl->cmd) == 0) {
+                comm_writer_put_template(w, tpl);
+                return;
+            }
+        }
+    }
+
+    comm_writer_puts(w, cmd);
+    comm_writer_put(w, COMM_CMD_DATA_SEPARATOR);
+}
+
+/**
+ * @brief  整段拷贝模板的"CMD:"并直接采用其CRC
+ * @note   只能紧跟在起始符之后调用
+ */
+static void comm_writer_put_template(comm_frame_writer_t *w, const comm_frame_template_t *tpl)
+{
+    if (w->overflow || w->len + tpl->cmd_len + 1u >= w->limit) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(&w->buf[w->len], tpl->cmd, tpl->cmd_len);
+    w->len += tpl->cmd_len;
+    w->buf[w->len++] = COMM_CMD_DATA_SEPARATOR;
+    w->crc = tpl->crc;
+}
+
+/**
+ * @brief  实例启用寻址时写入地址字段"@DDSS"
+ */
+static void comm_writer_put_address(comm_frame_writer_t *w, const comm_instance_t *instance, uint8_t dst)
+{
+#if COMM_ENABLE_RS485
+    if (instance->rs485.enabled) {
+        comm_writer_put(w, COMM_ADDR_SEPARATOR);
+        comm_writer_put_hex(w, dst, 2);
+        comm_writer_put_hex(w, instance->rs485.node_addr, 2);
+    }
+#else
+    (void)w;
+    (void)instance;
+    (void)dst;
+#endif
+}
+
+/**
+ * @brief  写入"#CRC}"并以'\0'结尾，对端请求纠错时再加纠错外壳
+ * @retval true: 成功, false: 缓冲区不足
+ */
+static bool comm_writer_finish(comm_frame_writer_t *w, comm_instance_t *instance, uint16_t *frame_length)
+{
+    if (w->overflow || w->len + 4u >= w->limit) {
+        return false;
+    }
+
+    uint8_t crc = w->crc;
+    char *out = &w->buf[w->len];
+    out[0] = COMM_FIELD_SEPARATOR;
+    out[1] = g_comm_hex_digits[crc >> 4];
+    out[2] = g_comm_hex_digits[crc & 0x0F];
+    out[3] = COMM_FRAME_END;
+    out[4] = '\0';
+    w->len += 4;
+
+    *frame_length = w->len;
+#if COMM_ENABLE_FEC
+    comm_fec_wrap(instance, w->buf, w->limit, frame_length);
+#else
+    (void)instance;
+#endif
+    return true;
+}
@@ -17,6 +17,36 @@
 
 #include "comm_internal.h"
 
+/* =============================================================================
+ * 十六进制字段函数
+ * =============================================================================
+ */
+
+/**
+ * @brief  十六进制字符转数值（大小写均可）
+ * @param  c: 字符
+ * @retval 0-15，非十六进制字符返回-1
+ */
+int8_t comm_hex_nibble(uint8_t c);
+
+/**
+ * @brief  写入定长大写十六进制，高位在前，不写结束符
+ * @param  out: 输出位置，至少digits字节
+ * @param  value: 数值
+ * @param  digits: 位数（1-8）
+ * @retval 写入的字符数
+ */
+uint8_t comm_hex_encode(char *out, uint32_t value, uint8_t digits);
+
+/**
+ * @brief  解析定长十六进制字段
+ * @param  text: 字段
+ * @param  length: 字段长度（1-8）
+ * @param  value: 输出数值
+ * @retval true: 解析成功, false: 长度无效或含非十六进制字符
+ */
+bool comm_hex_decode(const char *text, uint16_t length, uint32_t *value);
+
 /* =============================================================================
  * CRC计算函数
  * =============================================================================
@@ -39,6 +69,23 @@ uint8_t comm_crc8_calculate(const uint8_t *data, uint16_t length);
  */
 bool comm_crc8_verify(const uint8_t *data, uint16_t length, uint8_t expected_crc);
 
+/**
+ * @brief  在已有CRC8结果上继续累积一个字节
+ * @param  crc: 当前CRC值（首字节传0）
+ * @param  byte: 新字节
+ * @retval 更新后的CRC8值
+ * @note   接收中断中逐字节调用，帧结束时即得到整帧CRC，无需重新格式化
+ */
+uint8_t comm_crc8_update(uint8_t crc, uint8_t byte);
+
+/**
+ * @brief  协议层初始化：预先计算固定命令（ACK/NAK/PING/PONG）帧模板的CRC
+ * @param  None
+ * @retval None
+ * @note   由comm_init()调用
+ */
+void comm_protocol_init(void);
+
 /* =============================================================================
  * 序列号管理函数
  * =============================================================================
@@ -49,7 +96,7 @@ bool comm_crc8_verify(const uint8_t *data, uint16_t length, uint8_t expected_crc
  * @param  instance: 实例指针
  * @retval 序列号
  */
-uint8_t comm_get_next_tx_sequence(comm_instance_t *instance);
+comm_seq_t comm_get_next_tx_sequence(comm_instance_t *instance);
 
 /**
  * @brief  检查接收序列号的有效性
@@ -57,14 +104,14 @@ uint8_t comm_get_next_tx_sequence(comm_instance_t *instance);
  * @param  rx_seq: 接收到的序列号
  * @retval true: 有效, false: 无效/重复
  */
-bool comm_is_valid_rx_sequence(comm_instance_t *instance, uint8_t rx_seq);
+bool comm_is_valid_rx_sequence(comm_instance_t *instance, comm_seq_t rx_seq);
 
 /**
  * @brief  更新接收序列号
  * @param  instance: 实例指针
  * @param  rx_seq: 接收到的序列号
  */
-void comm_update_rx_sequence(comm_instance_t *instance, uint8_t rx_seq);
+void comm_update_rx_sequence(comm_instance_t *instance, comm_seq_t rx_seq);
 
 /* =============================================================================
  * 帧处理函数
@@ -76,9 +123,12 @@ void comm_update_rx_sequence(comm_instance_t *instance, uint8_t rx_seq);
  * @param  instance: 实例指针
  * @param  cmd: 命令字符串
  * @param  data: 数据字符串
- * @param  frame_buffer: 帧缓冲区
+ * @param  frame_buffer: 帧缓冲区（实例的tx_buffer，大小为tx_buffer_size）
  * @param  frame_length: 帧长度指针
  * @retval true: 构建成功, false: 构建失败
+ * @note   数据长度只受发送缓冲区限制，普通命令的长度由comm_send_command()检查；
+ *         不经过snprintf和中间缓冲区，分隔符、十六进制序列号/CRC和数据一次写入frame_buffer，
+ *         CRC边写边算；固定命令直接拷贝预先算好CRC的模板
  */
 bool comm_build_frame(comm_instance_t *instance, const char *cmd, const char *data, 
                      char *frame_buffer, uint16_t *frame_length);
@@ -97,17 +147,39 @@ void comm_process_byte_in_interrupt(comm_instance_t *instance, uint8_t byte);
  * @param  instance: 实例指针
  * @param  frame: 完整帧指针
  * @retval None
- * @note   在主循环或定时器中断中调用
+ * @note   在主循环或定时器中断中调用；命令/数据以视图形式直接指向所属接收槽，
+ *         回调返回前视图有效，期间中断只会写入其他空闲的槽
  */
 void comm_handle_complete_frame(comm_instance_t *instance, const comm_frame_t *frame);
 
+/**
+ * @brief  判断接收帧的命令是否为指定命令
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @param  expected: 命令字符串
+ * @retval true: 命令相同, false: 不同
+ */
+bool comm_frame_cmd_is(const comm_instance_t *instance, const comm_frame_t *frame, const char *expected);
+
+#if COMM_ENABLE_FEC
+/**
+ * @brief  解析接收槽中一段完整的帧文本
+ * @param  instance: 实例指针
+ * @param  frame: 接收槽中的帧，slot已设置
+ * @param  length: 帧文本长度（从'{'到'}'）
+ * @retval true: 格式正确且CRC通过, false: 格式错误或CRC错误
+ * @note   与接收中断的逐字节解析结果相同，分隔符同样原地改写为'\0'；用于纠错后的帧
+ */
+bool comm_parse_frame(comm_instance_t *instance, comm_frame_t *frame, uint16_t length);
+#endif
+
 /**
  * @brief  发送ACK确认帧
  * @param  instance: 实例指针
  * @param  ack_seq: 确认的序列号
  * @retval true: 发送成功, false: 发送失败
  */
-bool comm_send_ack(comm_instance_t *instance, uint8_t ack_seq);
+bool comm_send_ack(comm_instance_t *instance, comm_seq_t ack_seq);
 
 /**
  * @brief  发送NAK否认帧
@@ -116,6 +188,41 @@ bool comm_send_ack(comm_instance_t *instance, uint8_t ack_seq);
  * @param  reason: 错误原因
  * @retval true: 发送成功, false: 发送失败
  */
-bool comm_send_nak(comm_instance_t *instance, uint8_t nak_seq, const char *reason);
+bool comm_send_nak(comm_instance_t *instance, comm_seq_t nak_seq, const char *reason);
+
+/**
+ * @brief  发送无确认数据报帧
+ * @param  instance: 实例指针
+ * @param  cmd: 命令字符串
+ * @param  data: 数据字符串
+ * @retval true: 发送成功, false: 发送失败
+ * @note   序列号固定为00，接收方不回ACK也不做序列号检查，直接分发给回调；
+ *         不占用tx_buffer，可在等待ACK期间发送，适合高频遥测等可丢失数据
+ */
+bool comm_send_datagram(comm_instance_t *instance, const char *cmd, const char *data);
+
+/**
+ * @brief  发送已带CRC中间状态的帧内容（用于转发）
+ * @param  instance: 实例指针
+ * @param  payload: 帧内容"CMD:DATA#"，不含起始符
+ * @param  payload_len: 帧内容长度
+ * @param  cmd_len: 命令长度
+ * @param  crc_partial: payload的CRC累积值
+ * @param  datagram: true按无确认数据报发送，false按命令发送（需要实例就绪）
+ * @retval true: 发送成功, false: 发送失败
+ * @note   只对新的序列号/地址续算CRC，不重新格式化和校验payload
+ */
+bool comm_send_prefolded(comm_instance_t *instance, const char *payload, uint16_t payload_len,
+                         uint8_t cmd_len, uint8_t crc_partial, bool datagram);
+
+/**
+ * @brief  向指定节点发送无确认数据报帧
+ * @param  instance: 实例指针
+ * @param  dst: 目标节点地址（未启用RS-485寻址时忽略）
+ * @param  cmd: 命令字符串
+ * @param  data: 数据字符串
+ * @retval true: 发送成功, false: 发送失败
+ */
+bool comm_send_datagram_to(comm_instance_t *instance, uint8_t dst, const char *cmd, const char *data);
 
 #endif /* COMM_PROTOCOL_H */
\ No newline at end of file
@@ -0,0 +1,447 @@
+/**
+ * @file    comm_pubsub.c
+ * @brief   通信库发布/订阅主题层 - 最新值合并、按订阅周期发送
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_pubsub.h"
+
+#if COMM_ENABLE_PUBSUB
+
+#include "comm.h"
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Private function prototypes -----------------------------------------------*/
+static bool comm_topic_name_is_valid(const char *topic);
+static bool comm_topic_value_is_valid(const char *value);
+static comm_topic_t* comm_find_topic(comm_instance_t *instance, const char *name, uint16_t name_len);
+static comm_topic_t* comm_alloc_topic(comm_instance_t *instance, bool advertise);
+static comm_subscription_t* comm_find_subscription(comm_instance_t *instance, const char *name, uint16_t name_len);
+static void comm_pubsub_send_requests(comm_instance_t *instance);
+static void comm_pubsub_send_reliable(comm_instance_t *instance, uint32_t now);
+static bool comm_pubsub_send_best_effort(comm_instance_t *instance, uint32_t now);
+static void comm_pubsub_deliver(comm_instance_t *instance, char *data, uint16_t data_len);
+
+/* =============================================================================
+ * 发布端API实现
+ * =============================================================================
+ */
+
+bool comm_advertise_topic(UART_HandleTypeDef *huart, const char *topic, comm_topic_qos_t qos)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || !comm_topic_name_is_valid(topic)) {
+        return false;
+    }
+
+    comm_topic_t *entry = comm_find_topic(instance, topic, (uint16_t)strlen(topic));
+    if (entry != NULL) {
+        if (!entry->advertised) {
+            // 对端在声明之前已订阅：保留订阅周期，第一次发布立即发出
+            entry->advertised = true;
+            entry->last_publish_time = HAL_GetTick() - entry->period_ms;
+            COMM_DEBUG_INSTANCE(instance, "声明主题: %s（已被订阅，周期%dms）", topic, entry->period_ms);
+        }
+        entry->qos = (uint8_t)qos;
+        return true;
+    }
+
+    entry = comm_alloc_topic(instance, true);
+    if (entry == NULL) {
+        COMM_DEBUG_INSTANCE(instance, "主题表已满，无法声明: %s", topic);
+        return false;
+    }
+
+    strcpy(entry->name, topic);
+    entry->qos = (uint8_t)qos;
+    entry->advertised = true;
+    COMM_DEBUG_INSTANCE(instance, "声明主题: %s", topic);
+    return true;
+}
+
+bool comm_publish(UART_HandleTypeDef *huart, const char *topic, const char *value)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || topic == NULL || !comm_topic_value_is_valid(value)) {
+        return false;
+    }
+
+    comm_topic_t *entry = comm_find_topic(instance, topic, (uint16_t)strlen(topic));
+    if (entry == NULL || !entry->advertised) {
+        return false;
+    }
+
+    // 只保留最新值，未发出的旧值直接被覆盖
+    strcpy(entry->value, value);
+    entry->dirty = true;
+    return true;
+}
+
+/* =============================================================================
+ * 订阅端API实现
+ * =============================================================================
+ */
+
+bool comm_subscribe(UART_HandleTypeDef *huart, const char *topic, uint16_t period_ms,
+                    comm_topic_callback_t callback, void *user_ctx)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || callback == NULL || !comm_topic_name_is_valid(topic)) {
+        return false;
+    }
+
+    comm_subscription_t *sub = comm_find_subscription(instance, topic, (uint16_t)strlen(topic));
+    if (sub == NULL) {
+        for (int i = 0; i < COMM_PUBSUB_MAX_TOPICS; i++) {
+            if (!instance->pubsub.subscriptions[i].is_used) {
+                sub = &instance->pubsub.subscriptions[i];
+                memset(sub, 0, sizeof(comm_subscription_t));
+                strcpy(sub->name, topic);
+                sub->is_used = true;
+                break;
+            }
+        }
+    }
+
+    if (sub == NULL) {
+        COMM_DEBUG_INSTANCE(instance, "订阅表已满，无法订阅: %s", topic);
+        return false;
+    }
+
+    sub->period_ms = period_ms;
+    sub->callback = callback;
+    sub->user_ctx = user_ctx;
+    sub->request_pending = true;
+    return true;
+}
+
+bool comm_unsubscribe(UART_HandleTypeDef *huart, const char *topic)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || topic == NULL) {
+        return false;
+    }
+
+    comm_subscription_t *sub = comm_find_subscription(instance, topic, (uint16_t)strlen(topic));
+    if (sub == NULL) {
+        return false;
+    }
+
+    // 回调清空表示待发送USUB，发送成功后释放表项
+    sub->callback = NULL;
+    sub->user_ctx = NULL;
+    sub->request_pending = true;
+    return true;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_pubsub_process(comm_instance_t *instance)
+{
+    if (instance == NULL) {
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+
+    // 可靠消息共用实例的单个发送槽，每次tick最多发起一个
+    if (comm_instance_is_ready(instance)) {
+        comm_pubsub_send_requests(instance);
+    }
+    if (comm_instance_is_ready(instance)) {
+        comm_pubsub_send_reliable(instance, now);
+    }
+
+    // 无确认主题不占用发送槽，等待ACK期间也可以发送
+    comm_pubsub_send_best_effort(instance, now);
+}
+
+bool comm_pubsub_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    if (instance == NULL || frame == NULL) {
+        return false;
+    }
+
+    // 数据视图指向实例自己的接收缓冲区，可以原地切分
+    char *data = (char *)COMM_FRAME_DATA(instance, frame);
+
+    if (comm_frame_cmd_is(instance, frame, COMM_CMD_PUB)) {
+        comm_pubsub_deliver(instance, data, frame->data_len);
+        return true;
+    }
+
+    if (comm_frame_cmd_is(instance, frame, COMM_CMD_SUB)) {
+        // 数据格式: TOPIC,PERIOD_MS
+        char *comma = memchr(data, ',', frame->data_len);
+        uint16_t name_len = (comma != NULL) ? (uint16_t)(comma - data) : frame->data_len;
+        comm_topic_t *entry = comm_find_topic(instance, data, name_len);
+
+        if (entry == NULL) {
+            // 订阅已经ACK，先记录下来，本端声明该主题时开始发布
+            if (name_len == 0 || name_len > COMM_PUBSUB_MAX_TOPIC_LENGTH ||
+                (entry = comm_alloc_topic(instance, false)) == NULL) {
+                COMM_DEBUG_INSTANCE(instance, "无法记录未声明主题的订阅: %s", data);
+                return true;
+            }
+            memcpy(entry->name, data, name_len);
+            entry->name[name_len] = '\0';
+            COMM_DEBUG_INSTANCE(instance, "订阅了未声明的主题，等待声明: %s", entry->name);
+        }
+
+        entry->subscribed = true;
+        entry->period_ms = (comma != NULL) ? (uint16_t)strtoul(comma + 1, NULL, 10) : 0;
+        // 订阅时立即推送一次当前值
+        entry->dirty = (entry->value[0] != '\0');
+        entry->last_publish_time = HAL_GetTick() - entry->period_ms;
+        COMM_DEBUG_INSTANCE(instance, "主题被订阅: %s, 周期%dms", entry->name, entry->period_ms);
+        return true;
+    }
+
+    if (comm_frame_cmd_is(instance, frame, COMM_CMD_UNSUB)) {
+        comm_topic_t *entry = comm_find_topic(instance, data, frame->data_len);
+        if (entry != NULL) {
+            entry->subscribed = false;
+            // 只为记录订阅而占用的表项直接释放
+            if (!entry->advertised) {
+                entry->is_used = false;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+static bool comm_topic_name_is_valid(const char *topic)
+{
+    if (topic == NULL || topic[0] == '\0' || strlen(topic) > COMM_PUBSUB_MAX_TOPIC_LENGTH) {
+        return false;
+    }
+
+    // 主题名中不能出现主题层和帧格式使用的分隔符
+    return strpbrk(topic, ",;=#:{}") == NULL;
+}
+
+static bool comm_topic_value_is_valid(const char *value)
+{
+    if (value == NULL || strlen(value) > COMM_PUBSUB_MAX_VALUE_LENGTH) {
+        return false;
+    }
+
+    return strpbrk(value, ";#{}") == NULL;
+}
+
+static comm_topic_t* comm_find_topic(comm_instance_t *instance, const char *name, uint16_t name_len)
+{
+    for (int i = 0; i < COMM_PUBSUB_MAX_TOPICS; i++) {
+        comm_topic_t *entry = &instance->pubsub.topics[i];
+        if (entry->is_used && strlen(entry->name) == name_len &&
+            memcmp(entry->name, name, name_len) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief  分配一个清零的主题表项
+ * @param  advertise: true: 本端声明，表已满时可以占用只记录了订阅的表项
+ * @retval 表项指针，表已满时返回NULL
+ * @note   本端声明的主题优先，对端订阅本端不会声明的主题时不会因此占满主题表
+ */
+static comm_topic_t* comm_alloc_topic(comm_instance_t *instance, bool advertise)
+{
+    comm_topic_t *pending = NULL;
+
+    for (int i = 0; i < COMM_PUBSUB_MAX_TOPICS; i++) {
+        comm_topic_t *entry = &instance->pubsub.topics[i];
+        if (!entry->is_used) {
+            memset(entry, 0, sizeof(comm_topic_t));
+            entry->is_used = true;
+            return entry;
+        }
+        if (pending == NULL && !entry->advertised) {
+            pending = entry;
+        }
+    }
+
+    if (!advertise || pending == NULL) {
+        return NULL;
+    }
+
+    COMM_DEBUG_INSTANCE(instance, "主题表已满，丢弃未声明主题的订阅: %s", pending->name);
+    memset(pending, 0, sizeof(comm_topic_t));
+    pending->is_used = true;
+    return pending;
+}
+
+static comm_subscription_t* comm_find_subscription(comm_instance_t *instance, const char *name, uint16_t name_len)
+{
+    for (int i = 0; i < COMM_PUBSUB_MAX_TOPICS; i++) {
+        comm_subscription_t *sub = &instance->pubsub.subscriptions[i];
+        if (sub->is_used && strlen(sub->name) == name_len &&
+            memcmp(sub->name, name, name_len) == 0) {
+            return sub;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief  发送一个待发的SUB/USUB请求（可靠命令）
+ */
+static void comm_pubsub_send_requests(comm_instance_t *instance)
+{
+    for (int i = 0; i < COMM_PUBSUB_MAX_TOPICS; i++) {
+        comm_subscription_t *sub = &instance->pubsub.subscriptions[i];
+        if (!sub->is_used || !sub->request_pending) {
+            continue;
+        }
+
+        char data[COMM_PUBSUB_MAX_TOPIC_LENGTH + 8];
+        bool sent;
+        if (sub->callback != NULL) {
+            snprintf(data, sizeof(data), "%s,%u", sub->name, sub->period_ms);
+            sent = comm_send_command(instance->huart, COMM_CMD_SUB, data);
+        } else {
+            sent = comm_send_command(instance->huart, COMM_CMD_UNSUB, sub->name);
+            if (sent) {
+                sub->is_used = false;
+            }
+        }
+
+        if (sent) {
+            sub->request_pending = false;
+        }
+        return;
+    }
+}
+
+/**
+ * @brief  发送一个到期的可靠主题
+ */
+static void comm_pubsub_send_reliable(comm_instance_t *instance, uint32_t now)
+{
+    for (int i = 0; i < COMM_PUBSUB_MAX_TOPICS; i++) {
+        comm_topic_t *entry = &instance->pubsub.topics[i];
+        if (!entry->is_used || entry->qos != COMM_TOPIC_RELIABLE ||
+            !entry->subscribed || !entry->dirty ||
+            (now - entry->last_publish_time) < entry->period_ms) {
+            continue;
+        }
+
+        char data[COMM_PUBSUB_MAX_TOPIC_LENGTH + COMM_PUBSUB_MAX_VALUE_LENGTH + 2];
+        snprintf(data, sizeof(data), "%s%c%s", entry->name, COMM_PUBSUB_VALUE_SEPARATOR, entry->value);
+
+        if (comm_send_command(instance->huart, COMM_CMD_PUB, data)) {
+            entry->dirty = false;
+            entry->last_publish_time = now;
+        }
+        return;
+    }
+}
+
+/**
+ * @brief  把所有到期的无确认主题合并成一个PUB数据报
+ * @retval true: 已发送或没有到期的主题, false: 发送失败，主题保持dirty等待下次tick
+ */
+static bool comm_pubsub_send_best_effort(comm_instance_t *instance, uint32_t now)
+{
+    char data[COMM_MAX_DATA_LENGTH];
+    uint16_t length = 0;
+    bool packed[COMM_PUBSUB_MAX_TOPICS] = {0};
+
+    for (int i = 0; i < COMM_PUBSUB_MAX_TOPICS; i++) {
+        comm_topic_t *entry = &instance->pubsub.topics[i];
+        if (!entry->is_used || entry->qos != COMM_TOPIC_BEST_EFFORT ||
+            !entry->subscribed || !entry->dirty ||
+            (now - entry->last_publish_time) < entry->period_ms) {
+            continue;
+        }
+
+        uint16_t name_len = (uint16_t)strlen(entry->name);
+        uint16_t value_len = (uint16_t)strlen(entry->value);
+        uint16_t needed = name_len + 1 + value_len + (length > 0 ? 1 : 0);
+
+        // 放不下的主题保持dirty，下次tick再发
+        if (length + needed >= sizeof(data)) {
+            continue;
+        }
+
+        if (length > 0) {
+            data[length++] = COMM_PUBSUB_ENTRY_SEPARATOR;
+        }
+        memcpy(&data[length], entry->name, name_len);
+        length += name_len;
+        data[length++] = COMM_PUBSUB_VALUE_SEPARATOR;
+        memcpy(&data[length], entry->value, value_len);
+        length += value_len;
+        packed[i] = true;
+    }
+
+    if (length == 0) {
+        return true;
+    }
+
+    data[length] = '\0';
+    // 发送失败（信用不足、链路断开等）时保持dirty，下次tick重发最新值
+    if (!comm_send_datagram(instance, COMM_CMD_PUB, data)) {
+        COMM_DEBUG_INSTANCE(instance, "无确认主题发送失败，稍后重试");
+        return false;
+    }
+
+    for (int i = 0; i < COMM_PUBSUB_MAX_TOPICS; i++) {
+        if (packed[i]) {
+            instance->pubsub.topics[i].dirty = false;
+            instance->pubsub.topics[i].last_publish_time = now;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief  拆分PUB数据并分发给订阅回调
+ * @note   data指向rx_buffer，分隔符原地改写为'\0'
+ */
+static void comm_pubsub_deliver(comm_instance_t *instance, char *data, uint16_t data_len)
+{
+    char *entry = data;
+    char *end = data + data_len;
+
+    while (entry < end) {
+        char *next = memchr(entry, COMM_PUBSUB_ENTRY_SEPARATOR, (size_t)(end - entry));
+        if (next == NULL) {
+            next = end;
+        }
+        *next = '\0';
+
+        char *value = memchr(entry, COMM_PUBSUB_VALUE_SEPARATOR, (size_t)(next - entry));
+        if (value != NULL) {
+            uint16_t name_len = (uint16_t)(value - entry);
+            *value++ = '\0';
+
+            comm_subscription_t *sub = comm_find_subscription(instance, entry, name_len);
+            if (sub != NULL && sub->callback != NULL) {
+                sub->callback(instance->huart, entry, value, (uint16_t)(next - value), sub->user_ctx);
+            }
+        }
+
+        entry = next + 1;
+    }
+}
+
+#endif /* COMM_ENABLE_PUBSUB */
@@ -0,0 +1,114 @@
+/**
+ ******************************************************************************
+ * @file           : comm_pubsub.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信发布/订阅主题层
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 主题层 - 建立在实例和命令分发之上，用于周期性遥测数据
+ *
+ * 发布端只保存每个主题的最新值（新值覆盖旧值），按订阅端请求的周期发送：
+ *   - COMM_TOPIC_BEST_EFFORT: 多个到期主题合并成一个无确认PUB数据报
+ *   - COMM_TOPIC_RELIABLE:    每个主题单独用带ACK的PUB命令发送
+ *
+ * 使用示例:
+ *   // 发布端
+ *   comm_advertise_topic(&huart2, "TEMP", COMM_TOPIC_BEST_EFFORT);
+ *   comm_publish(&huart2, "TEMP", "25.3");
+ *   // 订阅端，最多每100ms更新一次
+ *   comm_subscribe(&huart3, "TEMP", 100, temp_callback, NULL);
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_PUBSUB_H
+#define COMM_PUBSUB_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_PUBSUB
+
+typedef enum {
+    COMM_TOPIC_BEST_EFFORT = 0,     /**< 无确认，多个主题合并为一帧 */
+    COMM_TOPIC_RELIABLE             /**< 带ACK和重试，逐个主题发送 */
+} comm_topic_qos_t;
+
+/* =============================================================================
+ * 发布端API
+ * =============================================================================
+ */
+
+/**
+ * @brief  在指定UART上声明一个可被订阅的主题
+ * @param  huart: UART句柄指针
+ * @param  topic: 主题名
+ * @param  qos: 可靠性
+ * @retval true: 声明成功, false: 声明失败
+ * @note   对端可以在声明之前订阅：SUB照常ACK并记录下来，声明后按记录的周期发布。
+ *         主题表已满时本端声明优先，占用只记录了订阅的表项
+ */
+bool comm_advertise_topic(UART_HandleTypeDef *huart, const char *topic, comm_topic_qos_t qos);
+
+/**
+ * @brief  更新主题的最新值
+ * @param  huart: UART句柄指针
+ * @param  topic: 主题名
+ * @param  value: 主题值（不能包含';'和'#'）
+ * @retval true: 更新成功, false: 更新失败
+ * @note   只记录最新值，实际发送在comm_tick()中按订阅周期进行，
+ *         两次发送之间的多次更新只会发出最后一个值
+ */
+bool comm_publish(UART_HandleTypeDef *huart, const char *topic, const char *value);
+
+/* =============================================================================
+ * 订阅端API
+ * =============================================================================
+ */
+
+/**
+ * @brief  订阅对端的主题
+ * @param  huart: UART句柄指针
+ * @param  topic: 主题名
+ * @param  period_ms: 期望的最小发布间隔（毫秒），0表示每次更新都发送
+ * @param  callback: 主题更新回调
+ * @param  user_ctx: 用户上下文
+ * @retval true: 订阅已登记, false: 登记失败
+ * @note   SUB请求在链路空闲时由comm_tick()自动发送
+ */
+bool comm_subscribe(UART_HandleTypeDef *huart, const char *topic, uint16_t period_ms,
+                    comm_topic_callback_t callback, void *user_ctx);
+
+/**
+ * @brief  取消订阅
+ * @param  huart: UART句柄指针
+ * @param  topic: 主题名
+ * @retval true: 已登记取消, false: 未找到订阅
+ */
+bool comm_unsubscribe(UART_HandleTypeDef *huart, const char *topic);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  处理到期的发布和待发送的订阅请求
+ * @param  instance: 实例指针
+ * @retval None
+ * @note   由comm_tick()调用
+ */
+void comm_pubsub_process(comm_instance_t *instance);
+
+/**
+ * @brief  处理SUB/USUB/PUB命令
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @retval true: 已作为主题命令处理, false: 不是主题命令
+ */
+bool comm_pubsub_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+#endif /* COMM_ENABLE_PUBSUB */
+
+#endif /* COMM_PUBSUB_H */
@@ -0,0 +1,293 @@
+/**
+ * @file    comm_query.c
+ * @brief   通信库远程查询 - 应答QRY命令，生成统计、状态、队列深度和配置快照
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_query.h"
+
+#if COMM_ENABLE_QUERY
+
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#include <string.h>
+
+/* 快照缓冲区大小，最长的H类别为(3 + 桶数)个32位字段 */
+#define COMM_QUERY_BUFFER_SIZE      (8 + (3 + COMM_STATS_DELAY_BUCKETS) * 9)
+
+/* 按字段顺序拼接快照，溢出后不再写入 */
+typedef struct {
+    char *buffer;
+    uint16_t size;
+    uint16_t length;
+    bool overflow;
+} comm_query_writer_t;
+
+/* Private function prototypes -----------------------------------------------*/
+static void comm_query_put(comm_query_writer_t *w, char c);
+static void comm_query_put_hex(comm_query_writer_t *w, uint32_t value);
+static void comm_query_field(comm_query_writer_t *w, uint32_t value);
+#if !COMM_ENABLE_LINK || !COMM_ENABLE_PRIORITY || !COMM_ENABLE_CREDITS
+static void comm_query_field_none(comm_query_writer_t *w);
+#endif
+static bool comm_query_build(comm_instance_t *instance, char kind, comm_query_writer_t *w);
+static comm_instance_t* comm_query_target(comm_instance_t *instance, const char *data, uint16_t length,
+                                          uint8_t *index);
+
+/* =============================================================================
+ * API实现
+ * =============================================================================
+ */
+
+bool comm_query_request(UART_HandleTypeDef *huart, char kind, uint8_t index)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return false;
+    }
+
+    char request[8] = { 'Q', ',', kind, '\0' };
+    if (index != COMM_QUERY_SELF) {
+        comm_query_writer_t w = { request, sizeof(request), 3, false };
+        comm_query_put(&w, ',');
+        comm_query_put_hex(&w, index);
+        request[w.length] = '\0';
+    }
+    return comm_send_datagram(instance, COMM_CMD_QUERY, request);
+}
+
+uint16_t comm_query_snapshot(UART_HandleTypeDef *huart, char kind, char *buffer, uint16_t size)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || buffer == NULL || size == 0) {
+        return 0;
+    }
+
+    comm_query_writer_t w = { buffer, (uint16_t)(size - 1), 0, false };
+    if (!comm_query_build(instance, kind, &w) || w.overflow) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    buffer[w.length] = '\0';
+    return w.length;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+bool comm_query_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    if (!comm_frame_cmd_is(instance, frame, COMM_CMD_QUERY)) {
+        return false;
+    }
+
+    const char *data = COMM_FRAME_DATA(instance, frame);
+    if (frame->data_len < 3 || data[0] != 'Q' || data[1] != ',') {
+        return false;       // 应答交给监控端的用户回调
+    }
+
+    char kind = data[2];
+    uint8_t index = 0;
+    comm_instance_t *target = comm_query_target(instance, data + 3, (uint16_t)(frame->data_len - 3), &index);
+
+    // 应答头 R,K,IDX 之后跟字段；不可用时改为 E,K,IDX
+    char reply[COMM_QUERY_BUFFER_SIZE];
+    comm_query_writer_t w = { reply, sizeof(reply) - 1, 0, false };
+    comm_query_put(&w, 'R');
+    comm_query_put(&w, ',');
+    comm_query_put(&w, kind);
+    comm_query_put(&w, ',');
+    comm_query_put_hex(&w, index);
+    uint16_t header_length = w.length;
+
+    if (target == NULL || !comm_query_build(target, kind, &w) || w.overflow) {
+        reply[0] = 'E';
+        w.length = header_length;
+    }
+    reply[w.length] = '\0';
+
+    COMM_DEBUG_INSTANCE(instance, "远程查询: %s", reply);
+    comm_send_datagram(instance, COMM_CMD_QUERY, reply);
+    return true;
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+static void comm_query_put(comm_query_writer_t *w, char c)
+{
+    if (w->length >= w->size) {
+        w->overflow = true;
+        return;
+    }
+    w->buffer[w->length++] = c;
+}
+
+/**
+ * @brief  写入不补0的大写十六进制
+ */
+static void comm_query_put_hex(comm_query_writer_t *w, uint32_t value)
+{
+    char digits[8];
+    uint8_t count = 1;
+    while (count < 8 && (value >> (4 * count)) != 0) {
+        count++;
+    }
+    comm_hex_encode(digits, value, count);
+    for (uint8_t i = 0; i < count; i++) {
+        comm_query_put(w, digits[i]);
+    }
+}
+
+static void comm_query_field(comm_query_writer_t *w, uint32_t value)
+{
+    if (w->length > 0) {
+        comm_query_put(w, ',');
+    }
+    comm_query_put_hex(w, value);
+}
+
+#if !COMM_ENABLE_LINK || !COMM_ENABLE_PRIORITY || !COMM_ENABLE_CREDITS
+/**
+ * @brief  写入未启用功能的占位字段'-'
+ */
+static void comm_query_field_none(comm_query_writer_t *w)
+{
+    if (w->length > 0) {
+        comm_query_put(w, ',');
+    }
+    comm_query_put(w, '-');
+}
+#endif
+
+/**
+ * @brief  按类别写入实例的字段
+ * @retval true: 已写入, false: 类别未知或所需功能未启用
+ */
+static bool comm_query_build(comm_instance_t *instance, char kind, comm_query_writer_t *w)
+{
+    switch (kind) {
+#if COMM_ENABLE_STATS
+    case 'S': {
+        const comm_stats_t *s = &instance->stats;
+        comm_query_field(w, s->tx_count);
+        comm_query_field(w, s->tx_success);
+        comm_query_field(w, s->tx_failed);
+        comm_query_field(w, s->tx_retry);
+        comm_query_field(w, s->tx_timeout);
+        comm_query_field(w, s->ping_count);
+        comm_query_field(w, s->ping_success);
+        return true;
+    }
+
+    case 'R': {
+        const comm_stats_t *s = &instance->stats;
+        comm_query_field(w, s->rx_count);
+        comm_query_field(w, s->rx_success);
+        comm_query_field(w, s->rx_error);
+        comm_query_field(w, s->rx_crc_error);
+        comm_query_field(w, s->rx_frame_error);
+        comm_query_field(w, s->rx_seq_error);
+        return true;
+    }
+
+    case 'H': {
+        const comm_stats_t *s = &instance->stats;
+        // 还没有样本时最小值为UINT32_MAX，按0应答
+        comm_query_field(w, (s->min_delay_ms == UINT32_MAX) ? 0 : s->min_delay_ms);
+        comm_query_field(w, s->avg_delay_ms);
+        comm_query_field(w, s->max_delay_ms);
+        for (uint8_t i = 0; i < COMM_STATS_DELAY_BUCKETS; i++) {
+            comm_query_field(w, s->delay_hist[i]);
+        }
+        return true;
+    }
+#endif
+
+    case 'T':
+        comm_query_field(w, instance->state);
+        comm_query_field(w, instance->retry_count);
+        comm_query_field(w, instance->tx_sequence);
+        comm_query_field(w, instance->rx_sequence);
+#if COMM_ENABLE_LINK
+        comm_query_field(w, instance->link.state);
+#else
+        comm_query_field_none(w);
+#endif
+        comm_query_field(w, HAL_GetTick() - instance->last_send_time);
+        return true;
+
+    case 'Q':
+        comm_query_field(w, (uint8_t)(instance->rx_produced - instance->rx_consumed));
+        comm_query_field(w, COMM_RX_FRAME_SLOTS);
+#if COMM_ENABLE_PRIORITY
+        for (uint8_t i = 0; i < COMM_PRIORITY_LANES; i++) {
+            comm_query_field(w, instance->priority.lanes[i].count);
+        }
+#else
+        for (uint8_t i = 0; i < 3; i++) {
+            comm_query_field_none(w);
+        }
+#endif
+#if COMM_ENABLE_CREDITS
+        comm_query_field(w, instance->credit.peer_credits);
+#else
+        comm_query_field_none(w);
+#endif
+        return true;
+
+    case 'C':
+        comm_query_field(w, instance->huart->Init.BaudRate);
+        comm_query_field(w, instance->timeout_ms);
+        comm_query_field(w, instance->max_retry);
+        comm_query_field(w, instance->rx_slot_size);
+        comm_query_field(w, instance->tx_buffer_size);
+        comm_query_field(w, COMM_FEATURE_MASK);
+        comm_query_field(w, comm_get_instance_count());
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief  解析查询的实例序号
+ * @param  instance: 收到查询的实例
+ * @param  data: 类别之后的内容（空或",IDX"）
+ * @param  length: 内容长度
+ * @param  index: 输出应答中的实例序号
+ * @retval 查询的实例，序号无效或不允许查询其它实例时返回NULL
+ */
+static comm_instance_t* comm_query_target(comm_instance_t *instance, const char *data, uint16_t length,
+                                          uint8_t *index)
+{
+    int8_t self = comm_manager_instance_index(instance);
+    *index = (self < 0) ? 0 : (uint8_t)self;
+    if (length == 0) {
+        return instance;
+    }
+    if (data[0] != ',' || length < 2 || length > 3) {
+        return NULL;
+    }
+
+    uint32_t value;
+    if (!comm_hex_decode(&data[1], (uint16_t)(length - 1), &value)) {
+        return NULL;
+    }
+    *index = (uint8_t)value;
+
+#if COMM_QUERY_ANY_INSTANCE
+    return comm_get_instance_by_index(*index);
+#else
+    return (*index == (uint8_t)self) ? instance : NULL;
+#endif
+}
+
+#endif /* COMM_ENABLE_QUERY */
@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * @file           : comm_query.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信远程查询
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 远程查询 - 监控端通过同一条链路读取统计、状态、队列深度和配置，不经过应用回调
+ *
+ * QRY命令由库保留并直接应答，应答为数据报:
+ *   {QRY:Q,K[,IDX]#..}         查询，IDX为实例表序号（十六进制），省略时查询收到请求的实例
+ *   {QRY:R,K,IDX,F1,F2,...#00#..}   应答，字段为不补0的大写十六进制，顺序固定
+ *   {QRY:E,K,IDX#00#..}        该类别不可用（功能未启用）或实例不存在
+ *
+ * 查询类别K及应答字段:
+ *   S 发送统计（需COMM_ENABLE_STATS）: 完成数,成功,失败,重传,超时,PING数,PING成功
+ *   R 接收统计（需COMM_ENABLE_STATS）: 帧数,成功,错误,CRC错误,格式错误,序列号错误
+ *   H ACK延迟（需COMM_ENABLE_STATS）: 最小,平均,最大,直方图各桶计数（见COMM_STATS_DELAY_BUCKETS）
+ *   T 状态: 状态码,当前重试次数,发送序列号,接收序列号,链路状态,距上次发送的毫秒数
+ *   Q 队列深度: 待处理接收槽（含本次查询）,接收槽数,URGENT/NORMAL/BULK排队数,对端额度
+ *   C 配置: 波特率,超时,最大重试,接收槽大小,发送缓冲区大小,功能掩码,实例数
+ * 未启用的功能对应字段为'-'；状态码与comm_instance_get_state()一致，链路状态为comm_link_state_t。
+ *
+ * 监控端的QRY应答不被库消费，注册"QRY"命令回调即可收到:
+ *   comm_register_command_callback_ex(&huart1, COMM_CMD_QUERY, on_query_reply, NULL);
+ *   comm_query_request(&huart1, 'S', COMM_QUERY_SELF);
+ *
+ * 注意：
+ *   - 应答以数据报发送，丢失时重新查询即可
+ *   - 本端也可以用comm_query_snapshot()取得同样格式的字段，直接打印或转发
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_QUERY_H
+#define COMM_QUERY_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_QUERY
+
+/** @brief 查询收到请求的实例自身 */
+#define COMM_QUERY_SELF             0xFF
+
+/* =============================================================================
+ * 查询API
+ * =============================================================================
+ */
+
+/**
+ * @brief  向对端发送查询
+ * @param  huart: UART句柄指针
+ * @param  kind: 查询类别（S/R/H/T/Q/C）
+ * @param  index: 对端实例表序号，COMM_QUERY_SELF表示对端收到查询的实例
+ * @retval true: 查询已发送, false: 发送失败
+ * @note   应答交给本端注册的"QRY"命令回调
+ */
+bool comm_query_request(UART_HandleTypeDef *huart, char kind, uint8_t index);
+
+/**
+ * @brief  生成本端实例的查询字段
+ * @param  huart: UART句柄指针
+ * @param  kind: 查询类别（S/R/H/T/Q/C）
+ * @param  buffer: 输出缓冲区，字段以','分隔并以'\0'结尾
+ * @param  size: 缓冲区大小
+ * @retval 字段长度，类别不可用、未找到实例或放不下时返回0
+ */
+uint16_t comm_query_snapshot(UART_HandleTypeDef *huart, char kind, char *buffer, uint16_t size);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  应答查询帧
+ * @param  instance: 实例指针
+ * @param  frame: 接收到的帧
+ * @retval true: 已处理（QRY查询帧）, false: 不是查询帧（包括应答，交给用户回调）
+ */
+bool comm_query_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+#endif /* COMM_ENABLE_QUERY */
+
+#endif /* COMM_QUERY_H */
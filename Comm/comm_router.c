@@ -0,0 +1,348 @@
+/**
+ * @file    comm_router.c
+ * @brief   通信库帧路由层 - 前缀/地址路由、转发队列、背压
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_router.h"
+
+#if COMM_ENABLE_ROUTER
+
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#if COMM_ENABLE_RS485
+#include "comm_rs485.h"
+#endif
+#if COMM_ENABLE_COMPRESS
+#include "comm_compress.h"
+#endif
+#include <string.h>
+
+/* 转发队列中的一帧 */
+typedef struct {
+    char payload[COMM_ROUTE_PAYLOAD_SIZE];  /**< "CMD:DATA#"原样拷贝 */
+    uint16_t payload_len;                   /**< 内容长度 */
+    uint8_t cmd_len;                        /**< 命令长度 */
+    uint8_t crc_partial;                    /**< 内容部分的CRC累积值 */
+    bool datagram;                          /**< 按数据报转发 */
+} comm_route_entry_t;
+
+typedef struct {
+    comm_instance_t *in;                    /**< 入口实例，NULL表示任意 */
+    comm_instance_t *out;                   /**< 出口实例 */
+    char prefix[COMM_MAX_CMD_LENGTH + 1];   /**< 命令前缀 */
+    uint8_t prefix_len;                     /**< 前缀长度 */
+    bool match_addr;                        /**< 按目标地址匹配 */
+    uint8_t addr;                           /**< 目标地址 */
+    bool is_used;                           /**< 是否已使用 */
+
+    comm_route_entry_t queue[COMM_ROUTE_QUEUE_DEPTH];   /**< 转发队列 */
+    uint8_t head;                           /**< 队头 */
+    uint8_t count;                          /**< 队列长度 */
+
+    uint32_t forwarded;                     /**< 已转发帧数 */
+    uint32_t rejected;                      /**< 队列满被拒绝的帧数 */
+} comm_route_t;
+
+typedef struct {
+    comm_route_t routes[COMM_ROUTER_MAX_ROUTES];
+    uint8_t next_route;                     /**< 轮转起点，共用出口的路由轮流发送 */
+} comm_router_t;
+
+static comm_router_t g_comm_router = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+static int8_t comm_route_alloc(UART_HandleTypeDef *in_huart, UART_HandleTypeDef *out_huart);
+static bool comm_route_matches(const comm_route_t *route, const comm_instance_t *instance,
+                               const comm_frame_t *frame);
+#if COMM_ENABLE_COMPRESS
+static bool comm_route_inflate_entry(const comm_route_t *route, comm_route_entry_t *entry);
+#endif
+static bool comm_route_send_head(comm_route_t *route);
+
+/* =============================================================================
+ * 路由配置API实现
+ * =============================================================================
+ */
+
+int8_t comm_route_add_prefix(UART_HandleTypeDef *in_huart, const char *prefix, UART_HandleTypeDef *out_huart)
+{
+    if (prefix == NULL || strlen(prefix) > COMM_MAX_CMD_LENGTH) {
+        return -1;
+    }
+
+    int8_t id = comm_route_alloc(in_huart, out_huart);
+    if (id < 0) {
+        return -1;
+    }
+
+    comm_route_t *route = &g_comm_router.routes[id];
+    strcpy(route->prefix, prefix);
+    route->prefix_len = (uint8_t)strlen(prefix);
+    return id;
+}
+
+#if COMM_ENABLE_RS485
+int8_t comm_route_add_address(UART_HandleTypeDef *in_huart, uint8_t dst_addr, UART_HandleTypeDef *out_huart)
+{
+    if (dst_addr >= COMM_RS485_MAX_NODES) {
+        return -1;
+    }
+
+    int8_t id = comm_route_alloc(in_huart, out_huart);
+    if (id < 0) {
+        return -1;
+    }
+
+    g_comm_router.routes[id].match_addr = true;
+    g_comm_router.routes[id].addr = dst_addr;
+    return id;
+}
+#endif
+
+bool comm_route_remove(int8_t route_id)
+{
+    if (route_id < 0 || route_id >= COMM_ROUTER_MAX_ROUTES) {
+        return false;
+    }
+
+    memset(&g_comm_router.routes[route_id], 0, sizeof(comm_route_t));
+    return true;
+}
+
+bool comm_route_get_stats(int8_t route_id, uint32_t *forwarded, uint32_t *rejected)
+{
+    if (route_id < 0 || route_id >= COMM_ROUTER_MAX_ROUTES || !g_comm_router.routes[route_id].is_used) {
+        return false;
+    }
+
+    const comm_route_t *route = &g_comm_router.routes[route_id];
+    if (forwarded != NULL) {
+        *forwarded = route->forwarded;
+    }
+    if (rejected != NULL) {
+        *rejected = route->rejected;
+    }
+    return true;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_router_init(void)
+{
+    memset(&g_comm_router, 0, sizeof(comm_router_t));
+}
+
+comm_route_result_t comm_router_route(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    for (uint8_t i = 0; i < COMM_ROUTER_MAX_ROUTES; i++) {
+        comm_route_t *route = &g_comm_router.routes[i];
+        if (!comm_route_matches(route, instance, frame)) {
+            continue;
+        }
+
+        // 出口放不下的帧不转发，交给本地处理
+        if (frame->cmd_len >= COMM_MAX_CMD_LENGTH || frame->data_len >= COMM_MAX_DATA_LENGTH) {
+            COMM_DEBUG_INSTANCE(instance, "帧过长，无法转发: %s", COMM_FRAME_CMD(instance, frame));
+            return COMM_ROUTE_NONE;
+        }
+
+        if (route->count >= COMM_ROUTE_QUEUE_DEPTH) {
+            route->rejected++;
+            return COMM_ROUTE_BUSY;
+        }
+
+        uint8_t tail = (uint8_t)((route->head + route->count) % COMM_ROUTE_QUEUE_DEPTH);
+        comm_route_entry_t *entry = &route->queue[tail];
+
+        // 接收缓冲区中分隔符已改写为'\0'，拷贝时还原
+        uint16_t len = 0;
+        memcpy(&entry->payload[len], COMM_FRAME_CMD(instance, frame), frame->cmd_len);
+        len += frame->cmd_len;
+        entry->payload[len++] = COMM_CMD_DATA_SEPARATOR;
+        memcpy(&entry->payload[len], COMM_FRAME_DATA(instance, frame), frame->data_len);
+        len += frame->data_len;
+        entry->payload[len++] = COMM_FIELD_SEPARATOR;
+
+        entry->payload_len = len;
+        entry->cmd_len = frame->cmd_len;
+        entry->crc_partial = frame->crc_partial;
+
+#if COMM_ENABLE_COMPRESS
+        // 出口对端未通告解压能力时，压缩帧解压后再转发
+        if (!comm_route_inflate_entry(route, entry)) {
+            COMM_DEBUG_INSTANCE(instance, "压缩帧无法解压转发: %s", COMM_FRAME_CMD(instance, frame));
+            return COMM_ROUTE_NONE;
+        }
+#endif
+        entry->datagram = (frame->sequence == 0);
+#if COMM_ENABLE_RS485
+        entry->datagram = entry->datagram ||
+                          (frame->has_address && frame->dst_addr == COMM_RS485_BROADCAST_ADDR);
+#endif
+        route->count++;
+        return COMM_ROUTE_QUEUED;
+    }
+
+    return COMM_ROUTE_NONE;
+}
+
+void comm_router_process(void)
+{
+    uint8_t start = g_comm_router.next_route;
+
+    for (uint8_t n = 0; n < COMM_ROUTER_MAX_ROUTES; n++) {
+        uint8_t i = (uint8_t)((start + n) % COMM_ROUTER_MAX_ROUTES);
+        comm_route_t *route = &g_comm_router.routes[i];
+
+        if (!route->is_used || route->count == 0) {
+            continue;
+        }
+
+        if (comm_route_send_head(route)) {
+            // 下一轮从后一条路由开始，避免共用出口的路由饿死
+            g_comm_router.next_route = (uint8_t)((i + 1) % COMM_ROUTER_MAX_ROUTES);
+        }
+    }
+}
+
+#if COMM_ENABLE_RS485
+bool comm_router_has_address_route(const comm_instance_t *instance, uint8_t dst_addr)
+{
+    for (uint8_t i = 0; i < COMM_ROUTER_MAX_ROUTES; i++) {
+        const comm_route_t *route = &g_comm_router.routes[i];
+        if (route->is_used && route->match_addr && route->addr == dst_addr &&
+            (route->in == NULL || route->in == instance)) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  分配空闲路由条目
+ */
+static int8_t comm_route_alloc(UART_HandleTypeDef *in_huart, UART_HandleTypeDef *out_huart)
+{
+    comm_instance_t *out = comm_find_instance(out_huart);
+    comm_instance_t *in = (in_huart != NULL) ? comm_find_instance(in_huart) : NULL;
+    if (out == NULL || (in_huart != NULL && in == NULL) || in == out) {
+        return -1;
+    }
+
+    for (int8_t i = 0; i < COMM_ROUTER_MAX_ROUTES; i++) {
+        comm_route_t *route = &g_comm_router.routes[i];
+        if (!route->is_used) {
+            memset(route, 0, sizeof(comm_route_t));
+            route->in = in;
+            route->out = out;
+            route->is_used = true;
+            return i;
+        }
+    }
+
+    COMM_ERROR_OUTPUT("路由表已满: %d", COMM_ROUTER_MAX_ROUTES);
+    return -1;
+}
+
+/**
+ * @brief  判断帧是否匹配路由
+ */
+static bool comm_route_matches(const comm_route_t *route, const comm_instance_t *instance,
+                               const comm_frame_t *frame)
+{
+    if (!route->is_used || route->out == instance ||
+        (route->in != NULL && route->in != instance)) {
+        return false;
+    }
+
+    if (route->match_addr) {
+#if COMM_ENABLE_RS485
+        return frame->has_address && frame->dst_addr == route->addr;
+#else
+        return false;
+#endif
+    }
+
+    return frame->cmd_len >= route->prefix_len &&
+           memcmp(COMM_FRAME_CMD(instance, frame), route->prefix, route->prefix_len) == 0;
+}
+
+#if COMM_ENABLE_COMPRESS
+/**
+ * @brief  出口不支持解压时把队列条目中的压缩帧还原为原始命令和数据
+ * @retval true: 条目可以转发, false: 数据错误或解压后放不下
+ * @note   去掉命令的压缩后缀，重新计算"CMD:DATA#"的CRC累积值
+ */
+static bool comm_route_inflate_entry(const comm_route_t *route, comm_route_entry_t *entry)
+{
+    if (route->out->compress.peer_supported || entry->cmd_len < 2 ||
+        entry->payload[entry->cmd_len - 1] != COMM_COMPRESS_MARK) {
+        return true;
+    }
+
+    char data[COMM_MAX_DATA_LENGTH];
+    uint16_t data_offset = (uint16_t)(entry->cmd_len + 1);
+    int len = comm_compress_decode(&entry->payload[data_offset],
+                                   (uint16_t)(entry->payload_len - data_offset - 1),
+                                   data, sizeof(data) - 1);
+    if (len < 0) {
+        return false;
+    }
+
+    uint16_t pos = (uint16_t)(entry->cmd_len - 1);
+    entry->payload[pos++] = COMM_CMD_DATA_SEPARATOR;
+    memcpy(&entry->payload[pos], data, (size_t)len);
+    pos += (uint16_t)len;
+    entry->payload[pos++] = COMM_FIELD_SEPARATOR;
+
+    entry->cmd_len--;
+    entry->payload_len = pos;
+    entry->crc_partial = comm_crc8_calculate((const uint8_t *)entry->payload, pos);
+    return true;
+}
+#endif
+
+/**
+ * @brief  发送队头帧，出口未就绪时保留在队列中
+ * @retval true: 已出队, false: 等待出口
+ */
+static bool comm_route_send_head(comm_route_t *route)
+{
+    comm_route_entry_t *entry = &route->queue[route->head];
+
+    if (!entry->datagram && !comm_instance_is_ready(route->out)) {
+        return false;
+    }
+
+#if COMM_ENABLE_RS485
+    // 按地址转发时，出口发往同一地址的节点
+    if (route->match_addr && route->out->rs485.enabled && !entry->datagram) {
+        comm_rs485_select_tx_peer(route->out, route->addr);
+    }
+#endif
+
+    if (comm_send_prefolded(route->out, entry->payload, entry->payload_len,
+                            entry->cmd_len, entry->crc_partial, entry->datagram)) {
+        route->forwarded++;
+    } else {
+        COMM_DEBUG_INSTANCE(route->out, "转发失败，丢弃: %.*s", entry->cmd_len, entry->payload);
+    }
+
+    route->head = (uint8_t)((route->head + 1) % COMM_ROUTE_QUEUE_DEPTH);
+    route->count--;
+    return true;
+}
+
+#endif /* COMM_ENABLE_ROUTER */
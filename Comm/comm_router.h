@@ -0,0 +1,126 @@
+/**
+ ******************************************************************************
+ * @file           : comm_router.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信实例间帧路由
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 帧路由层 - 把一个UART收到的帧转发到另一个UART，用于网关/桥接
+ *
+ * 路由按命令前缀或RS-485目标地址匹配，第一条匹配的路由生效：
+ *   - 转发时原样拷贝"CMD:DATA#"，沿用接收时累积的CRC，只续算出口的新序列号
+ *   - 每条路由一个转发队列，出口就绪时由comm_tick()逐帧发出
+ *   - 队列满时对命令帧回复NAK(BUSY)，发送方退避后重发；数据报直接丢弃
+ *   - ACK只表示本跳已接收，不代表最终目的地已收到
+ *
+ * 使用示例:
+ *   // 4路传感器的TEL*命令汇总到上行口
+ *   comm_route_add_prefix(&huart2, "TEL", &huart1);
+ *   comm_route_add_prefix(&huart3, "TEL", &huart1);
+ *   // 上行口的CFG*命令下发到传感器2
+ *   comm_route_add_prefix(&huart1, "CFG", &huart2);
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_ROUTER_H
+#define COMM_ROUTER_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_ROUTER
+
+/** @brief 转发队列中一帧的最大内容长度: CMD + ':' + DATA + '#' */
+#define COMM_ROUTE_PAYLOAD_SIZE     (COMM_MAX_CMD_LENGTH + COMM_MAX_DATA_LENGTH + 2)
+
+typedef enum {
+    COMM_ROUTE_NONE = 0,            /**< 没有匹配的路由，本地处理 */
+    COMM_ROUTE_QUEUED,              /**< 已进入转发队列 */
+    COMM_ROUTE_BUSY                 /**< 匹配但队列已满 */
+} comm_route_result_t;
+
+/* =============================================================================
+ * 路由配置API
+ * =============================================================================
+ */
+
+/**
+ * @brief  按命令前缀添加路由
+ * @param  in_huart: 入口UART，NULL表示任意入口
+ * @param  prefix: 命令前缀，""匹配所有命令
+ * @param  out_huart: 出口UART
+ * @retval 路由编号，失败返回-1
+ */
+int8_t comm_route_add_prefix(UART_HandleTypeDef *in_huart, const char *prefix, UART_HandleTypeDef *out_huart);
+
+#if COMM_ENABLE_RS485
+/**
+ * @brief  按RS-485目标地址添加路由
+ * @param  in_huart: 入口UART，NULL表示任意入口
+ * @param  dst_addr: 目标节点地址
+ * @param  out_huart: 出口UART，启用RS-485时转发给同一地址的节点
+ * @retval 路由编号，失败返回-1
+ * @note   入口会接收发往该地址的帧，而不是在中断中丢弃
+ */
+int8_t comm_route_add_address(UART_HandleTypeDef *in_huart, uint8_t dst_addr, UART_HandleTypeDef *out_huart);
+#endif
+
+/**
+ * @brief  删除路由
+ * @param  route_id: 路由编号
+ * @retval true: 删除成功, false: 编号无效
+ * @note   队列中未发出的帧一并丢弃
+ */
+bool comm_route_remove(int8_t route_id);
+
+/**
+ * @brief  获取路由统计
+ * @param  route_id: 路由编号
+ * @param  forwarded: 输出已转发帧数，可为NULL
+ * @param  rejected: 输出因队列满被拒绝的帧数，可为NULL
+ * @retval true: 获取成功, false: 编号无效
+ */
+bool comm_route_get_stats(int8_t route_id, uint32_t *forwarded, uint32_t *rejected);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  清空路由表
+ * @retval None
+ * @note   由comm_init()调用
+ */
+void comm_router_init(void);
+
+/**
+ * @brief  为接收帧查找路由并入队
+ * @param  instance: 入口实例
+ * @param  frame: 已通过校验的帧
+ * @retval 路由结果
+ */
+comm_route_result_t comm_router_route(comm_instance_t *instance, const comm_frame_t *frame);
+
+/**
+ * @brief  把各路由队列中的帧发往已就绪的出口
+ * @retval None
+ * @note   由comm_tick()在处理完所有实例后调用
+ */
+void comm_router_process(void);
+
+#if COMM_ENABLE_RS485
+/**
+ * @brief  判断入口是否有该目标地址的路由（接收中断中调用）
+ * @param  instance: 入口实例
+ * @param  dst_addr: 目标地址
+ * @retval true: 有路由, false: 没有
+ */
+bool comm_router_has_address_route(const comm_instance_t *instance, uint8_t dst_addr);
+#endif
+
+#endif /* COMM_ENABLE_ROUTER */
+
+#endif /* COMM_ROUTER_H */
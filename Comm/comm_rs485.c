@@ -0,0 +1,338 @@
+/**
+ * @file    comm_rs485.c
+ * @brief   通信库RS-485总线层 - 节点寻址、DE/RE方向控制、主站轮询
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_rs485.h"
+
+#if COMM_ENABLE_RS485
+
+#include "comm.h"
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#if COMM_ENABLE_ROUTER
+#include "comm_router.h"
+#endif
+#include <string.h>
+
+/* Private function prototypes -----------------------------------------------*/
+static void comm_rs485_answer_poll(comm_instance_t *instance);
+
+/* =============================================================================
+ * 配置API实现
+ * =============================================================================
+ */
+
+bool comm_rs485_enable(UART_HandleTypeDef *huart, GPIO_TypeDef *de_port, uint16_t de_pin,
+                       uint8_t node_addr, comm_rs485_role_t role)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || node_addr >= COMM_RS485_MAX_NODES) {
+        return false;
+    }
+
+    comm_rs485_t *bus = &instance->rs485;
+    memset(bus, 0, sizeof(comm_rs485_t));
+    bus->enabled = true;
+    bus->role = (uint8_t)role;
+    bus->node_addr = node_addr;
+    bus->peer_addr = COMM_RS485_MASTER_ADDR;
+    bus->rx_peer = COMM_RS485_MASTER_ADDR;
+    bus->de_port = de_port;
+    bus->de_pin = de_pin;
+    bus->turnaround_ms = COMM_RS485_DEFAULT_TURNAROUND_MS;
+
+    // 已有的序列号归入默认对端
+    bus->tx_seq_table[bus->peer_addr] = instance->tx_sequence;
+    bus->rx_seq_table[bus->rx_peer] = instance->rx_sequence;
+
+    // 默认处于接收方向
+    if (de_port != NULL) {
+        HAL_GPIO_WritePin(de_port, de_pin, GPIO_PIN_RESET);
+    }
+
+    COMM_DEBUG_INSTANCE(instance, "RS-485启用: 地址=%02X, 角色=%d", node_addr, role);
+    return true;
+}
+
+bool comm_rs485_add_slave(UART_HandleTypeDef *huart, uint8_t addr)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || !instance->rs485.enabled || addr >= COMM_RS485_MAX_NODES) {
+        return false;
+    }
+
+    comm_rs485_t *bus = &instance->rs485;
+    for (uint8_t i = 0; i < bus->slave_count; i++) {
+        if (bus->slaves[i] == addr) {
+            return true;
+        }
+    }
+
+    if (bus->slave_count >= COMM_RS485_MAX_NODES) {
+        return false;
+    }
+
+    bus->slaves[bus->slave_count++] = addr;
+    return true;
+}
+
+bool comm_rs485_start_polling(UART_HandleTypeDef *huart, uint16_t interval_ms, uint16_t turnaround_ms)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || !instance->rs485.enabled || instance->rs485.role != COMM_RS485_MASTER) {
+        return false;
+    }
+
+    comm_rs485_t *bus = &instance->rs485;
+    bus->poll_interval_ms = interval_ms;
+    bus->turnaround_ms = (turnaround_ms > 0) ? turnaround_ms : COMM_RS485_DEFAULT_TURNAROUND_MS;
+    bus->poll_index = 0;
+    bus->last_poll_time = HAL_GetTick();
+    bus->polling = true;
+    return true;
+}
+
+bool comm_rs485_stop_polling(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return false;
+    }
+
+    // 已发出的轮询仍等待应答或超时，避免与从站应答冲突
+    instance->rs485.polling = false;
+    return true;
+}
+
+uint32_t comm_rs485_get_poll_timeouts(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return 0;
+    }
+
+    return instance->rs485.poll_timeouts;
+}
+
+/* =============================================================================
+ * 发送API实现
+ * =============================================================================
+ */
+
+bool comm_send_command_to(UART_HandleTypeDef *huart, uint8_t dst, const char *cmd, const char *data)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL || !instance->rs485.enabled) {
+        return false;
+    }
+
+    if (dst == COMM_RS485_BROADCAST_ADDR) {
+        // 广播无人应答ACK，按数据报发送；从站不允许主动广播
+        if (instance->rs485.role != COMM_RS485_MASTER || instance->rs485.poll_outstanding) {
+            return false;
+        }
+        return comm_send_datagram_to(instance, dst, cmd, data);
+    }
+
+    if (dst >= COMM_RS485_MAX_NODES || !comm_instance_is_ready(instance)) {
+        return false;
+    }
+
+    comm_rs485_select_tx_peer(instance, dst);
+    return comm_send_command(huart, cmd, data);
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_rs485_tx_begin(comm_instance_t *instance)
+{
+    comm_rs485_t *bus = &instance->rs485;
+    if (!bus->enabled || bus->de_port == NULL) {
+        return;
+    }
+
+    HAL_GPIO_WritePin(bus->de_port, bus->de_pin, GPIO_PIN_SET);
+    bus->de_active = true;
+}
+
+void comm_rs485_tx_end(comm_instance_t *instance)
+{
+    comm_rs485_t *bus = &instance->rs485;
+    if (!bus->de_active) {
+        return;
+    }
+
+    HAL_GPIO_WritePin(bus->de_port, bus->de_pin, GPIO_PIN_RESET);
+    bus->de_active = false;
+}
+
+bool comm_rs485_defer_tx(comm_instance_t *instance)
+{
+    comm_rs485_t *bus = &instance->rs485;
+    if (!bus->enabled || bus->role != COMM_RS485_SLAVE) {
+        return false;
+    }
+
+    bus->tx_deferred = true;
+    return true;
+}
+
+bool comm_rs485_accept_frame(const comm_instance_t *instance, const comm_frame_t *frame)
+{
+    const comm_rs485_t *bus = &instance->rs485;
+
+    // 未启用寻址或点对点帧，保持原有行为
+    if (!bus->enabled || !frame->has_address) {
+        return true;
+    }
+
+    if (frame->src_addr >= COMM_RS485_MAX_NODES || frame->src_addr == bus->node_addr) {
+        return false;
+    }
+
+    if (frame->dst_addr == bus->node_addr || frame->dst_addr == COMM_RS485_BROADCAST_ADDR) {
+        return true;
+    }
+
+#if COMM_ENABLE_ROUTER
+    // 网关代收发往其他总线节点的帧
+    return comm_router_has_address_route(instance, frame->dst_addr);
+#else
+    return false;
+#endif
+}
+
+void comm_rs485_select_tx_peer(comm_instance_t *instance, uint8_t dst)
+{
+    comm_rs485_t *bus = &instance->rs485;
+    if (!bus->enabled || dst >= COMM_RS485_MAX_NODES || dst == bus->peer_addr) {
+        return;
+    }
+
+    bus->tx_seq_table[bus->peer_addr] = instance->tx_sequence;
+    bus->peer_addr = dst;
+    instance->tx_sequence = bus->tx_seq_table[dst];
+}
+
+void comm_rs485_select_rx_peer(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    comm_rs485_t *bus = &instance->rs485;
+    if (!bus->enabled || !frame->has_address || frame->src_addr == bus->rx_peer) {
+        return;
+    }
+
+    bus->rx_seq_table[bus->rx_peer] = instance->rx_sequence;
+    bus->rx_peer = frame->src_addr;
+    instance->rx_sequence = bus->rx_seq_table[bus->rx_peer];
+}
+
+bool comm_rs485_is_from_tx_peer(const comm_instance_t *instance, const comm_frame_t *frame)
+{
+    const comm_rs485_t *bus = &instance->rs485;
+    if (!bus->enabled || !frame->has_address) {
+        return true;
+    }
+
+    return frame->src_addr == bus->peer_addr;
+}
+
+bool comm_rs485_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    comm_rs485_t *bus = &instance->rs485;
+    if (!bus->enabled || !frame->has_address) {
+        return false;
+    }
+
+    if (bus->role == COMM_RS485_MASTER) {
+        // 被轮询从站的任何一帧都表示它已交还总线
+        if (bus->poll_outstanding && frame->src_addr == bus->polled_addr) {
+            bus->poll_outstanding = false;
+            bus->last_poll_time = HAL_GetTick();
+        }
+        return comm_frame_cmd_is(instance, frame, COMM_CMD_POLL_EMPTY);
+    }
+
+    if (comm_frame_cmd_is(instance, frame, COMM_CMD_POLL)) {
+        // 广播轮询会让所有从站同时应答，忽略
+        if (frame->dst_addr == bus->node_addr) {
+            comm_rs485_answer_poll(instance);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void comm_rs485_process(comm_instance_t *instance)
+{
+    comm_rs485_t *bus = &instance->rs485;
+    if (!bus->enabled || bus->role != COMM_RS485_MASTER) {
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+
+    if (bus->poll_outstanding) {
+        if (now - bus->poll_start_time >= bus->turnaround_ms) {
+            // 从站无应答，收回总线继续轮询下一个
+            bus->poll_outstanding = false;
+            bus->last_poll_time = now;
+            bus->poll_timeouts++;
+            COMM_DEBUG_INSTANCE(instance, "从站%02X轮询无应答", bus->polled_addr);
+        }
+        return;
+    }
+
+    if (!bus->polling || bus->slave_count == 0 || instance->state != COMM_STATE_IDLE) {
+        return;
+    }
+
+    if (now - bus->last_poll_time < bus->poll_interval_ms) {
+        return;
+    }
+
+    uint8_t addr = bus->slaves[bus->poll_index];
+    bus->poll_index = (uint8_t)((bus->poll_index + 1) % bus->slave_count);
+
+    if (comm_send_datagram_to(instance, addr, COMM_CMD_POLL, "")) {
+        bus->polled_addr = addr;
+        bus->poll_outstanding = true;
+        bus->poll_start_time = HAL_GetTick();
+    } else {
+        bus->last_poll_time = now;
+    }
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  从站应答轮询：发出积压的命令，否则回复PRDY
+ */
+static void comm_rs485_answer_poll(comm_instance_t *instance)
+{
+    comm_rs485_t *bus = &instance->rs485;
+
+    if (!bus->tx_deferred) {
+        comm_send_datagram_to(instance, bus->rx_peer, COMM_CMD_POLL_EMPTY, "");
+        return;
+    }
+
+    if (comm_send_raw(instance, instance->tx_buffer, instance->tx_length)) {
+        bus->tx_deferred = false;
+        comm_set_state(instance, COMM_STATE_WAIT_ACK);
+    } else {
+        COMM_DEBUG_INSTANCE(instance, "轮询应答发送失败，等待下次轮询");
+    }
+}
+
+#endif /* COMM_ENABLE_RS485 */
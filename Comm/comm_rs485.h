@@ -0,0 +1,191 @@
+/**
+ ******************************************************************************
+ * @file           : comm_rs485.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信RS-485多点总线支持
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * RS-485总线层 - 一个UART挂多个节点
+ *
+ * 寻址帧在序列号后附加目标/源地址: {CMD:DATA#SEQ@DDSS#CRC}
+ *   - DD为0xFF时是广播帧，所有节点接收，不回ACK
+ *   - 发给其他节点的帧在接收中断中直接丢弃
+ *   - 每个对端节点各自维护收发序列号
+ *
+ * 半双工方向控制: 发送前拉高DE/RE，发送完成(TC)后释放。
+ *
+ * 主从轮询: 从站不主动占用总线，comm_send_command()只把帧放进tx_buffer，
+ * 主站轮询到该从站时才发出；没有待发命令的从站回复PRDY。
+ *
+ * 使用示例:
+ *   // 主站
+ *   comm_rs485_enable(&huart2, GPIOA, GPIO_PIN_8, 0x00, COMM_RS485_MASTER);
+ *   comm_rs485_add_slave(&huart2, 0x01);
+ *   comm_rs485_add_slave(&huart2, 0x02);
+ *   comm_rs485_start_polling(&huart2, 5, 20);
+ *   comm_send_command_to(&huart2, 0x01, "WALK", "D1 V100");
+ *   // 从站
+ *   comm_rs485_enable(&huart2, GPIOA, GPIO_PIN_8, 0x01, COMM_RS485_SLAVE);
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_RS485_H
+#define COMM_RS485_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_RS485
+
+typedef enum {
+    COMM_RS485_MASTER = 0,          /**< 主站：可随时发送，负责轮询从站 */
+    COMM_RS485_SLAVE                /**< 从站：只在被轮询或应答时发送 */
+} comm_rs485_role_t;
+
+/* =============================================================================
+ * 配置API
+ * =============================================================================
+ */
+
+/**
+ * @brief  在指定UART上启用RS-485寻址
+ * @param  huart: UART句柄指针（需先comm_add_uart）
+ * @param  de_port: DE/RE控制端口，收发器自动切换方向时传NULL
+ * @param  de_pin: DE/RE控制引脚（高电平发送）
+ * @param  node_addr: 本节点地址（0 ~ COMM_RS485_MAX_NODES-1）
+ * @param  role: 节点角色
+ * @retval true: 启用成功, false: 启用失败
+ * @note   从站的命令默认发往COMM_RS485_MASTER_ADDR
+ */
+bool comm_rs485_enable(UART_HandleTypeDef *huart, GPIO_TypeDef *de_port, uint16_t de_pin,
+                       uint8_t node_addr, comm_rs485_role_t role);
+
+/**
+ * @brief  主站：把从站加入轮询列表
+ * @param  huart: UART句柄指针
+ * @param  addr: 从站地址
+ * @retval true: 添加成功, false: 添加失败
+ */
+bool comm_rs485_add_slave(UART_HandleTypeDef *huart, uint8_t addr);
+
+/**
+ * @brief  主站：启动轮询
+ * @param  huart: UART句柄指针
+ * @param  interval_ms: 上一次轮询结束到下一次轮询的最小间隔
+ * @param  turnaround_ms: 从站应答时限，0使用COMM_RS485_DEFAULT_TURNAROUND_MS
+ * @retval true: 启动成功, false: 启动失败
+ * @note   应答时限需覆盖从站最长帧的传输时间
+ */
+bool comm_rs485_start_polling(UART_HandleTypeDef *huart, uint16_t interval_ms, uint16_t turnaround_ms);
+
+/**
+ * @brief  主站：停止轮询
+ * @param  huart: UART句柄指针
+ * @retval true: 停止成功, false: 未找到实例
+ */
+bool comm_rs485_stop_polling(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  主站：获取轮询无应答次数
+ * @param  huart: UART句柄指针
+ * @retval 无应答次数
+ */
+uint32_t comm_rs485_get_poll_timeouts(UART_HandleTypeDef *huart);
+
+/* =============================================================================
+ * 发送API
+ * =============================================================================
+ */
+
+/**
+ * @brief  向指定节点发送命令
+ * @param  huart: UART句柄指针
+ * @param  dst: 目标地址，COMM_RS485_BROADCAST_ADDR为广播（无确认，仅主站）
+ * @param  cmd: 命令字符串
+ * @param  data: 数据字符串
+ * @retval true: 发送成功（从站为已排队）, false: 发送失败
+ * @note   之后的comm_send_command()继续发往该节点
+ */
+bool comm_send_command_to(UART_HandleTypeDef *huart, uint8_t dst, const char *cmd, const char *data);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  发送前占用总线（拉高DE）
+ * @param  instance: 实例指针
+ * @retval None
+ */
+void comm_rs485_tx_begin(comm_instance_t *instance);
+
+/**
+ * @brief  发送完成后释放总线（拉低DE）
+ * @param  instance: 实例指针
+ * @retval None
+ * @note   必须在TC之后调用，可在中断中调用
+ */
+void comm_rs485_tx_end(comm_instance_t *instance);
+
+/**
+ * @brief  从站推迟发送，等待被轮询
+ * @param  instance: 实例指针
+ * @retval true: 已推迟（帧保留在tx_buffer中）, false: 不需要推迟
+ */
+bool comm_rs485_defer_tx(comm_instance_t *instance);
+
+/**
+ * @brief  接收中断中判断帧是否发给本节点
+ * @param  instance: 实例指针
+ * @param  frame: 已通过CRC的帧
+ * @retval true: 接收, false: 丢弃
+ */
+bool comm_rs485_accept_frame(const comm_instance_t *instance, const comm_frame_t *frame);
+
+/**
+ * @brief  切换发送目标，同时换入该节点的发送序列号
+ * @param  instance: 实例指针
+ * @param  dst: 目标节点地址
+ * @retval None
+ * @note   只能在实例就绪时调用，否则会打乱正在等待ACK的序列号
+ */
+void comm_rs485_select_tx_peer(comm_instance_t *instance, uint8_t dst);
+
+/**
+ * @brief  切换到帧源节点的接收序列号
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @retval None
+ */
+void comm_rs485_select_rx_peer(comm_instance_t *instance, const comm_frame_t *frame);
+
+/**
+ * @brief  判断帧是否来自当前发送目标（用于ACK/NAK匹配）
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @retval true: 来自当前目标或非寻址帧, false: 来自其他节点
+ */
+bool comm_rs485_is_from_tx_peer(const comm_instance_t *instance, const comm_frame_t *frame);
+
+/**
+ * @brief  处理轮询相关帧（POLL/PRDY）并更新主站轮询状态
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @retval true: 已作为轮询帧处理, false: 继续按普通帧处理
+ */
+bool comm_rs485_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+/**
+ * @brief  主站轮询调度
+ * @param  instance: 实例指针
+ * @retval None
+ * @note   由comm_tick()调用
+ */
+void comm_rs485_process(comm_instance_t *instance);
+
+#endif /* COMM_ENABLE_RS485 */
+
+#endif /* COMM_RS485_H */
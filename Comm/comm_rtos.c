@@ -0,0 +1,357 @@
+/**
+ * @file    comm_rtos.c
+ * @brief   通信库FreeRTOS运行时 - 通信任务、中断任务通知、发送请求队列、按期限休眠
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_rtos.h"
+
+#if COMM_ENABLE_RTOS
+
+#include "comm.h"
+#include "comm_manager.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include <string.h>
+
+/* 发送请求 */
+typedef struct {
+    UART_HandleTypeDef *huart;              /**< 目标UART */
+    TaskHandle_t waiter;                    /**< 等待结果的任务，NULL表示异步发送 */
+    TickType_t deadline;                    /**< 期限（节拍） */
+    uint8_t id;                             /**< 请求编号，等待方据此丢弃迟到的旧结果 */
+    char cmd[COMM_MAX_CMD_LENGTH];          /**< 命令 */
+    char data[COMM_MAX_DATA_LENGTH];        /**< 数据 */
+} comm_rtos_request_t;
+
+/* 每个实例的请求状态 */
+typedef struct {
+    comm_rtos_request_t pending;            /**< 等待实例空闲的请求 */
+    bool has_pending;                       /**< pending有效 */
+
+    bool active;                            /**< 已发出的请求尚未结算 */
+    bool done;                              /**< 已发出的请求已结束，等待结算 */
+    bool failed;                            /**< 已发出的请求未收到ACK就放弃 */
+    comm_seq_t sequence;                    /**< 已发出请求的序列号 */
+    TaskHandle_t waiter;                    /**< 已发出请求的等待任务 */
+    TickType_t deadline;                    /**< 已发出请求的期限 */
+    uint8_t id;                             /**< 已发出请求的编号 */
+} comm_rtos_slot_t;
+
+typedef struct {
+    TaskHandle_t task;                      /**< 通信任务 */
+    QueueHandle_t queue;                    /**< 发送请求队列 */
+    comm_rtos_slot_t slots[COMM_MAX_INSTANCES];
+    uint8_t next_id;                        /**< 下一个请求编号 */
+
+    StaticTask_t task_tcb;
+    StackType_t task_stack[COMM_RTOS_STACK_WORDS];
+    StaticQueue_t queue_cb;
+    uint8_t queue_storage[COMM_RTOS_QUEUE_LENGTH * sizeof(comm_rtos_request_t)];
+} comm_rtos_t;
+
+static comm_rtos_t g_comm_rtos = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+static void comm_rtos_task(void *argument);
+static bool comm_rtos_enqueue(comm_rtos_request_t *request, UART_HandleTypeDef *huart,
+                              const char *cmd, const char *data, TickType_t wait);
+static void comm_rtos_collect(void);
+static void comm_rtos_service(void);
+static void comm_rtos_finish(TaskHandle_t waiter, uint8_t id, TickType_t deadline,
+                             comm_rtos_result_t result);
+static TickType_t comm_rtos_next_wait(void);
+static bool comm_rtos_expired(TickType_t deadline, TickType_t now);
+
+/* =============================================================================
+ * RTOS运行时API实现
+ * =============================================================================
+ */
+
+bool comm_rtos_start(void)
+{
+    if (g_comm_rtos.task != NULL) {
+        return false;
+    }
+
+    g_comm_rtos.queue = xQueueCreateStatic(COMM_RTOS_QUEUE_LENGTH, sizeof(comm_rtos_request_t),
+                                           g_comm_rtos.queue_storage, &g_comm_rtos.queue_cb);
+    if (g_comm_rtos.queue == NULL) {
+        return false;
+    }
+
+    g_comm_rtos.task = xTaskCreateStatic(comm_rtos_task, "comm", COMM_RTOS_STACK_WORDS, NULL,
+                                         COMM_RTOS_TASK_PRIORITY, g_comm_rtos.task_stack,
+                                         &g_comm_rtos.task_tcb);
+    return g_comm_rtos.task != NULL;
+}
+
+bool comm_rtos_send(UART_HandleTypeDef *huart, const char *cmd, const char *data, uint32_t timeout_ms)
+{
+    comm_rtos_request_t request;
+    request.waiter = NULL;
+    request.deadline = xTaskGetTickCount() + pdMS_TO_TICKS(COMM_RTOS_REQUEST_TTL_MS);
+
+    return comm_rtos_enqueue(&request, huart, cmd, data, pdMS_TO_TICKS(timeout_ms));
+}
+
+comm_rtos_result_t comm_rtos_send_wait(UART_HandleTypeDef *huart, const char *cmd, const char *data,
+                                       uint32_t timeout_ms)
+{
+    // 通信任务自己等待会死锁
+    if (xTaskGetCurrentTaskHandle() == g_comm_rtos.task) {
+        return COMM_RTOS_REJECTED;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    TickType_t ticks = pdMS_TO_TICKS(timeout_ms);
+
+    comm_rtos_request_t request;
+    request.waiter = xTaskGetCurrentTaskHandle();
+    request.deadline = start + ticks;
+    if (!comm_rtos_enqueue(&request, huart, cmd, data, ticks)) {
+        return COMM_RTOS_REJECTED;
+    }
+
+    for (;;) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        uint32_t value;
+        if (elapsed >= ticks || xTaskNotifyWait(0, UINT32_MAX, &value, ticks - elapsed) == pdFALSE) {
+            return COMM_RTOS_TIMEOUT;
+        }
+
+        // 之前超时放弃的请求迟到的结果，继续等待本次的
+        if ((uint8_t)(value >> 8) == request.id) {
+            return (comm_rtos_result_t)(value & 0xFF);
+        }
+    }
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_rtos_notify_from_isr(void)
+{
+    if (g_comm_rtos.task == NULL) {
+        return;
+    }
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(g_comm_rtos.task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void comm_rtos_on_send_done(comm_instance_t *instance, comm_seq_t sequence, bool acked)
+{
+    int8_t index = comm_manager_instance_index(instance);
+    if (index < 0) {
+        return;
+    }
+
+    comm_rtos_slot_t *slot = &g_comm_rtos.slots[index];
+    if (slot->active && sequence == slot->sequence) {
+        slot->done = true;
+        slot->failed = !acked;
+    }
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  通信任务：等待中断通知或最近的期限，然后处理所有实例
+ */
+static void comm_rtos_task(void *argument)
+{
+    (void)argument;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, comm_rtos_next_wait());
+
+        comm_tick();
+
+        // 发出请求后再取一次，空出来的位置马上补上
+        comm_rtos_collect();
+        comm_rtos_service();
+        comm_rtos_collect();
+    }
+}
+
+/**
+ * @brief  检查参数、分配请求编号并放入队列，成功后唤醒通信任务
+ */
+static bool comm_rtos_enqueue(comm_rtos_request_t *request, UART_HandleTypeDef *huart,
+                              const char *cmd, const char *data, TickType_t wait)
+{
+    if (g_comm_rtos.task == NULL || cmd == NULL || data == NULL ||
+        comm_manager_instance_index(comm_find_instance(huart)) < 0 ||
+        strlen(cmd) >= COMM_MAX_CMD_LENGTH || strlen(data) >= COMM_MAX_DATA_LENGTH) {
+        return false;
+    }
+
+    request->huart = huart;
+    strcpy(request->cmd, cmd);
+    strcpy(request->data, data);
+
+    taskENTER_CRITICAL();
+    request->id = ++g_comm_rtos.next_id;
+    taskEXIT_CRITICAL();
+
+    if (xQueueSend(g_comm_rtos.queue, request, wait) != pdTRUE) {
+        return false;
+    }
+
+    xTaskNotifyGive(g_comm_rtos.task);
+    return true;
+}
+
+/**
+ * @brief  按顺序把队列中的请求取到各实例的等待位置
+ * @note   队头请求的实例已有等待的请求时停止，保证同一实例的请求按提交顺序发送
+ */
+static void comm_rtos_collect(void)
+{
+    comm_rtos_request_t request;
+
+    while (xQueuePeek(g_comm_rtos.queue, &request, 0) == pdTRUE) {
+        int8_t index = comm_manager_instance_index(comm_find_instance(request.huart));
+        comm_rtos_slot_t *slot = &g_comm_rtos.slots[index];
+        if (slot->has_pending) {
+            break;
+        }
+
+        xQueueReceive(g_comm_rtos.queue, &slot->pending, 0);
+        slot->has_pending = true;
+    }
+}
+
+/**
+ * @brief  结束已完成的请求，实例空闲时发出等待的请求，丢弃过期的请求
+ */
+static void comm_rtos_service(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    uint8_t count = comm_get_instance_count();
+
+    for (uint8_t i = 0; i < count; i++) {
+        comm_instance_t *instance = comm_get_instance_by_index(i);
+        comm_rtos_slot_t *slot = &g_comm_rtos.slots[i];
+
+        if (slot->active && slot->done) {
+            slot->active = false;
+            comm_rtos_finish(slot->waiter, slot->id, slot->deadline,
+                             slot->failed ? COMM_RTOS_FAILED : COMM_RTOS_OK);
+        }
+
+        if (!slot->has_pending) {
+            continue;
+        }
+
+        comm_rtos_request_t *request = &slot->pending;
+        if (comm_rtos_expired(request->deadline, now)) {
+            // 阻塞发送的调用方已自行超时返回
+            slot->has_pending = false;
+            if (request->waiter == NULL) {
+                comm_call_fail_callback(instance, request->cmd, request->data, "发送期限已过");
+            }
+            continue;
+        }
+
+        if (!comm_instance_is_ready(instance)) {
+            continue;
+        }
+
+        slot->has_pending = false;
+        if (!comm_send_command(instance->huart, request->cmd, request->data)) {
+            if (request->waiter == NULL) {
+                comm_call_fail_callback(instance, request->cmd, request->data, "发送失败");
+            }
+            comm_rtos_finish(request->waiter, request->id, request->deadline, COMM_RTOS_FAILED);
+            continue;
+        }
+
+        slot->active = true;
+        slot->done = false;
+        slot->failed = false;
+        slot->sequence = instance->current_sequence;
+        slot->waiter = request->waiter;
+        slot->deadline = request->deadline;
+        slot->id = request->id;
+    }
+}
+
+/**
+ * @brief  把结果通知给等待的任务（异步请求和已超时返回的请求不通知）
+ */
+static void comm_rtos_finish(TaskHandle_t waiter, uint8_t id, TickType_t deadline,
+                             comm_rtos_result_t result)
+{
+    if (waiter == NULL || comm_rtos_expired(deadline, xTaskGetTickCount())) {
+        return;
+    }
+
+    xTaskNotify(waiter, ((uint32_t)id << 8) | (uint32_t)result, eSetValueWithOverwrite);
+}
+
+/**
+ * @brief  计算通信任务的休眠时间：最近的ACK超时、帧超时、请求期限，最长COMM_RTOS_IDLE_MS
+ * @note   帧的第一个字节不唤醒任务，帧超时最多晚COMM_RTOS_IDLE_MS发现
+ */
+static TickType_t comm_rtos_next_wait(void)
+{
+    uint32_t now = HAL_GetTick();
+    uint32_t wait_ms = COMM_RTOS_IDLE_MS;
+    uint8_t count = comm_get_instance_count();
+
+    for (uint8_t i = 0; i < count; i++) {
+        comm_instance_t *instance = comm_get_instance_by_index(i);
+
+        // 休眠前刚收完的帧
+        if (instance->rx_consumed != instance->rx_produced) {
+            return 0;
+        }
+
+        int32_t remaining = (int32_t)wait_ms;
+        if (instance->state == COMM_STATE_WAIT_ACK) {
+            int32_t ack = (int32_t)(instance->last_send_time + instance->timeout_ms - now);
+            remaining = (ack < remaining) ? ack : remaining;
+        }
+        if (instance->parse_state != FRAME_STATE_IDLE) {
+            int32_t frame = (int32_t)(instance->frame_timeout - now);
+            remaining = (frame < remaining) ? frame : remaining;
+        }
+        wait_ms = (remaining > 0) ? (uint32_t)remaining : 0;
+    }
+
+    TickType_t wait = pdMS_TO_TICKS(wait_ms);
+    TickType_t tick_now = xTaskGetTickCount();
+    for (uint8_t i = 0; i < count; i++) {
+        const comm_rtos_slot_t *slot = &g_comm_rtos.slots[i];
+        if (!slot->has_pending) {
+            continue;
+        }
+
+        TickType_t left = comm_rtos_expired(slot->pending.deadline, tick_now)
+                        ? 0 : (TickType_t)(slot->pending.deadline - tick_now);
+        wait = (left < wait) ? left : wait;
+    }
+
+    return wait;
+}
+
+/**
+ * @brief  判断节拍期限是否已过（考虑计数回绕）
+ */
+static bool comm_rtos_expired(TickType_t deadline, TickType_t now)
+{
+    return (TickType_t)(now - deadline) < (TickType_t)(portMAX_DELAY / 2);
+}
+
+#endif /* COMM_ENABLE_RTOS */
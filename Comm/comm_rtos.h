@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ * @file           : comm_rtos.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信FreeRTOS运行时
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * RTOS运行时 - 在FreeRTOS中使用通信库，应用任务可以安全地发送命令并阻塞等待结果
+ *
+ * 裸机方式下comm_tick()在1ms定时器中断中调用，实例状态只在中断和主循环之间共享，
+ * 没有任何锁。启用后改为由一个通信任务独占所有实例：
+ *   - 通信任务代替定时器中断调用comm_tick()，命令回调、失败回调都在通信任务中执行
+ *   - 接收中断收完一帧、发送完成中断时用任务通知唤醒通信任务，不必轮询
+ *   - 没有事件时按最近的期限休眠（ACK超时、帧超时、请求期限），最长COMM_RTOS_IDLE_MS
+ *   - 其它任务通过请求队列发送命令，由通信任务在实例空闲时发出
+ *
+ * 发送方式:
+ *   - comm_rtos_send()      - 放入队列立即返回，结果通过原有的失败回调通知
+ *   - comm_rtos_send_wait() - 阻塞到收到ACK、重试失败或超过期限，期间调用任务让出CPU
+ *
+ * 注意：
+ *   - 启用后不要再在定时器中断中调用comm_tick()
+ *   - 其它任务只能调用comm_rtos_send()/comm_rtos_send_wait()，库的其它API
+ *     只能在comm_rtos_start()之前或在回调中（即通信任务内）调用
+ *   - 使用静态分配创建任务和队列，需要configSUPPORT_STATIC_ALLOCATION为1
+ *   - 接收中断优先级不能高于configMAX_SYSCALL_INTERRUPT_PRIORITY
+ *
+ * 使用示例:
+ *   comm_init();
+ *   comm_add_uart(&huart2);
+ *   comm_rtos_start();
+ *   vTaskStartScheduler();
+ *
+ *   // 任意任务中
+ *   if (comm_rtos_send_wait(&huart2, "SET", "LED=1", 500) != COMM_RTOS_OK) { ... }
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_RTOS_H
+#define COMM_RTOS_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_RTOS
+
+/** @brief 阻塞发送结果 */
+typedef enum {
+    COMM_RTOS_OK = 0,                       /**< 已收到ACK */
+    COMM_RTOS_FAILED,                       /**< 重试失败或链路断开 */
+    COMM_RTOS_TIMEOUT,                      /**< 超过期限仍未完成 */
+    COMM_RTOS_REJECTED                      /**< 参数错误、队列已满或运行时未启动 */
+} comm_rtos_result_t;
+
+/* =============================================================================
+ * RTOS运行时API
+ * =============================================================================
+ */
+
+/**
+ * @brief  创建通信任务和请求队列
+ * @param  None
+ * @retval true: 创建成功, false: 已经启动过或创建失败
+ * @note   在comm_init()、comm_add_uart()之后、vTaskStartScheduler()之前调用
+ */
+bool comm_rtos_start(void);
+
+/**
+ * @brief  从任意任务发送命令（异步）
+ * @param  huart: UART句柄指针
+ * @param  cmd: 命令字符串
+ * @param  data: 数据字符串
+ * @param  timeout_ms: 队列已满时最长等待时间（毫秒），0表示不等待
+ * @retval true: 已放入队列, false: 参数错误、队列已满或运行时未启动
+ * @note   实例忙时请求在队列中等待，超过COMM_RTOS_REQUEST_TTL_MS仍未发出按失败回调通知
+ */
+bool comm_rtos_send(UART_HandleTypeDef *huart, const char *cmd, const char *data, uint32_t timeout_ms);
+
+/**
+ * @brief  从任意任务发送命令并等待结果
+ * @param  huart: UART句柄指针
+ * @param  cmd: 命令字符串
+ * @param  data: 数据字符串
+ * @param  timeout_ms: 期限（毫秒），包括排队、发送和全部重试
+ * @retval 发送结果
+ * @note   结果通过调用任务的任务通知（默认索引）返回，调用任务不要再把它用于其它用途；
+ *         不能在通信任务（即库的回调）中调用；超过期限时已发出的命令仍会继续重试
+ */
+comm_rtos_result_t comm_rtos_send_wait(UART_HandleTypeDef *huart, const char *cmd, const char *data,
+                                       uint32_t timeout_ms);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  从中断唤醒通信任务
+ * @param  None
+ * @retval None
+ * @note   由comm_uart_rx_callback()（收完一帧）和comm_uart_tx_callback()调用
+ */
+void comm_rtos_notify_from_isr(void);
+
+/**
+ * @brief  命令发送结束，结束的是已发出的请求时记录结果
+ * @param  instance: 实例指针
+ * @param  sequence: 结束的命令的序列号
+ * @param  acked: 是否收到ACK
+ * @retval None
+ * @note   由comm_call_send_done()调用
+ */
+void comm_rtos_on_send_done(comm_instance_t *instance, comm_seq_t sequence, bool acked);
+
+#endif /* COMM_ENABLE_RTOS */
+
+#endif /* COMM_RTOS_H */
@@ -0,0 +1,186 @@
+/**
+ * @file    comm_session.c
+ * @brief   通信库会话层 - 会话纪元、启动通告、序列号对齐、对端重启检测
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_session.h"
+
+#if COMM_ENABLE_SESSION
+
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#if COMM_ENABLE_CREDITS
+#include "comm_credit.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 通告数据的类型字符 */
+#define COMM_SESSION_OP_HELLO       'H'
+#define COMM_SESSION_OP_ACK         'A'
+
+/* Private function prototypes -----------------------------------------------*/
+static comm_seq_t comm_session_next_seq(const comm_instance_t *instance);
+static void comm_session_peer_restarted(comm_instance_t *instance);
+
+/* =============================================================================
+ * 会话API实现
+ * =============================================================================
+ */
+
+bool comm_session_hello(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    if (instance == NULL) {
+        return false;
+    }
+
+    return comm_session_announce(instance, false);
+}
+
+uint16_t comm_session_get_epoch(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    return (instance != NULL) ? instance->session.local_epoch : 0;
+}
+
+uint16_t comm_session_get_peer_epoch(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    return (instance != NULL) ? instance->session.peer_epoch : 0;
+}
+
+uint32_t comm_session_get_peer_restarts(UART_HandleTypeDef *huart)
+{
+    comm_instance_t *instance = comm_find_instance(huart);
+    return (instance != NULL) ? instance->session.peer_restarts : 0;
+}
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_session_init(comm_instance_t *instance)
+{
+    comm_session_t *session = &instance->session;
+    memset(session, 0, sizeof(comm_session_t));
+
+    session->local_epoch = COMM_SESSION_EPOCH();
+    if (session->local_epoch == 0) {
+        session->local_epoch = 1;
+    }
+
+    // 第一次comm_tick()时立即通告
+    session->hello_left = COMM_SESSION_HELLO_COUNT;
+    session->last_hello = HAL_GetTick() - COMM_SESSION_HELLO_MS;
+}
+
+bool comm_session_announce(comm_instance_t *instance, bool reply)
+{
+    char data[16];
+    snprintf(data, sizeof(data), "%c,%04X,%0*X",
+             reply ? COMM_SESSION_OP_ACK : COMM_SESSION_OP_HELLO,
+             instance->session.local_epoch, COMM_SEQ_DIGITS, comm_session_next_seq(instance));
+
+    return comm_send_datagram(instance, COMM_CMD_SESSION, data);
+}
+
+bool comm_session_handle_frame(comm_instance_t *instance, const comm_frame_t *frame)
+{
+    if (!comm_frame_cmd_is(instance, frame, COMM_CMD_SESSION)) {
+        return false;
+    }
+
+    // 数据格式: OP,EPOCH,SEQ
+    const char *data = COMM_FRAME_DATA(instance, frame);
+    char *end;
+    uint16_t epoch = (frame->data_len > 2) ? (uint16_t)strtoul(&data[2], &end, 16) : 0;
+    if (epoch == 0 || data[1] != ',' || *end != ',' ||
+        (data[0] != COMM_SESSION_OP_HELLO && data[0] != COMM_SESSION_OP_ACK)) {
+        COMM_DEBUG_INSTANCE(instance, "会话通告格式错误: %s", data);
+        return true;
+    }
+    comm_seq_t next = (comm_seq_t)strtoul(end + 1, NULL, 16);
+
+    comm_session_t *session = &instance->session;
+    bool restarted = (session->peer_epoch != 0 && epoch != session->peer_epoch);
+    session->peer_epoch = epoch;
+    if (restarted) {
+        comm_session_peer_restarted(instance);
+    }
+
+    // next已在窗口内（或正是刚收到的帧）时不动，保留重复帧检测；
+    // 窗口外或对端重启过才对齐，对齐后next正好是"递增1"
+    comm_seq_t diff = (comm_seq_t)(next - instance->rx_sequence);
+    if (restarted || diff > COMM_SEQ_ACCEPT_WINDOW) {
+        COMM_DEBUG_INSTANCE(instance, "接收序列号对齐: %d -> %d", instance->rx_sequence, next - 1);
+        instance->rx_sequence = (comm_seq_t)(next - 1);
+        session->realigns++;
+    }
+
+    if (data[0] == COMM_SESSION_OP_HELLO) {
+        comm_session_announce(instance, true);
+    }
+
+    return true;
+}
+
+void comm_session_process(comm_instance_t *instance)
+{
+    comm_session_t *session = &instance->session;
+    if (session->peer_epoch != 0 || session->hello_left == 0) {
+        return;
+    }
+
+    if (HAL_GetTick() - session->last_hello < COMM_SESSION_HELLO_MS) {
+        return;
+    }
+
+    // 发送失败（链路忙）时下一次comm_tick()再试
+    if (comm_session_announce(instance, false)) {
+        session->last_hello = HAL_GetTick();
+        session->hello_left--;
+    }
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+/**
+ * @brief  对端应接受的下一个序列号（正在发送的命令重发时沿用原序列号）
+ */
+static comm_seq_t comm_session_next_seq(const comm_instance_t *instance)
+{
+    if (instance->state != COMM_STATE_IDLE) {
+        return instance->current_sequence;
+    }
+
+    comm_seq_t next = (comm_seq_t)(instance->tx_sequence + 1);
+    return (next == 0) ? 1 : next;
+}
+
+/**
+ * @brief  对端重启：之前通告的压缩能力和额度都已失效
+ */
+static void comm_session_peer_restarted(comm_instance_t *instance)
+{
+    instance->session.peer_restarts++;
+    COMM_DEBUG_INSTANCE(instance, "对端已重启: 纪元 %04X", instance->session.peer_epoch);
+
+#if COMM_ENABLE_COMPRESS
+    instance->compress.peer_supported = false;
+#endif
+
+#if COMM_ENABLE_CREDITS
+    comm_credit_init(instance);
+#endif
+}
+
+#endif /* COMM_ENABLE_SESSION */
@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ * @file           : comm_session.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信会话握手与16位序列号
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 会话 - 对端重启或连续丢帧超过接受窗口后，不再持续收到SEQ_ERROR
+ *
+ * 启用后序列号扩展为16位（帧中4个十六进制字符: {CMD:DATA#0001#CRC}），
+ * 接受窗口由COMM_SEQ_ACCEPT_WINDOW配置，可以远大于8位序列号时的10。
+ *
+ * 握手（数据报）:
+ *   - 上电后发送 {SES:H,EPOCH,SEQ#00#CRC}，直到收到对端的通告（最多COMM_SESSION_HELLO_COUNT次）
+ *   - 对端应答 {SES:A,EPOCH,SEQ#00#CRC}
+ *   - EPOCH为本端会话纪元（每次上电不同），SEQ为对端应接受的下一个序列号
+ *   - 收到通告的一方把接收序列号对齐到SEQ；EPOCH变化说明对端重启过
+ *
+ * 失步恢复: 接收方对窗口外的序列号回复 {NAK:SSSS,SEQ_ERROR#00#CRC}，
+ * 发送方先重新通告再重发，一个往返后即恢复，而不是重试到失败。
+ *
+ * 注意：
+ *   - 通信双方必须都启用（帧中序列号位数不同）
+ *   - 检测到对端重启时清除对端的压缩能力和流控额度，等待对端重新通告
+ *   - 启用RS-485寻址时序列号对齐按源节点进行，会话纪元只记录最近一个对端
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_SESSION_H
+#define COMM_SESSION_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_SESSION
+
+/* =============================================================================
+ * 会话API
+ * =============================================================================
+ */
+
+/**
+ * @brief  重新发送会话通告
+ * @param  huart: UART句柄指针
+ * @retval true: 已发送, false: 发送失败
+ * @note   一般不需要调用，上电和失步时库会自动通告
+ */
+bool comm_session_hello(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取本端会话纪元
+ * @param  huart: UART句柄指针
+ * @retval 会话纪元，未找到实例返回0
+ */
+uint16_t comm_session_get_epoch(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取对端会话纪元
+ * @param  huart: UART句柄指针
+ * @retval 会话纪元，尚未握手返回0
+ */
+uint16_t comm_session_get_peer_epoch(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取检测到对端重启的次数
+ * @param  huart: UART句柄指针
+ * @retval 重启次数
+ */
+uint32_t comm_session_get_peer_restarts(UART_HandleTypeDef *huart);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  初始化会话状态，生成本端会话纪元
+ * @param  instance: 实例指针
+ * @retval None
+ */
+void comm_session_init(comm_instance_t *instance);
+
+/**
+ * @brief  发送会话通告
+ * @param  instance: 实例指针
+ * @param  reply: true: 应答对端通告, false: 主动通告
+ * @retval true: 已发送, false: 发送失败
+ */
+bool comm_session_announce(comm_instance_t *instance, bool reply);
+
+/**
+ * @brief  处理会话通告帧
+ * @param  instance: 实例指针
+ * @param  frame: 接收帧指针
+ * @retval true: 已处理, false: 不是会话帧
+ */
+bool comm_session_handle_frame(comm_instance_t *instance, const comm_frame_t *frame);
+
+/**
+ * @brief  启动阶段重发会话通告
+ * @param  instance: 实例指针
+ * @retval None
+ * @note   由comm_tick()调用
+ */
+void comm_session_process(comm_instance_t *instance);
+
+#endif /* COMM_ENABLE_SESSION */
+
+#endif /* COMM_SESSION_H */
@@ -0,0 +1,619 @@
+/**
+ * @file    comm_store.c
+ * @brief   通信库持久化发送队列 - 记录追加、扫描恢复、按顺序补发、送达标记
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ */
+
+#include "comm_store.h"
+
+#if COMM_ENABLE_STORE
+
+#include "comm.h"
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#if COMM_ENABLE_BATCH
+#include "comm_batch.h"
+#endif
+#include <string.h>
+
+/* 记录头部字段 */
+#define COMM_STORE_MAGIC            0xA5
+#define COMM_STORE_POS_MAGIC        8
+#define COMM_STORE_POS_LENGTH       9
+#define COMM_STORE_POS_CRC          10
+#define COMM_STORE_POS_ID           12
+
+/* 每个扇区的记录数 */
+#define COMM_STORE_SLOTS_PER_SECTOR (COMM_STORE_SECTOR_SIZE / COMM_STORE_RECORD_SIZE)
+
+/* 每帧最多补发的消息数 */
+#if COMM_ENABLE_BATCH
+#define COMM_STORE_FRAME_MAX        COMM_STORE_BATCH_MAX
+#else
+#define COMM_STORE_FRAME_MAX        1
+#endif
+
+/* 记录状态 */
+typedef enum {
+    COMM_STORE_RECORD_EMPTY = 0,            /**< 已擦除 */
+    COMM_STORE_RECORD_PENDING,              /**< 未送达 */
+    COMM_STORE_RECORD_DONE,                 /**< 已送达 */
+    COMM_STORE_RECORD_INVALID               /**< 写入中途掉电等原因损坏 */
+} comm_store_record_state_t;
+
+typedef struct {
+    bool is_used;                           /**< 是否已使用 */
+    uint8_t index;                          /**< 管理器实例表中的序号 */
+    const comm_store_ops_t *ops;            /**< 存储访问接口 */
+    void *ctx;                              /**< 存储访问上下文 */
+    uint16_t slot_count;                    /**< 记录总数 */
+    uint16_t head;                          /**< 最早未送达的记录 */
+    uint16_t tail;                          /**< 下一条记录的写入位置 */
+    uint32_t next_id;                       /**< 下一条记录的记录号 */
+
+    bool busy;                              /**< 有消息正在补发或尚未结算 */
+    bool done;                              /**< 补发帧已结束，等待结算 */
+    bool failed;                            /**< 补发帧未收到ACK就放弃 */
+    bool paused;                            /**< 补发失败后暂停 */
+    uint32_t paused_time;                   /**< 暂停的时刻 */
+    comm_seq_t sequence;                    /**< 补发帧的序列号 */
+    uint8_t in_flight;                      /**< 补发帧中的消息数 */
+    uint16_t in_flight_slots[COMM_STORE_FRAME_MAX]; /**< 补发帧中各消息所在的记录 */
+    uint16_t next_head;                     /**< 补发帧送达后的head */
+
+    comm_store_stats_t stats;               /**< 统计 */
+} comm_store_queue_t;
+
+static comm_store_queue_t g_comm_store_queues[COMM_STORE_MAX_QUEUES] = {0};
+
+static const uint8_t g_store_done_mark[8] = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+static comm_store_queue_t* comm_store_find(comm_instance_t *instance);
+static comm_store_queue_t* comm_store_find_by_huart(UART_HandleTypeDef *huart);
+static uint32_t comm_store_offset(uint16_t slot);
+static uint16_t comm_store_next_slot(const comm_store_queue_t *queue, uint16_t slot);
+static uint8_t comm_store_record_crc(const uint8_t *record);
+static comm_store_record_state_t comm_store_read_record(comm_store_queue_t *queue, uint16_t slot,
+                                                        uint8_t *record, uint32_t *id);
+static void comm_store_scan(comm_store_queue_t *queue);
+static bool comm_store_prepare_tail(comm_store_queue_t *queue);
+static void comm_store_settle(comm_store_queue_t *queue, uint32_t now);
+static void comm_store_drain(comm_store_queue_t *queue, comm_instance_t *instance, uint32_t now);
+
+/* =============================================================================
+ * 持久化队列API实现
+ * =============================================================================
+ */
+
+bool comm_store_attach(UART_HandleTypeDef *huart, const comm_store_ops_t *ops, void *ctx, uint32_t size)
+{
+    if (ops == NULL || ops->read == NULL || ops->write == NULL || ops->erase == NULL) {
+        return false;
+    }
+
+    uint32_t sectors = size / COMM_STORE_SECTOR_SIZE;
+    if ((size % COMM_STORE_SECTOR_SIZE) != 0 || sectors < 2 ||
+        sectors * COMM_STORE_SLOTS_PER_SECTOR > UINT16_MAX) {
+        return false;
+    }
+
+    comm_instance_t *instance = comm_find_instance(huart);
+    int8_t index = comm_manager_instance_index(instance);
+    if (index < 0 || comm_store_find(instance) != NULL) {
+        return false;
+    }
+
+    comm_store_queue_t *queue = NULL;
+    for (uint8_t i = 0; i < COMM_STORE_MAX_QUEUES; i++) {
+        if (!g_comm_store_queues[i].is_used) {
+            queue = &g_comm_store_queues[i];
+            break;
+        }
+    }
+    if (queue == NULL) {
+        return false;
+    }
+
+    memset(queue, 0, sizeof(comm_store_queue_t));
+    queue->index = (uint8_t)index;
+    queue->ops = ops;
+    queue->ctx = ctx;
+    queue->slot_count = (uint16_t)(sectors * COMM_STORE_SLOTS_PER_SECTOR);
+    queue->stats.capacity = (uint16_t)((sectors - 1) * COMM_STORE_SLOTS_PER_SECTOR);
+
+    comm_store_scan(queue);
+    queue->is_used = true;
+
+    COMM_DEBUG_INSTANCE(instance, "持久化队列: %d条记录, 恢复%d条未送达消息",
+                        queue->slot_count, queue->stats.pending);
+    return true;
+}
+
+bool comm_store_detach(UART_HandleTypeDef *huart)
+{
+    comm_store_queue_t *queue = comm_store_find_by_huart(huart);
+    if (queue == NULL) {
+        return false;
+    }
+
+    queue->is_used = false;
+    return true;
+}
+
+bool comm_store_send(UART_HandleTypeDef *huart, const char *cmd, const char *data)
+{
+    comm_store_queue_t *queue = comm_store_find_by_huart(huart);
+    if (queue == NULL || cmd == NULL || data == NULL) {
+        return false;
+    }
+
+    // 和comm_send_command()同样的长度限制，保证补发时不会因参数被拒绝而堵住队列
+    size_t cmd_len = strlen(cmd);
+    size_t data_len = strlen(data);
+    if (cmd_len == 0 || cmd_len >= COMM_MAX_CMD_LENGTH || data_len >= COMM_MAX_DATA_LENGTH ||
+        strchr(cmd, COMM_CMD_DATA_SEPARATOR) != NULL) {
+        return false;
+    }
+
+    if (!comm_store_prepare_tail(queue)) {
+        queue->stats.rejected++;
+        return false;
+    }
+
+    uint8_t record[COMM_STORE_RECORD_SIZE];
+    memset(record, 0xFF, sizeof(record));
+    uint8_t *message = &record[COMM_STORE_HEADER_SIZE];
+    memcpy(message, cmd, cmd_len);
+    message[cmd_len] = COMM_CMD_DATA_SEPARATOR;
+    memcpy(message + cmd_len + 1, data, data_len);
+
+    uint32_t id = queue->next_id;
+    record[COMM_STORE_POS_MAGIC] = COMM_STORE_MAGIC;
+    record[COMM_STORE_POS_LENGTH] = (uint8_t)(cmd_len + 1 + data_len);
+    record[COMM_STORE_POS_ID] = (uint8_t)id;
+    record[COMM_STORE_POS_ID + 1] = (uint8_t)(id >> 8);
+    record[COMM_STORE_POS_ID + 2] = (uint8_t)(id >> 16);
+    record[COMM_STORE_POS_ID + 3] = (uint8_t)(id >> 24);
+    record[COMM_STORE_POS_CRC] = comm_store_record_crc(record);
+
+    // 送达标记保持擦除状态，只写头部和内容
+    uint16_t slot = queue->tail;
+    if (!queue->ops->write(queue->ctx, comm_store_offset(slot) + 8, &record[8], COMM_STORE_RECORD_SIZE - 8)) {
+        // 写坏的记录在扫描时按损坏跳过，不再使用这个位置
+        queue->tail = comm_store_next_slot(queue, slot);
+        queue->stats.rejected++;
+        return false;
+    }
+
+    queue->next_id++;
+    queue->tail = comm_store_next_slot(queue, slot);
+    if (queue->stats.pending == 0) {
+        queue->head = slot;
+    }
+    queue->stats.pending++;
+    queue->stats.stored++;
+    return true;
+}
+
+uint16_t comm_store_pending(UART_HandleTypeDef *huart)
+{
+    comm_store_queue_t *queue = comm_store_find_by_huart(huart);
+    return (queue != NULL) ? queue->stats.pending : 0;
+}
+
+bool comm_store_get_stats(UART_HandleTypeDef *huart, comm_store_stats_t *stats)
+{
+    comm_store_queue_t *queue = comm_store_find_by_huart(huart);
+    if (queue == NULL || stats == NULL) {
+        return false;
+    }
+
+    *stats = queue->stats;
+    return true;
+}
+
+/* =============================================================================
+ * RAM模拟存储
+ * =============================================================================
+ */
+
+static bool comm_store_ram_read(void *ctx, uint32_t offset, void *buffer, uint16_t length)
+{
+    comm_store_ram_t *ram = (comm_store_ram_t *)ctx;
+    if (ram == NULL || offset + length > ram->size) {
+        return false;
+    }
+
+    memcpy(buffer, &ram->memory[offset], length);
+    return true;
+}
+
+static bool comm_store_ram_write(void *ctx, uint32_t offset, const void *data, uint16_t length)
+{
+    comm_store_ram_t *ram = (comm_store_ram_t *)ctx;
+    if (ram == NULL || offset + length > ram->size) {
+        return false;
+    }
+
+    // 和Flash一样只能把1写为0
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (uint16_t i = 0; i < length; i++) {
+        ram->memory[offset + i] &= bytes[i];
+    }
+    return true;
+}
+
+static bool comm_store_ram_erase(void *ctx, uint32_t offset)
+{
+    comm_store_ram_t *ram = (comm_store_ram_t *)ctx;
+    uint32_t start = offset - (offset % COMM_STORE_SECTOR_SIZE);
+    if (ram == NULL || start + COMM_STORE_SECTOR_SIZE > ram->size) {
+        return false;
+    }
+
+    memset(&ram->memory[start], 0xFF, COMM_STORE_SECTOR_SIZE);
+    return true;
+}
+
+const comm_store_ops_t comm_store_ram_ops = {
+    comm_store_ram_read,
+    comm_store_ram_write,
+    comm_store_ram_erase
+};
+
+/* =============================================================================
+ * 内部接口实现
+ * =============================================================================
+ */
+
+void comm_store_init(void)
+{
+    memset(g_comm_store_queues, 0, sizeof(g_comm_store_queues));
+}
+
+void comm_store_process(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint8_t i = 0; i < COMM_STORE_MAX_QUEUES; i++) {
+        comm_store_queue_t *queue = &g_comm_store_queues[i];
+        if (!queue->is_used) {
+            continue;
+        }
+
+        comm_instance_t *instance = comm_get_instance_by_index(queue->index);
+        comm_store_settle(queue, now);
+        comm_store_drain(queue, instance, now);
+    }
+}
+
+void comm_store_on_send_done(comm_instance_t *instance, comm_seq_t sequence, bool acked)
+{
+    comm_store_queue_t *queue = comm_store_find(instance);
+    if (queue == NULL) {
+        return;
+    }
+
+    // 应用自己发送的命令与队列无关
+    if (queue->busy && sequence == queue->sequence) {
+        queue->done = true;
+        queue->failed = !acked;
+    }
+}
+
+/* =============================================================================
+ * 私有函数实现
+ * =============================================================================
+ */
+
+static comm_store_queue_t* comm_store_find(comm_instance_t *instance)
+{
+    int8_t index = comm_manager_instance_index(instance);
+    if (index < 0) {
+        return NULL;
+    }
+
+    for (uint8_t i = 0; i < COMM_STORE_MAX_QUEUES; i++) {
+        if (g_comm_store_queues[i].is_used && g_comm_store_queues[i].index == (uint8_t)index) {
+            return &g_comm_store_queues[i];
+        }
+    }
+    return NULL;
+}
+
+static comm_store_queue_t* comm_store_find_by_huart(UART_HandleTypeDef *huart)
+{
+    return comm_store_find(comm_find_instance(huart));
+}
+
+/**
+ * @brief  记录在存储区中的偏移，扇区末尾放不下一条记录的部分不使用
+ */
+static uint32_t comm_store_offset(uint16_t slot)
+{
+    return (uint32_t)(slot / COMM_STORE_SLOTS_PER_SECTOR) * COMM_STORE_SECTOR_SIZE +
+           (uint32_t)(slot % COMM_STORE_SLOTS_PER_SECTOR) * COMM_STORE_RECORD_SIZE;
+}
+
+static uint16_t comm_store_next_slot(const comm_store_queue_t *queue, uint16_t slot)
+{
+    return (uint16_t)((slot + 1u) % queue->slot_count);
+}
+
+/**
+ * @brief  头部（长度、记录号）和内容的CRC
+ */
+static uint8_t comm_store_record_crc(const uint8_t *record)
+{
+    uint8_t crc = comm_crc8_update(0, record[COMM_STORE_POS_LENGTH]);
+    for (uint8_t i = 0; i < 4; i++) {
+        crc = comm_crc8_update(crc, record[COMM_STORE_POS_ID + i]);
+    }
+    for (uint8_t i = 0; i < record[COMM_STORE_POS_LENGTH]; i++) {
+        crc = comm_crc8_update(crc, record[COMM_STORE_HEADER_SIZE + i]);
+    }
+    return crc;
+}
+
+/**
+ * @brief  读取一条记录并判断状态
+ * @param  record: 输出，COMM_STORE_RECORD_SIZE字节
+ * @param  id: 输出记录号（EMPTY/INVALID时无效）
+ */
+static comm_store_record_state_t comm_store_read_record(comm_store_queue_t *queue, uint16_t slot,
+                                                        uint8_t *record, uint32_t *id)
+{
+    if (!queue->ops->read(queue->ctx, comm_store_offset(slot), record, COMM_STORE_RECORD_SIZE)) {
+        return COMM_STORE_RECORD_INVALID;
+    }
+
+    bool erased = true;
+    for (uint8_t i = 0; i < COMM_STORE_HEADER_SIZE; i++) {
+        if (record[i] != 0xFF) {
+            erased = false;
+            break;
+        }
+    }
+    if (erased) {
+        return COMM_STORE_RECORD_EMPTY;
+    }
+
+    if (record[COMM_STORE_POS_MAGIC] != COMM_STORE_MAGIC ||
+        record[COMM_STORE_POS_LENGTH] > COMM_STORE_MAX_MESSAGE ||
+        record[COMM_STORE_POS_CRC] != comm_store_record_crc(record)) {
+        return COMM_STORE_RECORD_INVALID;
+    }
+
+    *id = (uint32_t)record[COMM_STORE_POS_ID] |
+          ((uint32_t)record[COMM_STORE_POS_ID + 1] << 8) |
+          ((uint32_t)record[COMM_STORE_POS_ID + 2] << 16) |
+          ((uint32_t)record[COMM_STORE_POS_ID + 3] << 24);
+
+    // 送达标记只要有一位被写过就算已送达，写标记时掉电也不会重复补发太多
+    for (uint8_t i = 0; i < sizeof(g_store_done_mark); i++) {
+        if (record[i] != 0xFF) {
+            return COMM_STORE_RECORD_DONE;
+        }
+    }
+    return COMM_STORE_RECORD_PENDING;
+}
+
+/**
+ * @brief  扫描存储，找出最早的未送达记录和写入位置
+ * @note   读取失败的记录按损坏处理
+ */
+static void comm_store_scan(comm_store_queue_t *queue)
+{
+    uint8_t record[COMM_STORE_RECORD_SIZE];
+    bool any = false;
+    uint32_t newest_id = 0;
+    uint16_t newest_slot = 0;
+    bool any_pending = false;
+    uint32_t oldest_id = 0;
+
+    for (uint16_t slot = 0; slot < queue->slot_count; slot++) {
+        uint32_t id = 0;
+        comm_store_record_state_t state = comm_store_read_record(queue, slot, record, &id);
+        if (state == COMM_STORE_RECORD_EMPTY || state == COMM_STORE_RECORD_INVALID) {
+            continue;
+        }
+
+        // 记录号只增不减，差值的符号即先后
+        if (!any || (int32_t)(id - newest_id) > 0) {
+            any = true;
+            newest_id = id;
+            newest_slot = slot;
+        }
+        if (state == COMM_STORE_RECORD_PENDING) {
+            if (!any_pending || (int32_t)(id - oldest_id) < 0) {
+                any_pending = true;
+                oldest_id = id;
+                queue->head = slot;
+            }
+            queue->stats.pending++;
+        }
+    }
+
+    queue->tail = any ? comm_store_next_slot(queue, newest_slot) : 0;
+    queue->next_id = any ? newest_id + 1 : 0;
+    if (!any_pending) {
+        queue->head = queue->tail;
+    }
+    queue->stats.recovered = queue->stats.pending;
+}
+
+/**
+ * @brief  确保tail指向可写入的空记录，进入新扇区时先擦除
+ * @retval true: 可以写入, false: 存储已满或擦除失败
+ */
+static bool comm_store_prepare_tail(comm_store_queue_t *queue)
+{
+    uint8_t record[COMM_STORE_RECORD_SIZE];
+
+    for (uint16_t attempts = 0; attempts < queue->slot_count; attempts++) {
+        uint16_t slot = queue->tail;
+
+        if ((slot % COMM_STORE_SLOTS_PER_SECTOR) == 0) {
+            // 未送达的消息还在这个扇区里，不能擦除
+            uint16_t sector = slot / COMM_STORE_SLOTS_PER_SECTOR;
+            if (queue->stats.pending > 0 && queue->head / COMM_STORE_SLOTS_PER_SECTOR == sector) {
+                return false;
+            }
+            if (!queue->ops->erase(queue->ctx, comm_store_offset(slot))) {
+                return false;
+            }
+            return true;
+        }
+
+        // 扇区中间的位置应当是空的，写入中途掉电留下的残缺记录跳过
+        uint32_t id;
+        if (comm_store_read_record(queue, slot, record, &id) == COMM_STORE_RECORD_EMPTY) {
+            return true;
+        }
+        if (queue->stats.pending > 0 && slot == queue->head) {
+            return false;
+        }
+        queue->tail = comm_store_next_slot(queue, slot);
+    }
+    return false;
+}
+
+/**
+ * @brief  补发帧结束后标记送达或暂停补发
+ */
+static void comm_store_settle(comm_store_queue_t *queue, uint32_t now)
+{
+    if (queue->paused && (now - queue->paused_time) >= COMM_STORE_RETRY_MS) {
+        queue->paused = false;
+    }
+
+    if (!queue->busy || !queue->done) {
+        return;
+    }
+
+    queue->busy = false;
+    if (queue->failed) {
+        queue->paused = true;
+        queue->paused_time = now;
+        queue->stats.failures++;
+        COMM_DEBUG_INSTANCE(comm_get_instance_by_index(queue->index),
+                            "补发失败，%d条消息保留在存储中", queue->stats.pending);
+        return;
+    }
+
+    for (uint8_t i = 0; i < queue->in_flight; i++) {
+        // 标记写入失败时重启后会再补发一次，不影响本次运行
+        queue->ops->write(queue->ctx, comm_store_offset(queue->in_flight_slots[i]),
+                          g_store_done_mark, sizeof(g_store_done_mark));
+    }
+    queue->stats.pending -= queue->in_flight;
+    queue->stats.delivered += queue->in_flight;
+    queue->head = (queue->stats.pending > 0) ? queue->next_head : queue->tail;
+}
+
+/**
+ * @brief  实例空闲时从最早的记录开始补发
+ */
+static void comm_store_drain(comm_store_queue_t *queue, comm_instance_t *instance, uint32_t now)
+{
+    if (queue->busy || queue->paused || queue->stats.pending == 0 || !comm_instance_is_ready(instance)) {
+        return;
+    }
+
+#if COMM_ENABLE_LINK
+    if (instance->link.state == COMM_LINK_DOWN) {
+        return;
+    }
+#endif
+
+    uint8_t record[COMM_STORE_RECORD_SIZE + 1];
+    uint16_t slot = queue->head;
+    uint8_t count = 0;
+    bool sent = false;
+#if COMM_ENABLE_BATCH
+    comm_batch_t batch;
+    comm_batch_begin(&batch);
+#endif
+
+    while (slot != queue->tail && count < COMM_STORE_FRAME_MAX) {
+        uint32_t id;
+        comm_store_record_state_t state = comm_store_read_record(queue, slot, record, &id);
+        if (state != COMM_STORE_RECORD_PENDING) {
+            // 已送达或损坏的记录跳过
+            slot = comm_store_next_slot(queue, slot);
+            if (count == 0) {
+                queue->head = slot;
+            }
+            continue;
+        }
+
+        char *cmd = (char *)&record[COMM_STORE_HEADER_SIZE];
+        cmd[record[COMM_STORE_POS_LENGTH]] = '\0';
+        char *separator = strchr(cmd, COMM_CMD_DATA_SEPARATOR);
+        if (separator == NULL) {
+            break;
+        }
+        *separator = '\0';
+
+#if COMM_ENABLE_BATCH
+        if (!comm_batch_add(&batch, cmd, separator + 1)) {
+            if (count > 0) {
+                break;      // 放不下或含分隔符，留给下一帧
+            }
+            // 不能合并的消息单独发送
+            sent = comm_send_command(instance->huart, cmd, separator + 1);
+            queue->in_flight_slots[count++] = slot;
+            slot = comm_store_next_slot(queue, slot);
+            break;
+        }
+#endif
+        queue->in_flight_slots[count++] = slot;
+        slot = comm_store_next_slot(queue, slot);
+
+#if !COMM_ENABLE_BATCH
+        sent = comm_send_command(instance->huart, cmd, separator + 1);
+#endif
+    }
+
+    if (count == 0) {
+        if (slot == queue->tail) {
+            // 计数与存储不一致（例如记录被外部改写），以存储为准
+            queue->stats.pending = 0;
+        }
+        return;
+    }
+
+#if COMM_ENABLE_BATCH
+    if (!sent && batch.count > 0) {
+        if (batch.count == 1) {
+            // 单条消息不加批量帧的开销
+            char *cmd = batch.payload;
+            char *separator = strchr(cmd, COMM_CMD_DATA_SEPARATOR);
+            *separator = '\0';
+            sent = comm_send_command(instance->huart, cmd, separator + 1);
+        } else {
+            sent = comm_batch_send(instance->huart, &batch);
+        }
+    }
+#endif
+
+    if (!sent) {
+        queue->paused = true;
+        queue->paused_time = now;
+        queue->stats.failures++;
+        return;
+    }
+
+    queue->busy = true;
+    queue->done = false;
+    queue->failed = false;
+    queue->sequence = instance->current_sequence;
+    queue->in_flight = count;
+    queue->next_head = slot;
+    queue->stats.frames++;
+}
+
+#endif /* COMM_ENABLE_STORE */
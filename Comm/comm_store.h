@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ * @file           : comm_store.h
+ * @author         : ShanQue
+ * @brief          : STM32串口通信持久化发送队列
+ * @date           : 2026/10/16
+ * @version        : 2.0.0
+ ******************************************************************************
+ *
+ * 持久化发送队列 - 对端离线时消息写入Flash等存储，链路恢复或重启后按顺序补发
+ *
+ * 普通命令重试用尽后只调用失败回调，消息随之丢失。通过comm_store_send()发送的消息
+ * 先追加到存储中，再由comm_tick()从最早的一条开始发送:
+ *   - 收到ACK后才在存储中标记为已送达，重试用尽时保留，暂停COMM_STORE_RETRY_MS后再补发
+ *   - 启用链路监测时，链路断开期间不补发，恢复后立即开始
+ *   - 启用批量命令时，连续的多条消息合并为一个BAT帧（最多COMM_STORE_BATCH_MAX条），
+ *     对端也要启用COMM_ENABLE_BATCH
+ *   - comm_store_attach()扫描存储恢复未送达的消息，重启前写入的消息照常补发
+ *
+ * 存储布局（按Flash的写入规则设计，只把1写为0，整扇区擦除为0xFF）:
+ *   存储区由若干COMM_STORE_SECTOR_SIZE的扇区组成，每个扇区存放若干固定大小的记录，
+ *   记录在扇区间循环追加。每条记录:
+ *     [0..7]   送达标记，0xFF为未送达，送达后写为全0
+ *     [8..15]  头部: 0xA5, 长度, CRC8, 0xFF, 32位记录号（小端）
+ *     [16..]   "CMD:DATA"，剩余部分保持0xFF
+ *   写入总是8字节对齐、长度为8的倍数，兼容需要按双字编程的Flash。
+ *   写到下一个扇区时先擦除它，该扇区还有未送达的消息时队列已满。
+ *
+ * 注意：
+ *   - 消息至少送达一次：收到ACK与写入送达标记之间掉电，重启后会再发一次
+ *   - 存储区至少两个扇区，可用容量约为(扇区数 - 1) * 每扇区记录数
+ *   - 重启后序列号从头开始，接收端会当作倒退的序列号拒绝，需要跨重启补发时两端都要启用
+ *     COMM_ENABLE_SESSION
+ *   - comm_store_ram_ops用一块RAM模拟Flash（写入按位与、擦除置0xFF），可用于主机测试，
+ *     或放在复位不清零的RAM中跨软件复位保存
+ *
+ * 使用示例:
+ *   static const comm_store_ops_t flash_ops = { flash_read, flash_write, flash_erase };
+ *   comm_store_attach(&huart2, &flash_ops, NULL, 8 * COMM_STORE_SECTOR_SIZE);
+ *   comm_store_send(&huart2, "LOG", "T=25.6,H=48.2");   // 存储已满时返回false
+ *
+ ******************************************************************************
+ */
+
+#ifndef COMM_STORE_H
+#define COMM_STORE_H
+
+#include "comm_internal.h"
+
+#if COMM_ENABLE_STORE
+
+/** @brief 记录头部大小（送达标记 + 头部） */
+#define COMM_STORE_HEADER_SIZE      16
+
+/** @brief 记录中"CMD:DATA"的最大长度 */
+#define COMM_STORE_MAX_MESSAGE      (COMM_MAX_CMD_LENGTH + COMM_MAX_DATA_LENGTH - 1)
+
+/** @brief 每条记录占用的存储大小（8字节对齐） */
+#define COMM_STORE_RECORD_SIZE      ((COMM_STORE_HEADER_SIZE + COMM_STORE_MAX_MESSAGE + 7) & ~7)
+
+#if COMM_STORE_MAX_MESSAGE > 255
+#error "COMM_MAX_CMD_LENGTH + COMM_MAX_DATA_LENGTH不能超过256"
+#endif
+
+#if COMM_STORE_SECTOR_SIZE < COMM_STORE_RECORD_SIZE || (COMM_STORE_SECTOR_SIZE % 8) != 0
+#error "COMM_STORE_SECTOR_SIZE必须是8的倍数且至少放得下一条记录"
+#endif
+
+/**
+ * @brief 存储访问接口
+ * @note  offset从存储区起点算起；write只会把1写为0，erase把offset所在的整个扇区擦除为0xFF。
+ *        返回false表示操作失败。
+ */
+typedef struct {
+    bool (*read)(void *ctx, uint32_t offset, void *buffer, uint16_t length);
+    bool (*write)(void *ctx, uint32_t offset, const void *data, uint16_t length);
+    bool (*erase)(void *ctx, uint32_t offset);
+} comm_store_ops_t;
+
+/** @brief RAM模拟存储的上下文 */
+typedef struct {
+    uint8_t *memory;                        /**< 存储区 */
+    uint32_t size;                          /**< 存储区大小 */
+} comm_store_ram_t;
+
+/** @brief RAM模拟存储，ctx为comm_store_ram_t指针 */
+extern const comm_store_ops_t comm_store_ram_ops;
+
+/** @brief 持久化队列统计 */
+typedef struct {
+    uint16_t pending;                       /**< 未送达的消息数 */
+    uint16_t capacity;                      /**< 至少可保存的消息数 */
+    uint16_t recovered;                     /**< 挂接时从存储恢复的未送达消息数 */
+    uint32_t stored;                        /**< 写入的消息数 */
+    uint32_t delivered;                     /**< 已送达的消息数 */
+    uint32_t rejected;                      /**< 存储已满或写入失败而拒绝的消息数 */
+    uint32_t frames;                        /**< 补发的帧数（批量帧算一帧） */
+    uint32_t failures;                      /**< 补发失败的次数 */
+} comm_store_stats_t;
+
+/* =============================================================================
+ * 持久化队列API
+ * =============================================================================
+ */
+
+/**
+ * @brief  为已添加的UART挂接持久化队列
+ * @param  huart: UART句柄指针
+ * @param  ops: 存储访问接口
+ * @param  ctx: 传给存储访问接口的上下文
+ * @param  size: 存储区大小，COMM_STORE_SECTOR_SIZE的整数倍，至少两个扇区
+ * @retval true: 挂接成功, false: 参数无效、实例未添加或已挂接、队列表已满
+ * @note   扫描存储恢复未送达的消息，由comm_tick()开始补发
+ */
+bool comm_store_attach(UART_HandleTypeDef *huart, const comm_store_ops_t *ops, void *ctx, uint32_t size);
+
+/**
+ * @brief  解除挂接
+ * @param  huart: UART句柄指针
+ * @retval true: 解除成功, false: 未挂接
+ * @note   存储中的消息保留，再次挂接后继续补发
+ */
+bool comm_store_detach(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  把一条消息写入持久化队列
+ * @param  huart: UART句柄指针
+ * @param  cmd: 命令字符串
+ * @param  data: 数据字符串
+ * @retval true: 已写入存储, false: 未挂接、参数无效、存储已满或写入失败
+ * @note   由comm_tick()按写入顺序发送，收到ACK后才从队列中移除
+ */
+bool comm_store_send(UART_HandleTypeDef *huart, const char *cmd, const char *data);
+
+/**
+ * @brief  获取未送达的消息数
+ * @param  huart: UART句柄指针
+ * @retval 未送达的消息数，未挂接时返回0
+ */
+uint16_t comm_store_pending(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  获取持久化队列统计
+ * @param  huart: UART句柄指针
+ * @param  stats: 统计输出
+ * @retval true: 获取成功, false: 未挂接
+ */
+bool comm_store_get_stats(UART_HandleTypeDef *huart, comm_store_stats_t *stats);
+
+/* =============================================================================
+ * 内部接口
+ * =============================================================================
+ */
+
+/**
+ * @brief  初始化持久化队列表
+ * @param  None
+ * @retval None
+ * @note   由comm_init()调用
+ */
+void comm_store_init(void);
+
+/**
+ * @brief  结算正在补发的消息，实例空闲时补发下一批
+ * @param  None
+ * @retval None
+ * @note   由comm_tick()在处理完所有实例后调用
+ */
+void comm_store_process(void);
+
+/**
+ * @brief  实例的命令发送结束，结束的是补发帧时记录结果
+ * @param  instance: 实例指针
+ * @param  sequence: 结束的命令的序列号
+ * @param  acked: 是否收到ACK
+ * @retval None
+ * @note   由comm_call_send_done()调用
+ */
+void comm_store_on_send_done(comm_instance_t *instance, comm_seq_t sequence, bool acked);
+
+#endif /* COMM_ENABLE_STORE */
+
+#endif /* COMM_STORE_H */
@@ -0,0 +1,213 @@
+/**
+ * @file    comm_bench.c
+ * @brief   帧构建基准（主机程序） - 对比snprintf两次格式化+拷贝与单遍序列化器的每帧开销
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ *
+ * 编译（在Comm目录下，COMM_ENABLE_RTOS为0）:
+ *   gcc -std=gnu11 -O2 -I tools/host -I . -I ../Uart -o comm_bench tools/comm_bench.c tools/host/hal_host.c comm*.c
+ *
+ * 用法:
+ *   comm_bench [帧数]
+ *
+ * "旧"是改写前的构建方式：snprintf格式化到临时frame_content、计算CRC、再snprintf到发送缓冲区，
+ * 发送前再拷贝到栈上的send_copy。"新"是comm_build_frame()/comm_send_ack()当前的实现。
+ * 先逐字节核对两者输出一致，再分别计时；x86主机上以TSC周期计，其它主机以纳秒计。
+ * 单片机上可用DWT->CYCCNT对同样的调用计时。
+ */
+
+#include "comm.h"
+#include "comm_manager.h"
+#include "comm_protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "周期"
+#define BENCH_NOW() ((uint64_t)__rdtsc())
+#else
+#define BENCH_UNIT "ns"
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#define BENCH_NOW() bench_now_ns()
+#endif
+
+static UART_HandleTypeDef g_uart;
+static volatile uint8_t g_sink;
+
+typedef struct {
+    const char *name;
+    const char *cmd;
+    const char *data;
+} bench_case_t;
+
+static const bench_case_t g_cases[] = {
+    { "短命令",   "LED",  "1" },
+    { "遥测",     "TEMP", "25.6,48.2,1013.25" },
+    { "PING模板", "PING", "TEST" },
+    { "长数据",   "LOG",  "0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDE" },
+};
+
+/* =============================================================================
+ * 改写前的构建方式（仅作对照）
+ * =============================================================================
+ */
+
+static bool old_build_frame(comm_seq_t seq, const char *cmd, const char *data, char *frame_buffer,
+                            uint16_t size, uint16_t *frame_length)
+{
+    char frame_content[COMM_TX_BUFFER_SIZE];
+    int content_len = snprintf(frame_content, sizeof(frame_content), "%c%s%c%s%c%0*X",
+                               COMM_FRAME_START, cmd, COMM_CMD_DATA_SEPARATOR,
+                               data, COMM_FIELD_SEPARATOR, COMM_SEQ_DIGITS, seq);
+    if (content_len < 0 || content_len >= (int)sizeof(frame_content)) {
+        return false;
+    }
+
+    uint8_t crc = comm_crc8_calculate((uint8_t *)(frame_content + 1), (uint16_t)(content_len - 1));
+    int total_len = snprintf(frame_buffer, size, "%s%c%02X%c",
+                             frame_content, COMM_FIELD_SEPARATOR, crc, COMM_FRAME_END);
+    if (total_len < 0 || total_len >= size) {
+        return false;
+    }
+
+    *frame_length = (uint16_t)total_len;
+    return true;
+}
+
+static void old_send(const char *frame_buffer, uint16_t length)
+{
+    char send_copy[COMM_TX_BUFFER_SIZE];
+    memcpy(send_copy, frame_buffer, length);
+    HAL_UART_Transmit(&g_uart, (uint8_t *)send_copy, length, 1000);
+    g_sink = (uint8_t)send_copy[length - 1];
+}
+
+static bool old_send_ack(comm_seq_t ack_seq)
+{
+    char ack_data[8];
+    snprintf(ack_data, sizeof(ack_data), "%0*X", COMM_SEQ_DIGITS, ack_seq);
+
+    char frame_content[COMM_TX_BUFFER_SIZE];
+    int content_len = snprintf(frame_content, sizeof(frame_content), "%s%c%s%c00",
+                               COMM_CMD_ACK, COMM_CMD_DATA_SEPARATOR, ack_data, COMM_FIELD_SEPARATOR);
+    if (content_len < 0 || content_len >= (int)sizeof(frame_content)) {
+        return false;
+    }
+
+    uint8_t crc = comm_crc8_calculate((uint8_t *)frame_content, (uint16_t)content_len);
+    char ack_frame[COMM_TX_BUFFER_SIZE];
+    int total_len = snprintf(ack_frame, sizeof(ack_frame), "%c%s%c%02X%c",
+                             COMM_FRAME_START, frame_content, COMM_FIELD_SEPARATOR, crc, COMM_FRAME_END);
+    if (total_len < 0 || total_len >= (int)sizeof(ack_frame)) {
+        return false;
+    }
+
+    HAL_UART_Transmit(&g_uart, (uint8_t *)ack_frame, (uint16_t)total_len, 500);
+    g_sink = (uint8_t)ack_frame[total_len - 1];
+    return true;
+}
+
+/* =============================================================================
+ * 基准
+ * =============================================================================
+ */
+
+static bool bench_verify(comm_instance_t *instance)
+{
+    for (size_t i = 0; i < sizeof(g_cases) / sizeof(g_cases[0]); i++) {
+        uint16_t new_len;
+        uint16_t old_len;
+        char old_frame[COMM_TX_BUFFER_SIZE];
+
+        instance->retry_count = 0;
+        if (!comm_build_frame(instance, g_cases[i].cmd, g_cases[i].data, instance->tx_buffer, &new_len) ||
+            !old_build_frame(instance->current_sequence, g_cases[i].cmd, g_cases[i].data, old_frame,
+                             sizeof(old_frame), &old_len)) {
+            printf("%s: 构建失败\n", g_cases[i].name);
+            return false;
+        }
+        if (new_len != old_len || memcmp(instance->tx_buffer, old_frame, new_len) != 0) {
+            printf("%s: 输出不一致\n  旧 %.*s\n  新 %.*s\n", g_cases[i].name,
+                   old_len, old_frame, new_len, instance->tx_buffer);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void bench_frames(comm_instance_t *instance, const bench_case_t *c, uint32_t frames)
+{
+    uint16_t len = 0;
+    char old_frame[COMM_TX_BUFFER_SIZE];
+
+    uint64_t begin = BENCH_NOW();
+    for (uint32_t i = 0; i < frames; i++) {
+        old_build_frame((comm_seq_t)(i | 1), c->cmd, c->data, old_frame, sizeof(old_frame), &len);
+        old_send(old_frame, len);
+    }
+    uint64_t old_cost = BENCH_NOW() - begin;
+
+    begin = BENCH_NOW();
+    for (uint32_t i = 0; i < frames; i++) {
+        instance->retry_count = 0;
+        comm_build_frame(instance, c->cmd, c->data, instance->tx_buffer, &len);
+        HAL_UART_Transmit(instance->huart, (uint8_t *)instance->tx_buffer, len, 1000);
+        g_sink = (uint8_t)instance->tx_buffer[len - 1];
+    }
+    uint64_t new_cost = BENCH_NOW() - begin;
+
+    printf("%-10s %3u字节  旧 %7.1f  新 %7.1f %s/帧  (%.1fx)\n", c->name, len,
+           (double)old_cost / frames, (double)new_cost / frames, BENCH_UNIT,
+           new_cost ? (double)old_cost / (double)new_cost : 0.0);
+}
+
+static void bench_ack(comm_instance_t *instance, uint32_t frames)
+{
+    uint64_t begin = BENCH_NOW();
+    for (uint32_t i = 0; i < frames; i++) {
+        old_send_ack((comm_seq_t)(i | 1));
+    }
+    uint64_t old_cost = BENCH_NOW() - begin;
+
+    begin = BENCH_NOW();
+    for (uint32_t i = 0; i < frames; i++) {
+        comm_send_ack(instance, (comm_seq_t)(i | 1));
+    }
+    uint64_t new_cost = BENCH_NOW() - begin;
+
+    printf("%-10s          旧 %7.1f  新 %7.1f %s/帧  (%.1fx)\n", "ACK模板",
+           (double)old_cost / frames, (double)new_cost / frames, BENCH_UNIT,
+           new_cost ? (double)old_cost / (double)new_cost : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 200000;
+    if (frames == 0) frames = 1;
+
+    comm_init();
+    comm_add_uart(&g_uart);
+    comm_instance_t *instance = comm_find_instance(&g_uart);
+    if (instance == NULL) {
+        return 2;
+    }
+
+    if (!bench_verify(instance)) {
+        return 1;
+    }
+    printf("输出核对一致，每项 %lu 帧\n", (unsigned long)frames);
+
+    for (size_t i = 0; i < sizeof(g_cases) / sizeof(g_cases[0]); i++) {
+        bench_frames(instance, &g_cases[i], frames);
+    }
+    bench_ack(instance, frames);
+    return 0;
+}
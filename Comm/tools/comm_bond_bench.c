@@ -0,0 +1,256 @@
+/**
+ * @file    comm_bond_bench.c
+ * @brief   链路聚合基准（主机程序） - 模拟1~N条串口链路聚合后的有效吞吐和断开一条成员时的表现
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ *
+ * 编译（在Comm目录下，comm_internal.h中COMM_ENABLE_BOND为1、COMM_BOND_MAX_BONDS至少为2、
+ * COMM_MAX_INSTANCES至少为2 x COMM_BOND_MAX_MEMBERS、COMM_ENABLE_RTOS为0）:
+ *   gcc -std=gnu11 -O2 -I tools/host -I . -I ../Uart -o comm_bond_bench tools/comm_bond_bench.c tools/host/hal_host.c comm*.c
+ *
+ * 用法:
+ *   comm_bond_bench [每项模拟秒数] [波特率] 2>/dev/null
+ *
+ * 两端各用N个UART建立聚合通道，第i个成员两两相连，每个字节按波特率占用线路时间（10位/字节）。
+ * A端只要发送窗口有空位就用comm_bond_send()发送200字节的消息，
+ * 有效吞吐 = B端回调按顺序收到的消息字节数 / 模拟时间。
+ * 断开测试在一半时间处让第2条链路两个方向都不再送达，直到结束。
+ */
+
+#include "comm.h"
+#include "comm_bond.h"
+#include "comm_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !COMM_ENABLE_BOND || COMM_BOND_MAX_BONDS < 2
+#error "comm_bond_bench需要在comm_internal.h中启用COMM_ENABLE_BOND，且COMM_BOND_MAX_BONDS至少为2"
+#endif
+
+#if COMM_MAX_INSTANCES < 2 * COMM_BOND_MAX_MEMBERS
+#error "comm_bond_bench的两端各有COMM_BOND_MAX_MEMBERS条链路，COMM_MAX_INSTANCES至少为2 x COMM_BOND_MAX_MEMBERS"
+#endif
+
+#define BENCH_QUEUE_SIZE    4096
+#define BENCH_STEP_US       10
+#define BENCH_MESSAGE_SIZE  200
+
+/* 单向信道：字节带到达时刻排队 */
+typedef struct {
+    uint8_t bytes[BENCH_QUEUE_SIZE];
+    uint64_t due_us[BENCH_QUEUE_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint64_t line_free_us;                  /**< 线路空闲时刻 */
+    UART_HandleTypeDef *from;               /**< 发送端 */
+    UART_HandleTypeDef *to;                 /**< 接收端 */
+    bool cut;                               /**< 已断开，不再送达 */
+} bench_channel_t;
+
+typedef struct {
+    uint32_t delivered;                     /**< B按顺序收到的消息数 */
+    uint32_t payload_bytes;                 /**< B按顺序收到的消息字节数 */
+    uint32_t out_of_order;                  /**< 乱序、重复或内容错误的消息数 */
+    comm_bond_stats_t tx;                   /**< A端聚合统计 */
+} bench_result_t;
+
+static UART_HandleTypeDef g_a[COMM_BOND_MAX_MEMBERS];
+static UART_HandleTypeDef g_b[COMM_BOND_MAX_MEMBERS];
+static bench_channel_t g_channels[2 * COMM_BOND_MAX_MEMBERS];
+static uint8_t g_channel_count;
+static uint64_t g_now_us;
+static uint32_t g_byte_us;
+static uint32_t g_next_expected;
+static bench_result_t g_result;
+
+/* =============================================================================
+ * 模拟链路
+ * =============================================================================
+ */
+
+static void bench_tx_hook(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size)
+{
+    bench_channel_t *ch = NULL;
+    for (uint8_t i = 0; i < g_channel_count; i++) {
+        if (g_channels[i].from == huart) {
+            ch = &g_channels[i];
+            break;
+        }
+    }
+    if (ch == NULL) {
+        return;
+    }
+
+    uint64_t t = (ch->line_free_us > g_now_us) ? ch->line_free_us : g_now_us;
+    for (uint16_t i = 0; i < size; i++) {
+        if (ch->tail - ch->head >= BENCH_QUEUE_SIZE) {
+            break;      // 相当于发送端FIFO溢出，不会在正常参数下发生
+        }
+        t += g_byte_us;
+        uint32_t idx = ch->tail++ % BENCH_QUEUE_SIZE;
+        ch->bytes[idx] = data[i];
+        ch->due_us[idx] = t;
+    }
+    ch->line_free_us = t;
+}
+
+static void bench_deliver(bench_channel_t *ch)
+{
+    comm_instance_t *instance = comm_find_instance(ch->to);
+    while (ch->head != ch->tail && ch->due_us[ch->head % BENCH_QUEUE_SIZE] <= g_now_us) {
+        uint8_t byte = ch->bytes[ch->head++ % BENCH_QUEUE_SIZE];
+        if (ch->cut) {
+            continue;
+        }
+        instance->rx_byte = byte;
+        comm_uart_rx_callback(ch->to);
+    }
+}
+
+/* =============================================================================
+ * 应用
+ * =============================================================================
+ */
+
+static void bench_on_block(UART_HandleTypeDef *huart, const char *cmd, const char *data,
+                           uint16_t data_len, void *user_ctx)
+{
+    (void)huart; (void)cmd; (void)user_ctx;
+    // 消息开头是计数，检查按顺序、不重复、长度完整
+    uint32_t value = (uint32_t)strtoul(data, NULL, 10);
+    if (value != g_next_expected || data_len != BENCH_MESSAGE_SIZE) {
+        g_result.out_of_order++;
+        g_next_expected = value + 1;
+        return;
+    }
+    g_next_expected++;
+    g_result.delivered++;
+    g_result.payload_bytes += data_len;
+}
+
+static void bench_fill_message(char *message, uint32_t counter)
+{
+    int n = snprintf(message, BENCH_MESSAGE_SIZE + 1, "%08lu,", (unsigned long)counter);
+    for (int i = n; i < BENCH_MESSAGE_SIZE; i++) {
+        message[i] = (char)('A' + (counter + (uint32_t)i) % 26);
+    }
+    message[BENCH_MESSAGE_SIZE] = '\0';
+}
+
+/**
+ * @brief  推进模拟时间，按毫秒调用comm_tick()，发送窗口有空位就发送
+ */
+static void bench_run(uint64_t until_us, uint32_t *counter)
+{
+    char message[BENCH_MESSAGE_SIZE + 1];
+    uint32_t last_ms = (uint32_t)(g_now_us / 1000);
+
+    while (g_now_us < until_us) {
+        for (uint8_t i = 0; i < g_channel_count; i++) {
+            bench_deliver(&g_channels[i]);
+        }
+
+        uint32_t ms = (uint32_t)(g_now_us / 1000);
+        if (ms != last_ms) {
+            last_ms = ms;
+            hal_host_tick = ms;
+            comm_tick();
+        }
+
+        while (comm_bond_is_ready(&g_a[0])) {
+            bench_fill_message(message, *counter);
+            if (!comm_bond_send(&g_a[0], "BLK", message)) {
+                break;
+            }
+            (*counter)++;
+        }
+
+        g_now_us += BENCH_STEP_US;
+    }
+}
+
+static void bench_once(uint8_t members, bool cut, uint32_t seconds, bench_result_t *result)
+{
+    UART_HandleTypeDef *a[COMM_BOND_MAX_MEMBERS];
+    UART_HandleTypeDef *b[COMM_BOND_MAX_MEMBERS];
+
+    memset(g_channels, 0, sizeof(g_channels));
+    memset(&g_result, 0, sizeof(g_result));
+    memset(g_a, 0, sizeof(g_a));
+    memset(g_b, 0, sizeof(g_b));
+    g_now_us = 0;
+    hal_host_tick = 0;
+    g_next_expected = 0;
+
+    comm_init();
+    g_channel_count = (uint8_t)(2 * members);
+    for (uint8_t i = 0; i < members; i++) {
+        comm_add_uart(&g_a[i]);
+        comm_add_uart(&g_b[i]);
+        g_channels[2 * i] = (bench_channel_t){ .from = &g_a[i], .to = &g_b[i] };
+        g_channels[2 * i + 1] = (bench_channel_t){ .from = &g_b[i], .to = &g_a[i] };
+        a[i] = &g_a[i];
+        b[i] = &g_b[i];
+    }
+    comm_bond_create(a, members);
+    comm_bond_create(b, members);
+    comm_register_command_callback_ex(&g_b[0], "BLK", bench_on_block, NULL);
+
+    uint32_t counter = 0;
+    uint64_t end = (uint64_t)seconds * 1000000u;
+    if (cut) {
+        bench_run(end / 2, &counter);
+        g_channels[2].cut = true;
+        g_channels[3].cut = true;
+    }
+    bench_run(end, &counter);
+
+    comm_bond_get_stats(&g_a[0], &g_result.tx);
+    *result = g_result;
+}
+
+static void bench_print(const char *name, uint32_t seconds, const bench_result_t *r, double base)
+{
+    double rate = (double)r->payload_bytes / seconds;
+    printf("%-18s | %8.1f %7lu %5lu | %4u/%u %6lu %6lu   (%.2fx)\n", name, rate,
+           (unsigned long)r->delivered, (unsigned long)r->out_of_order,
+           r->tx.members_up, r->tx.members, (unsigned long)r->tx.tx_reassigned,
+           (unsigned long)r->tx.tx_duplicated, base > 0 ? rate / base : 1.0);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seconds = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 20;
+    uint32_t baud = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : 115200;
+    if (seconds == 0) seconds = 1;
+    if (baud == 0) baud = 115200;
+    g_byte_us = (10000000u + baud - 1) / baud;
+
+    hal_host_tx_hook = bench_tx_hook;
+    printf("%lu bps，每项模拟 %lu s，消息 %d 字节，分片 %d 字节，窗口 %d 条\n",
+           (unsigned long)baud, (unsigned long)seconds, BENCH_MESSAGE_SIZE,
+           COMM_BOND_FRAGMENT_SIZE, COMM_BOND_WINDOW);
+    printf("%-18s | %-22s | %-14s\n", "成员", "吞吐B/s  送达  乱序", "可用  改派  重复");
+
+    bench_result_t result;
+    double base = 0;
+    char name[32];
+    for (uint8_t members = 1; members <= COMM_BOND_MAX_MEMBERS; members++) {
+        bench_once(members, false, seconds, &result);
+        if (members == 1) {
+            base = (double)result.payload_bytes / seconds;
+        }
+        snprintf(name, sizeof(name), "%d条", members);
+        bench_print(name, seconds, &result, base);
+    }
+
+    if (COMM_BOND_MAX_MEMBERS >= 2) {
+        uint8_t members = (COMM_BOND_MAX_MEMBERS >= 3) ? 3 : 2;
+        bench_once(members, true, seconds, &result);
+        snprintf(name, sizeof(name), "%d条，中途断开1条", members);
+        bench_print(name, seconds, &result, base);
+    }
+    return 0;
+}
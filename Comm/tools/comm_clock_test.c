@@ -0,0 +1,258 @@
+/**
+ * @file    comm_clock_test.c
+ * @brief   时钟同步测试（主机程序） - 在模拟线路上检查偏差、往返延迟、漂移的计算和时间戳换算
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ *
+ * 编译（在Comm目录下，comm_internal.h中COMM_ENABLE_CLOCK为1、COMM_ENABLE_RTOS为0）:
+ *   gcc -std=gnu11 -O2 -I tools/host -I . -I ../Uart -o comm_clock_test tools/comm_clock_test.c tools/host/hal_host.c comm*.c
+ *
+ * 用法:
+ *   comm_clock_test
+ *
+ * 实例A向实例B同步，B为主时钟。测试按微秒推进真实时间:
+ *   - 阻塞发送占用 字节数 x TEST_BYTE_US，之后再经过单向延迟TEST_LATENCY_US字节到达对端
+ *   - A的时钟比真实时间快50ppm并有固定偏差，B的时钟等于真实时间加上可设置的跳变量
+ * 依次检查:
+ *   - 默认时间源HAL_GetTick() * 1000：换算误差在1毫秒之内（不保证亚毫秒精度）
+ *   - 微秒时间源：往返延迟等于2 x TEST_LATENCY_US，换算误差在几十微秒之内，漂移接近-50ppm
+ *   - 停止交换30秒后按漂移外推，误差仍在范围内；主时钟换算回本地时间与原值一致
+ *   - 一次应答被耽搁时该样本因延迟过大被丢弃，偏差不受影响
+ *   - 主时钟跳变后检测到跳变并重新同步
+ * 全部通过时打印"OK"并返回0，失败时打印出错的一步并返回1。
+ */
+
+#include "comm.h"
+#include "comm_manager.h"
+#include "comm_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !COMM_ENABLE_CLOCK
+#error "comm_clock_test需要在comm_internal.h中启用COMM_ENABLE_CLOCK"
+#endif
+
+#define TEST_CHECK(cond, step)  do { if (!(cond)) { printf("失败: %s\n", step); return 1; } } while (0)
+
+#define TEST_BYTE_US            87          /**< 115200bps 8N1每字节的时间 */
+#define TEST_LATENCY_US         300         /**< 单向延迟（收发器、隔离器等） */
+#define TEST_LOCAL_OFFSET_US    0xF0000000u /**< A的时钟相对真实时间的偏差 */
+#define TEST_DRIFT_DIVISOR      20000       /**< A的时钟每20000微秒多走1微秒（50ppm） */
+#define TEST_PENDING_MAX        8
+#define TEST_FRAME_MAX          64
+
+/* 在线路上、尚未到达对端的帧 */
+typedef struct {
+    UART_HandleTypeDef *peer;
+    uint64_t arrive_us;
+    uint16_t size;
+    uint8_t data[TEST_FRAME_MAX];
+} test_pending_t;
+
+static UART_HandleTypeDef g_a;
+static UART_HandleTypeDef g_b;
+static uint64_t g_now_us;                   /**< 真实时间 */
+static uint32_t g_master_jump_us;           /**< 主时钟的跳变量 */
+static uint32_t g_extra_latency_us;         /**< 下一帧B到A额外的延迟 */
+static test_pending_t g_pending[TEST_PENDING_MAX];
+static uint8_t g_pending_count;
+
+/* =============================================================================
+ * 模拟线路和时钟
+ * =============================================================================
+ */
+
+static uint32_t test_local_us(uint64_t now)
+{
+    return (uint32_t)(now + now / TEST_DRIFT_DIVISOR) + TEST_LOCAL_OFFSET_US;
+}
+
+static uint32_t test_master_us(uint64_t now)
+{
+    return (uint32_t)now + g_master_jump_us;
+}
+
+static uint32_t test_source(UART_HandleTypeDef *huart)
+{
+    return (huart == &g_a) ? test_local_us(g_now_us) : test_master_us(g_now_us);
+}
+
+static void test_set_time(uint64_t now)
+{
+    g_now_us = now;
+    hal_host_tick = (uint32_t)(now / 1000);
+}
+
+/**
+ * @brief  送达一帧（整帧在同一时刻到达，接收中断在'}'处打时间戳）
+ */
+static void test_deliver(uint8_t slot)
+{
+    test_pending_t p = g_pending[slot];
+    g_pending[slot] = g_pending[--g_pending_count];
+
+    comm_instance_t *instance = comm_find_instance(p.peer);
+    for (uint16_t i = 0; i < p.size; i++) {
+        instance->rx_byte = p.data[i];
+        comm_uart_rx_callback(p.peer);
+    }
+}
+
+/**
+ * @brief  把真实时间推进到end，途中按到达时刻送达线路上的帧
+ */
+static void test_advance(uint64_t end)
+{
+    for (;;) {
+        int8_t slot = -1;
+        for (uint8_t i = 0; i < g_pending_count; i++) {
+            if (g_pending[i].arrive_us <= end &&
+                (slot < 0 || g_pending[i].arrive_us < g_pending[slot].arrive_us)) {
+                slot = (int8_t)i;
+            }
+        }
+        if (slot < 0) {
+            break;
+        }
+        if (g_pending[slot].arrive_us > g_now_us) {
+            test_set_time(g_pending[slot].arrive_us);
+        }
+        test_deliver((uint8_t)slot);
+    }
+    test_set_time(end);
+}
+
+static void test_tx_hook(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size)
+{
+    // 阻塞发送在最后一个字节移出后返回，其间到达的帧照常进入接收中断
+    test_advance(g_now_us + (uint64_t)size * TEST_BYTE_US);
+    if (g_pending_count >= TEST_PENDING_MAX || size > TEST_FRAME_MAX) {
+        return;
+    }
+
+    test_pending_t *p = &g_pending[g_pending_count++];
+    p->peer = (huart == &g_a) ? &g_b : &g_a;
+    p->arrive_us = g_now_us + TEST_LATENCY_US;
+    if (huart == &g_b) {
+        p->arrive_us += g_extra_latency_us;
+        g_extra_latency_us = 0;
+    }
+    p->size = size;
+    memcpy(p->data, data, size);
+}
+
+/**
+ * @brief  推进真实时间，每毫秒调用一次comm_tick()
+ */
+static void test_run(uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++) {
+        test_advance((g_now_us / 1000 + 1) * 1000);
+        comm_tick();
+    }
+}
+
+/**
+ * @brief  当前时刻的换算误差
+ * @param  to_master: 输出本地换算到主时钟的误差
+ * @param  to_local: 输出主时钟换算回本地的误差
+ */
+static bool test_error(int32_t *to_master, int32_t *to_local)
+{
+    uint32_t local = test_local_us(g_now_us);
+    uint32_t master = test_master_us(g_now_us);
+    uint32_t estimate;
+    uint32_t back;
+    if (!comm_clock_to_master(&g_a, local, &estimate) || !comm_clock_from_master(&g_a, master, &back)) {
+        return false;
+    }
+
+    *to_master = (int32_t)(estimate - master);
+    *to_local = (int32_t)(back - local);
+    return true;
+}
+
+static void test_print(const char *step, int32_t to_master, int32_t to_local)
+{
+    comm_clock_status_t status;
+    comm_clock_get_status(&g_a, &status);
+    printf("%-16s 样本%u 往返%lu us 漂移%ld ppb 交换%lu 丢弃%lu 跳变%lu | 误差 %ld / %ld us\n",
+           step, status.samples, (unsigned long)status.delay_us, (long)status.drift_ppb,
+           (unsigned long)status.exchanges, (unsigned long)status.rejected, (unsigned long)status.steps,
+           (long)to_master, (long)to_local);
+}
+
+static bool test_within(int32_t to_master, int32_t to_local, int32_t limit)
+{
+    return labs(to_master) <= limit && labs(to_local) <= limit;
+}
+
+int main(void)
+{
+    int32_t to_master;
+    int32_t to_local;
+    comm_clock_status_t status;
+
+    hal_host_tx_hook = test_tx_hook;
+    comm_init();
+    comm_add_uart(&g_a);
+    comm_add_uart(&g_b);
+
+    // 默认时间源：两块板共用同一个HAL_GetTick()，只有毫秒分辨率
+    TEST_CHECK(comm_clock_sync_start(&g_a, 1000) && !comm_clock_is_synced(&g_a), "开始同步");
+    test_run(5500);
+    TEST_CHECK(comm_clock_is_synced(&g_a) && comm_clock_get_status(&g_a, &status), "默认时间源同步");
+    printf("%-16s 样本%u 往返%lu us | 偏差 %ld us（实际为0）\n",
+           "默认时间源", status.samples, (unsigned long)status.delay_us, (long)status.offset_us);
+    TEST_CHECK(labs(status.offset_us) <= 1000, "默认时间源误差在1毫秒之内");
+    comm_clock_sync_stop(&g_a);
+
+    // 微秒时间源
+    comm_clock_set_source(test_source);
+    TEST_CHECK(comm_clock_sync_start(&g_a, 1000), "微秒时间源开始同步");
+    test_run(2500);
+    TEST_CHECK(comm_clock_is_synced(&g_a) && test_error(&to_master, &to_local), "3个样本后已同步");
+    test_print("3个样本", to_master, to_local);
+    TEST_CHECK(test_within(to_master, to_local, 20), "3个样本后误差");
+    TEST_CHECK(comm_clock_get_status(&g_a, &status) &&
+               labs((long)status.delay_us - 2 * TEST_LATENCY_US) <= 2, "往返延迟");
+
+    test_run(20000);
+    TEST_CHECK(test_error(&to_master, &to_local), "20秒后");
+    test_print("20秒", to_master, to_local);
+    TEST_CHECK(test_within(to_master, to_local, 10), "20秒后误差");
+    // 主时钟每本地秒少走 50e-6 / (1 + 50e-6) 秒，约-49998ppb
+    TEST_CHECK(comm_clock_get_status(&g_a, &status) && labs(status.drift_ppb + 49998) <= 500, "漂移");
+
+    // 30秒没有新样本，按漂移外推
+    comm_clock_sync_start(&g_a, 60000);
+    test_run(30000);
+    TEST_CHECK(test_error(&to_master, &to_local), "外推30秒");
+    test_print("外推30秒", to_master, to_local);
+    TEST_CHECK(test_within(to_master, to_local, 30), "外推30秒误差");
+
+    // 一次应答被耽搁2毫秒：延迟过大的样本丢弃
+    comm_clock_sync_start(&g_a, 1000);
+    test_run(3000);
+    comm_clock_get_status(&g_a, &status);
+    uint32_t rejected = status.rejected;
+    g_extra_latency_us = 2000;
+    test_run(1000);
+    TEST_CHECK(test_error(&to_master, &to_local), "应答被耽搁");
+    test_print("应答被耽搁", to_master, to_local);
+    TEST_CHECK(comm_clock_get_status(&g_a, &status) && status.rejected == rejected + 1, "丢弃延迟过大的样本");
+    TEST_CHECK(test_within(to_master, to_local, 20), "丢弃后误差");
+
+    // 主时钟重启跳变
+    g_master_jump_us = 123456789;
+    test_run(12000);
+    TEST_CHECK(test_error(&to_master, &to_local), "主时钟跳变");
+    test_print("主时钟跳变", to_master, to_local);
+    TEST_CHECK(comm_clock_get_status(&g_a, &status) && status.steps == 1, "检测到跳变");
+    TEST_CHECK(test_within(to_master, to_local, 20), "跳变后误差");
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file    comm_compress_bench.c
+ * @brief   压缩基准（主机程序） - 按数据类型统计压缩率和每帧压缩/解压开销
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ *
+ * 编译（在Comm目录下，comm_internal.h中COMM_ENABLE_COMPRESS为1、COMM_ENABLE_RTOS为0）:
+ *   gcc -std=gnu11 -O2 -I tools/host -I . -I ../Uart -o comm_compress_bench tools/comm_compress_bench.c tools/host/hal_host.c comm*.c
+ *
+ * 用法:
+ *   comm_compress_bench [每类帧数]
+ *
+ * 对每类数据调用comm_compress_encode()/comm_compress_decode()，先核对解压结果与原文一致，
+ * 再分别计时。压缩率 = 压缩后字节数 / 原始字节数；发送时压缩后不变短的数据按原样发送，
+ * "发送"一列按这个规则计算。x86主机上以TSC周期计，其它主机以纳秒计。
+ * 单片机上可用DWT->CYCCNT对同样的调用计时。
+ */
+
+#include "comm.h"
+#include "comm_compress.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "周期"
+#define BENCH_NOW() ((uint64_t)__rdtsc())
+#else
+#define BENCH_UNIT "ns"
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#define BENCH_NOW() bench_now_ns()
+#endif
+
+#if !COMM_ENABLE_COMPRESS
+#error "comm_compress_bench需要在comm_internal.h中启用COMM_ENABLE_COMPRESS"
+#endif
+
+typedef struct {
+    const char *name;
+    const char *data;
+} bench_case_t;
+
+/* 数据长度都小于默认的COMM_MAX_DATA_LENGTH（64），可以直接发送 */
+static const bench_case_t g_cases[] = {
+    { "短遥测",   "T=25.6,H=48.2,P=1013.25" },
+    { "光谱通道", "F1=0123,F2=0456,F3=0789,F4=1012,F5=0345,F6=0678,F7=0901,F8=1234" },
+    { "ADC日志",  "ADC0=2048,ADC1=2047,ADC2=2049,ADC0=2048,ADC1=2046,ADC2=2049" },
+    { "小数序列", "0.000,0.000,0.000,0.000,0.125,0.250,0.375,0.500,0.500,0.500,0.5" },
+    { "重复序列", "OK,OK,OK,OK,OK,OK,OK,OK,OK,OK,OK,OK,OK,OK,OK,OK,OK,OK,OK,OK,OK" },
+    { "十六进制", "9F3A0C71E24B58D6A1F0937C4E2B86D5C03A7F19E864B2D0" },
+};
+
+static volatile int g_sink;
+
+/* =============================================================================
+ * 基准
+ * =============================================================================
+ */
+
+static bool bench_verify(const bench_case_t *c, char *packed, int *packed_len)
+{
+    char unpacked[COMM_TX_BUFFER_SIZE];
+    uint16_t raw_len = (uint16_t)strlen(c->data);
+
+    *packed_len = comm_compress_encode(c->data, raw_len, packed, COMM_TX_BUFFER_SIZE);
+    if (*packed_len < 0) {
+        printf("%s: 压缩失败\n", c->name);
+        return false;
+    }
+
+    int len = comm_compress_decode(packed, (uint16_t)*packed_len, unpacked, sizeof(unpacked));
+    if (len != raw_len || memcmp(unpacked, c->data, raw_len) != 0) {
+        printf("%s: 解压结果不一致\n", c->name);
+        return false;
+    }
+    return true;
+}
+
+static void bench_case(const bench_case_t *c, uint32_t frames, uint32_t *raw_total, uint32_t *wire_total)
+{
+    char packed[COMM_TX_BUFFER_SIZE];
+    char unpacked[COMM_TX_BUFFER_SIZE];
+    uint16_t raw_len = (uint16_t)strlen(c->data);
+    int packed_len;
+
+    if (!bench_verify(c, packed, &packed_len)) {
+        exit(1);
+    }
+
+    uint64_t begin = BENCH_NOW();
+    for (uint32_t i = 0; i < frames; i++) {
+        g_sink = comm_compress_encode(c->data, raw_len, packed, sizeof(packed));
+    }
+    uint64_t encode_cost = BENCH_NOW() - begin;
+
+    begin = BENCH_NOW();
+    for (uint32_t i = 0; i < frames; i++) {
+        g_sink = comm_compress_decode(packed, (uint16_t)packed_len, unpacked, sizeof(unpacked));
+    }
+    uint64_t decode_cost = BENCH_NOW() - begin;
+
+    // 压缩后不变短时按原样发送，短于COMM_COMPRESS_MIN_LENGTH的数据不压缩
+    uint16_t wire_len = (raw_len >= COMM_COMPRESS_MIN_LENGTH && packed_len < raw_len) ?
+                        (uint16_t)packed_len : raw_len;
+    *raw_total += raw_len;
+    *wire_total += wire_len;
+
+    printf("%-10s %3u -> %3d字节  压缩率 %5.1f%%  发送 %3u字节  压缩 %8.1f  解压 %7.1f %s/帧\n",
+           c->name, raw_len, packed_len, 100.0 * packed_len / raw_len, wire_len,
+           (double)encode_cost / frames, (double)decode_cost / frames, BENCH_UNIT);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 100000;
+    if (frames == 0) frames = 1;
+
+    uint32_t raw_total = 0;
+    uint32_t wire_total = 0;
+
+    printf("解压结果逐字节核对，每类 %lu 帧\n", (unsigned long)frames);
+    for (size_t i = 0; i < sizeof(g_cases) / sizeof(g_cases[0]); i++) {
+        bench_case(&g_cases[i], frames, &raw_total, &wire_total);
+    }
+    printf("合计 %lu -> %lu字节 (%.1f%%)\n", (unsigned long)raw_total, (unsigned long)wire_total,
+           100.0 * wire_total / raw_total);
+    return 0;
+}
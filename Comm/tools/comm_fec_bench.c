@@ -0,0 +1,240 @@
+/**
+ * @file    comm_fec_bench.c
+ * @brief   纠错基准（主机程序） - 在模拟的噪声信道上对比有无纠错时的有效吞吐
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ *
+ * 编译（在Comm目录下，comm_internal.h中COMM_ENABLE_FEC为1、COMM_ENABLE_RTOS为0）:
+ *   gcc -std=gnu11 -O2 -I tools/host -I . -I ../Uart -o comm_fec_bench tools/comm_fec_bench.c tools/host/hal_host.c comm*.c
+ *
+ * 用法:
+ *   comm_fec_bench [每点模拟秒数] [波特率] 2>/dev/null
+ *
+ * 两个实例A、B通过模拟的串口线相连，每个字节按波特率占用线路时间（10位/字节），
+ * 每一位以给定误码率(BER)独立翻转，两个方向都加噪声。A用comm_send_command()连续发送
+ * 48字节的遥测数据（等待ACK、超时重发，参数为comm_add_uart()的默认值），
+ * 有效吞吐 = B的回调收到的不重复数据字节数 / 模拟时间。
+ * 同一误码率下分别在不启用和启用纠错时各跑一次，随机数种子相同。
+ * 放弃发送时库的错误输出在stderr。
+ */
+
+#include "comm.h"
+#include "comm_fec.h"
+#include "comm_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !COMM_ENABLE_FEC
+#error "comm_fec_bench需要在comm_internal.h中启用COMM_ENABLE_FEC"
+#endif
+
+#define BENCH_QUEUE_SIZE    4096
+#define BENCH_STEP_US       10
+
+/* 单向信道：字节带到达时刻排队 */
+typedef struct {
+    uint8_t bytes[BENCH_QUEUE_SIZE];
+    uint64_t due_us[BENCH_QUEUE_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint64_t line_free_us;                  /**< 线路空闲时刻 */
+    UART_HandleTypeDef *to;                 /**< 接收端 */
+} bench_channel_t;
+
+typedef struct {
+    uint32_t delivered;                     /**< B收到的不重复命令数 */
+    uint32_t payload_bytes;                 /**< B收到的不重复数据字节数 */
+    uint32_t sent;                          /**< A发出的命令数（不含重发） */
+    uint32_t gave_up;                       /**< A重试后放弃的命令数 */
+    comm_fec_stats_t fec;                   /**< B的纠错统计 */
+} bench_result_t;
+
+static UART_HandleTypeDef g_a;
+static UART_HandleTypeDef g_b;
+static bench_channel_t g_channels[2];
+static uint64_t g_now_us;
+static uint32_t g_byte_us;
+static uint32_t g_flip_threshold;
+static uint32_t g_rng;
+static uint32_t g_last_counter;
+static bench_result_t g_result;
+
+/* =============================================================================
+ * 噪声信道
+ * =============================================================================
+ */
+
+static uint32_t bench_random(void)
+{
+    // xorshift32
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static uint8_t bench_add_noise(uint8_t byte)
+{
+    if (g_flip_threshold == 0) {
+        return byte;
+    }
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        if (bench_random() < g_flip_threshold) {
+            byte ^= (uint8_t)(1u << bit);
+        }
+    }
+    return byte;
+}
+
+static void bench_tx_hook(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size)
+{
+    bench_channel_t *ch = (huart == &g_a) ? &g_channels[0] : &g_channels[1];
+    uint64_t t = (ch->line_free_us > g_now_us) ? ch->line_free_us : g_now_us;
+
+    for (uint16_t i = 0; i < size; i++) {
+        if (ch->tail - ch->head >= BENCH_QUEUE_SIZE) {
+            break;      // 相当于发送端FIFO溢出，不会在正常参数下发生
+        }
+        t += g_byte_us;
+        uint32_t idx = ch->tail++ % BENCH_QUEUE_SIZE;
+        ch->bytes[idx] = bench_add_noise(data[i]);
+        ch->due_us[idx] = t;
+    }
+    ch->line_free_us = t;
+}
+
+static void bench_deliver(bench_channel_t *ch)
+{
+    comm_instance_t *instance = comm_find_instance(ch->to);
+    while (ch->head != ch->tail && ch->due_us[ch->head % BENCH_QUEUE_SIZE] <= g_now_us) {
+        instance->rx_byte = ch->bytes[ch->head++ % BENCH_QUEUE_SIZE];
+        comm_uart_rx_callback(ch->to);
+    }
+}
+
+/* =============================================================================
+ * 应用
+ * =============================================================================
+ */
+
+static void bench_on_data(const char *cmd, const char *data)
+{
+    (void)cmd;
+    // 数据末尾是计数，重发被库去重，这里再按计数去重一次
+    const char *counter = strrchr(data, '=');
+    uint32_t value = (counter != NULL) ? (uint32_t)strtoul(counter + 1, NULL, 10) : 0;
+    if (value != g_last_counter) {
+        g_last_counter = value;
+        g_result.delivered++;
+        g_result.payload_bytes += (uint32_t)strlen(data);
+    }
+}
+
+static void bench_on_fail(const char *cmd, const char *data, const char *reason)
+{
+    (void)cmd; (void)data; (void)reason;
+    g_result.gave_up++;
+}
+
+/**
+ * @brief  推进模拟时间，按毫秒调用comm_tick()
+ */
+static void bench_run(uint64_t until_us, bool send)
+{
+    char payload[64];
+    uint32_t last_ms = (uint32_t)(g_now_us / 1000);
+
+    while (g_now_us < until_us) {
+        bench_deliver(&g_channels[0]);
+        bench_deliver(&g_channels[1]);
+
+        uint32_t ms = (uint32_t)(g_now_us / 1000);
+        if (ms != last_ms) {
+            last_ms = ms;
+            hal_host_tick = ms;
+            comm_tick();
+        }
+
+        if (send && comm_is_ready(&g_a)) {
+            g_result.sent++;
+            snprintf(payload, sizeof(payload), "T=25.61,H=48.20,P=1013.25,V=3.301,I=0.125,N=%05lu",
+                     (unsigned long)(g_result.sent % 100000));
+            comm_send_command(&g_a, "DAT", payload);
+        }
+
+        g_now_us += BENCH_STEP_US;
+    }
+}
+
+static void bench_once(double ber, bool fec, uint32_t seconds, bench_result_t *result)
+{
+    memset(g_channels, 0, sizeof(g_channels));
+    memset(&g_result, 0, sizeof(g_result));
+    memset(&g_a, 0, sizeof(g_a));
+    memset(&g_b, 0, sizeof(g_b));
+    g_channels[0].to = &g_b;
+    g_channels[1].to = &g_a;
+    g_now_us = 0;
+    hal_host_tick = 0;
+    g_last_counter = 0;
+    g_flip_threshold = 0;
+    g_rng = 0x2545F491u;
+
+    comm_init();
+    comm_add_uart(&g_a);
+    comm_add_uart(&g_b);
+    comm_register_command_callback(&g_b, "DAT", bench_on_data);
+    comm_register_fail_callback(&g_a, bench_on_fail);
+
+    if (fec) {
+        // 无噪声时完成协商
+        comm_fec_enable(&g_a);
+        bench_run(50000, false);
+        if (!comm_fec_is_active(&g_a) || !comm_fec_is_active(&g_b)) {
+            fprintf(stderr, "纠错协商失败\n");
+            exit(1);
+        }
+    }
+
+    memset(&g_result, 0, sizeof(g_result));
+    g_flip_threshold = (uint32_t)(ber * 4294967296.0);
+    uint64_t start = g_now_us;
+    bench_run(start + (uint64_t)seconds * 1000000u, true);
+
+    comm_fec_get_stats(&g_b, &g_result.fec);
+    *result = g_result;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seconds = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 20;
+    uint32_t baud = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : 115200;
+    if (seconds == 0) seconds = 1;
+    if (baud == 0) baud = 115200;
+    g_byte_us = (10000000u + baud - 1) / baud;
+
+    static const double bers[] = { 0, 1e-5, 1e-4, 3e-4, 1e-3, 2e-3, 3e-3, 5e-3 };
+
+    hal_host_tx_hook = bench_tx_hook;
+    printf("%lu bps，每点模拟 %lu s，校验字节 %d（每帧最多纠正 %d 字节）\n",
+           (unsigned long)baud, (unsigned long)seconds, COMM_FEC_PARITY, COMM_FEC_PARITY / 2);
+    printf("%-8s | %-30s | %-44s\n", "BER", "无纠错: 吞吐B/s  送达  放弃", "纠错: 吞吐B/s  送达  放弃  纠正帧  失败帧");
+
+    for (size_t i = 0; i < sizeof(bers) / sizeof(bers[0]); i++) {
+        bench_result_t plain;
+        bench_result_t coded;
+        bench_once(bers[i], false, seconds, &plain);
+        bench_once(bers[i], true, seconds, &coded);
+
+        printf("%-8.0e | %8.1f %7lu %5lu       | %8.1f %7lu %5lu %7lu %7lu   (%.2fx)\n", bers[i],
+               (double)plain.payload_bytes / seconds, (unsigned long)plain.delivered,
+               (unsigned long)plain.gave_up,
+               (double)coded.payload_bytes / seconds, (unsigned long)coded.delivered,
+               (unsigned long)coded.gave_up, (unsigned long)coded.fec.rx_corrected,
+               (unsigned long)coded.fec.rx_failed,
+               plain.payload_bytes ? (double)coded.payload_bytes / plain.payload_bytes : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file    comm_pubsub_test.c
+ * @brief   发布/订阅测试（主机程序） - 检查先订阅后声明、订阅周期、取消订阅和主题表占用
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ *
+ * 编译（在Comm目录下，comm_internal.h中COMM_ENABLE_PUBSUB为1、COMM_ENABLE_RTOS为0）:
+ *   gcc -std=gnu11 -O2 -I tools/host -I . -I ../Uart -o comm_pubsub_test tools/comm_pubsub_test.c tools/host/hal_host.c comm*.c
+ *
+ * 用法:
+ *   comm_pubsub_test
+ *
+ * 实例A发布，实例B订阅，发送直接回环到对端的接收中断。依次检查:
+ *   - B在A声明主题之前订阅：SUB被ACK后记录下来，A声明并发布后B收到，无确认和可靠主题都一样
+ *   - 连续发布时按订阅周期发送，只发最新值
+ *   - 声明之前取消订阅：记录的表项被释放，不占用主题表
+ *   - 对端订阅的主题占满主题表时，本端声明的主题仍能加入，其余记录的订阅保留
+ * 全部通过时打印"OK"并返回0，失败时打印出错的一步并返回1。
+ */
+
+#include "comm.h"
+#include "comm_manager.h"
+#include "comm_pubsub.h"
+#include <stdio.h>
+#include <string.h>
+
+#if !COMM_ENABLE_PUBSUB
+#error "comm_pubsub_test需要在comm_internal.h中启用COMM_ENABLE_PUBSUB"
+#endif
+
+#define TEST_CHECK(cond, step)  do { if (!(cond)) { printf("失败: %s\n", step); return 1; } } while (0)
+
+/* 一个主题收到的更新 */
+typedef struct {
+    uint32_t count;
+    char value[COMM_PUBSUB_MAX_VALUE_LENGTH + 1];
+} test_topic_t;
+
+static UART_HandleTypeDef g_a;
+static UART_HandleTypeDef g_b;
+static test_topic_t g_temp;
+static test_topic_t g_alarm;
+static test_topic_t g_other;
+
+static void test_tx_hook(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size)
+{
+    UART_HandleTypeDef *peer = (huart == &g_a) ? &g_b : &g_a;
+    comm_instance_t *instance = comm_find_instance(peer);
+    for (uint16_t i = 0; i < size; i++) {
+        instance->rx_byte = data[i];
+        comm_uart_rx_callback(peer);
+    }
+}
+
+static void test_run(uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++) {
+        hal_host_tick++;
+        comm_tick();
+    }
+}
+
+static void test_on_topic(UART_HandleTypeDef *huart, const char *topic, const char *value,
+                          uint16_t value_len, void *user_ctx)
+{
+    (void)huart; (void)topic; (void)value_len;
+    test_topic_t *received = (test_topic_t *)user_ctx;
+    received->count++;
+    snprintf(received->value, sizeof(received->value), "%s", value);
+}
+
+static void test_setup(void)
+{
+    memset(&g_temp, 0, sizeof(g_temp));
+    memset(&g_alarm, 0, sizeof(g_alarm));
+    memset(&g_other, 0, sizeof(g_other));
+    comm_init();
+    comm_add_uart(&g_a);
+    comm_add_uart(&g_b);
+}
+
+int main(void)
+{
+    char value[16];
+
+    hal_host_tx_hook = test_tx_hook;
+    test_setup();
+
+    // 先订阅：A还没有声明这两个主题
+    TEST_CHECK(comm_subscribe(&g_b, "TEMP", 100, test_on_topic, &g_temp) &&
+               comm_subscribe(&g_b, "ALARM", 0, test_on_topic, &g_alarm), "订阅");
+    test_run(200);
+    TEST_CHECK(!comm_publish(&g_a, "TEMP", "1"), "声明之前不能发布");
+
+    // 后声明：记录的订阅生效，第一次发布立即发出
+    TEST_CHECK(comm_advertise_topic(&g_a, "TEMP", COMM_TOPIC_BEST_EFFORT) &&
+               comm_advertise_topic(&g_a, "ALARM", COMM_TOPIC_RELIABLE), "声明");
+    TEST_CHECK(comm_publish(&g_a, "TEMP", "25.3") && comm_publish(&g_a, "ALARM", "HIGH"), "发布");
+    test_run(50);
+    printf("先订阅后声明: TEMP %lu次 \"%s\", ALARM %lu次 \"%s\"\n",
+           (unsigned long)g_temp.count, g_temp.value, (unsigned long)g_alarm.count, g_alarm.value);
+    TEST_CHECK(g_temp.count == 1 && strcmp(g_temp.value, "25.3") == 0, "先订阅的无确认主题");
+    TEST_CHECK(g_alarm.count == 1 && strcmp(g_alarm.value, "HIGH") == 0, "先订阅的可靠主题");
+
+    // 每毫秒发布一次，按100ms的订阅周期发送最新值
+    for (int i = 0; i < 1000; i++) {
+        snprintf(value, sizeof(value), "%d", i);
+        comm_publish(&g_a, "TEMP", value);
+        test_run(1);
+    }
+    test_run(200);
+    printf("1000次发布:   TEMP %lu次 \"%s\"\n", (unsigned long)g_temp.count, g_temp.value);
+    TEST_CHECK(g_temp.count >= 10 && g_temp.count <= 12 && strcmp(g_temp.value, "999") == 0, "按订阅周期发送");
+
+    // 声明之前取消订阅：表项释放，A仍能声明COMM_PUBSUB_MAX_TOPICS个主题
+    test_setup();
+    TEST_CHECK(comm_subscribe(&g_b, "HUM", 0, test_on_topic, &g_other), "订阅HUM");
+    test_run(50);
+    TEST_CHECK(comm_unsubscribe(&g_b, "HUM"), "取消订阅HUM");
+    test_run(50);
+    for (int i = 0; i < COMM_PUBSUB_MAX_TOPICS; i++) {
+        snprintf(value, sizeof(value), "T%d", i);
+        TEST_CHECK(comm_advertise_topic(&g_a, value, COMM_TOPIC_BEST_EFFORT), "取消订阅后声明");
+    }
+    TEST_CHECK(!comm_advertise_topic(&g_a, "HUM", COMM_TOPIC_BEST_EFFORT), "主题表已满");
+
+    // 对端订阅的主题占满主题表：本端声明的主题优先
+    test_setup();
+    for (int i = 0; i < COMM_PUBSUB_MAX_TOPICS; i++) {
+        snprintf(value, sizeof(value), "X%d", i);
+        TEST_CHECK(comm_subscribe(&g_b, value, 0, test_on_topic, &g_other), "订阅不存在的主题");
+    }
+    test_run(200);
+    TEST_CHECK(comm_advertise_topic(&g_a, "TEMP", COMM_TOPIC_BEST_EFFORT), "占满后声明");
+    TEST_CHECK(comm_publish(&g_a, "TEMP", "1") && !comm_publish(&g_a, "X3", "3"), "未声明的主题不能发布");
+    TEST_CHECK(comm_advertise_topic(&g_a, "X3", COMM_TOPIC_BEST_EFFORT) && comm_publish(&g_a, "X3", "3"), "声明X3");
+    test_run(50);
+    TEST_CHECK(g_other.count == 1 && strcmp(g_other.value, "3") == 0, "保留的订阅仍然生效");
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file    comm_replay.c
+ * @brief   抓包回放工具（主机程序） - 按原时序重新执行抓包记录，核对行为并计时
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ *
+ * 编译（在Comm目录下，comm_internal.h中的功能开关与抓包端一致、COMM_ENABLE_CAPTURE为1、
+ * COMM_ENABLE_RTOS为0）:
+ *   gcc -std=gnu11 -O2 -I tools/host -I . -I ../Uart -o comm_replay tools/comm_replay.c tools/host/hal_host.c comm*.c
+ *
+ * 用法:
+ *   comm_replay <抓包文件> [重复次数]
+ *
+ * 库重新产生的每次发送都与记录逐条核对内容和时刻：全部一致说明当前代码在同样的输入和
+ * 时序下行为不变；不一致时给出第一次不一致的时间。重复多次时输出最快一次的耗时，用于性能对比。
+ *
+ * 应用注册的回调会影响回复内容，需要时在另一个文件中实现comm_replay_setup()，
+ * 注册与抓包端相同的回调并做其它初始化。
+ */
+
+#include "comm.h"
+#include "comm_capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !COMM_ENABLE_CAPTURE
+#error "comm_replay需要在comm_internal.h中启用COMM_ENABLE_CAPTURE"
+#endif
+
+static UART_HandleTypeDef g_uarts[COMM_MAX_INSTANCES];
+
+/* =============================================================================
+ * 回放
+ * =============================================================================
+ */
+
+/**
+ * @brief  应用初始化钩子，默认不注册任何回调
+ * @param  uarts: 按抓包端添加顺序排列的UART句柄
+ * @param  count: 实例数
+ */
+__attribute__((weak)) void comm_replay_setup(UART_HandleTypeDef *uarts, uint8_t count)
+{
+    (void)uarts;
+    (void)count;
+}
+
+static void replay_set_tick(uint32_t now)
+{
+    hal_host_tick = now;
+}
+
+static double replay_elapsed_us(const struct timespec *begin, const struct timespec *end)
+{
+    return (double)(end->tv_sec - begin->tv_sec) * 1e6 + (double)(end->tv_nsec - begin->tv_nsec) / 1e3;
+}
+
+/**
+ * @brief  从头初始化库并回放一次
+ * @retval true: 记录完整回放
+ */
+static bool replay_once(const uint8_t *log, uint32_t length, comm_capture_stats_t *stats, double *elapsed_us)
+{
+    uint8_t count = log[5];
+
+    // 初始化期间的时刻与抓包开始时一致
+    hal_host_tick = (uint32_t)log[8] | ((uint32_t)log[9] << 8) | ((uint32_t)log[10] << 16) | ((uint32_t)log[11] << 24);
+    memset(g_uarts, 0, sizeof(g_uarts));
+
+    comm_init();
+    for (uint8_t i = 0; i < count; i++) {
+        if (!comm_add_uart(&g_uarts[i])) {
+            fprintf(stderr, "添加第%d个实例失败\n", i);
+            return false;
+        }
+    }
+    comm_replay_setup(g_uarts, count);
+
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    bool ok = comm_capture_replay(log, length, replay_set_tick, stats);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    *elapsed_us = replay_elapsed_us(&begin, &end);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "用法: %s <抓包文件> [重复次数]\n", argv[0]);
+        return 2;
+    }
+    int repeat = (argc > 2) ? atoi(argv[2]) : 1;
+    if (repeat < 1) repeat = 1;
+
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        perror(argv[1]);
+        return 2;
+    }
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (file_size < COMM_CAPTURE_HEADER_SIZE) {
+        fprintf(stderr, "%s: 不是抓包记录\n", argv[1]);
+        fclose(file);
+        return 2;
+    }
+
+    uint32_t length = (uint32_t)file_size;
+    uint8_t *log = malloc(length);
+    if (log == NULL || fread(log, 1, length, file) != length) {
+        fprintf(stderr, "%s: 读取失败\n", argv[1]);
+        fclose(file);
+        return 2;
+    }
+    fclose(file);
+
+    comm_capture_stats_t stats = {0};
+    double best_us = 0;
+    for (int r = 0; r < repeat; r++) {
+        double us = 0;
+        if (!replay_once(log, length, &stats, &us)) {
+            return 1;
+        }
+        if (r == 0 || us < best_us) best_us = us;
+    }
+
+    printf("记录 %lu 条, 接收 %lu 字节, 发送 %lu 字节, comm_tick %lu 次, 覆盖 %lu ms\n",
+           (unsigned long)stats.records, (unsigned long)stats.rx_bytes, (unsigned long)stats.tx_bytes,
+           (unsigned long)stats.ticks, (unsigned long)stats.duration_ms);
+    printf("回放耗时 %.1f us (%.3f us/接收字节)\n", best_us,
+           stats.rx_bytes ? best_us / stats.rx_bytes : 0.0);
+
+    if (stats.tx_mismatched == 0 && stats.tx_missing == 0 && stats.tx_extra == 0) {
+        printf("行为一致: %lu 次发送全部吻合\n", (unsigned long)stats.tx_matched);
+        return 0;
+    }
+    printf("行为不一致: 吻合 %lu, 不一致 %lu, 缺少 %lu, 多出 %lu, 第一次不一致在 %lu ms\n",
+           (unsigned long)stats.tx_matched, (unsigned long)stats.tx_mismatched, (unsigned long)stats.tx_missing,
+           (unsigned long)stats.tx_extra, (unsigned long)stats.first_mismatch_ms);
+    return 1;
+}
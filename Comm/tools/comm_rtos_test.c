@@ -0,0 +1,185 @@
+/**
+ * @file    comm_rtos_test.c
+ * @brief   RTOS运行时测试（主机程序） - 在pthread实现的FreeRTOS替身上检查请求队列、任务通知和阻塞发送
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ *
+ * 编译（在Comm目录下，comm_internal.h中COMM_ENABLE_RTOS为1）:
+ *   gcc -std=gnu11 -O2 -pthread -I tools/host -I . -I ../Uart -o comm_rtos_test tools/comm_rtos_test.c tools/host/hal_host.c tools/host/freertos_host.c comm*.c
+ *
+ * 用法:
+ *   comm_rtos_test 2>/dev/null
+ *
+ * 两个实例A、B的发送直接回环到对方的接收中断，接收中断在发送线程（通信任务）中执行；
+ * 一个线程每毫秒更新hal_host_tick代替SysTick。依次检查:
+ *   - 阻塞发送由接收中断的任务通知唤醒，几毫秒内返回OK
+ *   - 参数错误返回REJECTED，异步请求在实例忙时排队、按顺序发出
+ *   - 两个任务同时向同一实例阻塞发送，全部成功且不丢帧
+ *   - 对端静默时阻塞发送在期限处返回TIMEOUT，期限足够长时重试用尽返回FAILED
+ *   - 一直发不出去的异步请求超过COMM_RTOS_REQUEST_TTL_MS后以"发送期限已过"调用失败回调
+ * 全部通过时打印"OK"并返回0，失败时打印出错的一步并返回1。库的错误输出在stderr。
+ */
+
+#include "comm.h"
+#include "comm_manager.h"
+#include "comm_rtos.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+#if !COMM_ENABLE_RTOS
+#error "comm_rtos_test需要在comm_internal.h中启用COMM_ENABLE_RTOS"
+#endif
+
+#define TEST_CHECK(cond, step)  do { if (!(cond)) { printf("失败: %s\n", step); return 1; } } while (0)
+
+static UART_HandleTypeDef g_a;
+static UART_HandleTypeDef g_b;
+static volatile int g_b_silent;             /**< B不发送任何字节（对端静默） */
+static volatile int g_received;
+static volatile int g_failures;
+static char g_last_reason[32];
+
+/* =============================================================================
+ * 模拟硬件
+ * =============================================================================
+ */
+
+static void test_tx_hook(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size)
+{
+    if (huart == &g_b && g_b_silent) {
+        return;
+    }
+
+    UART_HandleTypeDef *peer = (huart == &g_a) ? &g_b : &g_a;
+    comm_instance_t *instance = comm_find_instance(peer);
+    for (uint16_t i = 0; i < size; i++) {
+        instance->rx_byte = data[i];
+        comm_uart_rx_callback(peer);
+    }
+}
+
+static void *test_systick(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        hal_host_tick = xTaskGetTickCount();
+        vTaskDelay(1);
+    }
+    return NULL;
+}
+
+/* =============================================================================
+ * 应用
+ * =============================================================================
+ */
+
+static void test_on_data(UART_HandleTypeDef *huart, const char *cmd, const char *data, uint16_t len, void *ctx)
+{
+    (void)huart; (void)cmd; (void)data; (void)len; (void)ctx;
+    g_received++;
+}
+
+static void test_on_fail(const char *cmd, const char *data, const char *reason)
+{
+    (void)cmd; (void)data;
+    g_failures++;
+    snprintf(g_last_reason, sizeof(g_last_reason), "%s", reason);
+}
+
+static void *test_sender(void *arg)
+{
+    (void)arg;
+    long ok = 0;
+    for (int i = 0; i < 20; i++) {
+        if (comm_rtos_send_wait(&g_a, "X", "T", 500) == COMM_RTOS_OK) {
+            ok++;
+        }
+    }
+    return (void *)ok;
+}
+
+int main(void)
+{
+    pthread_t ticker;
+    setvbuf(stdout, NULL, _IONBF, 0);
+    hal_host_tx_hook = test_tx_hook;
+    pthread_create(&ticker, NULL, test_systick, NULL);
+
+    comm_init();
+    comm_add_uart(&g_a);
+    comm_add_uart(&g_b);
+    comm_register_command_callback_ex(&g_b, "X", test_on_data, NULL);
+    comm_register_fail_callback(&g_a, test_on_fail);
+
+    TEST_CHECK(!comm_rtos_send(&g_a, "X", "1", 0), "启动前的请求应被拒绝");
+    TEST_CHECK(comm_rtos_start() && !comm_rtos_start(), "启动通信任务");
+
+    // 阻塞发送：ACK由接收中断的任务通知唤醒，不靠轮询
+    TickType_t t = xTaskGetTickCount();
+    comm_rtos_result_t r = comm_rtos_send_wait(&g_a, "X", "1", 500);
+    printf("阻塞发送: 结果%d，用时%lu ms\n", r, (unsigned long)(xTaskGetTickCount() - t));
+    TEST_CHECK(r == COMM_RTOS_OK && g_received == 1 && xTaskGetTickCount() - t <= 5, "阻塞发送");
+
+    TEST_CHECK(comm_rtos_send_wait(&g_a, "TOOLONGCOMMANDNAME1234", "1", 100) == COMM_RTOS_REJECTED,
+               "命令过长应返回REJECTED");
+
+    // 异步请求在实例忙时排队，依次发出
+    for (int i = 0; i < 8; i++) {
+        TEST_CHECK(comm_rtos_send(&g_a, "X", "A", 100), "异步请求入队");
+    }
+    vTaskDelay(50);
+    printf("异步发送: 收到%d\n", g_received);
+    TEST_CHECK(g_received == 9, "异步请求全部送达");
+
+    // 两个任务同时向同一实例发送
+    pthread_t a, b;
+    void *ok_a;
+    void *ok_b;
+    pthread_create(&a, NULL, test_sender, NULL);
+    pthread_create(&b, NULL, test_sender, NULL);
+    pthread_join(a, &ok_a);
+    pthread_join(b, &ok_b);
+    printf("并发发送: %ld + %ld 成功，收到%d\n", (long)ok_a, (long)ok_b, g_received);
+    TEST_CHECK((long)ok_a == 20 && (long)ok_b == 20 && g_received == 49, "并发阻塞发送");
+
+#if COMM_ENABLE_CREDITS
+    // 静默的对端不会发放额度，后面的检查不适用
+    printf("OK\n");
+    return 0;
+#endif
+
+    // 对端静默：短期限在期限处返回TIMEOUT
+    g_b_silent = 1;
+    t = xTaskGetTickCount();
+    r = comm_rtos_send_wait(&g_a, "X", "2", 300);
+    TickType_t elapsed = xTaskGetTickCount() - t;
+    printf("对端静默(300ms期限): 结果%d，用时%lu ms\n", r, (unsigned long)elapsed);
+    TEST_CHECK(r == COMM_RTOS_TIMEOUT && elapsed >= 300 && elapsed <= 330, "期限处返回TIMEOUT");
+
+    // 等上一条命令重试结束，再用足够长的期限等到重试用尽
+    vTaskDelay(4000);
+    t = xTaskGetTickCount();
+    r = comm_rtos_send_wait(&g_a, "X", "3", 10000);
+    elapsed = xTaskGetTickCount() - t;
+    printf("对端静默(10s期限): 结果%d，用时%lu ms，原因: %s\n", r, (unsigned long)elapsed, g_last_reason);
+    TEST_CHECK(r == COMM_RTOS_FAILED && elapsed >= 3900 && elapsed <= 4100, "重试用尽返回FAILED");
+
+    // 第一条发出后一直重试，第二条排队超过期限
+    int failures = g_failures;
+    comm_rtos_send(&g_a, "X", "4", 0);
+    comm_rtos_send(&g_a, "X", "5", 0);
+    vTaskDelay(COMM_RTOS_REQUEST_TTL_MS + 100);
+    printf("排队过期: 失败回调%d次，原因: %s\n", g_failures - failures, g_last_reason);
+    TEST_CHECK(g_failures - failures == 1 && strcmp(g_last_reason, "发送期限已过") == 0, "排队请求过期");
+
+    // 对端恢复后正常发送
+    g_b_silent = 0;
+    vTaskDelay(3500);
+    TEST_CHECK(comm_rtos_send_wait(&g_a, "X", "6", 500) == COMM_RTOS_OK, "对端恢复后发送");
+
+    printf("OK\n");
+    return 0;
+}
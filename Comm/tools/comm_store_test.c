@@ -0,0 +1,229 @@
+/**
+ * @file    comm_store_test.c
+ * @brief   持久化队列测试（主机程序） - 在comm_store_ram_ops上检查补发顺序、扇区擦除、重启恢复和合并补发
+ * @author  ShanQue
+ * @version 2.0
+ * @date    2026-10-16
+ *
+ * 编译（在Comm目录下，comm_internal.h中COMM_ENABLE_STORE、COMM_ENABLE_BATCH为1，COMM_ENABLE_RTOS为0）:
+ *   gcc -std=gnu11 -O2 -I tools/host -I . -I ../Uart -o comm_store_test tools/comm_store_test.c tools/host/hal_host.c comm*.c
+ *
+ * 用法:
+ *   comm_store_test 2>/dev/null
+ *
+ * 实例A挂接三个扇区的RAM模拟存储，发送直接回环到实例B的接收中断，B可以设为离线（收不到A的任何字节）。
+ * 存储访问经过一层计数包装后交给comm_store_ram_ops。依次检查:
+ *   - 在线时按写入顺序送达，连续的消息合并为BAT帧
+ *   - 离线时补发失败、消息保留在存储中
+ *   - 模拟重启（重新初始化库、再次挂接同一块存储）后扫描恢复未送达的消息，写入中途掉电的残缺记录跳过
+ *   - 恢复在线后按原顺序补发完毕
+ *   - 离线时写满：绕回时擦除已全部送达的扇区，写满后拒绝，恢复在线后一条不少地补发
+ *   - 多次绕回存储区后没有丢失、重复或乱序
+ * 全部通过时打印"OK"并返回0，失败时打印出错的一步并返回1。库的错误输出在stderr。
+ */
+
+#include "comm.h"
+#include "comm_manager.h"
+#include "comm_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !COMM_ENABLE_STORE || !COMM_ENABLE_BATCH
+#error "comm_store_test需要在comm_internal.h中启用COMM_ENABLE_STORE和COMM_ENABLE_BATCH"
+#endif
+
+#define TEST_CHECK(cond, step)  do { if (!(cond)) { printf("失败: %s\n", step); return 1; } } while (0)
+
+#define TEST_SECTORS            3
+#define TEST_SLOTS_PER_SECTOR   (COMM_STORE_SECTOR_SIZE / COMM_STORE_RECORD_SIZE)
+#define TEST_RECORD_CRC         10          /**< 记录中CRC8的位置，见comm_store.h的存储布局 */
+
+static UART_HandleTypeDef g_a;
+static UART_HandleTypeDef g_b;
+static bool g_b_offline;
+static uint8_t g_memory[TEST_SECTORS * COMM_STORE_SECTOR_SIZE];
+static comm_store_ram_t g_ram = { g_memory, sizeof(g_memory) };
+static uint32_t g_erases;
+static long g_expected;                     /**< 下一条应当收到的消息号 */
+static uint32_t g_received;
+static uint32_t g_out_of_order;
+static uint32_t g_torn_received;
+
+/* =============================================================================
+ * 存储和线路
+ * =============================================================================
+ */
+
+static bool test_read(void *ctx, uint32_t offset, void *buffer, uint16_t length)
+{
+    return comm_store_ram_ops.read(ctx, offset, buffer, length);
+}
+
+static bool test_write(void *ctx, uint32_t offset, const void *data, uint16_t length)
+{
+    return comm_store_ram_ops.write(ctx, offset, data, length);
+}
+
+static bool test_erase(void *ctx, uint32_t offset)
+{
+    g_erases++;
+    return comm_store_ram_ops.erase(ctx, offset);
+}
+
+static const comm_store_ops_t g_test_ops = { test_read, test_write, test_erase };
+
+static void test_tx_hook(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size)
+{
+    if (huart == &g_a && g_b_offline) {
+        return;
+    }
+
+    UART_HandleTypeDef *peer = (huart == &g_a) ? &g_b : &g_a;
+    comm_instance_t *instance = comm_find_instance(peer);
+    for (uint16_t i = 0; i < size; i++) {
+        instance->rx_byte = data[i];
+        comm_uart_rx_callback(peer);
+    }
+}
+
+static void test_run(uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++) {
+        hal_host_tick++;
+        comm_tick();
+    }
+}
+
+/* =============================================================================
+ * 应用
+ * =============================================================================
+ */
+
+static void test_on_log(UART_HandleTypeDef *huart, const char *cmd, const char *data, uint16_t len, void *ctx)
+{
+    (void)huart; (void)cmd; (void)len; (void)ctx;
+    if (data[0] == 'X') {
+        g_torn_received++;
+        return;
+    }
+
+    long value = strtol(data, NULL, 10);
+    if (value != g_expected) {
+        g_out_of_order++;
+    }
+    g_expected = value + 1;
+    g_received++;
+}
+
+/**
+ * @brief  初始化库并挂接存储，重复调用相当于重启后再挂接同一块存储
+ */
+static bool test_setup(void)
+{
+    comm_init();
+    comm_add_uart(&g_a);
+    comm_add_uart(&g_b);
+    comm_register_command_callback_ex(&g_b, "LOG", test_on_log, NULL);
+    return comm_store_attach(&g_a, &g_test_ops, &g_ram, sizeof(g_memory));
+}
+
+static bool test_store(long *next, uint32_t count)
+{
+    char data[16];
+    for (uint32_t i = 0; i < count; i++) {
+        snprintf(data, sizeof(data), "%ld", *next);
+        if (!comm_store_send(&g_a, "LOG", data)) {
+            return false;
+        }
+        (*next)++;
+    }
+    return true;
+}
+
+static void test_print(const char *step)
+{
+    comm_store_stats_t stats;
+    comm_store_get_stats(&g_a, &stats);
+    printf("%-12s 未送达%u 容量%u 恢复%u 写入%lu 送达%lu 拒绝%lu 帧%lu 失败%lu | 收到%lu 擦除%lu\n",
+           step, stats.pending, stats.capacity, stats.recovered, (unsigned long)stats.stored,
+           (unsigned long)stats.delivered, (unsigned long)stats.rejected, (unsigned long)stats.frames,
+           (unsigned long)stats.failures, (unsigned long)g_received, (unsigned long)g_erases);
+}
+
+int main(void)
+{
+    comm_store_stats_t stats;
+    long next = 0;
+
+    hal_host_tx_hook = test_tx_hook;
+    memset(g_memory, 0xFF, sizeof(g_memory));
+    TEST_CHECK(test_setup(), "挂接存储");
+    TEST_CHECK(comm_store_get_stats(&g_a, &stats) &&
+               stats.capacity == (TEST_SECTORS - 1) * TEST_SLOTS_PER_SECTOR, "容量");
+
+    // 在线：按顺序送达，合并为BAT帧
+    TEST_CHECK(test_store(&next, 12), "在线写入");
+    test_run(200);
+    test_print("在线");
+    TEST_CHECK(comm_store_get_stats(&g_a, &stats) && stats.pending == 0 && stats.delivered == 12 &&
+               g_received == 12 && g_out_of_order == 0, "在线送达");
+    TEST_CHECK(stats.frames < stats.delivered, "合并补发");
+
+    // 离线：补发失败，消息保留
+    g_b_offline = true;
+    TEST_CHECK(test_store(&next, 10), "离线写入");
+    test_run(5000);
+    test_print("离线");
+    TEST_CHECK(comm_store_get_stats(&g_a, &stats) && stats.pending == 10 && stats.failures > 0 &&
+               g_received == 12, "离线保留");
+
+    // 写入中途掉电：最后一条记录的CRC没有写完
+    TEST_CHECK(comm_store_send(&g_a, "LOG", "X"), "写入残缺记录");
+    uint32_t torn = stats.stored;
+    g_memory[torn / TEST_SLOTS_PER_SECTOR * COMM_STORE_SECTOR_SIZE +
+             torn % TEST_SLOTS_PER_SECTOR * COMM_STORE_RECORD_SIZE + TEST_RECORD_CRC] = 0x00;
+
+    // 重启后再挂接：扫描恢复，残缺记录跳过
+    TEST_CHECK(test_setup(), "重启后挂接");
+    test_print("重启");
+    TEST_CHECK(comm_store_get_stats(&g_a, &stats) && stats.recovered == 10 && stats.pending == 10, "恢复未送达消息");
+
+    g_b_offline = false;
+    test_run(3000);
+    test_print("恢复在线");
+    TEST_CHECK(comm_store_get_stats(&g_a, &stats) && stats.pending == 0 && stats.delivered == 10 &&
+               stats.frames < stats.delivered, "恢复后合并补发");
+    TEST_CHECK(g_received == 22 && g_out_of_order == 0 && g_torn_received == 0, "恢复后按顺序送达");
+
+    // 离线写满：绕回时擦除已送达的扇区，写满后拒绝；擦掉未送达的消息会在补发时少收
+    g_b_offline = true;
+    uint32_t erases = g_erases;
+    uint32_t accepted = 0;
+    while (accepted < 1000 && test_store(&next, 1)) {
+        accepted++;
+    }
+    test_print("写满");
+    TEST_CHECK(comm_store_get_stats(&g_a, &stats) && accepted >= stats.capacity && stats.pending == accepted &&
+               stats.rejected == 1, "写满后拒绝");
+    TEST_CHECK(g_erases > erases, "绕回时擦除扇区");
+
+    g_b_offline = false;
+    test_run(8000);
+    test_print("补发完毕");
+    TEST_CHECK(comm_store_get_stats(&g_a, &stats) && stats.pending == 0 &&
+               g_received == 22 + accepted && g_out_of_order == 0, "写满后补发");
+
+    // 边写边发，多次绕回存储区
+    for (int round = 0; round < 200; round++) {
+        TEST_CHECK(test_store(&next, 3), "持续写入");
+        test_run(5);
+    }
+    test_run(3000);
+    test_print("多次绕回");
+    TEST_CHECK(comm_store_get_stats(&g_a, &stats) && stats.pending == 0 &&
+               g_received == (uint32_t)next && g_out_of_order == 0, "多次绕回");
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file    FreeRTOS.h
+ * @brief   主机工具用的FreeRTOS替身 - 用pthread实现comm_rtos.c用到的任务、任务通知、队列和临界区
+ * @note    仅用于tools/comm_rtos_test.c，函数由freertos_host.c实现；
+ *          任务即线程，没有优先级和抢占，临界区是一把全局互斥锁
+ */
+
+#ifndef COMM_HOST_FREERTOS_H
+#define COMM_HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t StackType_t;
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  1
+#define portMAX_DELAY           0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))      /* 节拍为1ms */
+#define portYIELD_FROM_ISR(x)   ((void)(x))
+
+/* 任务控制块：线程加一个带互斥锁/条件变量的通知值 */
+typedef struct host_task {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t value;                         /**< 通知值 */
+    int pending;                            /**< 有未取走的通知 */
+    void (*entry)(void *);
+    void *arg;
+} StaticTask_t;
+typedef StaticTask_t *TaskHandle_t;
+
+/* 队列：定长环形缓冲区，存储由调用方提供 */
+typedef struct host_queue {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint8_t *storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+} StaticQueue_t;
+typedef StaticQueue_t *QueueHandle_t;
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+
+void taskENTER_CRITICAL(void);
+void taskEXIT_CRITICAL(void);
+
+#endif /* COMM_HOST_FREERTOS_H */
@@ -0,0 +1,295 @@
+/**
+ * @file    freertos_host.c
+ * @brief   主机工具用的FreeRTOS替身实现 - 任务为pthread线程，节拍为CLOCK_MONOTONIC毫秒
+ * @note    仅用于tools/comm_rtos_test.c；只实现comm_rtos.c用到的API，语义按FreeRTOS文档:
+ *          任务通知是每个任务一个32位值加一个"待取"标志，队列按值拷贝、先进先出
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+static pthread_mutex_t g_critical = PTHREAD_MUTEX_INITIALIZER;
+static struct timespec g_start;
+static pthread_once_t g_start_once = PTHREAD_ONCE_INIT;
+static __thread StaticTask_t *g_self;
+
+/* =============================================================================
+ * 时间
+ * =============================================================================
+ */
+
+static void host_start_clock(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &g_start);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec now;
+    pthread_once(&g_start_once, host_start_clock);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (TickType_t)((now.tv_sec - g_start.tv_sec) * 1000 + (now.tv_nsec - g_start.tv_nsec) / 1000000);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = { (time_t)(ticks / 1000), (long)(ticks % 1000) * 1000000 };
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief  计算pthread_cond_timedwait的绝对期限（条件变量使用CLOCK_MONOTONIC）
+ */
+static void host_deadline(struct timespec *ts, TickType_t wait)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += wait / 1000;
+    ts->tv_nsec += (long)(wait % 1000) * 1000000;
+    if (ts->tv_nsec >= 1000000000) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000;
+    }
+}
+
+static void host_cond_init(pthread_mutex_t *mutex, pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(mutex, NULL);
+}
+
+/**
+ * @brief  在已加锁的条件变量上等待ready()成立
+ * @retval 1: 条件成立, 0: 超时
+ */
+static int host_wait(pthread_mutex_t *mutex, pthread_cond_t *cond, TickType_t wait,
+                     int (*ready)(const void *), const void *obj)
+{
+    struct timespec deadline;
+    host_deadline(&deadline, wait);
+
+    while (!ready(obj)) {
+        if (wait == 0) {
+            return 0;
+        }
+        if (wait == portMAX_DELAY) {
+            pthread_cond_wait(cond, mutex);
+        } else if (pthread_cond_timedwait(cond, mutex, &deadline) == ETIMEDOUT) {
+            return ready(obj);
+        }
+    }
+    return 1;
+}
+
+/* =============================================================================
+ * 临界区
+ * =============================================================================
+ */
+
+void taskENTER_CRITICAL(void)
+{
+    pthread_mutex_lock(&g_critical);
+}
+
+void taskEXIT_CRITICAL(void)
+{
+    pthread_mutex_unlock(&g_critical);
+}
+
+/* =============================================================================
+ * 任务和任务通知
+ * =============================================================================
+ */
+
+static void host_task_init(StaticTask_t *task)
+{
+    memset(task, 0, sizeof(StaticTask_t));
+    host_cond_init(&task->mutex, &task->cond);
+}
+
+static void *host_task_entry(void *arg)
+{
+    StaticTask_t *task = (StaticTask_t *)arg;
+    g_self = task;
+    task->entry(task->arg);
+    return NULL;
+}
+
+TaskHandle_t xTaskCreateStatic(void (*entry)(void *), const char *name, uint32_t stack_depth, void *arg,
+                               UBaseType_t priority, StackType_t *stack, StaticTask_t *tcb)
+{
+    (void)name; (void)stack_depth; (void)priority; (void)stack;
+    host_task_init(tcb);
+    tcb->entry = entry;
+    tcb->arg = arg;
+    if (pthread_create(&tcb->thread, NULL, host_task_entry, tcb) != 0) {
+        return NULL;
+    }
+    return tcb;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    // 不是由xTaskCreateStatic()创建的线程（主线程、测试线程）第一次调用时分配控制块
+    static __thread StaticTask_t own;
+    if (g_self == NULL) {
+        host_task_init(&own);
+        g_self = &own;
+    }
+    return g_self;
+}
+
+static int host_notify_pending(const void *obj)
+{
+    return ((const StaticTask_t *)obj)->pending;
+}
+
+static int host_notify_nonzero(const void *obj)
+{
+    return ((const StaticTask_t *)obj)->value != 0;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t wait)
+{
+    StaticTask_t *task = xTaskGetCurrentTaskHandle();
+    uint32_t value = 0;
+
+    pthread_mutex_lock(&task->mutex);
+    if (host_wait(&task->mutex, &task->cond, wait, host_notify_nonzero, task)) {
+        value = task->value;
+        task->value = clear_on_exit ? 0 : value - 1;
+    }
+    task->pending = 0;
+    pthread_mutex_unlock(&task->mutex);
+    return value;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    BaseType_t result = pdPASS;
+
+    pthread_mutex_lock(&task->mutex);
+    switch (action) {
+        case eSetBits:                  task->value |= value; break;
+        case eIncrement:                task->value++; break;
+        case eSetValueWithOverwrite:    task->value = value; break;
+        case eSetValueWithoutOverwrite:
+            if (task->pending) {
+                result = pdFALSE;
+            } else {
+                task->value = value;
+            }
+            break;
+        default: break;
+    }
+    task->pending = 1;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->mutex);
+    return result;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    xTaskNotify(task, 0, eIncrement);
+    if (woken != NULL) {
+        *woken = pdTRUE;
+    }
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t wait)
+{
+    StaticTask_t *task = xTaskGetCurrentTaskHandle();
+
+    pthread_mutex_lock(&task->mutex);
+    if (!task->pending) {
+        task->value &= ~clear_on_entry;
+    }
+    int got = host_wait(&task->mutex, &task->cond, wait, host_notify_pending, task);
+    if (got) {
+        if (value != NULL) {
+            *value = task->value;
+        }
+        task->value &= ~clear_on_exit;
+        task->pending = 0;
+    }
+    pthread_mutex_unlock(&task->mutex);
+    return got ? pdTRUE : pdFALSE;
+}
+
+/* =============================================================================
+ * 队列
+ * =============================================================================
+ */
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *storage, StaticQueue_t *queue)
+{
+    memset(queue, 0, sizeof(StaticQueue_t));
+    host_cond_init(&queue->mutex, &queue->cond);
+    queue->storage = storage;
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+static int host_queue_has_space(const void *obj)
+{
+    const StaticQueue_t *queue = (const StaticQueue_t *)obj;
+    return queue->count < queue->length;
+}
+
+static int host_queue_has_item(const void *obj)
+{
+    return ((const StaticQueue_t *)obj)->count > 0;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait)
+{
+    pthread_mutex_lock(&queue->mutex);
+    int ok = host_wait(&queue->mutex, &queue->cond, wait, host_queue_has_space, queue);
+    if (ok) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->storage + tail * queue->item_size, item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+static BaseType_t host_queue_get(QueueHandle_t queue, void *item, TickType_t wait, int remove)
+{
+    pthread_mutex_lock(&queue->mutex);
+    int ok = host_wait(&queue->mutex, &queue->cond, wait, host_queue_has_item, queue);
+    if (ok) {
+        memcpy(item, queue->storage + queue->head * queue->item_size, queue->item_size);
+        if (remove) {
+            queue->head = (queue->head + 1) % queue->length;
+            queue->count--;
+            pthread_cond_broadcast(&queue->cond);
+        }
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait)
+{
+    return host_queue_get(queue, item, wait, 1);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t wait)
+{
+    return host_queue_get(queue, item, wait, 0);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file    hal_host.c
+ * @brief   主机工具用的HAL替身实现 - 时间由工具设置，发送交给工具的钩子（未设置时丢弃），错误输出打印到stderr
+ * @note    仅用于tools目录下的主机程序
+ */
+
+#include "stm32f4xx_hal.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+uint32_t hal_host_tick;
+void (*hal_host_tx_hook)(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size);
+UART_HandleTypeDef huart1;                  /* COMM_ERROR_UART */
+static SysTick_Type g_systick;
+SysTick_Type *SysTick = &g_systick;
+
+uint32_t HAL_GetTick(void)
+{
+    return hal_host_tick;
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *data, uint16_t size, uint32_t timeout)
+{
+    (void)timeout;
+    if (hal_host_tx_hook != NULL) {
+        hal_host_tx_hook(huart, data, size);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, uint8_t *data, uint16_t size)
+{
+    // 发送完成中断由工具自行调用comm_uart_tx_callback()重现
+    if (hal_host_tx_hook != NULL) {
+        hal_host_tx_hook(huart, data, size);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *data, uint16_t size)
+{
+    (void)huart; (void)data; (void)size;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive_IT(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+    return HAL_OK;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state)
+{
+    (void)port; (void)pin; (void)state;
+}
+
+HAL_StatusTypeDef USARTx_printf(UART_HandleTypeDef huartx, const char *format, ...)
+{
+    (void)huartx;
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    return HAL_OK;
+}
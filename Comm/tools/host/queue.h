@@ -0,0 +1,17 @@
+/**
+ * @file    queue.h
+ * @brief   主机工具用的FreeRTOS队列替身
+ * @note    仅用于tools/comm_rtos_test.c，函数由freertos_host.c实现
+ */
+
+#ifndef COMM_HOST_QUEUE_H
+#define COMM_HOST_QUEUE_H
+
+#include "FreeRTOS.h"
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *storage, StaticQueue_t *queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait);
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t wait);
+
+#endif /* COMM_HOST_QUEUE_H */
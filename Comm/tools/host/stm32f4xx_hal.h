@@ -0,0 +1,55 @@
+/**
+ * @file    stm32f4xx_hal.h
+ * @brief   主机工具用的最小HAL替身 - 只提供通信库用到的类型和函数声明
+ * @note    仅用于tools目录下主机程序的编译，函数由hal_host.c实现
+ */
+
+#ifndef COMM_HOST_HAL_H
+#define COMM_HOST_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+
+typedef struct { volatile uint32_t ODR; } GPIO_TypeDef;
+typedef struct { volatile uint32_t SR; volatile uint32_t DR; } USART_TypeDef;
+typedef struct { uint32_t BaudRate; uint32_t WordLength; uint32_t StopBits; uint32_t Parity; } UART_InitTypeDef;
+typedef struct {
+    USART_TypeDef *Instance;
+    UART_InitTypeDef Init;
+    volatile uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+typedef struct { volatile uint32_t VAL; } SysTick_Type;
+extern SysTick_Type *SysTick;
+
+#define HAL_UART_ERROR_NONE 0x00000000U
+#define HAL_UART_ERROR_PE   0x00000001U
+#define HAL_UART_ERROR_NE   0x00000002U
+#define HAL_UART_ERROR_FE   0x00000004U
+#define HAL_UART_ERROR_ORE  0x00000008U
+#define HAL_MAX_DELAY       0xFFFFFFFFU
+
+/* 主机上没有中断，临界区为空 */
+#define __get_PRIMASK()     (0U)
+#define __set_PRIMASK(x)    ((void)(x))
+#define __disable_irq()     ((void)0)
+#define __enable_irq()      ((void)0)
+
+/* 主机专用：HAL_GetTick()的返回值，由工具设置 */
+extern uint32_t hal_host_tick;
+
+/* 主机专用：发送的字节交给工具（例如模拟信道），为NULL时丢弃 */
+extern void (*hal_host_tx_hook)(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size);
+
+uint32_t HAL_GetTick(void);
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_UART_AbortReceive_IT(UART_HandleTypeDef *huart);
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+
+#endif /* COMM_HOST_HAL_H */
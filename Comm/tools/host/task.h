@@ -0,0 +1,24 @@
+/**
+ * @file    task.h
+ * @brief   主机工具用的FreeRTOS任务和任务通知替身
+ * @note    仅用于tools/comm_rtos_test.c，函数由freertos_host.c实现
+ */
+
+#ifndef COMM_HOST_TASK_H
+#define COMM_HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+TaskHandle_t xTaskCreateStatic(void (*entry)(void *), const char *name, uint32_t stack_depth, void *arg,
+                               UBaseType_t priority, StackType_t *stack, StaticTask_t *tcb);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+void vTaskDelay(TickType_t ticks);
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t wait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t wait);
+
+#endif /* COMM_HOST_TASK_H */
@@ -0,0 +1,2 @@
+/* 主机工具用替身，见stm32f4xx_hal.h */
+#include "stm32f4xx_hal.h"